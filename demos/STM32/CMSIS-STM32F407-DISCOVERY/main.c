@@ -15,6 +15,7 @@
 */
 
 #include "hal.h"
+#include "chprintf.h"
 #include "cmsis_os.h"
 
 /*
@@ -38,6 +39,114 @@ static void Thread1(void const *arg) {
  */
 osThreadDef(Thread1, osPriorityAboveNormal, 128, "blinker");
 
+/*
+ * Objects used by the wrapper overhead benchmark, each operation is
+ * performed through the native RT API and through the CMSIS API.
+ */
+osMutexDef(bench_mutex);
+osSemaphoreDef(bench_semaphore);
+osMessageQDef(bench_queue, 4, uint32_t);
+
+static mutex_t mtx;
+static semaphore_t sem;
+static mailbox_t mb;
+static msg_t mb_buffer[4];
+
+static osMutexId mutex_id;
+static osSemaphoreId semaphore_id;
+static osMessageQId queue_id;
+
+static void native_mutex(void) {
+
+  chMtxLock(&mtx);
+  chMtxUnlock(&mtx);
+}
+
+static void cmsis_mutex(void) {
+
+  (void) osMutexWait(mutex_id, osWaitForever);
+  (void) osMutexRelease(mutex_id);
+}
+
+static void native_semaphore(void) {
+
+  chSemSignal(&sem);
+  (void) chSemWait(&sem);
+}
+
+static void cmsis_semaphore(void) {
+
+  (void) osSemaphoreRelease(semaphore_id);
+  (void) osSemaphoreWait(semaphore_id, osWaitForever);
+}
+
+static void native_queue(void) {
+  msg_t msg;
+
+  (void) chMBPostTimeout(&mb, (msg_t)0, TIME_INFINITE);
+  (void) chMBFetchTimeout(&mb, &msg, TIME_INFINITE);
+}
+
+static void cmsis_queue(void) {
+
+  (void) osMessagePut(queue_id, 0U, osWaitForever);
+  (void) osMessageGet(queue_id, osWaitForever);
+}
+
+/*
+ * Counts the operations executed in one second.
+ */
+static uint32_t bench_run(void (*op)(void)) {
+  systime_t start, end;
+  uint32_t n = 0U;
+
+  /* Starting at the beginning of a tick.*/
+  chThdSleep((sysinterval_t)1);
+  start = chVTGetSystemTimeX();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    op();
+    n++;
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  return n;
+}
+
+static void bench_compare(BaseSequentialStream *chp, const char *name,
+                          void (*native)(void), void (*cmsis)(void)) {
+  uint32_t n, c;
+  int overhead;
+
+  n = bench_run(native);
+  c = bench_run(cmsis);
+
+  /* Negative when the CMSIS call is the faster one.*/
+  overhead = 0;
+  if (c > 0U) {
+    overhead = (int)(((uint64_t)n * 100U) / c) - 100;
+  }
+  chprintf(chp, "%-10s native %7U ops/s, CMSIS %7U ops/s, overhead %4d%%\r\n",
+           name, n, c, overhead);
+}
+
+/*
+ * Per-call overhead of the CMSIS wrapper against the native RT calls.
+ */
+static void bench_execute(BaseSequentialStream *chp) {
+
+  chMtxObjectInit(&mtx);
+  chSemObjectInit(&sem, (cnt_t)0);
+  chMBObjectInit(&mb, mb_buffer, 4);
+  mutex_id = osMutexCreate(osMutex(bench_mutex));
+  semaphore_id = osSemaphoreCreate(osSemaphore(bench_semaphore), 0);
+  queue_id = osMessageCreate(osMessageQ(bench_queue), NULL);
+
+  chprintf(chp, "CMSIS RTOS wrapper overhead\r\n");
+  bench_compare(chp, "mutex", native_mutex, cmsis_mutex);
+  bench_compare(chp, "semaphore", native_semaphore, cmsis_semaphore);
+  bench_compare(chp, "queue", native_queue, cmsis_queue);
+}
+
 /*
  * Application entry point.
  */
@@ -65,6 +174,9 @@ int main(void) {
      by default.*/
   osKernelStart();
 
+  /* Measuring the wrapper overhead once, before the main loop.*/
+  bench_execute((BaseSequentialStream *)&SD2);
+
   /* In the ChibiOS/RT CMSIS RTOS implementation the main() is an
      usable thread, here we just sleep in a loop printing a message.*/
   while (true) {
@@ -0,0 +1,206 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "nasa_osal_test_root.h"
+#include "osapi.h"
+
+#define SHELL_WA_SIZE       THD_WORKING_AREA_SIZE(4096)
+
+static thread_t *shelltp;
+
+/*
+ * cFE-style software bus benchmark, a producer task sends messages to a
+ * consumer task through an OSAL queue (an SB pipe in cFE terms). Small
+ * messages are representative of the SB buffer descriptors actually
+ * exchanged by cFE, larger ones of direct telemetry packets.
+ */
+#define CFE_BENCH_MESSAGES  100000U
+#define CFE_BENCH_DEPTH     16U
+#define CFE_BENCH_MAX_SIZE  256U
+#define CFE_BENCH_PIPES     (OS_MAX_QUEUES - 1)
+#define CFE_BENCH_LOOKUPS   100000U
+
+static THD_WORKING_AREA(wa_cfe_producer, 2048);
+static THD_WORKING_AREA(wa_cfe_consumer, 2048);
+static uint32 cfe_bench_qid;
+static uint32 cfe_bench_size;
+static uint32 cfe_bench_errors;
+static char cfe_bench_names[CFE_BENCH_PIPES][OS_MAX_API_NAME];
+static uint32 cfe_bench_pipes[CFE_BENCH_PIPES];
+
+static void cfe_bench_producer(void) {
+  uint8 msg[CFE_BENCH_MAX_SIZE];
+  uint32 i;
+
+  memset(msg, 0x55, sizeof msg);
+  for (i = 0U; i < CFE_BENCH_MESSAGES; i++) {
+    if (OS_QueuePut(cfe_bench_qid, msg, cfe_bench_size, 0) != OS_SUCCESS) {
+      cfe_bench_errors++;
+    }
+  }
+  OS_TaskExit();
+}
+
+static void cfe_bench_consumer(void) {
+  uint8 msg[CFE_BENCH_MAX_SIZE];
+  uint32 i, copied;
+
+  for (i = 0U; i < CFE_BENCH_MESSAGES; i++) {
+    if ((OS_QueueGet(cfe_bench_qid, msg, sizeof msg,
+                     &copied, OS_PEND) != OS_SUCCESS) ||
+        (copied != cfe_bench_size)) {
+      cfe_bench_errors++;
+    }
+  }
+  OS_TaskExit();
+}
+
+static void cmd_cfebench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const uint32 sizes[] = {4U, 64U, CFE_BENCH_MAX_SIZE};
+  uint32 producer_id, consumer_id, i, j, n, ms;
+  systime_t start;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: cfebench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  chprintf(chp, "locked copy size %lu, names hash size %lu" SHELL_NEWLINE_STR,
+           (uint32)OS_QUEUE_LOCKED_COPY_SIZE, (uint32)OS_NAMES_HASH_SIZE);
+
+  /* Messages throughput between two tasks.*/
+  for (j = 0U; j < sizeof sizes / sizeof sizes[0]; j++) {
+    if (OS_QueueCreate(&cfe_bench_qid, "bench pipe", CFE_BENCH_DEPTH,
+                       CFE_BENCH_MAX_SIZE, 0) != OS_SUCCESS) {
+      chprintf(chp, "queue creation failed" SHELL_NEWLINE_STR);
+      return;
+    }
+    cfe_bench_size   = sizes[j];
+    cfe_bench_errors = 0U;
+
+    start = chVTGetSystemTimeX();
+    (void) OS_TaskCreate(&consumer_id, "bench consumer", cfe_bench_consumer,
+                         (uint32 *)wa_cfe_consumer, sizeof wa_cfe_consumer,
+                         200, 0);
+    (void) OS_TaskCreate(&producer_id, "bench producer", cfe_bench_producer,
+                         (uint32 *)wa_cfe_producer, sizeof wa_cfe_producer,
+                         200, 0);
+    (void) OS_TaskWait(producer_id);
+    (void) OS_TaskWait(consumer_id);
+    ms = (uint32)TIME_I2MS(chVTTimeElapsedSinceX(start));
+    (void) OS_QueueDelete(cfe_bench_qid);
+
+    chprintf(chp, "%3lu bytes: %lu ns per message, %lu msgs/s, %lu errors"
+             SHELL_NEWLINE_STR, cfe_bench_size,
+             (uint32)(((uint64_t)ms * 1000000U) / CFE_BENCH_MESSAGES),
+             ms > 0U ?
+             (uint32)(((uint64_t)CFE_BENCH_MESSAGES * 1000U) / ms) : 0U,
+             cfe_bench_errors);
+  }
+
+  /* Lookups by name with all the other queues in use.*/
+  for (n = 0U; n < CFE_BENCH_PIPES; n++) {
+    chsnprintf(cfe_bench_names[n], sizeof cfe_bench_names[n],
+               "SB_PIPE_%lu", n);
+    if (OS_QueueCreate(&cfe_bench_pipes[n], cfe_bench_names[n],
+                       1U, 4U, 0) != OS_SUCCESS) {
+      break;
+    }
+  }
+  if (n > 0U) {
+    cfe_bench_errors = 0U;
+    start = chVTGetSystemTimeX();
+    for (i = 0U; i < CFE_BENCH_LOOKUPS; i++) {
+      uint32 qid;
+
+      if ((OS_QueueGetIdByName(&qid, cfe_bench_names[(i * 7919U) % n]) !=
+           OS_SUCCESS) || (qid != cfe_bench_pipes[(i * 7919U) % n])) {
+        cfe_bench_errors++;
+      }
+    }
+    ms = (uint32)TIME_I2MS(chVTTimeElapsedSinceX(start));
+    chprintf(chp, "%3lu pipes: %lu ns per lookup, %lu errors"
+             SHELL_NEWLINE_STR, n,
+             (uint32)(((uint64_t)ms * 1000000U) / CFE_BENCH_LOOKUPS),
+             cfe_bench_errors);
+  }
+  for (i = 0U; i < n; i++) {
+    (void) OS_QueueDelete(cfe_bench_pipes[i]);
+  }
+}
+
+static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: test" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  test_execute(chp, &nasa_osal_test_suite);
+}
+
+static const ShellCommand commands[] = {
+  {"cfebench", cmd_cfebench},
+  {"test", cmd_test},
+  {NULL, NULL}
+};
+
+static const ShellConfig shell_cfg1 = {
+  (BaseSequentialStream *)&SD1,
+  commands
+};
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+
+  /* HAL initialization, this also initializes the configured device drivers
+     and performs the board-specific initializations.*/
+  halInit();
+
+  /* OS initialization.*/
+  (void) OS_API_Init();
+
+  /* Serial port (simulated) initialization.*/
+  sdStart(&SD1, NULL);
+
+  /* Shell manager initialization.*/
+  shellInit();
+
+  /* In the ChibiOS/RT OSAL implementation the main() function is an
+     usable thread with priority 128 (NORMALPRIO), here it just restarts
+     the shell on SD1 when it terminates.*/
+  while (true) {
+    if (shelltp == NULL) {
+      shelltp = chThdCreateFromHeap(NULL, SHELL_WA_SIZE, "shell",
+                                    NORMALPRIO, shellThread,
+                                    (void *)&shell_cfg1);
+    }
+    else if (chThdTerminatedX(shelltp)) {
+      chThdRelease(shelltp);
+      shelltp = NULL;
+    }
+    OS_TaskDelay(500);
+  }
+}
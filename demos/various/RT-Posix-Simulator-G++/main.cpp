@@ -0,0 +1,394 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include "ch.hpp"
+#include "chchannel.hpp"
+#include "chcoro.hpp"
+#include "chmemres.hpp"
+#include "hal.h"
+
+#include <list>
+
+using namespace chibios_rt;
+
+/*
+ * Token ring benchmark, a token is passed around a ring of tasks, each
+ * task waits on its own semaphore then signals the semaphore of the next
+ * task. The same ring is built using coroutines sharing a single executor
+ * thread and using a thread per task.
+ */
+#define RING_COROUTINES         1000U
+#define RING_THREADS            32U
+#define RING_THREAD_STACK       256
+#define RING_FRAME_SIZE         128U
+#define RING_WINDOW             TIME_MS2I(1000)
+
+#define SLEEPERS                100U
+#define SLEEPERS_ROUNDS         10U
+
+static volatile bool ring_stop;
+static uint32_t ring_hops;
+
+/*------------------------------------------------------------------------*
+ * Coroutines ring.                                                       *
+ *------------------------------------------------------------------------*/
+
+struct CoroutineNode {
+  AwaitableSemaphore sem{0};
+};
+
+static CoroutineNode coroutine_nodes[RING_COROUTINES];
+
+static ExecutorThread<4096> executor;
+
+/* Static frames pool, the frames size is checked at runtime.*/
+alignas(16) static uint8_t frames_buffer[RING_COROUTINES + SLEEPERS]
+                                        [RING_FRAME_SIZE];
+static MemoryPool frames_pool(RING_FRAME_SIZE, nullptr);
+
+static Task ring_coroutine(unsigned i) {
+  AwaitableSemaphore &next = coroutine_nodes[(i + 1U) % RING_COROUTINES].sem;
+
+  while (true) {
+    co_await coroutine_nodes[i].sem.asyncWait();
+    ring_hops++;
+    next.signal();
+    if (ring_stop) {
+      co_return;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*
+ * Threads ring.                                                          *
+ *------------------------------------------------------------------------*/
+
+static CounterSemaphore *thread_sems[RING_THREADS];
+
+class RingThread : public BaseStaticThread<RING_THREAD_STACK> {
+  CounterSemaphore sem{0};
+  unsigned index = 0U;
+
+protected:
+  void main(void) override {
+    CounterSemaphore &next = *thread_sems[(index + 1U) % RING_THREADS];
+
+    setName("ring");
+
+    while (true) {
+      sem.wait();
+      ring_hops++;
+      next.signal();
+      if (ring_stop) {
+        return;
+      }
+    }
+  }
+
+public:
+  void setIndex(unsigned i) {
+
+    index = i;
+    thread_sems[i] = &sem;
+  }
+};
+
+static RingThread ring_threads[RING_THREADS];
+
+/*------------------------------------------------------------------------*
+ * Sleeping coroutines.                                                   *
+ *------------------------------------------------------------------------*/
+
+static uint32_t sleepers_late;
+
+static Task sleeper_coroutine(sysinterval_t interval) {
+
+  for (unsigned i = 0U; i < SLEEPERS_ROUNDS; i++) {
+    systime_t start = chVTGetSystemTimeX();
+
+    co_await asyncSleep(interval);
+    if (chVTTimeElapsedSinceX(start) < interval) {
+      sleepers_late++;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*
+ * Channels and mailboxes.                                                *
+ *------------------------------------------------------------------------*/
+
+/*
+ * Messages are sent by producer threads to consumer threads, all threads
+ * have the same priority so the queue fills up before a consumer runs.
+ */
+#define QUEUE_MESSAGES          1000000U
+#define QUEUE_DEPTH             16U
+#define QUEUE_MAX_THREADS       2U
+
+static void queue_send(Mailbox<void *, QUEUE_DEPTH> &mb, uint32_t msg) {
+
+  (void) mb.post((void *)(uintptr_t)msg, TIME_INFINITE);
+}
+
+static uint32_t queue_receive(Mailbox<void *, QUEUE_DEPTH> &mb) {
+  void *msg = nullptr;
+
+  (void) mb.fetch(&msg, TIME_INFINITE);
+
+  return (uint32_t)(uintptr_t)msg;
+}
+
+template <ChannelMode M>
+static void queue_send(Channel<uint32_t, QUEUE_DEPTH, M> &ch, uint32_t msg) {
+
+  (void) ch.send(std::move(msg), TIME_INFINITE);
+}
+
+template <ChannelMode M>
+static uint32_t queue_receive(Channel<uint32_t, QUEUE_DEPTH, M> &ch) {
+  uint32_t msg;
+
+  (void) ch.receive(msg, TIME_INFINITE);
+
+  return msg;
+}
+
+template <typename Q>
+class QueueThread : public BaseStaticThread<1024> {
+  Q *queue = nullptr;
+  uint32_t messages = 0U;
+  bool producer = false;
+
+protected:
+  void main(void) override {
+    uint32_t sum = 0U;
+
+    for (uint32_t i = 1U; i <= messages; i++) {
+      if (producer) {
+        queue_send(*queue, i);
+      }
+      else {
+        sum += queue_receive(*queue);
+      }
+    }
+    exit((msg_t)sum);
+  }
+
+public:
+  void setup(Q *q, uint32_t n, bool p) {
+
+    queue = q;
+    messages = n;
+    producer = p;
+  }
+};
+
+template <typename Q>
+static void queue_bench(const char *name, Q &q, unsigned pairs) {
+  static QueueThread<Q> threads[QUEUE_MAX_THREADS * 2U];
+  thread_t *tps[QUEUE_MAX_THREADS * 2U];
+  uint32_t n = QUEUE_MESSAGES / pairs, sum = 0U;
+  systime_t start;
+  sysinterval_t elapsed;
+
+  start = chVTGetSystemTimeX();
+  for (unsigned i = 0U; i < pairs * 2U; i++) {
+    threads[i].setup(&q, n, (i & 1U) == 0U);
+    tps[i] = threads[i].start(NORMALPRIO - 1).getInner();
+  }
+  for (unsigned i = 0U; i < pairs * 2U; i++) {
+    msg_t msg = ThreadReference(tps[i]).wait();
+    if ((i & 1U) != 0U) {
+      sum += (uint32_t)msg;
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+
+  printf("%-12s %u:%u, %5lu ns per message, checksum %s\n",
+         name, pairs, pairs,
+         (unsigned long)(((uint64_t)TIME_I2US(elapsed) * 1000U) /
+                         (n * pairs)),
+         sum == (uint32_t)(((uint64_t)n * (n + 1U) / 2U) * pairs) ?
+         "ok" : "error");
+}
+
+static Mailbox<void *, QUEUE_DEPTH> bench_mailbox;
+static SpscChannel<uint32_t, QUEUE_DEPTH> bench_spsc;
+static Channel<uint32_t, QUEUE_DEPTH> bench_mpmc;
+
+/*------------------------------------------------------------------------*
+ * Memory resources.                                                      *
+ *------------------------------------------------------------------------*/
+
+/*
+ * A list of integers is filled and cleared using each resource, list
+ * nodes are allocated and freed one by one.
+ */
+#define LIST_NODES              1000U
+#define LIST_ROUNDS             1000U
+#define LIST_NODE_SIZE          32U
+
+static StaticArenaResource<LIST_NODES * LIST_NODE_SIZE> bench_arena;
+alignas(16) static uint8_t list_buffer[LIST_NODES][LIST_NODE_SIZE];
+static MemoryPool list_pool(LIST_NODE_SIZE, nullptr);
+
+static void resource_bench(const char *name, std::pmr::memory_resource *mr,
+                           ArenaResource *arena) {
+  std::pmr::list<uint32_t> list(mr);
+  systime_t start;
+  sysinterval_t elapsed;
+
+  start = chVTGetSystemTimeX();
+  for (uint32_t i = 0U; i < LIST_ROUNDS; i++) {
+    for (uint32_t j = 0U; j < LIST_NODES; j++) {
+      list.push_back(j);
+    }
+    list.clear();
+    if (arena != nullptr) {
+      arena->release();
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+
+  printf("%-12s %5lu ns per node\n", name,
+         (unsigned long)(((uint64_t)TIME_I2US(elapsed) * 1000U) /
+                         (LIST_NODES * LIST_ROUNDS)));
+}
+
+/*------------------------------------------------------------------------*
+ * Benchmark helpers.                                                     *
+ *------------------------------------------------------------------------*/
+
+static uint32_t ring_measure(void) {
+  uint32_t hops;
+
+  ring_hops = 0U;
+  chThdSleep(RING_WINDOW);
+  hops = ring_hops;
+  ring_stop = true;
+
+  return hops;
+}
+
+static void ring_report(const char *name, uint32_t tasks, uint32_t hops,
+                        size_t ram_per_task) {
+
+  printf("%-10s %5lu tasks, %8lu switches/s, %5lu ns per switch, "
+         "%6lu bytes per task\n",
+         name, (unsigned long)tasks, (unsigned long)hops,
+         hops > 0U ? (unsigned long)(1000000000ULL / hops) : 0UL,
+         (unsigned long)ram_per_task);
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+  Task::FrameStats fs;
+  uint32_t hops;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  System::init();
+
+  /* Coroutines frames allocated from the static pool.*/
+  frames_pool.loadArray(frames_buffer, RING_COROUTINES + SLEEPERS);
+  Task::setFramesPool(&frames_pool, RING_FRAME_SIZE);
+
+  /* The executor runs below the main thread priority, the main thread
+     only wakes up at the end of the measurement window.*/
+  ThreadReference etr = executor.start(NORMALPRIO - 1);
+
+  /* Coroutines ring.*/
+  ring_stop = false;
+  for (unsigned i = 0U; i < RING_COROUTINES; i++) {
+    if (!executor.spawn(ring_coroutine(i))) {
+      printf("coroutine %u allocation failed\n", i);
+      return 1;
+    }
+  }
+  coroutine_nodes[0].sem.signal();
+  hops = ring_measure();
+  while (executor.getTasksX() > 0U) {
+    chThdSleepMilliseconds(10);
+  }
+  Task::getFrameStats(&fs);
+  ring_report("coroutines", RING_COROUTINES, hops, fs.max_size);
+
+  /* Threads ring.*/
+  ring_stop = false;
+  for (unsigned i = 0U; i < RING_THREADS; i++) {
+    ring_threads[i].setIndex(i);
+  }
+  thread_t *tps[RING_THREADS];
+  for (unsigned i = 0U; i < RING_THREADS; i++) {
+    tps[i] = ring_threads[i].start(NORMALPRIO - 1).getInner();
+  }
+  thread_sems[0]->signal();
+  hops = ring_measure();
+  for (unsigned i = 0U; i < RING_THREADS; i++) {
+    ThreadReference(tps[i]).wait();
+  }
+  ring_report("threads", RING_THREADS, hops,
+              THD_WORKING_AREA_SIZE(RING_THREAD_STACK));
+
+  /* Sleeping coroutines, virtual timers wake-ups.*/
+  sleepers_late = 0U;
+  for (unsigned i = 0U; i < SLEEPERS; i++) {
+    (void) executor.spawn(sleeper_coroutine(TIME_MS2I(1U + (i % 10U))));
+  }
+  while (executor.getTasksX() > 0U) {
+    chThdSleepMilliseconds(10);
+  }
+  printf("sleepers   %5lu tasks, %lu early wake-ups\n",
+         (unsigned long)SLEEPERS, (unsigned long)sleepers_late);
+
+  Task::getFrameStats(&fs);
+  printf("frames     %lu from pool, %lu from heap, %lu failed, "
+         "%lu bytes max\n",
+         (unsigned long)fs.pool, (unsigned long)fs.heap,
+         (unsigned long)fs.failed, (unsigned long)fs.max_size);
+  printf("executor   %lu resumes\n", (unsigned long)executor.getResumesX());
+
+  executor.terminate();
+  etr.wait();
+
+  /* Channels against mailboxes.*/
+  queue_bench("mailbox", bench_mailbox, 1U);
+  queue_bench("spsc channel", bench_spsc, 1U);
+  queue_bench("mpmc channel", bench_mpmc, 1U);
+  queue_bench("mailbox", bench_mailbox, QUEUE_MAX_THREADS);
+  queue_bench("mpmc channel", bench_mpmc, QUEUE_MAX_THREADS);
+
+  /* Memory resources.*/
+  HeapResource heap_resource;
+  list_pool.loadArray(list_buffer, LIST_NODES);
+  PoolResource pool_resource(list_pool, &heap_resource);
+  resource_bench("new/delete", std::pmr::new_delete_resource(), nullptr);
+  resource_bench("heap", &heap_resource, nullptr);
+  resource_bench("pool", &pool_resource, nullptr);
+  resource_bench("arena", &bench_arena, &bench_arena);
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+
+#include "lwipthread.h"
+#include "lwip/api.h"
+
+#define SHELL_WA_SIZE       THD_WORKING_AREA_SIZE(4096)
+
+static thread_t *shelltp;
+
+/*
+ * UDP throughput benchmark. The simulated MAC has no peer so the
+ * transmitted frames are looped back, full size broadcast datagrams go
+ * through the lwIP transmit path, the MAC and the whole receive path up to
+ * a netconn served by a receiver thread. The link is not paced so the
+ * result is bound by the CPU, the time per Mbit is the cost of both paths.
+ */
+#define NET_BENCH_PORT      5001U
+#define NET_BENCH_DATAGRAMS 20000U
+#define NET_BENCH_SIZE      1472U
+
+static uint8_t net_bench_payload[NET_BENCH_SIZE];
+static uint32_t net_bench_count, net_bench_bytes, net_bench_errors;
+static THD_WORKING_AREA(waNetReceiver, 2048);
+
+static THD_FUNCTION(net_bench_receiver, arg) {
+  struct netconn *conn = (struct netconn *)arg;
+  struct netbuf *nb;
+
+  while (!chThdShouldTerminateX()) {
+    if (netconn_recv(conn, &nb) == ERR_OK) {
+      if (netbuf_len(nb) != NET_BENCH_SIZE) {
+        net_bench_errors++;
+      }
+      net_bench_bytes += netbuf_len(nb);
+      net_bench_count++;
+      netbuf_delete(nb);
+    }
+  }
+}
+
+static void cmd_netbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  struct netconn *rxconn, *txconn;
+  struct netbuf *nb;
+  const sim_mac_stats_t *sp;
+  thread_t *tp;
+  systime_t start;
+  uint32_t i, sent = 0U, us;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: netbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  rxconn = netconn_new(NETCONN_UDP);
+  txconn = netconn_new(NETCONN_UDP);
+  nb     = netbuf_new();
+  if ((rxconn == NULL) || (txconn == NULL) || (nb == NULL) ||
+      (netconn_bind(rxconn, IP_ADDR_ANY, NET_BENCH_PORT) != ERR_OK) ||
+      (netbuf_ref(nb, net_bench_payload, NET_BENCH_SIZE) != ERR_OK)) {
+    chprintf(chp, "netconn setup failed" SHELL_NEWLINE_STR);
+  }
+  else {
+    netconn_set_recvtimeout(rxconn, 10);
+    net_bench_count  = 0U;
+    net_bench_bytes  = 0U;
+    net_bench_errors = 0U;
+    tp = chThdCreateStatic(waNetReceiver, sizeof(waNetReceiver),
+                           NORMALPRIO + 4, net_bench_receiver, rxconn);
+
+    start = chVTGetSystemTimeX();
+    for (i = 0U; i < NET_BENCH_DATAGRAMS; i++) {
+      if (netconn_sendto(txconn, nb, IP_ADDR_BROADCAST,
+                         NET_BENCH_PORT) == ERR_OK) {
+        sent++;
+      }
+    }
+    us = (uint32_t)TIME_I2US(chVTTimeElapsedSinceX(start));
+    chThdSleepMilliseconds(50);
+
+    chThdTerminate(tp);
+    chThdWait(tp);
+    sp = simMacGetStats(&ETHD1);
+    chprintf(chp, "%s reception: %lu datagrams sent, %lu received in %lu ms"
+             SHELL_NEWLINE_STR,
+             LWIP_USE_MAC_ZERO_COPY == TRUE ? "zero-copy" : "copy",
+             sent, net_bench_count, us / 1000U);
+    chprintf(chp, "%lu Mbit/s, %lu us per Mbit, link rx %lu, errors %lu"
+             SHELL_NEWLINE_STR,
+             us > 0U ? (uint32_t)(((uint64_t)net_bench_bytes * 8U) / us) : 0U,
+             net_bench_bytes > 0U ?
+             (uint32_t)(((uint64_t)us * 1000000U) /
+                        ((uint64_t)net_bench_bytes * 8U)) : 0U,
+             sp->rx_frames, net_bench_errors);
+  }
+
+  if (nb != NULL) {
+    netbuf_delete(nb);
+  }
+  if (txconn != NULL) {
+    (void) netconn_delete(txconn);
+  }
+  if (rxconn != NULL) {
+    (void) netconn_delete(rxconn);
+  }
+}
+
+static const ShellCommand commands[] = {
+  {"netbench", cmd_netbench},
+  {NULL, NULL}
+};
+
+static const ShellConfig shell_cfg1 = {
+  (BaseSequentialStream *)&SD1,
+  commands
+};
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /* lwIP over the simulated MAC in loopback mode, static address.*/
+  lwipInit(NULL);
+
+  /* Serial port (simulated) initialization.*/
+  sdStart(&SD1, NULL);
+
+  /* Shell manager initialization.*/
+  shellInit();
+
+  /* The main() function restarts the shell on SD1 when it terminates.*/
+  while (true) {
+    if (shelltp == NULL) {
+      shelltp = chThdCreateFromHeap(NULL, SHELL_WA_SIZE, "shell",
+                                    NORMALPRIO, shellThread,
+                                    (void *)&shell_cfg1);
+    }
+    else if (chThdTerminatedX(shelltp)) {
+      chThdRelease(shelltp);
+      shelltp = NULL;
+    }
+    chThdSleepMilliseconds(500);
+  }
+}
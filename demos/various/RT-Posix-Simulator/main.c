@@ -14,10 +14,25 @@
     limitations under the License.
 */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "ch.h"
 #include "hal.h"
 #include "shell.h"
 #include "chprintf.h"
+#include "chscanf.h"
+#include "memstreams.h"
+#include "adc_stream.h"
+#include "hal_can_demux.h"
+#include "hal_i2c_scheduler.h"
+#include "blkfile.h"
+#include "block_cache.h"
+#include "periodic_tasks.h"
+#include "sb.h"
+#include "latency_test_root.h"
+#include "streams_test_root.h"
+#include "cmsis_os2_test_root.h"
 
 #define SHELL_WA_SIZE       THD_WORKING_AREA_SIZE(4096)
 #define CONSOLE_WA_SIZE     THD_WORKING_AREA_SIZE(4096)
@@ -29,7 +44,1077 @@ static thread_t *cdtp;
 static thread_t *shelltp1;
 static thread_t *shelltp2;
 
+#if HAL_USE_SPI == TRUE
+/*
+ * SPI bus benchmark, a set of devices on the same bus is polled using the
+ * normal API then using the transactions queue, the simulated SPI is a
+ * loopback device completing each transfer after its bus time. The bus use
+ * is the ratio between the bus time of all transfers and the elapsed time,
+ * the gaps are the software overhead between transfers.
+ */
+#define SPI_BENCH_DEVICES   10
+#define SPI_BENCH_ROUNDS    100
+#define SPI_BENCH_SIZE      16
+#define SPI_BENCH_BITRATE   2000000U
+
+/* Bus time of a full run in microseconds.*/
+#define SPI_BENCH_BUS_US                                                    \
+  ((uint32_t)(((uint64_t)SPI_BENCH_ROUNDS * SPI_BENCH_DEVICES *             \
+               (1U + SPI_BENCH_SIZE) * 8U * 1000000U) / SPI_BENCH_BITRATE))
+
+static SPIConfig spi_bench_cfg[SPI_BENCH_DEVICES];
+static const uint8_t spi_bench_cmd[1] = {0x80};
+static uint8_t spi_bench_rx[SPI_BENCH_DEVICES][SPI_BENCH_SIZE];
+
+#if SPI_USE_TRANSACTIONS == TRUE
+static spi_segment_t spi_bench_seg[SPI_BENCH_DEVICES][2];
+static spi_transaction_t spi_bench_tr[SPI_BENCH_DEVICES];
+static binary_semaphore_t spi_bench_sem;
+
+static void spi_bench_end_cb(SPIDriver *spip, spi_transaction_t *stp) {
+
+  (void)spip;
+  (void)stp;
+  chBSemSignalI(&spi_bench_sem);
+}
+#endif
+
+static void cmd_spibench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  unsigned i, r;
+  systime_t start;
+  sysinterval_t elapsed;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: spibench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  for (i = 0U; i < SPI_BENCH_DEVICES; i++) {
+    spi_bench_cfg[i].data_cb  = NULL;
+    spi_bench_cfg[i].error_cb = NULL;
+    spi_bench_cfg[i].ssport   = IOPORT1;
+    spi_bench_cfg[i].sspad    = i;
+    spi_bench_cfg[i].frame16  = false;
+    spi_bench_cfg[i].bitrate  = SPI_BENCH_BITRATE;
+  }
+
+  /* Each transfer goes through bus arbitration and a thread wakeup.*/
+  start = chVTGetSystemTimeX();
+  for (r = 0U; r < SPI_BENCH_ROUNDS; r++) {
+    for (i = 0U; i < SPI_BENCH_DEVICES; i++) {
+      spiAcquireBus(&SPID1);
+      spiStart(&SPID1, &spi_bench_cfg[i]);
+      spiSelect(&SPID1);
+      spiSend(&SPID1, sizeof spi_bench_cmd, spi_bench_cmd);
+      spiReceive(&SPID1, SPI_BENCH_SIZE, spi_bench_rx[i]);
+      spiUnselect(&SPID1);
+      spiReleaseBus(&SPID1);
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  chprintf(chp, "normal API: %lu transfers in %lu ms, bus use %lu%%"
+           SHELL_NEWLINE_STR,
+           (uint32_t)(SPI_BENCH_ROUNDS * SPI_BENCH_DEVICES * 2U),
+           (uint32_t)TIME_I2MS(elapsed),
+           (uint32_t)(((uint64_t)SPI_BENCH_BUS_US * 100U) /
+                      TIME_I2US(elapsed)));
+
+#if SPI_USE_TRANSACTIONS == TRUE
+  /* Transfers are chained from the completion interrupt, only the last
+     transaction of each round wakes up the thread.*/
+  chBSemObjectInit(&spi_bench_sem, true);
+  for (i = 0U; i < SPI_BENCH_DEVICES; i++) {
+    spi_bench_seg[i][0].n         = sizeof spi_bench_cmd;
+    spi_bench_seg[i][0].txbuf     = spi_bench_cmd;
+    spi_bench_seg[i][0].rxbuf     = NULL;
+    spi_bench_seg[i][1].n         = SPI_BENCH_SIZE;
+    spi_bench_seg[i][1].txbuf     = NULL;
+    spi_bench_seg[i][1].rxbuf     = spi_bench_rx[i];
+    spi_bench_tr[i].config        = &spi_bench_cfg[i];
+    spi_bench_tr[i].segments      = spi_bench_seg[i];
+    spi_bench_tr[i].nsegments     = 2U;
+    spi_bench_tr[i].end_cb        = i == SPI_BENCH_DEVICES - 1U ?
+                                    spi_bench_end_cb : NULL;
+    spi_bench_tr[i].arg           = NULL;
+  }
+  start = chVTGetSystemTimeX();
+  for (r = 0U; r < SPI_BENCH_ROUNDS; r++) {
+    msg_t msg = HAL_RET_SUCCESS;
+
+    chSysLock();
+    for (i = 0U; (i < SPI_BENCH_DEVICES) && (msg == HAL_RET_SUCCESS); i++) {
+      msg = spiQueueTransactionI(&SPID1, &spi_bench_tr[i]);
+    }
+    if (msg == HAL_RET_SUCCESS) {
+      (void) chBSemWaitS(&spi_bench_sem);
+    }
+    chSysUnlock();
+    if (msg != HAL_RET_SUCCESS) {
+      chprintf(chp, "transaction not queued" SHELL_NEWLINE_STR);
+      return;
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  chprintf(chp, "queued:     %lu transfers in %lu ms, bus use %lu%%"
+           SHELL_NEWLINE_STR,
+           (uint32_t)(SPI_BENCH_ROUNDS * SPI_BENCH_DEVICES * 2U),
+           (uint32_t)TIME_I2MS(elapsed),
+           (uint32_t)(((uint64_t)SPI_BENCH_BUS_US * 100U) /
+                      TIME_I2US(elapsed)));
+  chprintf(chp, "transactions %lu, segments %lu, chained %lu, errors %lu"
+           SHELL_NEWLINE_STR,
+           SPID1.tqstats.transactions, SPID1.tqstats.segments,
+           SPID1.tqstats.chained, SPID1.tqstats.errors);
+#endif
+}
+#endif
+
+#if HAL_USE_I2C == TRUE
+/*
+ * I2C scheduler test, two serving threads share the simulated bus. Each
+ * device receives a stream of register writes carrying a sequence number,
+ * completions out of order are counted as errors, then the last written
+ * value is read back from each device.
+ */
+#define I2CS_TEST_DEVICES   3U
+#define I2CS_TEST_REQUESTS  32U
+
+static const I2CConfig i2cs_test_cfg = {400000U};
+static I2CScheduler i2cs_test;
+static i2cs_device_t i2cs_test_dev[I2CS_TEST_DEVICES];
+static i2cs_request_t i2cs_test_rq[I2CS_TEST_DEVICES][I2CS_TEST_REQUESTS];
+static uint8_t i2cs_test_tx[I2CS_TEST_DEVICES][I2CS_TEST_REQUESTS][2];
+static uint32_t i2cs_test_next[I2CS_TEST_DEVICES], i2cs_test_errors;
+static semaphore_t i2cs_test_sem;
+static THD_WORKING_AREA(waI2CServer1, 1024);
+static THD_WORKING_AREA(waI2CServer2, 1024);
+
+static THD_FUNCTION(i2cs_test_server, arg) {
+
+  while (!chThdShouldTerminateX()) {
+    (void) i2csServe((I2CScheduler *)arg, TIME_MS2I(10));
+  }
+}
+
+static void i2cs_test_end_cb(I2CScheduler *schp, i2cs_request_t *rqp) {
+  uint32_t *np = (uint32_t *)rqp->arg;
+
+  (void)schp;
+  if ((rqp->status != MSG_OK) || (rqp->txbuf[1] != (uint8_t)*np)) {
+    i2cs_test_errors++;
+  }
+  (*np)++;
+  chSemSignalI(&i2cs_test_sem);
+}
+
+static void cmd_i2cstest(BaseSequentialStream *chp, int argc, char *argv[]) {
+  thread_t *tp[2];
+  i2cs_stats_t stats;
+  i2cs_request_t rq;
+  uint8_t reg = 0U, val;
+  systime_t start;
+  sysinterval_t elapsed;
+  unsigned d, i;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: i2cstest" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  i2cStart(&I2CD1, &i2cs_test_cfg);
+  i2csObjectInit(&i2cs_test, &I2CD1);
+  chSemObjectInit(&i2cs_test_sem, (cnt_t)0);
+  i2cs_test_errors = 0U;
+  for (d = 0U; d < I2CS_TEST_DEVICES; d++) {
+    i2csDeviceObjectInit(&i2cs_test, &i2cs_test_dev[d],
+                         (i2caddr_t)(I2C_SIM_SLAVE_BASE + d),
+                         d == 0U ? 2U : 1U);
+    i2cs_test_next[d] = 0U;
+    for (i = 0U; i < I2CS_TEST_REQUESTS; i++) {
+      i2cs_test_tx[d][i][0]       = 0U;
+      i2cs_test_tx[d][i][1]       = (uint8_t)i;
+      i2cs_test_rq[d][i].txbuf    = i2cs_test_tx[d][i];
+      i2cs_test_rq[d][i].txbytes  = 2U;
+      i2cs_test_rq[d][i].rxbuf    = NULL;
+      i2cs_test_rq[d][i].rxbytes  = 0U;
+      i2cs_test_rq[d][i].deadline = d == 1U ? TIME_MS2I(20) : TIME_INFINITE;
+      i2cs_test_rq[d][i].timeout  = TIME_MS2I(100);
+      i2cs_test_rq[d][i].end_cb   = i2cs_test_end_cb;
+      i2cs_test_rq[d][i].flags    = (eventflags_t)0;
+      i2cs_test_rq[d][i].arg      = &i2cs_test_next[d];
+    }
+  }
+
+  tp[0] = chThdCreateStatic(waI2CServer1, sizeof(waI2CServer1),
+                            NORMALPRIO + 11, i2cs_test_server, &i2cs_test);
+  tp[1] = chThdCreateStatic(waI2CServer2, sizeof(waI2CServer2),
+                            NORMALPRIO + 11, i2cs_test_server, &i2cs_test);
+
+  /* All the requests are queued at once so that both servers find work
+     addressed to the same devices.*/
+  start = chVTGetSystemTimeX();
+  chSysLock();
+  for (i = 0U; i < I2CS_TEST_REQUESTS; i++) {
+    for (d = 0U; d < I2CS_TEST_DEVICES; d++) {
+      i2csSubmitI(&i2cs_test, &i2cs_test_dev[d], &i2cs_test_rq[d][i]);
+    }
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+  for (i = 0U; i < I2CS_TEST_DEVICES * I2CS_TEST_REQUESTS; i++) {
+    if (chSemWaitTimeout(&i2cs_test_sem, TIME_MS2I(1000)) != MSG_OK) {
+      i2cs_test_errors++;
+      break;
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+
+  /* Reading back the last value written to each device.*/
+  rq.txbuf    = &reg;
+  rq.txbytes  = 1U;
+  rq.rxbuf    = &val;
+  rq.rxbytes  = 1U;
+  rq.deadline = TIME_INFINITE;
+  rq.timeout  = TIME_MS2I(100);
+  rq.end_cb   = NULL;
+  rq.flags    = (eventflags_t)0;
+  rq.arg      = NULL;
+  for (d = 0U; d < I2CS_TEST_DEVICES; d++) {
+    if ((i2csSubmitAndWait(&i2cs_test, &i2cs_test_dev[d], &rq) != MSG_OK) ||
+        (val != (uint8_t)(I2CS_TEST_REQUESTS - 1U))) {
+      i2cs_test_errors++;
+    }
+  }
+
+  for (i = 0U; i < 2U; i++) {
+    chThdTerminate(tp[i]);
+    chThdWait(tp[i]);
+  }
+  i2cStop(&I2CD1);
+
+  chSysLock();
+  i2csGetStatsI(&i2cs_test, &stats);
+  chSysUnlock();
+  chprintf(chp, "%lu requests in %lu ms, bus busy %lu ms" SHELL_NEWLINE_STR,
+           stats.requests, (uint32_t)TIME_I2MS(elapsed),
+           (uint32_t)TIME_I2MS(stats.busy));
+  chprintf(chp, "latency avg %lu ms, max %lu ms, deadline misses %lu"
+           SHELL_NEWLINE_STR,
+           (uint32_t)TIME_I2MS(stats.latency_total / stats.requests),
+           (uint32_t)TIME_I2MS(stats.latency_max), stats.deadline_misses);
+  chprintf(chp, "bus errors %lu, order or data errors %lu" SHELL_NEWLINE_STR,
+           stats.errors, i2cs_test_errors);
+}
+#endif
+
+/*
+ * Decimator benchmark, synthetic 12 bits samples are decimated by 32 using
+ * a 4th order CIC followed by a 16 taps FIR, the result is the CPU time
+ * required for each kSample.
+ */
+#define ADC_BENCH_FRAMES    4096
+#define ADC_BENCH_TIME      1000
+
+static const int16_t adc_bench_fir[16] = {
+     -79,  -136,   312,   654, -1244, -2280,  4501, 14655,
+   14655,  4501, -2280, -1244,   654,   312,  -136,   -79
+};
+
+static const adcs_decimator_config_t adc_bench_dcfg = {
+  .offset       = 2048,
+  .cic_order    = 4U,
+  .cic_ratio    = 16U,
+  .cic_shift    = 16U,
+  .fir_coeffs   = adc_bench_fir,
+  .fir_taps     = 16U,
+  .fir_ratio    = 2U,
+  .fir_shift    = 15U
+};
+
+static adcs_input_t adc_bench_in[ADC_BENCH_FRAMES];
+static int32_t adc_bench_out[ADC_BENCH_FRAMES / 32];
+static adcs_decimator_t adc_bench_dec;
+
+static void cmd_adcbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  uint32_t i, lcg = 1U, blocks = 0U;
+  systime_t start;
+  sysinterval_t elapsed;
+  uint64_t samples;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: adcbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  /* Ramp plus pseudo-random noise.*/
+  for (i = 0U; i < ADC_BENCH_FRAMES; i++) {
+    lcg = lcg * 1664525U + 1013904223U;
+    adc_bench_in[i] = (adcs_input_t)(((i * 8U) & 0xFFFU) ^ (lcg >> 28));
+  }
+
+  adcsDecimatorObjectInit(&adc_bench_dec, &adc_bench_dcfg, 1U);
+  start = chVTGetSystemTimeX();
+  do {
+    (void) adcsDecimatorProcess(&adc_bench_dec, adc_bench_in,
+                                ADC_BENCH_FRAMES, adc_bench_out);
+    blocks++;
+    elapsed = chVTTimeElapsedSinceX(start);
+  } while (elapsed < TIME_MS2I(ADC_BENCH_TIME));
+
+  samples = (uint64_t)blocks * ADC_BENCH_FRAMES;
+  chprintf(chp, "%lu samples in %lu ms, %lu ns per kSample" SHELL_NEWLINE_STR,
+           (uint32_t)samples, (uint32_t)TIME_I2MS(elapsed),
+           (uint32_t)(((uint64_t)TIME_I2US(elapsed) * 1000000U) / samples));
+}
+
+#if HAL_USE_CAN == TRUE
+/*
+ * CAN demultiplexer test, 300 identifiers are subscribed, CAN2 transmits a
+ * mix of standard, extended and unrouted identifiers on the virtual bus,
+ * CAN1 frames are dispatched to two subscribers.
+ */
+#define CAN_BENCH_FRAMES    3000U
+#define CAN_BENCH_STD_IDS   256U
+#define CAN_BENCH_EXT_IDS   44U
+#define CAN_BENCH_RING      64U
+
+static const CANConfig can_bench_cfg = {0U};
+static CANDemux can_bench_rx, can_bench_tx;
+static cdmx_subscriber_t can_bench_sub[2];
+static cdmx_entry_t can_bench_ring[2][CAN_BENCH_RING];
+static uint32_t can_bench_count[2], can_bench_errors;
+static THD_WORKING_AREA(waCanDispatcher, 2048);
+static THD_WORKING_AREA(waCanConsumer1, 1024);
+static THD_WORKING_AREA(waCanConsumer2, 1024);
+
+static THD_FUNCTION(can_bench_dispatcher, arg) {
+
+  while (!chThdShouldTerminateX()) {
+    (void) cdmxDispatch((CANDemux *)arg, TIME_MS2I(10));
+  }
+}
+
+static THD_FUNCTION(can_bench_consumer, arg) {
+  unsigned n = (unsigned)(uintptr_t)arg;
+  cdmx_entry_t e;
+
+  while (!chThdShouldTerminateX()) {
+    if (cdmxReceiveTimeout(&can_bench_sub[n], &e, TIME_MS2I(10)) == MSG_OK) {
+      if ((n == 0U) != (e.frame.IDE == CAN_IDE_STD)) {
+        can_bench_errors++;
+      }
+      can_bench_count[n]++;
+    }
+  }
+}
+
+static void cmd_canbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  thread_t *tp[3];
+  cdmx_stats_t stats;
+  CANTxFrame ctf;
+  systime_t start;
+  sysinterval_t elapsed;
+  uint32_t i, sent = 0U;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: canbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  cdmxObjectInit(&can_bench_rx, &CAND1);
+  cdmxObjectInit(&can_bench_tx, &CAND2);
+  for (i = 0U; i < 2U; i++) {
+    cdmxSubscriberObjectInit(&can_bench_sub[i], can_bench_ring[i],
+                             CAN_BENCH_RING);
+    can_bench_count[i] = 0U;
+  }
+  can_bench_errors = 0U;
+  for (i = 0U; i < CAN_BENCH_STD_IDS; i++) {
+    if (cdmxSubscribe(&can_bench_rx, CDMX_STD_KEY(0x100U + i),
+                      &can_bench_sub[0]) != HAL_RET_SUCCESS) {
+      can_bench_errors++;
+    }
+  }
+  for (i = 0U; i < CAN_BENCH_EXT_IDS; i++) {
+    if (cdmxSubscribe(&can_bench_rx, CDMX_EXT_KEY(0x18DA0000U + i),
+                      &can_bench_sub[1]) != HAL_RET_SUCCESS) {
+      can_bench_errors++;
+    }
+  }
+
+  canStart(&CAND1, &can_bench_cfg);
+  canStart(&CAND2, &can_bench_cfg);
+  tp[0] = chThdCreateStatic(waCanDispatcher, sizeof(waCanDispatcher),
+                            NORMALPRIO + 12, can_bench_dispatcher,
+                            &can_bench_rx);
+  tp[1] = chThdCreateStatic(waCanConsumer1, sizeof(waCanConsumer1),
+                            NORMALPRIO + 11, can_bench_consumer,
+                            (void *)0U);
+  tp[2] = chThdCreateStatic(waCanConsumer2, sizeof(waCanConsumer2),
+                            NORMALPRIO + 11, can_bench_consumer,
+                            (void *)1U);
+
+  ctf.DLC = 8U;
+  ctf.RTR = CAN_RTR_DATA;
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < CAN_BENCH_FRAMES; i++) {
+    switch (i % 3U) {
+    case 0U:
+      ctf.IDE = CAN_IDE_STD;
+      ctf.SID = 0x100U + (i % CAN_BENCH_STD_IDS);
+      break;
+    case 1U:
+      ctf.IDE = CAN_IDE_EXT;
+      ctf.EID = 0x18DA0000U + (i % CAN_BENCH_EXT_IDS);
+      break;
+    default:
+      ctf.IDE = CAN_IDE_STD;
+      ctf.SID = 0x700U;
+      break;
+    }
+    ctf.data32[0] = i;
+    ctf.data32[1] = ~i;
+    if (cdmxTransmitTimeout(&can_bench_tx, &ctf, TIME_MS2I(100)) == MSG_OK) {
+      sent++;
+    }
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  chThdSleepMilliseconds(50);
+
+  for (i = 0U; i < 3U; i++) {
+    chThdTerminate(tp[i]);
+    chThdWait(tp[i]);
+  }
+  canStop(&CAND2);
+  canStop(&CAND1);
+
+  chSysLock();
+  cdmxGetStatsI(&can_bench_rx, &stats);
+  chSysUnlock();
+  chprintf(chp, "%lu filters, %lu frames sent in %lu ms" SHELL_NEWLINE_STR,
+           (uint32_t)can_bench_rx.filters, sent,
+           (uint32_t)TIME_I2MS(elapsed));
+  chprintf(chp, "dispatched %lu, std %lu, ext %lu, unmatched %lu, "
+           "overruns %lu, errors %lu" SHELL_NEWLINE_STR,
+           stats.frames, can_bench_count[0], can_bench_count[1],
+           stats.unmatched, stats.overruns, can_bench_errors);
+}
+#endif
+
+#if HAL_USE_MAC == TRUE
+/*
+ * MAC throughput test, full size frames are looped back through the
+ * simulated link using the zero-copy API, the link speed in Mbit/s and the
+ * loss probability in ppm are optional parameters.
+ */
+#define MAC_BENCH_FRAMES    20000U
+#define MAC_BENCH_SIZE      1514U
+
+static uint8_t mac_bench_address[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static MACConfig mac_bench_cfg;
+static uint32_t mac_bench_count, mac_bench_errors;
+static THD_WORKING_AREA(waMacReceiver, 1024);
+
+static THD_FUNCTION(mac_bench_receiver, arg) {
+  MACReceiveDescriptor rd;
+  const uint8_t *p;
+  size_t n;
+
+  (void)arg;
+  while (!chThdShouldTerminateX()) {
+    if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_MS2I(10)) == MSG_OK) {
+      p = macGetNextReceiveBuffer(&rd, &n);
+      if ((p == NULL) || (n != MAC_BENCH_SIZE) || (p[0] != 0xFFU)) {
+        mac_bench_errors++;
+      }
+      macReleaseReceiveDescriptor(&rd);
+      mac_bench_count++;
+    }
+  }
+}
+
+static void cmd_macbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  MACTransmitDescriptor td;
+  const sim_mac_stats_t *sp;
+  thread_t *tp;
+  systime_t start;
+  sysinterval_t elapsed;
+  uint32_t i, sent = 0U, ms;
+  uint8_t *p;
+  size_t n;
+
+  if (argc > 2) {
+    chprintf(chp, "Usage: macbench [mbps [loss_ppm]]" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  memset(&mac_bench_cfg, 0, sizeof mac_bench_cfg);
+  mac_bench_cfg.mac_address = mac_bench_address;
+  if (argc > 0) {
+    mac_bench_cfg.link_speed = (uint32_t)strtoul(argv[0], NULL, 0) * 1000000U;
+  }
+  if (argc > 1) {
+    mac_bench_cfg.loss_ppm = (uint32_t)strtoul(argv[1], NULL, 0);
+  }
+  if (macStart(&ETHD1, &mac_bench_cfg) != HAL_RET_SUCCESS) {
+    chprintf(chp, "MAC start failed" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  mac_bench_count  = 0U;
+  mac_bench_errors = 0U;
+  tp = chThdCreateStatic(waMacReceiver, sizeof(waMacReceiver),
+                         NORMALPRIO + 11, mac_bench_receiver, NULL);
+
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < MAC_BENCH_FRAMES; i++) {
+    if (macWaitTransmitDescriptor(&ETHD1, &td, TIME_MS2I(100)) != MSG_OK) {
+      break;
+    }
+    p = macGetNextTransmitBuffer(&td, MAC_BENCH_SIZE, &n);
+    memset(p, 0xFF, 6U);
+    memcpy(p + 6, mac_bench_address, 6U);
+    p[12] = 0x88U;
+    p[13] = 0xB5U;
+    memcpy(p + 14, &i, sizeof i);
+    macReleaseTransmitDescriptor(&td);
+    sent++;
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  chThdSleepMilliseconds(50);
+
+  chThdTerminate(tp);
+  chThdWait(tp);
+  sp = simMacGetStats(&ETHD1);
+  ms = (uint32_t)TIME_I2MS(elapsed);
+  chprintf(chp, "%lu frames sent, %lu received in %lu ms, %lu Mbit/s"
+           SHELL_NEWLINE_STR, sent, mac_bench_count, ms,
+           ms > 0U ? (uint32_t)((sp->rx_bytes * 8U) / (ms * 1000U)) : 0U);
+  chprintf(chp, "link: tx %lu, lost %lu, rx %lu, errors %lu"
+           SHELL_NEWLINE_STR, sp->tx_frames, sp->tx_lost, sp->rx_frames,
+           mac_bench_errors);
+  macStop(&ETHD1);
+}
+#endif
+
+/*
+ * Block device benchmark, a FAT-like access pattern is run on a disk image
+ * with an SD card latency model, first directly then through the block
+ * cache. Data blocks are written one at a time with a FAT block update
+ * every cluster and a directory block update every 16 blocks, then read
+ * back. Throughput is computed on the modeled time.
+ */
+#define BLK_BENCH_BLOCKS    512U
+#define BLK_BENCH_CLUSTER   4U
+#define BLK_BENCH_DIR       16U
+#define BLK_BENCH_FAT       32U
+#define BLK_BENCH_DATA      256U
+
+static const blkfile_latency_t blk_bench_latency = {
+  .read_cmd     = 150U,
+  .read_block   = 25U,
+  .write_cmd    = 250U,
+  .write_block  = 50U,
+  .write_multi  = 500U,
+  .write_random = 2000U,
+  .sync         = 1000U
+};
+
+static const BlockFileConfig blk_bench_cfg = {
+  .path         = "blkbench.img",
+  .blk_size     = BCACHE_BLOCK_SIZE,
+  .blk_num      = 4096U,
+  .read_only    = false,
+  .latency      = &blk_bench_latency
+};
+
+static BlockFile blk_bench_file;
+static BlockCache blk_bench_cache;
+static uint8_t blk_bench_buf[BCACHE_BLOCK_SIZE];
+
+static bool blk_bench_run(BaseBlockDevice *bdp) {
+  uint32_t i;
+  bool err = HAL_SUCCESS;
+
+  for (i = 0U; i < BLK_BENCH_BLOCKS; i++) {
+    memset(blk_bench_buf, (int)i, sizeof blk_bench_buf);
+    err |= blkWrite(bdp, BLK_BENCH_DATA + i, blk_bench_buf, 1U);
+    if ((i % BLK_BENCH_CLUSTER) == 0U) {
+      uint32_t fat = BLK_BENCH_FAT + (i / (BCACHE_BLOCK_SIZE / 4U));
+
+      err |= blkRead(bdp, fat, blk_bench_buf, 1U);
+      err |= blkWrite(bdp, fat, blk_bench_buf, 1U);
+    }
+    if ((i % BLK_BENCH_DIR) == 0U) {
+      err |= blkRead(bdp, BLK_BENCH_DIR, blk_bench_buf, 1U);
+      err |= blkWrite(bdp, BLK_BENCH_DIR, blk_bench_buf, 1U);
+    }
+  }
+  err |= blkSync(bdp);
+
+  for (i = 0U; i < BLK_BENCH_BLOCKS; i++) {
+    if ((i % BLK_BENCH_CLUSTER) == 0U) {
+      err |= blkRead(bdp, BLK_BENCH_FAT + (i / (BCACHE_BLOCK_SIZE / 4U)),
+                     blk_bench_buf, 1U);
+    }
+    err |= blkRead(bdp, BLK_BENCH_DATA + i, blk_bench_buf, 1U);
+    if (blk_bench_buf[0] != (uint8_t)i) {
+      err = HAL_FAILED;
+    }
+  }
+
+  return err;
+}
+
+static void blk_bench_report(BaseSequentialStream *chp, const char *name,
+                             bool err) {
+  const blkfile_stats_t *sp = blkfileGetStats(&blk_bench_file);
+  uint32_t ms = (uint32_t)(sp->busy_us / 1000U);
+
+  chprintf(chp, "%s: %s, %lu reads, %lu writes, %lu blocks written, "
+           "%lu ms, %lu KB/s" SHELL_NEWLINE_STR,
+           name, err ? "FAILED" : "OK", sp->reads, sp->writes,
+           sp->blocks_written, ms,
+           ms > 0U ? (2U * BLK_BENCH_BLOCKS * BCACHE_BLOCK_SIZE) / ms : 0U);
+}
+
+static void cmd_blkbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  bcache_stats_t cs;
+  bool err;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: blkbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  blkfileObjectInit(&blk_bench_file);
+  blkfileStart(&blk_bench_file, &blk_bench_cfg);
+  if (blkConnect(&blk_bench_file) != HAL_SUCCESS) {
+    chprintf(chp, "image error" SHELL_NEWLINE_STR);
+    blkfileStop(&blk_bench_file);
+    return;
+  }
+  err = blk_bench_run((BaseBlockDevice *)&blk_bench_file);
+  blk_bench_report(chp, "direct", err);
+
+  /* The cache connects the image again on its own.*/
+  (void) blkDisconnect(&blk_bench_file);
+  blkfileResetStats(&blk_bench_file);
+  bcacheObjectInit(&blk_bench_cache, (BaseBlockDevice *)&blk_bench_file);
+  err = blkConnect(&blk_bench_cache) ||
+        blk_bench_run((BaseBlockDevice *)&blk_bench_cache);
+  blk_bench_report(chp, "cached", err);
+  bcacheGetStats(&blk_bench_cache, &cs);
+  chprintf(chp, "cache: %lu hits, %lu misses, %lu prefetched, "
+           "hit rate %lu%%" SHELL_NEWLINE_STR,
+           cs.hits, cs.misses, cs.prefetched,
+           (cs.hits + cs.misses) == 0U ? 0U :
+           (cs.hits * 100U) / (cs.hits + cs.misses));
+
+  (void) blkDisconnect(&blk_bench_cache);
+  if (blkGetDriverState(&blk_bench_file) == BLK_READY) {
+    /* The cache failed after connecting the image.*/
+    (void) blkDisconnect(&blk_bench_file);
+  }
+  blkfileStop(&blk_bench_file);
+}
+
+/*
+ * Sandbox benchmark, messages are exchanged with a sandboxed thread running
+ * the code in sbbench.c, first with an immediate reply then asking for a
+ * burst of syscalls. Sandbox regions are host pages protected while the
+ * sandboxed code runs.
+ */
+#define SB_BENCH_REGION_SIZE    4096U
+
+extern void sb_bench_sandbox(void);
+
+static sb_config_t sb_bench_config;
+static sb_class_t sb_bench;
+static THD_WORKING_AREA(waSandbox, 1024);
+
+static void cmd_sbbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  sb_sim_stats_t ss;
+  systime_t start;
+  uint32_t i, n = 100000U, ms;
+
+  if (argc > 1) {
+    chprintf(chp, "Usage: sbbench [n]" SHELL_NEWLINE_STR);
+    return;
+  }
+  if (argc > 0) {
+    n = (uint32_t)strtoul(argv[0], NULL, 0);
+  }
+
+  if (sb_bench.tp == NULL) {
+    uint8_t *code = sbSimAllocRegion(SB_BENCH_REGION_SIZE);
+    uint8_t *data = sbSimAllocRegion(SB_BENCH_REGION_SIZE);
+
+    if ((code == NULL) || (data == NULL)) {
+      chprintf(chp, "regions allocation failed" SHELL_NEWLINE_STR);
+      return;
+    }
+    sbSimMakeImage(code, sb_bench_sandbox);
+    sb_bench_config.code_region = 0U;
+    sb_bench_config.data_region = 1U;
+    sb_bench_config.regions[0].area.base = code;
+    sb_bench_config.regions[0].area.size = SB_BENCH_REGION_SIZE;
+    sb_bench_config.regions[0].writeable = false;
+    sb_bench_config.regions[1].area.base = data;
+    sb_bench_config.regions[1].area.size = SB_BENCH_REGION_SIZE;
+    sb_bench_config.regions[1].writeable = true;
+    if (sbStartThread(&sb_bench, &sb_bench_config, "sandbox",
+                      waSandbox, sizeof (waSandbox),
+                      NORMALPRIO + 11) == NULL) {
+      chprintf(chp, "sandbox start failed" SHELL_NEWLINE_STR);
+      return;
+    }
+  }
+
+  sbSimResetStats();
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < n; i++) {
+    (void) sbSendMessageTimeout(&sb_bench, (msg_t)0, TIME_INFINITE);
+  }
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  chprintf(chp, "%lu messages in %lu ms, %lu ns per round trip"
+           SHELL_NEWLINE_STR, n, ms,
+           n > 0U ? (uint32_t)(((uint64_t)ms * 1000000U) / n) : 0U);
+
+  start = chVTGetSystemTimeX();
+  (void) sbSendMessageTimeout(&sb_bench, (msg_t)n, TIME_INFINITE);
+  ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+  chprintf(chp, "%lu syscalls in %lu ms, %lu ns per syscall"
+           SHELL_NEWLINE_STR, n, ms,
+           n > 0U ? (uint32_t)(((uint64_t)ms * 1000000U) / n) : 0U);
+
+  sbSimGetStats(&ss);
+  chprintf(chp, "host: %lu syscalls, %lu protection changes"
+           SHELL_NEWLINE_STR, ss.syscalls, ss.mprotects);
+}
+
+/*
+ * Objects factory benchmark, sets of 10, 100 and 1000 objects are registered
+ * then looked up by name and released, CH_CFG_FACTORY_HASH_SIZE selects
+ * between linear lists and the hash index.
+ */
+#define FACT_BENCH_MAX_OBJECTS  1000U
+#define FACT_BENCH_LOOKUPS      100000U
+
+static char fact_bench_names[FACT_BENCH_MAX_OBJECTS][8];
+static registered_object_t *fact_bench_objs[FACT_BENCH_MAX_OBJECTS];
+
+static void cmd_factbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const uint32_t sizes[] = {10U, 100U, 1000U};
+  systime_t start;
+  uint32_t i, j, n, ms, errors;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: factbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  chprintf(chp, "hash index size %lu" SHELL_NEWLINE_STR,
+           (uint32_t)CH_CFG_FACTORY_HASH_SIZE);
+  for (i = 0U; i < FACT_BENCH_MAX_OBJECTS; i++) {
+    chsnprintf(fact_bench_names[i], sizeof fact_bench_names[i], "f%lu", i);
+  }
+
+  for (j = 0U; j < sizeof sizes / sizeof sizes[0]; j++) {
+    n = sizes[j];
+    for (i = 0U; i < n; i++) {
+      fact_bench_objs[i] = chFactoryRegisterObject(fact_bench_names[i],
+                                                   &fact_bench_objs[i]);
+      if (fact_bench_objs[i] == NULL) {
+        chprintf(chp, "registration failed" SHELL_NEWLINE_STR);
+        n = i;
+        break;
+      }
+    }
+    if (n == 0U) {
+      return;
+    }
+
+    errors = 0U;
+    start = chVTGetSystemTimeX();
+    for (i = 0U; i < FACT_BENCH_LOOKUPS; i++) {
+      registered_object_t *rop;
+
+      rop = chFactoryFindObject(fact_bench_names[(i * 7919U) % n]);
+      if (rop == NULL) {
+        errors++;
+      }
+      else {
+        chFactoryReleaseObject(rop);
+      }
+    }
+    ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+    chprintf(chp, "%4lu objects: %lu ns per find/release, %lu errors"
+             SHELL_NEWLINE_STR, n,
+             (uint32_t)(((uint64_t)ms * 1000000U) / FACT_BENCH_LOOKUPS),
+             errors);
+
+    for (i = 0U; i < n; i++) {
+      chFactoryReleaseObject(fact_bench_objs[i]);
+    }
+  }
+}
+
+#if CHSCANF_USE_FLOAT == TRUE
+/*
+ * Formatted input benchmark, an NMEA GGA sentence is parsed through a memory
+ * stream by chscanf() and in place by chsnscanf().
+ */
+#define SCAN_BENCH_LINES        20000U
+
+typedef struct {
+  unsigned  time;
+  double    lat;
+  char      ns;
+  double    lon;
+  char      ew;
+  int       fix;
+  int       sats;
+  float     hdop;
+  double    alt;
+  double    geoid;
+} scan_bench_gga_t;
+
+static const char scan_bench_line[] =
+  "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47";
+
+#define SCAN_BENCH_FMT          "$GPGGA,%u,%lf,%c,%lf,%c,%d,%d,%f,%lf,M,%lf"
+#define SCAN_BENCH_ARGS(g)      &(g).time, &(g).lat, &(g).ns, &(g).lon,     \
+                                &(g).ew, &(g).fix, &(g).sats, &(g).hdop,    \
+                                &(g).alt, &(g).geoid
+
+static bool scan_bench_check(int n, const scan_bench_gga_t *ggap) {
+
+  return (n == 10) && (ggap->time == 123519U) && (ggap->lat == 4807.038) &&
+         (ggap->lon == 1131.0) && (ggap->sats == 8) &&
+         (ggap->hdop == 0.9f) && (ggap->geoid == 46.9);
+}
+
+static void scan_bench_report(BaseSequentialStream *chp, const char *name,
+                              systime_t start, uint32_t errors) {
+  uint32_t ms = (uint32_t)TIME_I2MS(chVTTimeElapsedSinceX(start));
+
+  if (ms == 0U) {
+    ms = 1U;
+  }
+  chprintf(chp, "%s: %lu lines/s, %lu KB/s, %lu errors" SHELL_NEWLINE_STR,
+           name, (SCAN_BENCH_LINES * 1000U) / ms,
+           (uint32_t)(((uint64_t)SCAN_BENCH_LINES *
+                       (sizeof scan_bench_line - 1U)) / ms),
+           errors);
+}
+
+static void cmd_scanbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  char buf[sizeof scan_bench_line];
+  scan_bench_gga_t gga;
+  MemoryStream ms;
+  systime_t start;
+  uint32_t i, errors;
+  int n;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: scanbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  memcpy(buf, scan_bench_line, sizeof buf);
+
+  errors = 0U;
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < SCAN_BENCH_LINES; i++) {
+    msObjectInit(&ms, (uint8_t *)buf, sizeof buf, sizeof buf - 1U);
+    n = chscanf((BaseBufferedStream *)&ms, SCAN_BENCH_FMT,
+                SCAN_BENCH_ARGS(gga));
+    if (!scan_bench_check(n, &gga)) {
+      errors++;
+    }
+  }
+  scan_bench_report(chp, "stream", start, errors);
+
+  errors = 0U;
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < SCAN_BENCH_LINES; i++) {
+    n = chsnscanf(buf, sizeof buf, SCAN_BENCH_FMT, SCAN_BENCH_ARGS(gga));
+    if (!scan_bench_check(n, &gga)) {
+      errors++;
+    }
+  }
+  scan_bench_report(chp, "buffer", start, errors);
+}
+#endif
+
+/*
+ * Periodic tasks demo, three tasks with rate-monotonic priorities busy
+ * for a fraction of their period, the "ptasks" command shows their
+ * statistics. The 25ms task has a 5ms deadline and misses it when
+ * preempted by the 10ms task.
+ */
+typedef struct {
+  const char *name;
+  sysinterval_t period;
+  sysinterval_t deadline;
+  uint32_t busy_us;
+} pt_demo_t;
+
+static const pt_demo_t pt_demo[3] = {
+  {"pt10ms", TIME_MS2I(10), TIME_MS2I(0), 2000U},
+  {"pt25ms", TIME_MS2I(25), TIME_MS2I(5), 3000U},
+  {"pt50ms", TIME_MS2I(50), TIME_MS2I(0), 5000U}
+};
+
+static THD_WORKING_AREA(waPTDemo0, 1024);
+static THD_WORKING_AREA(waPTDemo1, 1024);
+static THD_WORKING_AREA(waPTDemo2, 1024);
+static ptask_config_t pt_demo_cfg[3];
+static periodic_task_t pt_demo_tasks[3];
+static bool pt_demo_running;
+
+static void pt_demo_job(void *arg) {
+  const pt_demo_t *dp = (const pt_demo_t *)arg;
+  rtcnt_t start = chSysGetRealtimeCounterX();
+
+  /* The simulator realtime counter counts microseconds.*/
+  while ((rtcnt_t)(chSysGetRealtimeCounterX() - start) < dp->busy_us) {
+    _sim_check_for_interrupts();
+  }
+}
+
+static void cmd_ptdemo(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static void * const was[3] = {waPTDemo0, waPTDemo1, waPTDemo2};
+  periodic_task_t *ptps[3];
+  systime_t origin;
+  unsigned i;
+
+  if ((argc == 1) && (strcmp(argv[0], "start") == 0) && !pt_demo_running) {
+    for (i = 0U; i < 3U; i++) {
+      pt_demo_cfg[i].name     = pt_demo[i].name;
+      pt_demo_cfg[i].wsp      = was[i];
+      pt_demo_cfg[i].size     = sizeof waPTDemo0;
+      pt_demo_cfg[i].prio     = NORMALPRIO;
+      pt_demo_cfg[i].period   = pt_demo[i].period;
+      pt_demo_cfg[i].phase    = (sysinterval_t)0;
+      pt_demo_cfg[i].deadline = pt_demo[i].deadline;
+      pt_demo_cfg[i].job      = pt_demo_job;
+      pt_demo_cfg[i].arg      = (void *)&pt_demo[i];
+      pt_demo_cfg[i].miss_cb  = NULL;
+      ptaskObjectInit(&pt_demo_tasks[i], &pt_demo_cfg[i]);
+      ptps[i] = &pt_demo_tasks[i];
+    }
+    ptaskAssignRateMonotonic(ptps, 3U, NORMALPRIO + 1);
+    origin = chTimeAddX(chVTGetSystemTime(), TIME_MS2I(10));
+    for (i = 0U; i < 3U; i++) {
+      ptaskStart(&pt_demo_tasks[i], origin);
+    }
+    pt_demo_running = true;
+    return;
+  }
+  if ((argc == 1) && (strcmp(argv[0], "stop") == 0) && pt_demo_running) {
+    for (i = 0U; i < 3U; i++) {
+      ptaskStop(&pt_demo_tasks[i]);
+    }
+    pt_demo_running = false;
+    return;
+  }
+
+  chprintf(chp, "Usage: ptdemo start|stop" SHELL_NEWLINE_STR);
+}
+
+/*
+ * Latency test suite, optionally followed by a machine-readable report.
+ */
+static void cmd_latency(BaseSequentialStream *chp, int argc, char *argv[]) {
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  unsigned format = TEST_REPORT_NONE;
+
+  if (argc == 1) {
+    if (strcmp(argv[0], "json") == 0) {
+      format = TEST_REPORT_JSON;
+    }
+    else if (strcmp(argv[0], "junit") == 0) {
+      format = TEST_REPORT_JUNIT;
+    }
+  }
+  if ((argc > 1) || ((argc == 1) && (format == TEST_REPORT_NONE))) {
+    chprintf(chp, "Usage: latency [json|junit]" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  test_set_report(format, NULL);
+#else
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: latency" SHELL_NEWLINE_STR);
+    return;
+  }
+#endif
+
+  (void) test_execute(chp, &latency_test_suite);
+}
+
+/*
+ * Streams test suite.
+ */
+static void cmd_streams(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: streams" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  (void) test_execute(chp, &streams_test_suite);
+}
+
+/*
+ * CMSIS RTOS2 test suite.
+ */
+static void cmd_cmsis2(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: cmsis2" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  (void) test_execute(chp, &cmsis_os2_test_suite);
+}
+
 static const ShellCommand commands[] = {
+#if HAL_USE_SPI == TRUE
+  {"spibench", cmd_spibench},
+#endif
+#if HAL_USE_CAN == TRUE
+  {"canbench", cmd_canbench},
+#endif
+#if HAL_USE_I2C == TRUE
+  {"i2cstest", cmd_i2cstest},
+#endif
+#if HAL_USE_MAC == TRUE
+  {"macbench", cmd_macbench},
+#endif
+  {"adcbench", cmd_adcbench},
+  {"blkbench", cmd_blkbench},
+  {"sbbench", cmd_sbbench},
+  {"factbench", cmd_factbench},
+#if CHSCANF_USE_FLOAT == TRUE
+  {"scanbench", cmd_scanbench},
+#endif
+  {"latency", cmd_latency},
+  {"streams", cmd_streams},
+  {"cmsis2", cmd_cmsis2},
+  {"ptdemo", cmd_ptdemo},
   {NULL, NULL}
 };
 
@@ -175,6 +1260,12 @@ int main(void) {
   shellInit();
   chEvtRegister(&shell_terminated, &tel, 0);
 
+  /*
+   * Sandbox host initialization.
+   */
+  sbHostInit();
+  sbObjectInit(&sb_bench);
+
   /*
    * Console thread started.
    */
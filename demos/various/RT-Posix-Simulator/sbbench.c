@@ -0,0 +1,42 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Sandboxed side of the "sbbench" command, this module only uses the
+ * sandbox user API. Each received message is a number of syscalls to be
+ * performed before replying, zero measures the bare messages round trip.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sbuser.h"
+
+void sb_bench_sandbox(void);
+
+void sb_bench_sandbox(void) {
+
+  while (true) {
+    msg_t msg = sbMsgWait();
+    uint32_t i;
+
+    for (i = 0U; i < (uint32_t)msg; i++) {
+      (void) sbGetSystemTime();
+    }
+    (void) sbMsgReply(msg);
+  }
+}
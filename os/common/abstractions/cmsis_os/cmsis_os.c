@@ -52,9 +52,27 @@ int32_t cmsis_os_started;
 static memory_pool_t sempool;
 static semaphore_t semaphores[CMSIS_CFG_NUM_SEMAPHORES];
 
+static memory_pool_t mtxpool;
+static mutex_t mutexes[CMSIS_CFG_NUM_MUTEXES];
+
 static memory_pool_t timpool;
 static struct os_timer_cb timers[CMSIS_CFG_NUM_TIMERS];
 
+/**
+ * @brief   Queue of the timers waiting for service.
+ */
+static ch_queue_t timers_queue;
+
+/**
+ * @brief   Reference to the timers service thread when idle.
+ */
+static thread_reference_t timers_trp;
+
+/**
+ * @brief   Working area of the timers service thread.
+ */
+static THD_WORKING_AREA(timers_wa, CMSIS_CFG_TIMER_THREAD_STACK);
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
@@ -66,20 +84,70 @@ __STATIC_INLINE sysinterval_t tmo(uint32_t millisec) {
                                                       TIME_MS2I(millisec));
 }
 
+/**
+ * @brief   Removes a timer from the service queue, if queued.
+ *
+ * @param[in] timer_id              a timer identifier
+ */
+static void timer_dequeue_i(osTimerId timer_id) {
+
+  if (timer_id->pending) {
+    (void) ch_queue_dequeue(&timer_id->queue);
+    timer_id->pending = false;
+  }
+}
+
 /**
  * @brief   Virtual timers common callback.
+ * @details The timer is queued for service, activations happening while
+ *          the timer is still queued are merged.
  */
-static void timer_cb(virtual_timer_t *vtp, void const *arg) {
+static void timer_cb(virtual_timer_t *vtp, void *arg) {
   osTimerId timer_id = (osTimerId)arg;
 
   (void)vtp;
 
-  timer_id->ptimer(timer_id->argument);
-  if (timer_id->type == osTimerPeriodic) {
-    chSysLockFromISR();
-    chVTDoSetI(&timer_id->vt, TIME_MS2I(timer_id->millisec),
-               (vtfunc_t)timer_cb, timer_id);
-    chSysUnlockFromISR();
+  chSysLockFromISR();
+  if (!timer_id->pending) {
+    timer_id->pending = true;
+    ch_queue_insert(&timers_queue, &timer_id->queue);
+    chThdResumeI(&timers_trp, MSG_OK);
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Timers service thread.
+ * @details Timer callbacks are executed by this thread, periodic timers
+ *          are continuous virtual timers so the period does not depend
+ *          on the callbacks execution time.
+ */
+static THD_FUNCTION(timers_thread, arg) {
+
+  (void)arg;
+
+  chRegSetThreadName("cmsis_timers");
+
+  chSysLock();
+  while (true) {
+    osTimerId timer_id;
+    os_ptimer ptimer;
+    void *argument;
+
+    if (ch_queue_isempty(&timers_queue)) {
+      (void) chThdSuspendS(&timers_trp);
+      continue;
+    }
+
+    timer_id = (osTimerId)ch_queue_fifo_remove(&timers_queue);
+    timer_id->pending = false;
+    ptimer   = timer_id->ptimer;
+    argument = timer_id->argument;
+    chSysUnlock();
+
+    ptimer(argument);
+
+    chSysLock();
   }
 }
 
@@ -103,9 +171,17 @@ osStatus osKernelInitialize(void) {
   chPoolObjectInit(&sempool, sizeof(semaphore_t), chCoreAllocAlignedI);
   chPoolLoadArray(&sempool, semaphores, CMSIS_CFG_NUM_SEMAPHORES);
 
+  chPoolObjectInit(&mtxpool, sizeof(mutex_t), chCoreAllocAlignedI);
+  chPoolLoadArray(&mtxpool, mutexes, CMSIS_CFG_NUM_MUTEXES);
+
   chPoolObjectInit(&timpool, sizeof(struct os_timer_cb), chCoreAllocAlignedI);
   chPoolLoadArray(&timpool, timers, CMSIS_CFG_NUM_TIMERS);
 
+  ch_queue_init(&timers_queue);
+  timers_trp = NULL;
+  (void) chThdCreateStatic(timers_wa, sizeof (timers_wa),
+                           CMSIS_CFG_TIMER_THREAD_PRIO, timers_thread, NULL);
+
   return osOK;
 }
 
@@ -236,6 +312,7 @@ osStatus osThreadSetPriority(osThreadId thread_id, osPriority newprio) {
  * @brief   Creates a one-shot or periodic timer.
  * @details The timer is in stopped state until it is started with
  *          @p osTimerStart.
+ * @note    The timer callback is executed by the timers service thread.
  *
  * @param[in] timer_def             the timer object declared with @p osTimer
  * @param[in] type                  @p osTimerOnce or @p osTimerPeriodic
@@ -252,16 +329,23 @@ osTimerId osTimerCreate(const osTimerDef_t *timer_def,
   }
 
   osTimerId timer = chPoolAlloc(&timpool);
+  if (timer == NULL) {
+    return NULL;
+  }
+
   chVTObjectInit(&timer->vt);
   timer->ptimer = timer_def->ptimer;
   timer->type = type;
   timer->argument = argument;
+  timer->pending = false;
 
   return timer;
 }
 
 /**
  * @brief   Starts or restarts a timer.
+ * @note    Periodic timers are re-armed relative to the previous expiration
+ *          time, not to the callback execution, so they do not drift.
  *
  * @param[in] timer_id              a timer identifier
  * @param[in] millisec              time delay value of the timer
@@ -286,8 +370,16 @@ osStatus osTimerStart(osTimerId timer_id, uint32_t millisec) {
     return osErrorValue;
   }
 
-  timer_id->millisec = millisec;
-  chVTSet(&timer_id->vt, TIME_MS2I(millisec), (vtfunc_t)timer_cb, timer_id);
+  chSysLock();
+  timer_dequeue_i(timer_id);
+  if (timer_id->type == osTimerPeriodic) {
+    chVTSetContinuousI(&timer_id->vt, TIME_MS2I(millisec),
+                       timer_cb, timer_id);
+  }
+  else {
+    chVTSetI(&timer_id->vt, TIME_MS2I(millisec), timer_cb, timer_id);
+  }
+  chSysUnlock();
 
   return osOK;
 }
@@ -313,11 +405,14 @@ osStatus osTimerStop(osTimerId timer_id) {
     return osErrorISR;
   }
 
-  if (chVTIsArmed(&timer_id->vt) == false) {
+  chSysLock();
+  if (!chVTIsArmedI(&timer_id->vt) && !timer_id->pending) {
+    chSysUnlock();
     return osErrorResource;
   }
-
-  chVTReset(&timer_id->vt);
+  chVTResetI(&timer_id->vt);
+  timer_dequeue_i(timer_id);
+  chSysUnlock();
 
   return osOK;
 }
@@ -342,7 +437,10 @@ osStatus osTimerDelete(osTimerId timer_id) {
     return osErrorISR;
   }
 
-  chVTReset(&timer_id->vt);
+  chSysLock();
+  chVTResetI(&timer_id->vt);
+  timer_dequeue_i(timer_id);
+  chSysUnlock();
   chPoolFree(&timpool, (void *)timer_id);
 
   return osOK;
@@ -494,8 +592,11 @@ osStatus osSemaphoreDelete(osSemaphoreId semaphore_id) {
 
 /**
  * @brief   Creates a mutex.
+ * @details The mutex implements the priority inheritance protocol.
  * @note    @p mutex_def is not used.
  * @note    Can involve memory allocation.
+ * @note    The mutex is recursive only if @p CH_CFG_USE_MUTEXES_RECURSIVE
+ *          is enabled.
  *
  * @param[in] mutex_def             the mutex object declared with @p osMutex
  * @return                          The mutex identifier.
@@ -505,44 +606,89 @@ osMutexId osMutexCreate(const osMutexDef_t *mutex_def) {
 
   (void)mutex_def;
 
-  binary_semaphore_t *mtx = chPoolAlloc(&sempool);
-  chBSemObjectInit(mtx, false);
+  if (port_is_isr_context()) {
+    return NULL;
+  }
+
+  mutex_t *mtx = chPoolAlloc(&mtxpool);
+  if (mtx != NULL) {
+    chMtxObjectInit(mtx);
+  }
   return mtx;
 }
 
 /**
  * @brief   Waits on a mutex.
+ * @note    The priority of the owner is raised while waiting, also with a
+ *          finite timeout.
  *
  * @param[in] mutex_id              a mutex identifier
+ * @param[in] millisec              the timeout value
  * @return                          The function execution status.
  * @retval osOK                     if the function succeeded.
- * @retval osErrorResource          if the object is in an invalid state.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is not available and
+ *                                  @p millisec is zero.
  * @retval osErrorTimeoutResource   if the function timed out.
  */
 osStatus osMutexWait(osMutexId mutex_id, uint32_t millisec) {
 
-  msg_t msg = chBSemWaitTimeout((binary_semaphore_t *)mutex_id, tmo(millisec));
-  switch (msg) {
-  case MSG_OK:
+  if (mutex_id == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (chMtxLockTimeout(mutex_id, tmo(millisec)) == MSG_OK) {
     return osOK;
-  case MSG_TIMEOUT:
-    return osErrorTimeoutResource;
   }
-  return osErrorResource;
+
+  return millisec == 0 ? osErrorResource : osErrorTimeoutResource;
 }
 
 /**
  * @brief   Releases a mutex.
+ * @note    Mutexes must be released in reverse locking order, releasing
+ *          out of order fails with @p osErrorResource.
  *
  * @param[in] mutex_id              a mutex identifier
  * @return                          The function execution status.
  * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is not owned by the caller
+ *                                  or it is not the last mutex acquired.
  */
 osStatus osMutexRelease(osMutexId mutex_id) {
 
-  syssts_t sts = chSysGetStatusAndLockX();
-  chBSemSignalI((binary_semaphore_t *)mutex_id);
-  chSysRestoreStatusX(sts);
+  if (mutex_id == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (mutex_id->owner != chThdGetSelfX()) {
+    return osErrorResource;
+  }
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  /* A recursive release that does not free the mutex is order-free.*/
+  if ((mutex_id->cnt == (cnt_t)1) && (chMtxGetNextMutexX() != mutex_id)) {
+#else
+  if (chMtxGetNextMutexX() != mutex_id) {
+#endif
+    /* Out of order release, RT mutexes are kept in a per-thread stack.*/
+    return osErrorResource;
+  }
+
+  chMtxUnlock(mutex_id);
 
   return osOK;
 }
@@ -550,16 +696,31 @@ osStatus osMutexRelease(osMutexId mutex_id) {
 /**
  * @brief   Deletes a mutex.
  * @note    After deletion there could be references in the system to a
- *          non-existent semaphore.
+ *          non-existent mutex.
  *
  * @param[in] mutex_id              a mutex identifier
  * @return                          The function execution status.
  * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is locked.
  */
 osStatus osMutexDelete(osMutexId mutex_id) {
 
-  chSemReset((semaphore_t *)mutex_id, 0);
-  chPoolFree(&sempool, (void *)mutex_id);
+  if (mutex_id == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (mutex_id->owner != NULL) {
+    return osErrorResource;
+  }
+
+  chPoolFree(&mtxpool, (void *)mutex_id);
 
   return osOK;
 }
@@ -83,19 +83,26 @@
 /*===========================================================================*/
 
 /**
- * @brief   Number of pre-allocated static semaphores/mutexes.
+ * @brief   Default stack size of the threads.
  */
 #if !defined(CMSIS_CFG_DEFAULT_STACK)
 #define CMSIS_CFG_DEFAULT_STACK     256
 #endif
 
 /**
- * @brief   Number of pre-allocated static semaphores/mutexes.
+ * @brief   Number of pre-allocated static semaphores.
  */
 #if !defined(CMSIS_CFG_NUM_SEMAPHORES)
 #define CMSIS_CFG_NUM_SEMAPHORES    4
 #endif
 
+/**
+ * @brief   Number of pre-allocated static mutexes.
+ */
+#if !defined(CMSIS_CFG_NUM_MUTEXES)
+#define CMSIS_CFG_NUM_MUTEXES       4
+#endif
+
 /**
  * @brief   Number of pre-allocated static timers.
  */
@@ -103,6 +110,22 @@
 #define CMSIS_CFG_NUM_TIMERS        4
 #endif
 
+/**
+ * @brief   Stack size of the timers service thread.
+ */
+#if !defined(CMSIS_CFG_TIMER_THREAD_STACK)
+#define CMSIS_CFG_TIMER_THREAD_STACK 256
+#endif
+
+/**
+ * @brief   Priority of the timers service thread.
+ * @note    The default is above @p osPriorityRealtime so that the timer
+ *          callbacks are not delayed by the application threads.
+ */
+#if !defined(CMSIS_CFG_TIMER_THREAD_PRIO)
+#define CMSIS_CFG_TIMER_THREAD_PRIO (NORMALPRIO + 4)
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -123,6 +146,10 @@
 #error "CMSIS RTOS requires CH_CFG_USE_SEMAPHORES"
 #endif
 
+#if !CH_CFG_USE_MUTEXES
+#error "CMSIS RTOS requires CH_CFG_USE_MUTEXES"
+#endif
+
 #if !CH_CFG_USE_OBJ_FIFOS
 #error "CMSIS RTOS requires CH_CFG_USE_OBJ_FIFOS"
 #endif
@@ -197,17 +224,25 @@ typedef thread_t *osThreadId;
  * @brief   Type of pointer to timer control block.
  */
 typedef struct os_timer_cb {
+  /**
+   * @brief   Link in the queue of the timers waiting for service.
+   * @note    Must be the first field.
+   */
+  ch_queue_t                queue;
   virtual_timer_t           vt;
   os_timer_type             type;
   os_ptimer                 ptimer;
   void                      *argument;
-  uint32_t                  millisec;
+  /**
+   * @brief   Timer queued for service.
+   */
+  bool                      pending;
 } *osTimerId;
 
 /**
  * @brief   Type of pointer to mutex control block.
  */
-typedef binary_semaphore_t *osMutexId;
+typedef mutex_t *osMutexId;
 
 /**
  * @brief   Type of pointer to semaphore control block.
@@ -395,7 +430,7 @@ const osTimerDef_t os_timer_def_##name = {                                  \
   extern const osPoolDef_t os_pool_def_##name
 #else
 #define osPoolDef(name, no, type)                                           \
-static const type os_pool_buf_##name[no];                                   \
+static type os_pool_buf_##name[no];                                         \
 static memory_pool_t os_pool_obj_##name;                                    \
 const osPoolDef_t os_pool_def_##name = {                                    \
   (no),                                                                     \
@@ -418,7 +453,7 @@ const osPoolDef_t os_pool_def_##name = {                                    \
   extern const osMessageQDef_t os_messageQ_def_##name
 #else
 #define osMessageQDef(name, queue_sz, type)                                 \
-static const msg_t os_messageQ_buf_##name[queue_sz];                        \
+static msg_t os_messageQ_buf_##name[queue_sz];                              \
 static mailbox_t os_messageQ_obj_##name;                                    \
 const osMessageQDef_t os_messageQ_def_##name = {                            \
   (queue_sz),                                                               \
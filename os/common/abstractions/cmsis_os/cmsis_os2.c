@@ -0,0 +1,950 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    cmsis_os2.c
+ * @brief   CMSIS RTOS2 module code.
+ *
+ * @addtogroup CMSIS_OS2
+ * @{
+ */
+
+#include "cmsis_os2.h"
+#include <string.h>
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static osKernelState_t kernel_state = osKernelInactive;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static inline sysinterval_t tmo(uint32_t ticks) {
+
+  return ticks == osWaitForever ? TIME_INFINITE : (sysinterval_t)ticks;
+}
+
+static inline tprio_t prio_to_rt(osPriority_t priority) {
+
+  return (tprio_t)((int32_t)NORMALPRIO +
+                   ((int32_t)priority - (int32_t)osPriorityNormal));
+}
+
+/**
+ * @brief   Control block allocation.
+ * @details The control block is the one specified in the attributes or,
+ *          if not specified, it is allocated from the default heap.
+ *
+ * @param[in] cb_mem    control block specified in the attributes or @p NULL
+ * @param[in] cb_size   size of the specified control block
+ * @param[in] size      size of the required control block
+ * @param[out] dynamicp the control block has been allocated from heap
+ * @return              The control block.
+ * @retval NULL         if the specified block is not valid or the heap
+ *                      is exhausted or not available.
+ */
+static void *cb_alloc(void *cb_mem, uint32_t cb_size, size_t size,
+                      bool *dynamicp) {
+
+  if (cb_mem != NULL) {
+    *dynamicp = false;
+    if (((size_t)cb_size < size) ||
+        !MEM_IS_ALIGNED(cb_mem, PORT_NATURAL_ALIGN)) {
+      return NULL;
+    }
+    return cb_mem;
+  }
+
+#if CH_CFG_USE_HEAP == TRUE
+  *dynamicp = true;
+  return chHeapAlloc(NULL, size);
+#else
+  *dynamicp = false;
+  return NULL;
+#endif
+}
+
+/**
+ * @brief   Control block release.
+ *
+ * @param[in] p         the control block
+ * @param[in] dynamic   the control block has been allocated from heap
+ */
+static void cb_free(void *p, bool dynamic) {
+
+#if CH_CFG_USE_HEAP == TRUE
+  if (dynamic) {
+    chHeapFree(p);
+  }
+#else
+  (void)p;
+  (void)dynamic;
+#endif
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Kernel initialization.
+ * @details The caller priority is raised to @p HIGHPRIO so that the threads
+ *          created before @p osKernelStart() do not run.
+ *
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osError                  if the kernel is already initialized.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osKernelInitialize(void) {
+
+  if (kernel_state != osKernelInactive) {
+    return osError;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  chSysInit();
+  chThdSetPriority(HIGHPRIO);
+
+  kernel_state = osKernelReady;
+
+  return osOK;
+}
+
+/**
+ * @brief   Returns the kernel state.
+ *
+ * @return                          The kernel state.
+ */
+osKernelState_t osKernelGetState(void) {
+
+  return kernel_state;
+}
+
+/**
+ * @brief   Kernel start.
+ * @note    The function returns, the caller continues as a thread with
+ *          priority @p osPriorityNormal.
+ *
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osError                  if the kernel is not ready.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osKernelStart(void) {
+
+  if (kernel_state != osKernelReady) {
+    return osError;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  kernel_state = osKernelRunning;
+
+  chThdSetPriority(NORMALPRIO);
+
+  return osOK;
+}
+
+/**
+ * @brief   Creates a thread.
+ * @details The working area is the one specified in the attributes or,
+ *          if not specified, it is allocated from the default heap.
+ * @note    The memory of threads with an heap-allocated working area is
+ *          not recovered on termination.
+ *
+ * @param[in] func                  the thread function
+ * @param[in] argument              argument for the thread function
+ * @param[in] attr                  thread attributes or @p NULL
+ * @return                          The thread identifier.
+ * @retval NULL                     if the function failed.
+ */
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument,
+                         const osThreadAttr_t *attr) {
+  osPriority_t priority = osPriorityNormal;
+  const char *name = NULL;
+  void *stack_mem = NULL;
+  size_t stack_size = (size_t)CMSIS_CFG_DEFAULT_STACK;
+
+  if ((func == NULL) || port_is_isr_context()) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    name = attr->name;
+    if (attr->priority != osPriorityNone) {
+      priority = attr->priority;
+    }
+    if (attr->stack_size != 0U) {
+      stack_size = (size_t)attr->stack_size;
+    }
+    stack_mem = attr->stack_mem;
+  }
+
+  if ((priority < osPriorityIdle) || (priority >= osPriorityISR)) {
+    return NULL;
+  }
+
+  if (stack_mem != NULL) {
+    thread_descriptor_t td;
+
+    if ((attr->stack_size == 0U) ||
+        (stack_size < THD_WORKING_AREA_SIZE(0)) ||
+        !MEM_IS_ALIGNED(stack_mem, PORT_WORKING_AREA_ALIGN) ||
+        !MEM_IS_ALIGNED(stack_size, PORT_STACK_ALIGN)) {
+      return NULL;
+    }
+
+    td.name  = name;
+    td.wbase = (stkalign_t *)stack_mem;
+    td.wend  = (stkalign_t *)((uint8_t *)stack_mem + stack_size);
+    td.prio  = prio_to_rt(priority);
+    td.funcp = (tfunc_t)func;
+    td.arg   = argument;
+#if CH_CFG_SMP_MODE != FALSE
+    td.instance = NULL;
+#endif
+
+    return (osThreadId_t)chThdCreate(&td);
+  }
+
+#if (CH_CFG_USE_DYNAMIC == TRUE) && (CH_CFG_USE_HEAP == TRUE)
+  return (osThreadId_t)chThdCreateFromHeap(NULL,
+                                           THD_WORKING_AREA_SIZE(stack_size),
+                                           name,
+                                           prio_to_rt(priority),
+                                           (tfunc_t)func,
+                                           argument);
+#else
+  return NULL;
+#endif
+}
+
+/**
+ * @brief   Returns the priority of a thread.
+ *
+ * @param[in] thread_id             a thread identifier
+ * @return                          The thread priority.
+ * @retval osPriorityError          if the priority cannot be represented.
+ */
+osPriority_t osThreadGetPriority(osThreadId_t thread_id) {
+  int32_t priority;
+
+  if (thread_id == NULL) {
+    return osPriorityError;
+  }
+
+  priority = (int32_t)osPriorityNormal +
+             ((int32_t)((thread_t *)thread_id)->hdr.pqueue.prio -
+              (int32_t)NORMALPRIO);
+  if ((priority < (int32_t)osPriorityIdle) ||
+      (priority > (int32_t)osPriorityISR)) {
+    return osPriorityError;
+  }
+
+  return (osPriority_t)priority;
+}
+
+/**
+ * @brief   Waits for a time period.
+ *
+ * @param[in] ticks                 the time period in system ticks
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if @p ticks is zero.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osDelay(uint32_t ticks) {
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (ticks == 0U) {
+    return osErrorParameter;
+  }
+
+  chThdSleep((sysinterval_t)ticks);
+
+  return osOK;
+}
+
+/**
+ * @brief   Waits until an absolute time.
+ * @note    Times up to half the system time range ahead are considered in
+ *          the future, anything else is considered already elapsed.
+ *
+ * @param[in] ticks                 the absolute time in system ticks
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if @p ticks is not in the future.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osDelayUntil(uint32_t ticks) {
+  sysinterval_t delay;
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  chSysLock();
+  delay = chTimeDiffX(chVTGetSystemTimeX(), (systime_t)ticks);
+  if ((delay == (sysinterval_t)0) ||
+      (delay > (sysinterval_t)(TIME_MAX_SYSTIME / 2U))) {
+    chSysUnlock();
+    return osErrorParameter;
+  }
+  chThdSleepS(delay);
+  chSysUnlock();
+
+  return osOK;
+}
+
+/**
+ * @brief   Creates a mutex.
+ * @details The mutex implements the priority inheritance protocol.
+ * @note    Recursive mutexes require @p CH_CFG_USE_MUTEXES_RECURSIVE, robust
+ *          mutexes are not supported.
+ *
+ * @param[in] attr                  mutex attributes or @p NULL
+ * @return                          The mutex identifier.
+ * @retval NULL                     if the function failed.
+ */
+osMutexId_t osMutexNew(const osMutexAttr_t *attr) {
+  os_mutex_cb_t *mcbp;
+  bool dynamic;
+
+  if (port_is_isr_context()) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+#if CH_CFG_USE_MUTEXES_RECURSIVE == FALSE
+    if ((attr->attr_bits & osMutexRecursive) != 0U) {
+      return NULL;
+    }
+#endif
+    mcbp = cb_alloc(attr->cb_mem, attr->cb_size, sizeof (os_mutex_cb_t),
+                    &dynamic);
+  }
+  else {
+    mcbp = cb_alloc(NULL, 0U, sizeof (os_mutex_cb_t), &dynamic);
+  }
+
+  if (mcbp != NULL) {
+    chMtxObjectInit(&mcbp->mtx);
+    mcbp->dynamic = dynamic;
+  }
+
+  return (osMutexId_t)mcbp;
+}
+
+/**
+ * @brief   Acquires a mutex.
+ * @note    The priority of the owner is raised while waiting, also with a
+ *          finite timeout.
+ *
+ * @param[in] mutex_id              a mutex identifier
+ * @param[in] timeout               the timeout in system ticks
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is not available and
+ *                                  @p timeout is zero.
+ * @retval osErrorTimeout           if the function timed out.
+ */
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout) {
+  os_mutex_cb_t *mcbp = (os_mutex_cb_t *)mutex_id;
+
+  if (mcbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (chMtxLockTimeout(&mcbp->mtx, tmo(timeout)) == MSG_OK) {
+    return osOK;
+  }
+
+  return timeout == 0U ? osErrorResource : osErrorTimeout;
+}
+
+/**
+ * @brief   Releases a mutex.
+ * @note    Mutexes must be released in reverse locking order, releasing
+ *          out of order fails with @p osErrorResource.
+ *
+ * @param[in] mutex_id              a mutex identifier
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is not owned by the caller
+ *                                  or it is not the last mutex acquired.
+ */
+osStatus_t osMutexRelease(osMutexId_t mutex_id) {
+  os_mutex_cb_t *mcbp = (os_mutex_cb_t *)mutex_id;
+
+  if (mcbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (mcbp->mtx.owner != chThdGetSelfX()) {
+    return osErrorResource;
+  }
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  /* A recursive release that does not free the mutex is order-free.*/
+  if ((mcbp->mtx.cnt == (cnt_t)1) && (chMtxGetNextMutexX() != &mcbp->mtx)) {
+#else
+  if (chMtxGetNextMutexX() != &mcbp->mtx) {
+#endif
+    /* Out of order release, RT mutexes are kept in a per-thread stack.*/
+    return osErrorResource;
+  }
+
+  chMtxUnlock(&mcbp->mtx);
+
+  return osOK;
+}
+
+/**
+ * @brief   Returns the owner of a mutex.
+ *
+ * @param[in] mutex_id              a mutex identifier
+ * @return                          The owner thread identifier.
+ * @retval NULL                     if the mutex is not locked.
+ */
+osThreadId_t osMutexGetOwner(osMutexId_t mutex_id) {
+  os_mutex_cb_t *mcbp = (os_mutex_cb_t *)mutex_id;
+
+  if ((mcbp == NULL) || port_is_isr_context()) {
+    return NULL;
+  }
+
+  return (osThreadId_t)mcbp->mtx.owner;
+}
+
+/**
+ * @brief   Deletes a mutex.
+ *
+ * @param[in] mutex_id              a mutex identifier
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ * @retval osErrorResource          if the mutex is locked.
+ */
+osStatus_t osMutexDelete(osMutexId_t mutex_id) {
+  os_mutex_cb_t *mcbp = (os_mutex_cb_t *)mutex_id;
+
+  if (mcbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  if (mcbp->mtx.owner != NULL) {
+    return osErrorResource;
+  }
+
+  cb_free(mcbp, mcbp->dynamic);
+
+  return osOK;
+}
+
+/**
+ * @brief   Creates a semaphore.
+ *
+ * @param[in] max_count             maximum number of tokens
+ * @param[in] initial_count         initial number of tokens
+ * @param[in] attr                  semaphore attributes or @p NULL
+ * @return                          The semaphore identifier.
+ * @retval NULL                     if the function failed.
+ */
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count,
+                               const osSemaphoreAttr_t *attr) {
+  os_semaphore_cb_t *scbp;
+  bool dynamic;
+
+  if ((max_count == 0U) || (initial_count > max_count) ||
+      (max_count > (uint32_t)((ucnt_t)-1 >> 1)) || port_is_isr_context()) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    scbp = cb_alloc(attr->cb_mem, attr->cb_size, sizeof (os_semaphore_cb_t),
+                    &dynamic);
+  }
+  else {
+    scbp = cb_alloc(NULL, 0U, sizeof (os_semaphore_cb_t), &dynamic);
+  }
+
+  if (scbp != NULL) {
+    chSemObjectInit(&scbp->sem, (cnt_t)initial_count);
+    scbp->max_count = max_count;
+    scbp->dynamic   = dynamic;
+  }
+
+  return (osSemaphoreId_t)scbp;
+}
+
+/**
+ * @brief   Acquires a semaphore token.
+ *
+ * @param[in] semaphore_id          a semaphore identifier
+ * @param[in] timeout               the timeout in system ticks, must be zero
+ *                                  if called from ISR context
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is invalid.
+ * @retval osErrorResource          if no token is available and
+ *                                  @p timeout is zero.
+ * @retval osErrorTimeout           if the function timed out.
+ */
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id,
+                              uint32_t timeout) {
+  os_semaphore_cb_t *scbp = (os_semaphore_cb_t *)semaphore_id;
+  msg_t msg;
+
+  if (scbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+
+    chSysLockFromISR();
+    if (chSemGetCounterI(&scbp->sem) > (cnt_t)0) {
+      chSemFastWaitI(&scbp->sem);
+      msg = MSG_OK;
+    }
+    else {
+      msg = MSG_TIMEOUT;
+    }
+    chSysUnlockFromISR();
+  }
+  else {
+    msg = chSemWaitTimeout(&scbp->sem, tmo(timeout));
+  }
+
+  if (msg == MSG_OK) {
+    return osOK;
+  }
+
+  return timeout == 0U ? osErrorResource : osErrorTimeout;
+}
+
+/**
+ * @brief   Releases a semaphore token.
+ *
+ * @param[in] semaphore_id          a semaphore identifier
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorResource          if the maximum count has been reached.
+ */
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id) {
+  os_semaphore_cb_t *scbp = (os_semaphore_cb_t *)semaphore_id;
+  osStatus_t status = osOK;
+
+  if (scbp == NULL) {
+    return osErrorParameter;
+  }
+
+  syssts_t sts = chSysGetStatusAndLockX();
+  if (chSemGetCounterI(&scbp->sem) >= (cnt_t)scbp->max_count) {
+    status = osErrorResource;
+  }
+  else {
+    chSemSignalI(&scbp->sem);
+    if (!port_is_isr_context()) {
+      chSchRescheduleS();
+    }
+  }
+  chSysRestoreStatusX(sts);
+
+  return status;
+}
+
+/**
+ * @brief   Returns the number of available tokens.
+ *
+ * @param[in] semaphore_id          a semaphore identifier
+ * @return                          The number of available tokens.
+ */
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id) {
+  os_semaphore_cb_t *scbp = (os_semaphore_cb_t *)semaphore_id;
+  cnt_t cnt;
+
+  if (scbp == NULL) {
+    return 0U;
+  }
+
+  syssts_t sts = chSysGetStatusAndLockX();
+  cnt = chSemGetCounterI(&scbp->sem);
+  chSysRestoreStatusX(sts);
+
+  return cnt > (cnt_t)0 ? (uint32_t)cnt : 0U;
+}
+
+/**
+ * @brief   Deletes a semaphore.
+ * @note    Threads waiting on the semaphore are released with a timeout
+ *          error.
+ *
+ * @param[in] semaphore_id          a semaphore identifier
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id) {
+  os_semaphore_cb_t *scbp = (os_semaphore_cb_t *)semaphore_id;
+
+  if (scbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  chSemResetWithMessage(&scbp->sem, (cnt_t)0, MSG_TIMEOUT);
+  cb_free(scbp, scbp->dynamic);
+
+  return osOK;
+}
+
+/**
+ * @brief   Creates a message queue.
+ * @details Messages have arbitrary size, they are copied into the queue
+ *          buffer on put and out of it on get. The buffer is the one
+ *          specified in the attributes or, if not specified, it is allocated
+ *          from the default heap, its size is given by
+ *          @p osMessageQueueMemSize().
+ *
+ * @param[in] msg_count             maximum number of messages in queue
+ * @param[in] msg_size              maximum message size in bytes
+ * @param[in] attr                  message queue attributes or @p NULL
+ * @return                          The message queue identifier.
+ * @retval NULL                     if the function failed.
+ */
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size,
+                                     const osMessageQueueAttr_t *attr) {
+  os_message_queue_cb_t *qcbp;
+  size_t objsize, memsize;
+  void *mq_mem = NULL;
+  bool dynamic, dynamic_mem;
+
+  if ((msg_count == 0U) || (msg_size == 0U) || port_is_isr_context()) {
+    return NULL;
+  }
+
+  objsize = MEM_ALIGN_NEXT(msg_size, PORT_NATURAL_ALIGN);
+  memsize = (size_t)osMessageQueueMemSize(msg_count, msg_size);
+
+  if (attr != NULL) {
+    qcbp = cb_alloc(attr->cb_mem, attr->cb_size,
+                    sizeof (os_message_queue_cb_t), &dynamic);
+    if ((qcbp != NULL) && (attr->mq_mem != NULL) &&
+        (((size_t)attr->mq_size < memsize) ||
+         !MEM_IS_ALIGNED(attr->mq_mem, PORT_NATURAL_ALIGN))) {
+      cb_free(qcbp, dynamic);
+      return NULL;
+    }
+    mq_mem = attr->mq_mem;
+  }
+  else {
+    qcbp = cb_alloc(NULL, 0U, sizeof (os_message_queue_cb_t), &dynamic);
+  }
+
+  if (qcbp == NULL) {
+    return NULL;
+  }
+
+  dynamic_mem = false;
+  if (mq_mem == NULL) {
+#if CH_CFG_USE_HEAP == TRUE
+    mq_mem = chHeapAlloc(NULL, memsize);
+    dynamic_mem = true;
+#endif
+    if (mq_mem == NULL) {
+      cb_free(qcbp, dynamic);
+      return NULL;
+    }
+  }
+
+  /* The objects are at the buffer start, the mailbox slots follow.*/
+  chFifoObjectInit(&qcbp->fifo, objsize, (size_t)msg_count, mq_mem,
+                   (msg_t *)((uint8_t *)mq_mem + (objsize * msg_count)));
+  qcbp->msg_count   = msg_count;
+  qcbp->msg_size    = msg_size;
+  qcbp->mq_mem      = mq_mem;
+  qcbp->dynamic     = dynamic;
+  qcbp->dynamic_mem = dynamic_mem;
+
+  return (osMessageQueueId_t)qcbp;
+}
+
+/**
+ * @brief   Puts a message into a queue.
+ * @note    Deviation from CMSIS RTOS2: the priority is not stored with the
+ *          message, messages with non-zero priority are queued ahead of
+ *          all the messages already in the queue, so they are received
+ *          in LIFO order among themselves whatever their priority.
+ *
+ * @param[in] mq_id                 a message queue identifier
+ * @param[in] msg_ptr               pointer to the message to be copied
+ * @param[in] msg_prio              message priority
+ * @param[in] timeout               the timeout in system ticks, must be zero
+ *                                  if called from ISR context
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is invalid.
+ * @retval osErrorResource          if the queue is full and @p timeout is
+ *                                  zero.
+ * @retval osErrorTimeout           if the function timed out.
+ */
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr,
+                             uint8_t msg_prio, uint32_t timeout) {
+  os_message_queue_cb_t *qcbp = (os_message_queue_cb_t *)mq_id;
+  void *objp;
+
+  if ((qcbp == NULL) || (msg_ptr == NULL)) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+
+    chSysLockFromISR();
+    objp = chFifoTakeObjectI(&qcbp->fifo);
+    chSysUnlockFromISR();
+    if (objp == NULL) {
+      return osErrorResource;
+    }
+
+    memcpy(objp, msg_ptr, qcbp->msg_size);
+
+    chSysLockFromISR();
+    if (msg_prio > 0U) {
+      chFifoSendObjectAheadI(&qcbp->fifo, objp);
+    }
+    else {
+      chFifoSendObjectI(&qcbp->fifo, objp);
+    }
+    chSysUnlockFromISR();
+
+    return osOK;
+  }
+
+  objp = chFifoTakeObjectTimeout(&qcbp->fifo, tmo(timeout));
+  if (objp == NULL) {
+    return timeout == 0U ? osErrorResource : osErrorTimeout;
+  }
+
+  memcpy(objp, msg_ptr, qcbp->msg_size);
+
+  if (msg_prio > 0U) {
+    chFifoSendObjectAhead(&qcbp->fifo, objp);
+  }
+  else {
+    chFifoSendObject(&qcbp->fifo, objp);
+  }
+
+  return osOK;
+}
+
+/**
+ * @brief   Gets a message from a queue.
+ *
+ * @param[in] mq_id                 a message queue identifier
+ * @param[out] msg_ptr              pointer to the buffer receiving the message
+ * @param[out] msg_prio             pointer to the message priority or
+ *                                  @p NULL, always zero because priorities
+ *                                  are not stored, see
+ *                                  @p osMessageQueuePut()
+ * @param[in] timeout               the timeout in system ticks, must be zero
+ *                                  if called from ISR context
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is invalid.
+ * @retval osErrorResource          if the queue is empty and @p timeout is
+ *                                  zero.
+ * @retval osErrorTimeout           if the function timed out.
+ */
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr,
+                             uint8_t *msg_prio, uint32_t timeout) {
+  os_message_queue_cb_t *qcbp = (os_message_queue_cb_t *)mq_id;
+  void *objp;
+  msg_t msg;
+
+  if ((qcbp == NULL) || (msg_ptr == NULL)) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+
+    chSysLockFromISR();
+    msg = chFifoReceiveObjectI(&qcbp->fifo, &objp);
+    chSysUnlockFromISR();
+    if (msg != MSG_OK) {
+      return osErrorResource;
+    }
+
+    memcpy(msg_ptr, objp, qcbp->msg_size);
+
+    chSysLockFromISR();
+    chFifoReturnObjectI(&qcbp->fifo, objp);
+    chSysUnlockFromISR();
+  }
+  else {
+    msg = chFifoReceiveObjectTimeout(&qcbp->fifo, &objp, tmo(timeout));
+    if (msg != MSG_OK) {
+      return timeout == 0U ? osErrorResource : osErrorTimeout;
+    }
+
+    memcpy(msg_ptr, objp, qcbp->msg_size);
+
+    chFifoReturnObject(&qcbp->fifo, objp);
+  }
+
+  if (msg_prio != NULL) {
+    *msg_prio = 0U;
+  }
+
+  return osOK;
+}
+
+/**
+ * @brief   Returns the number of messages in a queue.
+ *
+ * @param[in] mq_id                 a message queue identifier
+ * @return                          The number of queued messages.
+ */
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id) {
+  os_message_queue_cb_t *qcbp = (os_message_queue_cb_t *)mq_id;
+  size_t n;
+
+  if (qcbp == NULL) {
+    return 0U;
+  }
+
+  syssts_t sts = chSysGetStatusAndLockX();
+  n = chMBGetUsedCountI(&qcbp->fifo.mbx);
+  chSysRestoreStatusX(sts);
+
+  return (uint32_t)n;
+}
+
+/**
+ * @brief   Returns the number of free slots in a queue.
+ *
+ * @param[in] mq_id                 a message queue identifier
+ * @return                          The number of free slots.
+ */
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id) {
+  os_message_queue_cb_t *qcbp = (os_message_queue_cb_t *)mq_id;
+  cnt_t cnt;
+
+  if (qcbp == NULL) {
+    return 0U;
+  }
+
+  syssts_t sts = chSysGetStatusAndLockX();
+  cnt = chSemGetCounterI(&qcbp->fifo.free.sem);
+  chSysRestoreStatusX(sts);
+
+  return cnt > (cnt_t)0 ? (uint32_t)cnt : 0U;
+}
+
+/**
+ * @brief   Deletes a message queue.
+ * @note    There must be no threads waiting on the queue.
+ *
+ * @param[in] mq_id                 a message queue identifier
+ * @return                          The function execution status.
+ * @retval osOK                     if the function succeeded.
+ * @retval osErrorParameter         if some parameter is @p NULL.
+ * @retval osErrorISR               if the function has been called from ISR
+ *                                  context.
+ */
+osStatus_t osMessageQueueDelete(osMessageQueueId_t mq_id) {
+  os_message_queue_cb_t *qcbp = (os_message_queue_cb_t *)mq_id;
+
+  if (qcbp == NULL) {
+    return osErrorParameter;
+  }
+
+  if (port_is_isr_context()) {
+    return osErrorISR;
+  }
+
+  cb_free(qcbp->mq_mem, qcbp->dynamic_mem);
+  cb_free(qcbp, qcbp->dynamic);
+
+  return osOK;
+}
+
+/** @} */
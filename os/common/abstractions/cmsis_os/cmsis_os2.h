@@ -0,0 +1,398 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    cmsis_os2.h
+ * @brief   CMSIS RTOS2 module macros and structures.
+ * @details Subset of the CMSIS-RTOS2 API covering kernel, threads, delays,
+ *          mutexes, semaphores and message queues. Control blocks and
+ *          buffers can be provided statically through the attributes,
+ *          when not provided they are allocated from the default heap.
+ * @note    This module and the CMSIS RTOS module are alternatives, an
+ *          application can use only one of them.
+ *
+ * @addtogroup CMSIS_OS2
+ * @{
+ */
+
+#ifndef CMSIS_OS2_H
+#define CMSIS_OS2_H
+
+#include "ch.h"
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   API version.
+ */
+#define osCMSIS                     0x20001
+
+/**
+ * @brief   Kernel identification string.
+ */
+#define osKernelId                  "ChibiOS/RT"
+
+/**
+ * @brief   Wait forever specification for timeouts.
+ */
+#define osWaitForever               0xFFFFFFFFU
+
+/**
+ * @name    Mutex attributes
+ * @{
+ */
+#define osMutexRecursive            0x00000001U
+#define osMutexPrioInherit          0x00000002U
+#define osMutexRobust               0x00000008U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Default stack size of the threads.
+ */
+#if !defined(CMSIS_CFG_DEFAULT_STACK)
+#define CMSIS_CFG_DEFAULT_STACK     256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !CH_CFG_USE_SEMAPHORES
+#error "CMSIS RTOS2 requires CH_CFG_USE_SEMAPHORES"
+#endif
+
+#if !CH_CFG_USE_MUTEXES
+#error "CMSIS RTOS2 requires CH_CFG_USE_MUTEXES"
+#endif
+
+#if !CH_CFG_USE_OBJ_FIFOS
+#error "CMSIS RTOS2 requires CH_CFG_USE_OBJ_FIFOS"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of kernel states.
+ */
+typedef enum {
+  osKernelInactive          = 0,
+  osKernelReady             = 1,
+  osKernelRunning           = 2,
+  osKernelLocked            = 3,
+  osKernelSuspended         = 4,
+  osKernelError             = -1,
+  osKernelReserved          = 0x7FFFFFFF
+} osKernelState_t;
+
+/**
+ * @brief   Type of priority levels.
+ */
+typedef enum {
+  osPriorityNone            = 0,
+  osPriorityIdle            = 1,
+  osPriorityLow             = 8,
+  osPriorityLow1            = 8+1,
+  osPriorityLow2            = 8+2,
+  osPriorityLow3            = 8+3,
+  osPriorityLow4            = 8+4,
+  osPriorityLow5            = 8+5,
+  osPriorityLow6            = 8+6,
+  osPriorityLow7            = 8+7,
+  osPriorityBelowNormal     = 16,
+  osPriorityBelowNormal1    = 16+1,
+  osPriorityBelowNormal2    = 16+2,
+  osPriorityBelowNormal3    = 16+3,
+  osPriorityBelowNormal4    = 16+4,
+  osPriorityBelowNormal5    = 16+5,
+  osPriorityBelowNormal6    = 16+6,
+  osPriorityBelowNormal7    = 16+7,
+  osPriorityNormal          = 24,
+  osPriorityNormal1         = 24+1,
+  osPriorityNormal2         = 24+2,
+  osPriorityNormal3         = 24+3,
+  osPriorityNormal4         = 24+4,
+  osPriorityNormal5         = 24+5,
+  osPriorityNormal6         = 24+6,
+  osPriorityNormal7         = 24+7,
+  osPriorityAboveNormal     = 32,
+  osPriorityAboveNormal1    = 32+1,
+  osPriorityAboveNormal2    = 32+2,
+  osPriorityAboveNormal3    = 32+3,
+  osPriorityAboveNormal4    = 32+4,
+  osPriorityAboveNormal5    = 32+5,
+  osPriorityAboveNormal6    = 32+6,
+  osPriorityAboveNormal7    = 32+7,
+  osPriorityHigh            = 40,
+  osPriorityHigh1           = 40+1,
+  osPriorityHigh2           = 40+2,
+  osPriorityHigh3           = 40+3,
+  osPriorityHigh4           = 40+4,
+  osPriorityHigh5           = 40+5,
+  osPriorityHigh6           = 40+6,
+  osPriorityHigh7           = 40+7,
+  osPriorityRealtime        = 48,
+  osPriorityRealtime1       = 48+1,
+  osPriorityRealtime2       = 48+2,
+  osPriorityRealtime3       = 48+3,
+  osPriorityRealtime4       = 48+4,
+  osPriorityRealtime5       = 48+5,
+  osPriorityRealtime6       = 48+6,
+  osPriorityRealtime7       = 48+7,
+  osPriorityISR             = 56,
+  osPriorityError           = -1,
+  osPriorityReserved        = 0x7FFFFFFF
+} osPriority_t;
+
+/**
+ * @brief   Type of status codes.
+ */
+typedef enum {
+  osOK                      = 0,
+  osError                   = -1,
+  osErrorTimeout            = -2,
+  osErrorResource           = -3,
+  osErrorParameter          = -4,
+  osErrorNoMemory           = -5,
+  osErrorISR                = -6,
+  osStatusReserved          = 0x7FFFFFFF
+} osStatus_t;
+
+/**
+ * @brief   Type of thread functions.
+ */
+typedef void (*osThreadFunc_t)(void *argument);
+
+/**
+ * @name    Objects identifiers
+ * @{
+ */
+typedef void *osThreadId_t;
+typedef void *osMutexId_t;
+typedef void *osSemaphoreId_t;
+typedef void *osMessageQueueId_t;
+/** @} */
+
+/**
+ * @brief   Type of a thread attributes structure.
+ * @note    The thread structure is located in the working area so
+ *          @p cb_mem and @p cb_size are not used.
+ */
+typedef struct {
+  const char                *name;
+  uint32_t                  attr_bits;
+  void                      *cb_mem;
+  uint32_t                  cb_size;
+  void                      *stack_mem;
+  uint32_t                  stack_size;
+  osPriority_t              priority;
+  uint32_t                  tz_module;
+  uint32_t                  reserved;
+} osThreadAttr_t;
+
+/**
+ * @brief   Type of a mutex attributes structure.
+ */
+typedef struct {
+  const char                *name;
+  uint32_t                  attr_bits;
+  void                      *cb_mem;
+  uint32_t                  cb_size;
+} osMutexAttr_t;
+
+/**
+ * @brief   Type of a semaphore attributes structure.
+ */
+typedef struct {
+  const char                *name;
+  uint32_t                  attr_bits;
+  void                      *cb_mem;
+  uint32_t                  cb_size;
+} osSemaphoreAttr_t;
+
+/**
+ * @brief   Type of a message queue attributes structure.
+ */
+typedef struct {
+  const char                *name;
+  uint32_t                  attr_bits;
+  void                      *cb_mem;
+  uint32_t                  cb_size;
+  void                      *mq_mem;
+  uint32_t                  mq_size;
+} osMessageQueueAttr_t;
+
+/**
+ * @brief   Type of a mutex control block.
+ */
+typedef struct {
+  mutex_t                   mtx;
+  bool                      dynamic;
+} os_mutex_cb_t;
+
+/**
+ * @brief   Type of a semaphore control block.
+ */
+typedef struct {
+  semaphore_t               sem;
+  uint32_t                  max_count;
+  bool                      dynamic;
+} os_semaphore_cb_t;
+
+/**
+ * @brief   Type of a message queue control block.
+ */
+typedef struct {
+  objects_fifo_t            fifo;
+  uint32_t                  msg_count;
+  uint32_t                  msg_size;
+  void                      *mq_mem;
+  bool                      dynamic;
+  bool                      dynamic_mem;
+} os_message_queue_cb_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of a message queue buffer.
+ * @details Size to be specified in @p mq_size when the buffer is provided
+ *          statically, the buffer must be aligned to @p PORT_NATURAL_ALIGN.
+ *
+ * @param[in] msg_count             maximum number of messages in queue
+ * @param[in] msg_size              maximum message size in bytes
+ */
+#define osMessageQueueMemSize(msg_count, msg_size)                          \
+  ((uint32_t)(msg_count) *                                                  \
+   ((uint32_t)MEM_ALIGN_NEXT((msg_size), PORT_NATURAL_ALIGN) +              \
+    (uint32_t)sizeof (msg_t)))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  osStatus_t osKernelInitialize(void);
+  osKernelState_t osKernelGetState(void);
+  osStatus_t osKernelStart(void);
+  osThreadId_t osThreadNew(osThreadFunc_t func, void *argument,
+                           const osThreadAttr_t *attr);
+  osPriority_t osThreadGetPriority(osThreadId_t thread_id);
+  osStatus_t osDelay(uint32_t ticks);
+  osStatus_t osDelayUntil(uint32_t ticks);
+  osMutexId_t osMutexNew(const osMutexAttr_t *attr);
+  osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+  osStatus_t osMutexRelease(osMutexId_t mutex_id);
+  osThreadId_t osMutexGetOwner(osMutexId_t mutex_id);
+  osStatus_t osMutexDelete(osMutexId_t mutex_id);
+  osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count,
+                                 const osSemaphoreAttr_t *attr);
+  osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id,
+                                uint32_t timeout);
+  osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+  uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id);
+  osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id);
+  osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size,
+                                       const osMessageQueueAttr_t *attr);
+  osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr,
+                               uint8_t msg_prio, uint32_t timeout);
+  osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr,
+                               uint8_t *msg_prio, uint32_t timeout);
+  uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id);
+  uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id);
+  osStatus_t osMessageQueueDelete(osMessageQueueId_t mq_id);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the kernel tick count.
+ */
+static inline uint32_t osKernelGetTickCount(void) {
+
+  return (uint32_t)chVTGetSystemTimeX();
+}
+
+/**
+ * @brief   Returns the kernel tick frequency.
+ */
+static inline uint32_t osKernelGetTickFreq(void) {
+
+  return (uint32_t)CH_CFG_ST_FREQUENCY;
+}
+
+/**
+ * @brief   Returns the current thread.
+ */
+static inline osThreadId_t osThreadGetId(void) {
+
+  return (osThreadId_t)chThdGetSelfX();
+}
+
+/**
+ * @brief   Thread time slice yield.
+ */
+static inline osStatus_t osThreadYield(void) {
+
+  chThdYield();
+
+  return osOK;
+}
+
+/**
+ * @brief   Terminates the current thread.
+ */
+static inline void osThreadExit(void) {
+
+  chThdExit(MSG_OK);
+}
+
+/**
+ * @brief   Returns the capacity of a message queue.
+ */
+static inline uint32_t osMessageQueueGetCapacity(osMessageQueueId_t mq_id) {
+
+  return mq_id == NULL ? 0U : ((os_message_queue_cb_t *)mq_id)->msg_count;
+}
+
+/**
+ * @brief   Returns the maximum message size of a message queue.
+ */
+static inline uint32_t osMessageQueueGetMsgSize(osMessageQueueId_t mq_id) {
+
+  return mq_id == NULL ? 0U : ((os_message_queue_cb_t *)mq_id)->msg_size;
+}
+
+#endif /* CMSIS_OS2_H */
+
+/** @} */
@@ -33,10 +33,46 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @name    ChibiOS OSAL options
+ * @{
+ */
+/**
+ * @brief   Number of buckets of the names hash indexes.
+ * @details Queues, timers and semaphores are found by name using a hash
+ *          index, each object type has its own index.
+ * @note    It must be a power of two.
+ */
+#if !defined(OS_NAMES_HASH_SIZE) || defined(__DOXYGEN__)
+#define OS_NAMES_HASH_SIZE                  16
+#endif
+
+/**
+ * @brief   Maximum size of queue messages copied inside the critical zone.
+ * @details Messages up to this size are queued and dequeued in a single
+ *          critical zone, larger messages are copied outside the critical
+ *          zone and require two.
+ * @note    This value bounds the critical zone duration, zero disables
+ *          the single critical zone path.
+ */
+#if !defined(OS_QUEUE_LOCKED_COPY_SIZE) || defined(__DOXYGEN__)
+#define OS_QUEUE_LOCKED_COPY_SIZE           16
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (OS_NAMES_HASH_SIZE < 1) ||                                             \
+    ((OS_NAMES_HASH_SIZE & (OS_NAMES_HASH_SIZE - 1)) != 0)
+#error "OS_NAMES_HASH_SIZE must be a power of two"
+#endif
+
+#if OS_QUEUE_LOCKED_COPY_SIZE < 0
+#error "invalid OS_QUEUE_LOCKED_COPY_SIZE value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -66,6 +66,10 @@
 #error "NASA OSAL requires CH_CFG_USE_HEAP"
 #endif
 
+#if CH_CFG_USE_OBJ_FIFOS == FALSE
+#error "NASA OSAL requires CH_CFG_USE_OBJ_FIFOS"
+#endif
+
 /*===========================================================================*/
 /* Module local definitions.                                                 */
 /*===========================================================================*/
@@ -92,12 +96,34 @@
  */
 typedef void (*funcptr_t)(void);
 
+/**
+ * @brief   Type of a names hash index entry.
+ */
+typedef struct osal_name osal_name_t;
+
+/**
+ * @brief   Structure representing a names hash index entry.
+ */
+struct osal_name {
+  osal_name_t           *next;
+  uint32                hash;
+  uint32                id;
+  char                  name[OS_MAX_API_NAME];
+};
+
+/**
+ * @brief   Type of a names hash index.
+ */
+typedef struct {
+  osal_name_t           *buckets[OS_NAMES_HASH_SIZE];
+} osal_names_t;
+
 /**
  * @brief   Type of OSAL timer.
  */
 typedef struct {
   uint32                is_free;
-  char                  name[OS_MAX_API_NAME];
+  osal_name_t           name;
   OS_TimerCallback_t    callback_ptr;
   uint32                start_time;
   uint32                interval_time;
@@ -109,12 +135,9 @@ typedef struct {
  */
 typedef struct {
   uint32                is_free;
-  char                  name[OS_MAX_API_NAME];
-  semaphore_t           free_msgs;
-  memory_pool_t         messages;
-  mailbox_t             mb;
-  msg_t                 *mb_buffer;
-  void                  *q_buffer;
+  osal_name_t           name;
+  objects_fifo_t        fifo;
+  void                  *buffer;
   uint32                depth;
   uint32                size;
 } osal_queue_t;
@@ -145,6 +168,14 @@ typedef struct {
   binary_semaphore_t    binary_semaphores[OS_MAX_BIN_SEMAPHORES];
   semaphore_t           count_semaphores[OS_MAX_COUNT_SEMAPHORES];
   mutex_t               mutexes[OS_MAX_MUTEXES];
+  osal_name_t           binary_semaphores_names[OS_MAX_BIN_SEMAPHORES];
+  osal_name_t           count_semaphores_names[OS_MAX_COUNT_SEMAPHORES];
+  osal_name_t           mutexes_names[OS_MAX_MUTEXES];
+  osal_names_t          timers_index;
+  osal_names_t          queues_index;
+  osal_names_t          binary_semaphores_index;
+  osal_names_t          count_semaphores_index;
+  osal_names_t          mutexes_index;
 } osal_t;
 
 /*===========================================================================*/
@@ -195,53 +226,100 @@ static void timer_handler(virtual_timer_t *vtp, void *p) {
 }
 
 /**
- * @brief   Finds a queue by name.
+ * @brief   Copies an object name.
+ * @note    The name is truncated to @p OS_MAX_API_NAME - 1 characters and
+ *          always terminated.
  */
-uint32 queue_find(const char *queue_name) {
-  osal_queue_t *oqp;
+static void names_copy(char *dst, const char *src) {
+  size_t n = strnlen(src, OS_MAX_API_NAME - 1);
 
-  /* Searching the queue in the table.*/
-  for (oqp = &osal.queues[0]; oqp < &osal.queues[OS_MAX_QUEUES]; oqp++) {
-    /* Entering a reentrant critical zone.*/
-    syssts_t sts = chSysGetStatusAndLockX();
+  memcpy(dst, src, n);
+  dst[n] = '\0';
+}
 
-    if (!oqp->is_free &&
-        (strncmp(oqp->name, queue_name, OS_MAX_API_NAME - 1) == 0)) {
-      /* Leaving the critical zone.*/
-      chSysRestoreStatusX(sts);
-      return (uint32)oqp;
-    }
+/**
+ * @brief   Hash of an object name.
+ * @note    FNV-1a over the significant part of the name.
+ */
+static uint32 names_hash(const char *name) {
+  uint32 hash = 2166136261U;
+  unsigned i;
 
-    /* Leaving the critical zone.*/
-    chSysRestoreStatusX(sts);
+  for (i = 0U; (i < OS_MAX_API_NAME - 1U) && (name[i] != '\0'); i++) {
+    hash = (hash ^ (uint32)(uint8)name[i]) * 16777619U;
   }
 
-  return 0;
+  return hash;
 }
 
 /**
- * @brief   Finds a timer by name.
+ * @brief   Finds an object by name in a names index.
+ *
+ * @return                      The object id or zero if not found.
  */
-uint32 timer_find(const char *timer_name) {
-  osal_timer_t *otp;
+static uint32 names_find(osal_names_t *idxp, const char *name) {
+  uint32 hash = names_hash(name);
+  osal_name_t *np;
+  uint32 id = 0;
 
-  /* Searching the queue in the table.*/
-  for (otp = &osal.timers[0]; otp < &osal.timers[OS_MAX_TIMERS]; otp++) {
-    /* Entering a reentrant critical zone.*/
-    syssts_t sts = chSysGetStatusAndLockX();
-
-    if (!otp->is_free &&
-        (strncmp(otp->name, timer_name, OS_MAX_API_NAME - 1) == 0)) {
-      /* Leaving the critical zone.*/
-      chSysRestoreStatusX(sts);
-      return (uint32)otp;
+  /* Entering a reentrant critical zone.*/
+  syssts_t sts = chSysGetStatusAndLockX();
+
+  /* Only the entries in the bucket are compared, the full comparison is
+     done only on hash match.*/
+  np = idxp->buckets[hash & (OS_NAMES_HASH_SIZE - 1U)];
+  while (np != NULL) {
+    if ((np->hash == hash) &&
+        (strncmp(np->name, name, OS_MAX_API_NAME - 1) == 0)) {
+      id = np->id;
+      break;
     }
-
-    /* Leaving the critical zone.*/
-    chSysRestoreStatusX(sts);
+    np = np->next;
   }
 
-  return 0;
+  /* Leaving the critical zone.*/
+  chSysRestoreStatusX(sts);
+
+  return id;
+}
+
+/**
+ * @brief   Adds an object to a names index.
+ */
+static void names_add(osal_names_t *idxp, osal_name_t *np,
+                      const char *name, uint32 id) {
+  osal_name_t **bpp;
+
+  names_copy(np->name, name);
+  np->hash = names_hash(np->name);
+  np->id   = id;
+  bpp = &idxp->buckets[np->hash & (OS_NAMES_HASH_SIZE - 1U)];
+
+  /* Entering a reentrant critical zone.*/
+  syssts_t sts = chSysGetStatusAndLockX();
+
+  np->next = *bpp;
+  *bpp = np;
+
+  /* Leaving the critical zone.*/
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Removes an object from a names index.
+ *
+ * @iclass
+ */
+static void names_removeI(osal_names_t *idxp, osal_name_t *np) {
+  osal_name_t **npp = &idxp->buckets[np->hash & (OS_NAMES_HASH_SIZE - 1U)];
+
+  while (*npp != NULL) {
+    if (*npp == np) {
+      *npp = np->next;
+      break;
+    }
+    npp = &(*npp)->next;
+  }
 }
 
 /*===========================================================================*/
@@ -472,7 +550,7 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name,
   }
 
   /* Checking if the name is already taken.*/
-  if (timer_find(timer_name) > 0) {
+  if (names_find(&osal.timers_index, timer_name) > 0) {
     *timer_id = 0;
     return OS_ERR_NAME_TAKEN;
   }
@@ -484,12 +562,12 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name,
     return OS_ERR_NO_FREE_IDS;
   }
 
-  strncpy(otp->name, timer_name, OS_MAX_API_NAME - 1);
   chVTObjectInit(&otp->vt);
   otp->start_time    = 0;
   otp->interval_time = 0;
   otp->callback_ptr  = callback_ptr;
   otp->is_free       = 0;   /* Note, last.*/
+  names_add(&osal.timers_index, &otp->name, timer_name, (uint32)otp);
 
   *timer_id = (uint32)otp;
   *clock_accuracy = (uint32)(1000000 / CH_CFG_ST_FREQUENCY);
@@ -525,6 +603,9 @@ int32 OS_TimerDelete(uint32 timer_id) {
   otp->start_time    = 0;
   otp->interval_time = 0;
 
+  /* Removing the name from the index.*/
+  names_removeI(&osal.timers_index, &otp->name);
+
   /* Flagging it as unused and returning it to the pool.*/
   chPoolFreeI(&osal.timers_pool, (void *)otp);
 
@@ -595,7 +676,7 @@ int32 OS_TimerGetIdByName(uint32 *timer_id, const char *timer_name) {
   }
 
   /* Searching the queue.*/
-  *timer_id = timer_find(timer_name);
+  *timer_id = names_find(&osal.timers_index, timer_name);
   if (*timer_id > 0) {
     return OS_SUCCESS;
   }
@@ -639,7 +720,7 @@ int32 OS_TimerGetInfo(uint32 timer_id, OS_timer_prop_t *timer_prop) {
     return OS_ERR_INVALID_ID;
   }
 
-  strncpy(timer_prop->name, otp->name, OS_MAX_API_NAME - 1);
+  names_copy(timer_prop->name, otp->name.name);
   timer_prop->creator       = (uint32)0;
   timer_prop->start_time    = otp->start_time;
   timer_prop->interval_time = otp->interval_time;
@@ -684,7 +765,7 @@ int32 OS_QueueCreate(uint32 *queue_id, const char *queue_name,
   }
 
   /* Checking if the name is already taken.*/
-  if (queue_find(queue_name) > 0) {
+  if (names_find(&osal.queues_index, queue_name) > 0) {
     *queue_id = 0;
     return OS_ERR_NAME_TAKEN;
   }
@@ -703,35 +784,28 @@ int32 OS_QueueCreate(uint32 *queue_id, const char *queue_name,
     return OS_ERR_NO_FREE_IDS;
   }
 
-  /* Attempting messages buffer allocation.*/
+  /* Attempting buffer allocation, messages followed by the FIFO
+     mailbox buffer in a single heap block.*/
   msgsize = MEM_ALIGN_NEXT(data_size + sizeof (size_t), PORT_NATURAL_ALIGN);
-  oqp->mb_buffer = chHeapAllocAligned(NULL,
-                                      msgsize * (size_t)queue_depth,
-                                      PORT_NATURAL_ALIGN);
-  if (oqp->mb_buffer == NULL) {
-    *queue_id = 0;
-    return OS_ERROR;
-  }
-
-  /* Attempting queue buffer allocation.*/
-  oqp->q_buffer = chHeapAllocAligned(NULL,
-                                     sizeof (msg_t) * (size_t)queue_depth,
-                                     PORT_NATURAL_ALIGN);
-  if (oqp->q_buffer == NULL) {
+  oqp->buffer = chHeapAllocAligned(NULL,
+                                   (msgsize + sizeof (msg_t)) *
+                                   (size_t)queue_depth,
+                                   PORT_NATURAL_ALIGN);
+  if (oqp->buffer == NULL) {
+    chPoolFree(&osal.queues_pool, (void *)oqp);
     *queue_id = 0;
-    chHeapFree(oqp->mb_buffer);
     return OS_ERROR;
   }
 
   /* Initializing object static parts.*/
-  strncpy(oqp->name, queue_name, OS_MAX_API_NAME - 1);
-  chMBObjectInit(&oqp->mb, oqp->q_buffer, (size_t)queue_depth);
-  chSemObjectInit(&oqp->free_msgs, (cnt_t)queue_depth);
-  chPoolObjectInit(&oqp->messages, msgsize, NULL);
-  chPoolLoadArray(&oqp->messages, oqp->mb_buffer, (size_t)queue_depth);
+  chFifoObjectInitAligned(&oqp->fifo, msgsize, (size_t)queue_depth,
+                          PORT_NATURAL_ALIGN, oqp->buffer,
+                          (msg_t *)((uint8_t *)oqp->buffer +
+                                    (msgsize * (size_t)queue_depth)));
   oqp->depth   = queue_depth;
   oqp->size    = data_size;
   oqp->is_free = 0;   /* Note, last.*/
+  names_add(&osal.queues_index, &oqp->name, queue_name, (uint32)oqp);
   *queue_id = (uint32)oqp;
 
   return OS_SUCCESS;
@@ -747,7 +821,7 @@ int32 OS_QueueCreate(uint32 *queue_id, const char *queue_name,
  */
 int32 OS_QueueDelete(uint32 queue_id) {
   osal_queue_t *oqp = (osal_queue_t *)queue_id;
-  void *q_buffer, *mb_buffer;
+  void *buffer;
 
   /* Range check.*/
   if ((oqp < &osal.queues[0]) ||
@@ -762,13 +836,15 @@ int32 OS_QueueDelete(uint32 queue_id) {
   /* Marking as no more free, will be overwritten by the pool pointer.*/
   oqp->is_free = 1;
 
-  /* Pointers to areas to be freed.*/
-  q_buffer  = oqp->q_buffer;
-  mb_buffer = oqp->mb_buffer;
+  /* Pointer to the area to be freed.*/
+  buffer = oqp->buffer;
 
-  /* Resetting the queue.*/
-  chMBResetI(&oqp->mb);
-  chSemResetI(&oqp->free_msgs, 0);
+  /* Removing the name from the index.*/
+  names_removeI(&osal.queues_index, &oqp->name);
+
+  /* Resetting the queue, waiting threads are released with an error.*/
+  chMBResetI(&oqp->fifo.mbx);
+  chSemResetI(&oqp->fifo.free.sem, 0);
 
   /* Flagging it as unused and returning it to the pool.*/
   chPoolFreeI(&osal.queues_pool, (void *)oqp);
@@ -778,9 +854,8 @@ int32 OS_QueueDelete(uint32 queue_id) {
   /* Leaving critical zone.*/
   chSysUnlock();
 
-  /* Freeing buffers, outside critical zone, slow heap operation.*/
-  chHeapFree(q_buffer);
-  chHeapFree(mb_buffer);
+  /* Freeing buffer, outside critical zone, slow heap operation.*/
+  chHeapFree(buffer);
 
   return OS_SUCCESS;
 }
@@ -801,8 +876,9 @@ int32 OS_QueueDelete(uint32 queue_id) {
 int32 OS_QueueGet(uint32 queue_id, void *data, uint32 size,
                   uint32 *size_copied, int32 timeout) {
   osal_queue_t *oqp = (osal_queue_t *)queue_id;
-  msg_t msg, msgsts;
-  void *body;
+  osal_message_t *omsg;
+  sysinterval_t tmo;
+  msg_t msgsts;
 
   /* NULL pointer checks.*/
   if ((data == NULL) || (size_copied == NULL)) {
@@ -823,37 +899,49 @@ int32 OS_QueueGet(uint32 queue_id, void *data, uint32 size,
 
   /* Special time handling.*/
   if (timeout == OS_PEND) {
-    msgsts = chMBFetchTimeout(&oqp->mb, &msg, TIME_INFINITE);
-    if (msgsts < MSG_OK) {
-      *size_copied = 0;
-      return OS_ERROR;
-    }
+    tmo = TIME_INFINITE;
   }
   else if (timeout == OS_CHECK) {
-    msgsts = chMBFetchTimeout(&oqp->mb, &msg, TIME_IMMEDIATE);
-    if (msgsts < MSG_OK) {
-      *size_copied = 0;
-      return OS_QUEUE_EMPTY;
-    }
+    tmo = TIME_IMMEDIATE;
   }
   else {
-    msgsts = chMBFetchTimeout(&oqp->mb, &msg, (sysinterval_t)timeout);
-    if (msgsts < MSG_OK) {
-      *size_copied = 0;
-      return OS_QUEUE_TIMEOUT;
+    tmo = (sysinterval_t)timeout;
+  }
+
+  chSysLock();
+
+  /* Fetching the message, it is copied directly from the FIFO object into
+     the caller buffer.*/
+  msgsts = chFifoReceiveObjectTimeoutS(&oqp->fifo, (void **)&omsg, tmo);
+  if (msgsts < MSG_OK) {
+    chSysUnlock();
+    *size_copied = 0;
+    if (timeout == OS_PEND) {
+      return OS_ERROR;
     }
+    if (timeout == OS_CHECK) {
+      return OS_QUEUE_EMPTY;
+    }
+    return OS_QUEUE_TIMEOUT;
   }
+  *size_copied = (uint32)omsg->size;
 
-  /* Message body and size.*/
-  *size_copied = ((osal_message_t *)msg)->size;
-  body  = (void *)((osal_message_t *)msg)->buf;
+  /* Small messages are copied and the object returned without leaving the
+     critical zone.*/
+  if (omsg->size <= (size_t)OS_QUEUE_LOCKED_COPY_SIZE) {
+    memcpy(data, omsg->buf, omsg->size);
+    chFifoReturnObjectS(&oqp->fifo, (void *)omsg);
+    chSysUnlock();
+
+    return OS_SUCCESS;
+  }
+  chSysUnlock();
 
-  /* Copying the message body.*/
-  memcpy(data, body, *size_copied);
+  /* Copying the message body, the object is owned by this thread.*/
+  memcpy(data, omsg->buf, omsg->size);
 
-  /* Freeing the message buffer.*/
-  chPoolFree(&oqp->messages, (void *)msg);
-  chSemSignal(&oqp->free_msgs);
+  /* Returning the object to the FIFO.*/
+  chFifoReturnObject(&oqp->fifo, (void *)omsg);
 
   return OS_SUCCESS;
 }
@@ -871,7 +959,6 @@ int32 OS_QueueGet(uint32 queue_id, void *data, uint32 size,
  */
 int32 OS_QueuePut(uint32 queue_id, void *data, uint32 size, uint32 flags) {
   osal_queue_t *oqp = (osal_queue_t *)queue_id;
-  msg_t msgsts;
   osal_message_t *omsg;
 
   (void)flags;
@@ -893,22 +980,34 @@ int32 OS_QueuePut(uint32 queue_id, void *data, uint32 size, uint32 flags) {
     return OS_QUEUE_INVALID_SIZE;
   }
 
-  /* Getting a message buffer from the pool.*/
-  msgsts = chSemWait(&oqp->free_msgs);
-  if (msgsts < MSG_OK) {
+  chSysLock();
+
+  /* Getting a free object from the FIFO, NULL if the queue is deleted
+     while waiting.*/
+  omsg = (osal_message_t *)chFifoTakeObjectTimeoutS(&oqp->fifo,
+                                                    TIME_INFINITE);
+  if (omsg == NULL) {
+    chSysUnlock();
     return OS_ERROR;
   }
-  omsg = chPoolAlloc(&oqp->messages);
-
-  /* Filling message size and data.*/
   omsg->size = (size_t)size;
-  memcpy(omsg->buf, data, size);
 
-  /* Posting the message.*/
-  msgsts = chMBPostTimeout(&oqp->mb, (msg_t)omsg, TIME_INFINITE);
-  if (msgsts < MSG_OK) {
-    return OS_ERROR;
+  /* Small messages are copied and posted without leaving the critical
+     zone.*/
+  if (size <= (uint32)OS_QUEUE_LOCKED_COPY_SIZE) {
+    memcpy(omsg->buf, data, size);
+    chFifoSendObjectS(&oqp->fifo, (void *)omsg);
+    chSysUnlock();
+
+    return OS_SUCCESS;
   }
+  chSysUnlock();
+
+  /* Filling message data, the object is owned by this thread.*/
+  memcpy(omsg->buf, data, size);
+
+  /* Posting the message, by design it cannot fail.*/
+  chFifoSendObject(&oqp->fifo, (void *)omsg);
 
   return OS_SUCCESS;
 }
@@ -935,7 +1034,7 @@ int32 OS_QueueGetIdByName(uint32 *queue_id, const char *queue_name) {
   }
 
   /* Searching the queue.*/
-  *queue_id = queue_find(queue_name);
+  *queue_id = names_find(&osal.queues_index, queue_name);
   if (*queue_id > 0) {
     return OS_SUCCESS;
   }
@@ -979,7 +1078,7 @@ int32 OS_QueueGetInfo (uint32 queue_id, OS_queue_prop_t *queue_prop) {
     return OS_ERR_INVALID_ID;
   }
 
-  strncpy(queue_prop->name, oqp->name, OS_MAX_API_NAME - 1);
+  names_copy(queue_prop->name, oqp->name.name);
   queue_prop->creator = (uint32)0;
 
   /* Leaving the critical zone.*/
@@ -1019,6 +1118,11 @@ int32 OS_BinSemCreate(uint32 *sem_id, const char *sem_name,
     return OS_ERR_NAME_TOO_LONG;
   }
 
+  /* Checking if the name is already taken.*/
+  if (names_find(&osal.binary_semaphores_index, sem_name) > 0) {
+    return OS_ERR_NAME_TAKEN;
+  }
+
   /* Semaphore counter check, it is binary so only 0 and 1.*/
   if (sem_initial_value > 1) {
     return OS_INVALID_INT_NUM;
@@ -1032,6 +1136,9 @@ int32 OS_BinSemCreate(uint32 *sem_id, const char *sem_name,
 
   /* Semaphore is initialized.*/
   chBSemObjectInit(bsp, sem_initial_value == 0 ? true : false);
+  names_add(&osal.binary_semaphores_index,
+            &osal.binary_semaphores_names[bsp - &osal.binary_semaphores[0]],
+            sem_name, (uint32)bsp);
 
   *sem_id = (uint32)bsp;
 
@@ -1060,6 +1167,10 @@ int32 OS_BinSemDelete(uint32 sem_id) {
   /* Resetting the semaphore, no threads in queue.*/
   chBSemResetI(bsp, true);
 
+  /* Removing the name from the index.*/
+  names_removeI(&osal.binary_semaphores_index,
+                &osal.binary_semaphores_names[bsp - &osal.binary_semaphores[0]]);
+
   /* Flagging it as unused and returning it to the pool.*/
   bsp->sem.queue.prev = NULL;
   chPoolFreeI(&osal.binary_semaphores_pool, (void *)bsp);
@@ -1223,7 +1334,6 @@ int32 OS_BinSemTimedWait(uint32 sem_id, uint32 msecs) {
 
 /**
  * @brief   Retrieves a binary semaphore id by name.
- * @note    It is not currently implemented.
  *
  * @param[out] sem_id           pointer to a binary semaphore id variable
  * @param[in] sem_name          the binary semaphore name
@@ -1243,7 +1353,13 @@ int32 OS_BinSemGetIdByName(uint32 *sem_id, const char *sem_name) {
     return OS_ERR_NAME_TOO_LONG;
   }
 
-  return OS_ERR_NOT_IMPLEMENTED;
+  /* Searching the semaphore.*/
+  *sem_id = names_find(&osal.binary_semaphores_index, sem_name);
+  if (*sem_id > 0) {
+    return OS_SUCCESS;
+  }
+
+  return OS_ERR_NAME_NOT_FOUND;
 }
 
 /**
@@ -1317,6 +1433,11 @@ int32 OS_CountSemCreate(uint32 *sem_id, const char *sem_name,
     return OS_ERR_NAME_TOO_LONG;
   }
 
+  /* Checking if the name is already taken.*/
+  if (names_find(&osal.count_semaphores_index, sem_name) > 0) {
+    return OS_ERR_NAME_TAKEN;
+  }
+
   /* Semaphore counter check, it must be non-negative.*/
   if ((int32)sem_initial_value < 0) {
     return OS_INVALID_INT_NUM;
@@ -1330,6 +1451,9 @@ int32 OS_CountSemCreate(uint32 *sem_id, const char *sem_name,
 
   /* Semaphore is initialized.*/
   chSemObjectInit(sp, (cnt_t)sem_initial_value);
+  names_add(&osal.count_semaphores_index,
+            &osal.count_semaphores_names[sp - &osal.count_semaphores[0]],
+            sem_name, (uint32)sp);
 
   *sem_id = (uint32)sp;
 
@@ -1358,6 +1482,10 @@ int32 OS_CountSemDelete(uint32 sem_id) {
   /* Resetting the semaphore, no threads in queue.*/
   chSemResetI(sp, 0);
 
+  /* Removing the name from the index.*/
+  names_removeI(&osal.count_semaphores_index,
+                &osal.count_semaphores_names[sp - &osal.count_semaphores[0]]);
+
   /* Flagging it as unused and returning it to the pool.*/
   sp->queue.prev = NULL;
   chPoolFreeI(&osal.count_semaphores_pool, (void *)sp);
@@ -1480,7 +1608,6 @@ int32 OS_CountSemTimedWait(uint32 sem_id, uint32 msecs) {
 
 /**
  * @brief   Retrieves a counter semaphore id by name.
- * @note    It is not currently implemented.
  *
  * @param[out] sem_id           pointer to a counter semaphore id variable
  * @param[in] sem_name          the counter semaphore name
@@ -1500,7 +1627,13 @@ int32 OS_CountSemGetIdByName(uint32 *sem_id, const char *sem_name) {
     return OS_ERR_NAME_TOO_LONG;
   }
 
-  return OS_ERR_NOT_IMPLEMENTED;
+  /* Searching the semaphore.*/
+  *sem_id = names_find(&osal.count_semaphores_index, sem_name);
+  if (*sem_id > 0) {
+    return OS_SUCCESS;
+  }
+
+  return OS_ERR_NAME_NOT_FOUND;
 }
 
 /**
@@ -1572,6 +1705,11 @@ int32 OS_MutSemCreate(uint32 *sem_id, const char *sem_name, uint32 options) {
     return OS_ERR_NAME_TOO_LONG;
   }
 
+  /* Checking if the name is already taken.*/
+  if (names_find(&osal.mutexes_index, sem_name) > 0) {
+    return OS_ERR_NAME_TAKEN;
+  }
+
   /* Getting object.*/
   mp = chPoolAlloc(&osal.mutexes_pool);
   if (mp == NULL) {
@@ -1580,6 +1718,9 @@ int32 OS_MutSemCreate(uint32 *sem_id, const char *sem_name, uint32 options) {
 
   /* Semaphore is initialized.*/
   chMtxObjectInit(mp);
+  names_add(&osal.mutexes_index,
+            &osal.mutexes_names[mp - &osal.mutexes[0]],
+            sem_name, (uint32)mp);
 
   *sem_id = (uint32)mp;
 
@@ -1608,6 +1749,10 @@ int32 OS_MutSemDelete(uint32 sem_id) {
   /* Resetting the mutex, no threads in queue.*/
   chMtxUnlockAllS();
 
+  /* Removing the name from the index.*/
+  names_removeI(&osal.mutexes_index,
+                &osal.mutexes_names[mp - &osal.mutexes[0]]);
+
   /* Flagging it as unused and returning it to the pool.*/
   mp->queue.prev = NULL;
   chPoolFreeI(&osal.mutexes_pool, (void *)mp);
@@ -1687,7 +1832,6 @@ int32 OS_MutSemTake(uint32 sem_id) {
 
 /**
  * @brief   Retrieves a mutex id by name.
- * @note    It is not currently implemented.
  *
  * @param[out] sem_id           pointer to a mutex id variable
  * @param[in] sem_name          the mutex name
@@ -1707,7 +1851,13 @@ int32 OS_MutSemGetIdByName(uint32 *sem_id, const char *sem_name) {
     return OS_ERR_NAME_TOO_LONG;
   }
 
-  return OS_ERR_NOT_IMPLEMENTED;
+  /* Searching the semaphore.*/
+  *sem_id = names_find(&osal.mutexes_index, sem_name);
+  if (*sem_id > 0) {
+    return OS_SUCCESS;
+  }
+
+  return OS_ERR_NAME_NOT_FOUND;
 }
 
 /**
@@ -2137,7 +2287,7 @@ int32 OS_TaskGetInfo(uint32 task_id, OS_task_prop_t *task_prop) {
     return OS_ERR_INVALID_ID;
   }
 
-  strncpy(task_prop->name, tp->name, OS_MAX_API_NAME - 1);
+  names_copy(task_prop->name, tp->name);
   task_prop->creator    = (uint32)chSysGetIdleThreadX();
   task_prop->stack_size = (uint32)MEM_ALIGN_NEXT(wasize, PORT_STACK_ALIGN);
   task_prop->priority   = (uint32)256U - (uint32)tp->realprio;
@@ -2181,23 +2331,44 @@ int32 OS_IntUnlock(int32 IntLevel) {
 
 int32 OS_IntEnable(int32 Level) {
 
+#if !defined(SIMULATOR)
   NVIC_EnableIRQ((IRQn_Type)Level);
 
   return OS_SUCCESS;
+#else
+  /* No interrupt controller in the simulator.*/
+  (void)Level;
+
+  return OS_ERR_NOT_IMPLEMENTED;
+#endif
 }
 
 int32 OS_IntDisable(int32 Level) {
 
+#if !defined(SIMULATOR)
   NVIC_DisableIRQ((IRQn_Type)Level);
 
   return OS_SUCCESS;
+#else
+  /* No interrupt controller in the simulator.*/
+  (void)Level;
+
+  return OS_ERR_NOT_IMPLEMENTED;
+#endif
 }
 
 int32 OS_IntAck(int32 InterruptNumber) {
 
+#if !defined(SIMULATOR)
   NVIC_ClearPendingIRQ((IRQn_Type)InterruptNumber);
 
   return OS_SUCCESS;
+#else
+  /* No interrupt controller in the simulator.*/
+  (void)InterruptNumber;
+
+  return OS_ERR_NOT_IMPLEMENTED;
+#endif
 }
 
 /*-- System Exception API ---------------------------------------------------*/
@@ -58,6 +58,13 @@
  * @note    It is the alignment to be enforced for thread working areas.
  */
 #define PORT_WORKING_AREA_ALIGN         sizeof (stkalign_t)
+
+/**
+ * @brief   Number of MPU regions switched on context switch.
+ * @note    There is no MPU in the simulator, sandbox regions protection is
+ *          emulated by the sandbox host.
+ */
+#define PORT_SWITCHED_REGIONS_NUMBER    0
 /** @} */
 
 /**
@@ -113,6 +120,16 @@
 #define PORT_INT_REQUIRED_STACK         16384
 #endif
 
+/**
+ * @brief   Enables the emulated syscall support.
+ * @details Syscalls are plain function calls in the simulator, this option
+ *          adds the per-thread syscall context and the registers frame used
+ *          by the sandbox host handlers.
+ */
+#if !defined(PORT_USE_SYSCALL) || defined(__DOXYGEN__)
+#define PORT_USE_SYSCALL                FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -147,6 +164,12 @@ typedef void *regx86;
  *          preemption-capable interrupt handler.
  */
 struct port_extctx {
+#if (PORT_USE_SYSCALL == TRUE) || defined(__DOXYGEN__)
+  uint32_t      r0;
+  uint32_t      r1;
+  uint32_t      r2;
+  uint32_t      r3;
+#endif
 };
 
 /**
@@ -169,6 +192,11 @@ struct port_intctx {
  */
 struct port_context {
   struct port_intctx *sp;
+#if (PORT_USE_SYSCALL == TRUE) || defined(__DOXYGEN__)
+  struct {
+    const void          *p;
+  } syscall;
+#endif
 };
 
 #endif /* !defined(_FROM_ASM_) */
@@ -189,6 +217,13 @@ struct port_context {
 #define AALIGN(p, mask, mod)                                                \
   p = (void *)((((uint32_t)(p) - (uint32_t)(mod)) & ~(uint32_t)(mask)) + (uint32_t)(mod))
 
+#if (PORT_USE_SYSCALL == TRUE) || defined(__DOXYGEN__)
+  #define __PORT_SETUP_CONTEXT_SYSCALL(tp)                                  \
+    (tp)->ctx.syscall.p = NULL;
+#else
+  #define __PORT_SETUP_CONTEXT_SYSCALL(tp)
+#endif
+
 /**
  * @brief   Platform dependent part of the @p chThdCreateI() API.
  * @details This code usually setup the context switching frame represented
@@ -210,6 +245,7 @@ struct port_context {
   ((struct port_intctx *)(void *)esp)->esi = NULL;                          \
   ((struct port_intctx *)(void *)esp)->ebp = (void *)savebp;                \
   (tp)->ctx.sp = (struct port_intctx *)(void *)esp;                         \
+  __PORT_SETUP_CONTEXT_SYSCALL(tp);                                         \
   /*lint -restore*/                                                         \
 }
 
@@ -202,6 +202,174 @@ static msg_t acc_read_cooked(void *ip, float axes[]) {
   return msg;
 }
 
+/**
+ * @brief   Drains the accelerometer FIFO.
+ * @details The FIFO level is read then all the available samples, up to
+ *          @p *np, are fetched from the FIFO_DATA register whose address is
+ *          not incremented during multi-byte reads. Samples are fetched in
+ *          bursts of @p ADXL355_FIFO_BURST_SAMPLES within a single bus
+ *          ownership.
+ * @note    If the FIFO is found not aligned on an X-axis entry then the
+ *          alignment is recovered discarding entries and @p MSG_RESET is
+ *          returned, the samples read before are valid.
+ * @note    The buffer is filled with the big endian samples as they come
+ *          from the device.
+ *
+ * @param[in] devp      pointer to @p ADXL355Driver interface.
+ * @param[out] buff     buffer receiving the samples.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if the FIFO was not aligned or if FIFO access is not
+ *                      supported on the configured bus, I2C.
+ */
+static msg_t acc_read_fifo(ADXL355Driver *devp, uint8_t *buff, size_t *np) {
+  size_t i;
+  msg_t msg = MSG_OK;
+
+#if ADXL355_USE_SPI
+  uint8_t entries, *bp;
+  size_t n, k, chunk;
+
+#if	ADXL355_SHARED_SPI
+  osalDbgAssert((devp->config->spip->state == SPI_READY),
+                "acc_read_fifo(), channel not ready");
+
+  spiAcquireBus(devp->config->spip);
+  spiStart(devp->config->spip,
+           devp->config->spicfg);
+#endif /* ADXL355_SHARED_SPI */
+
+  adxl355SPIReadRegister(devp, ADXL355_AD_FIFO_ENTRIES, 1, &entries);
+  n = (size_t)(entries & ADXL355_FIFO_ENTRIES_MASK) /
+      ADXL355_ACC_NUMBER_OF_AXES;
+  if(n > *np)
+    n = *np;
+
+  for(i = 0U; i < n; i += chunk) {
+    chunk = n - i;
+    if(chunk > ADXL355_FIFO_BURST_SAMPLES)
+      chunk = ADXL355_FIFO_BURST_SAMPLES;
+    bp = &buff[i * ADXL355_ACC_NUMBER_OF_AXES * 3];
+    adxl355SPIReadRegister(devp, ADXL355_AD_FIFO_DATA,
+                           chunk * ADXL355_ACC_NUMBER_OF_AXES * 3, bp);
+
+    if((bp[2] & ADXL355_FIFO_DATA_X_MARKER) == 0U) {
+      /* Out of phase, the next X-axis entry is as far from the FIFO head
+         as the first X-axis entry found in this sample, skipping it.*/
+      for(k = 1U; k < ADXL355_ACC_NUMBER_OF_AXES; k++) {
+        if((bp[k * 3 + 2] & ADXL355_FIFO_DATA_X_MARKER) != 0U)
+          break;
+      }
+      if(k < ADXL355_ACC_NUMBER_OF_AXES)
+        adxl355SPIReadRegister(devp, ADXL355_AD_FIFO_DATA, k * 3, bp);
+      msg = MSG_RESET;
+      break;
+    }
+  }
+
+#if	ADXL355_SHARED_SPI
+  spiReleaseBus(devp->config->spip);
+#endif /* ADXL355_SHARED_SPI */
+#else /* !ADXL355_USE_SPI */
+  /* FIFO burst reads are only implemented on SPI.*/
+  (void)devp;
+  (void)buff;
+  i   = 0U;
+  msg = MSG_RESET;
+#endif /* ADXL355_USE_SPI */
+
+  *np = i;
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of raw data from the BaseAccelerometer FIFO.
+ * @note    The samples are fetched into the output buffer and then expanded
+ *          in place, starting from the last one.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with raw data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if the FIFO was not aligned.
+ */
+static msg_t acc_read_raw_batch(void *ip, int32_t axes[], size_t *np) {
+  ADXL355Driver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int32_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(ADXL355Driver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == ADXL355_READY),
+                "acc_read_raw_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * ADXL355_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = (bp[3 * (i - 1)] << 12) | (bp[3 * (i - 1) + 1] << 4) |
+          (bp[3 * (i - 1) + 2] >> 4);
+    if(tmp & 0x80000) {
+      tmp |= 0xFFF00000U;
+    }
+    axes[i - 1] = tmp;
+  }
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of cooked data from the BaseAccelerometer FIFO.
+ * @note    This data is manipulated according to the formula
+ *          cooked = (raw * sensitivity) - bias.
+ * @note    Final data is expressed as milli-G.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with cooked data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if the FIFO was not aligned.
+ */
+static msg_t acc_read_cooked_batch(void *ip, float axes[], size_t *np) {
+  ADXL355Driver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int32_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(ADXL355Driver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == ADXL355_READY),
+                "acc_read_cooked_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * ADXL355_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = (bp[3 * (i - 1)] << 12) | (bp[3 * (i - 1) + 1] << 4) |
+          (bp[3 * (i - 1) + 2] >> 4);
+    if(tmp & 0x80000) {
+      tmp |= 0xFFF00000U;
+    }
+    axes[i - 1] = (float)tmp;
+  }
+  sensorCookBatch(axes, *np, ADXL355_ACC_NUMBER_OF_AXES,
+                  devp->accsensitivity, devp->accbias);
+  return msg;
+}
+
 /**
  * @brief   Set bias values for the BaseAccelerometer.
  * @note    Bias must be expressed as milli-G.
@@ -427,6 +595,7 @@ static const struct ADXL355VMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct ADXL355VMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+  acc_read_raw_batch, acc_read_cooked_batch,
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
@@ -43,7 +43,7 @@
 /**
  * @brief   ADXL355 driver version string.
  */
-#define EX_ADXL355_VERSION                  "1.0.0"
+#define EX_ADXL355_VERSION                  "1.1.0"
 
 /**
  * @brief   ADXL355 driver version major number.
@@ -53,7 +53,7 @@
 /**
  * @brief   ADXL355 driver version minor number.
  */
-#define EX_ADXL355_MINOR                    0
+#define EX_ADXL355_MINOR                    1
 
 /**
  * @brief   ADXL355 driver version patch number.
@@ -80,6 +80,8 @@
 #define ADXL355_ACC_SENS_8G                 0.015625f
 
 #define ADXL355_ACC_BIAS                    0.0f
+
+#define ADXL355_ACC_FIFO_DEPTH              32U
 /** @} */
 
 /**
@@ -171,6 +173,21 @@
 #define ADXL355_FIFO_SAMPLES_BIT_6          (1 << 6)
 /** @} */
 
+/**
+ * @name    ADXL355_FIFO_ENTRIES register bits definitions
+ * @{
+ */
+#define ADXL355_FIFO_ENTRIES_MASK           0x7F
+/** @} */
+
+/**
+ * @name    ADXL355_FIFO_DATA entries bits definitions
+ * @{
+ */
+#define ADXL355_FIFO_DATA_X_MARKER          (1 << 0)
+#define ADXL355_FIFO_DATA_EMPTY             (1 << 1)
+/** @} */
+
 /**
  * @name    ADXL355_INT_MAP register bits definitions
  * @{
@@ -295,6 +312,18 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+/**
+ * @brief   Maximum number of FIFO samples fetched by a single SPI burst.
+ * @note    A value of @p ADXL355_COMM_BUFF_SIZE of 289 allows to drain the
+ *          whole FIFO with a single burst.
+ */
+#define ADXL355_FIFO_BURST_SAMPLES                                          \
+  (ADXL355_COMM_BUFF_SIZE / (ADXL355_ACC_NUMBER_OF_AXES * 3U))
+
+#if ADXL355_FIFO_BURST_SAMPLES < 1
+#error "ADXL355_COMM_BUFF_SIZE too small"
+#endif
+
 #if !(ADXL355_USE_SPI ^ ADXL355_USE_I2C)
 #error "ADXL355_USE_SPI and ADXL355_USE_I2C cannot be both true or both false"
 #endif
@@ -693,17 +693,20 @@ static msg_t thermo_reset_sensivity(void *ip) {
 }
 
 static const struct BaseSensorVMT vmt_basesensor = {
-  sens_get_axes_number, sens_read_raw, sens_read_cooked
+  sens_get_axes_number, sens_read_raw, sens_read_cooked,
+  NULL, NULL
 };
 
 static const struct BaseBarometerVMT vmt_basebarometer = {
   baro_get_axes_number, baro_read_raw, baro_read_cooked,
+  NULL, NULL,
   baro_set_bias, baro_reset_bias,
   baro_set_sensivity, baro_reset_sensivity
 };
 
 static const struct BaseThermometerVMT vmt_basethermometer = {
   thermo_get_axes_number, thermo_read_raw, thermo_read_cooked,
+  NULL, NULL,
   thermo_set_bias, thermo_reset_bias,
   thermo_set_sensivity, thermo_reset_sensivity
 };
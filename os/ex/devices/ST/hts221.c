@@ -597,6 +597,7 @@ static const struct HTS221VMT vmt_device = {
 static const struct BaseHygrometerVMT vmt_hygrometer = {
   sizeof(struct HTS221VMT*),
   hygro_get_axes_number, hygro_read_raw, hygro_read_cooked,
+  NULL, NULL,
   hygro_set_bias, hygro_reset_bias, hygro_set_sensitivity,
   hygro_reset_sensitivity
 };
@@ -604,6 +605,7 @@ static const struct BaseHygrometerVMT vmt_hygrometer = {
 static const struct BaseThermometerVMT vmt_thermometer = {
   sizeof(struct HTS221VMT*) + sizeof(BaseHygrometer),
   thermo_get_axes_number, thermo_read_raw, thermo_read_cooked,
+  NULL, NULL,
   thermo_set_bias, thermo_reset_bias, thermo_set_sensitivity,
   thermo_reset_sensitivity
 };
@@ -455,6 +455,7 @@ static const struct L3GD20VMT vmt_device = {
 static const struct BaseGyroscopeVMT vmt_gyroscope = {
   sizeof(struct L3GD20VMT*),
   gyro_get_axes_number, gyro_read_raw, gyro_read_cooked,
+  NULL, NULL,
   gyro_sample_bias, gyro_set_bias, gyro_reset_bias,
   gyro_set_sensivity, gyro_reset_sensivity
 };
@@ -408,6 +408,7 @@ static const struct LIS302DLVMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct LIS302DLVMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+  NULL, NULL,
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
@@ -194,6 +194,148 @@ static msg_t acc_read_cooked(void *ip, float axes[]) {
   return msg;
 }
 
+#if LIS3DSH_USE_FIFO || defined(__DOXYGEN__)
+/**
+ * @brief   Drains the accelerometer FIFO.
+ * @details The FIFO level is read then all the available samples, up to
+ *          @p *np, are fetched with a single burst. The output registers
+ *          address rolls back from OUT_Z_H to OUT_X_L while the FIFO is
+ *          enabled so consecutive samples are returned back to back.
+ * @note    The buffer is filled with the little endian samples as they come
+ *          from the device.
+ *
+ * @param[in] devp      pointer to @p LIS3DSHDriver interface.
+ * @param[out] buff     buffer receiving the samples.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if FIFO access is not supported on the configured
+ *                      bus, I2C.
+ */
+static msg_t acc_read_fifo(LIS3DSHDriver *devp, uint8_t *buff, size_t *np) {
+  size_t n = 0U;
+  msg_t msg = MSG_OK;
+
+#if LIS3DSH_USE_SPI
+  uint8_t src;
+
+#if	LIS3DSH_SHARED_SPI
+  osalDbgAssert((devp->config->spip->state == SPI_READY),
+                "acc_read_fifo(), channel not ready");
+
+  spiAcquireBus(devp->config->spip);
+  spiStart(devp->config->spip,
+           devp->config->spicfg);
+#endif /* LIS3DSH_SHARED_SPI */
+
+  lis3dshSPIReadRegister(devp->config->spip, LIS3DSH_AD_FIFO_SRC, 1, &src);
+
+  if((src & LIS3DSH_FIFO_SRC_EMPTY) != 0U)
+    n = 0U;
+  else if((src & LIS3DSH_FIFO_SRC_OVRN_FIFO) != 0U)
+    n = LIS3DSH_ACC_FIFO_DEPTH;
+  else
+    n = (size_t)(src & LIS3DSH_FIFO_SRC_FSS_MASK);
+  if(n > *np)
+    n = *np;
+
+  if(n > 0U) {
+    lis3dshSPIReadRegister(devp->config->spip, LIS3DSH_AD_OUT_X_L,
+                           n * LIS3DSH_ACC_NUMBER_OF_AXES * 2, buff);
+  }
+
+#if	LIS3DSH_SHARED_SPI
+  spiReleaseBus(devp->config->spip);
+#endif /* LIS3DSH_SHARED_SPI */
+#else /* !LIS3DSH_USE_SPI */
+  /* FIFO burst reads are only implemented on SPI.*/
+  (void)devp;
+  (void)buff;
+  msg = MSG_RESET;
+#endif /* LIS3DSH_USE_SPI */
+
+  *np = n;
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of raw data from the BaseAccelerometer FIFO.
+ * @note    The samples are fetched into the output buffer and then expanded
+ *          in place, starting from the last one.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with raw data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ */
+static msg_t acc_read_raw_batch(void *ip, int32_t axes[], size_t *np) {
+  LIS3DSHDriver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int16_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(LIS3DSHDriver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == LIS3DSH_READY),
+                "acc_read_raw_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * LIS3DSH_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = bp[2 * (i - 1)] + (bp[2 * (i - 1) + 1] << 8);
+    axes[i - 1] = (int32_t)tmp;
+  }
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of cooked data from the BaseAccelerometer FIFO.
+ * @note    This data is manipulated according to the formula
+ *          cooked = (raw * sensitivity) - bias.
+ * @note    Final data is expressed as milli-G.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with cooked data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ */
+static msg_t acc_read_cooked_batch(void *ip, float axes[], size_t *np) {
+  LIS3DSHDriver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int16_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(LIS3DSHDriver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == LIS3DSH_READY),
+                "acc_read_cooked_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * LIS3DSH_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = bp[2 * (i - 1)] + (bp[2 * (i - 1) + 1] << 8);
+    axes[i - 1] = (float)tmp;
+  }
+  sensorCookBatch(axes, *np, LIS3DSH_ACC_NUMBER_OF_AXES,
+                  devp->accsensitivity, devp->accbias);
+  return msg;
+}
+#endif /* LIS3DSH_USE_FIFO */
+
 /**
  * @brief   Set bias values for the BaseAccelerometer.
  * @note    Bias must be expressed as milli-G.
@@ -431,6 +573,11 @@ static const struct LIS3DSHVMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct LIS3DSHVMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+#if LIS3DSH_USE_FIFO
+  acc_read_raw_batch, acc_read_cooked_batch,
+#else
+  NULL, NULL,
+#endif
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
@@ -523,6 +670,9 @@ void lis3dshStart(LIS3DSHDriver *devp, const LIS3DSHConfig *config) {
     cr = LIS3DSH_CTRL_REG6_ADD_INC;
 #if LIS3DSH_USE_ADVANCED || defined(__DOXYGEN__)
     cr |= devp->config->accblockdataupdate;
+#endif
+#if LIS3DSH_USE_FIFO || defined(__DOXYGEN__)
+    cr |= LIS3DSH_CTRL_REG6_FIFO_EN;
 #endif
   }
 
@@ -534,6 +684,12 @@ void lis3dshStart(LIS3DSHDriver *devp, const LIS3DSHConfig *config) {
 
   lis3dshSPIWriteRegister(devp->config->spip, LIS3DSH_AD_CTRL_REG6, 1, &cr);
 
+#if LIS3DSH_USE_FIFO || defined(__DOXYGEN__)
+  /* FIFO in stream mode, the oldest samples are discarded on overrun.*/
+  cr = LIS3DSH_FIFO_CTRL_FMODE_STREAM;
+  lis3dshSPIWriteRegister(devp->config->spip, LIS3DSH_AD_FIFO_CTRL, 1, &cr);
+#endif
+
 #if	LIS3DSH_SHARED_SPI
   spiReleaseBus(devp->config->spip);
 #endif /* LIS3DSH_SHARED_SPI */
@@ -43,7 +43,7 @@
 /**
  * @brief   LIS3DSH driver version string.
  */
-#define EX_LIS3DSH_VERSION                  "1.1.2"
+#define EX_LIS3DSH_VERSION                  "1.2.0"
 
 /**
  * @brief   LIS3DSH driver version major number.
@@ -53,12 +53,12 @@
 /**
  * @brief   LIS3DSH driver version minor number.
  */
-#define EX_LIS3DSH_MINOR                    1
+#define EX_LIS3DSH_MINOR                    2
 
 /**
  * @brief   LIS3DSH driver version patch number.
  */
-#define EX_LIS3DSH_PATCH                    2
+#define EX_LIS3DSH_PATCH                    0
 /** @} */
 
 /**
@@ -84,6 +84,8 @@
 #define LIS3DSH_ACC_SENS_16G                0.73f
 
 #define LIS3DSH_ACC_BIAS                    0.0f
+
+#define LIS3DSH_ACC_FIFO_DEPTH              32U
 /** @} */
 
 /**
@@ -286,6 +288,29 @@
 #define LIS3DSH_CTRL_REG6_BOOT              (1 << 7)
 /** @} */
 
+/**
+ * @name    LIS3DSH_FIFO_CTRL register bits definitions
+ * @{
+ */
+#define LIS3DSH_FIFO_CTRL_MASK              0xFF
+#define LIS3DSH_FIFO_CTRL_WTMP_MASK         0x1F
+#define LIS3DSH_FIFO_CTRL_FMODE_MASK        0xE0
+#define LIS3DSH_FIFO_CTRL_FMODE_BYPASS      (0 << 5)
+#define LIS3DSH_FIFO_CTRL_FMODE_FIFO        (1 << 5)
+#define LIS3DSH_FIFO_CTRL_FMODE_STREAM      (2 << 5)
+/** @} */
+
+/**
+ * @name    LIS3DSH_FIFO_SRC register bits definitions
+ * @{
+ */
+#define LIS3DSH_FIFO_SRC_MASK               0xFF
+#define LIS3DSH_FIFO_SRC_FSS_MASK           0x1F
+#define LIS3DSH_FIFO_SRC_EMPTY              (1 << 5)
+#define LIS3DSH_FIFO_SRC_OVRN_FIFO          (1 << 6)
+#define LIS3DSH_FIFO_SRC_WTM                (1 << 7)
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -340,6 +365,18 @@
 #if !defined(LIS3DSH_USE_ADVANCED) || defined(__DOXYGEN__)
 #define LIS3DSH_USE_ADVANCED                FALSE
 #endif
+
+/**
+ * @brief   LIS3DSH FIFO switch.
+ * @details If set to @p TRUE the device FIFO is enabled in stream mode and
+ *          the batch read methods of the BaseAccelerometer are available.
+ * @note    With the FIFO enabled the single read methods return the oldest
+ *          sample stored in the FIFO.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(LIS3DSH_USE_FIFO) || defined(__DOXYGEN__)
+#define LIS3DSH_USE_FIFO                    FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
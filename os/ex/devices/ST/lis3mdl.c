@@ -429,6 +429,7 @@ static const struct LIS3MDLVMT vmt_device = {
 static const struct BaseCompassVMT vmt_compass = {
   sizeof(struct LIS3MDLVMT*),
   comp_get_axes_number, comp_read_raw, comp_read_cooked,
+  NULL, NULL,
   comp_set_bias, comp_reset_bias, comp_set_sensivity, comp_reset_sensivity
 };
 
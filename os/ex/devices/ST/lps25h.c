@@ -525,6 +525,7 @@ static const struct LPS25HVMT vmt_device = {
 static const struct BaseBarometerVMT vmt_barometer = {
   sizeof(struct LPS25HVMT*),
   baro_get_axes_number, baro_read_raw, baro_read_cooked,
+  NULL, NULL,
   baro_set_bias, baro_reset_bias, baro_set_sensitivity,
   baro_reset_sensitivity
 };
@@ -532,6 +533,7 @@ static const struct BaseBarometerVMT vmt_barometer = {
 static const struct BaseThermometerVMT vmt_thermometer = {
   sizeof(struct LPS25HVMT*) + sizeof(BaseBarometer),
   thermo_get_axes_number, thermo_read_raw, thermo_read_cooked,
+  NULL, NULL,
   thermo_set_bias, thermo_reset_bias, thermo_set_sensitivity,
   thermo_reset_sensitivity
 };
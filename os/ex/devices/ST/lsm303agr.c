@@ -667,12 +667,14 @@ static const struct LSM303AGRVMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct LSM303AGRVMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+  NULL, NULL,
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
 static const struct BaseCompassVMT vmt_compass = {
   sizeof(struct LSM303AGRVMT*) + sizeof(BaseAccelerometer),
   comp_get_axes_number, comp_read_raw, comp_read_cooked,
+  NULL, NULL,
   comp_set_bias, comp_reset_bias, comp_set_sensivity, comp_reset_sensivity
 };
 
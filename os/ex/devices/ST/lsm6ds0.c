@@ -191,6 +191,159 @@ static msg_t acc_read_cooked(void *ip, float axes[]) {
   return msg;
 }
 
+#if LSM6DS0_USE_FIFO || defined(__DOXYGEN__)
+/**
+ * @brief   Drains the accelerometer FIFO.
+ * @details The FIFO level is read then all the available samples, up to
+ *          @p *np, are fetched with a single burst. The output registers
+ *          address rolls back from OUT_Z_H_XL to OUT_X_L_XL while the FIFO
+ *          is enabled so consecutive samples are returned back to back.
+ * @note    The FIFO slots contain both the gyroscope and accelerometer
+ *          data, the gyroscope part of the drained slots is discarded.
+ * @note    The buffer is filled with the little endian samples as they come
+ *          from the device.
+ *
+ * @param[in] devp      pointer to @p LSM6DS0Driver interface.
+ * @param[out] buff     buffer receiving the samples.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ *                      FIFO access is not supported on SPI and the
+ *                      function returns @p MSG_RESET without samples.
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ */
+static msg_t acc_read_fifo(LSM6DS0Driver *devp, uint8_t *buff, size_t *np) {
+  size_t n = 0U;
+  msg_t msg;
+
+#if LSM6DS0_USE_I2C
+  uint8_t src;
+
+  osalDbgAssert((devp->config->i2cp->state == I2C_READY),
+                "acc_read_fifo(), channel not ready");
+
+#if LSM6DS0_SHARED_I2C
+  i2cAcquireBus(devp->config->i2cp);
+  i2cStart(devp->config->i2cp,
+           devp->config->i2ccfg);
+#endif /* LSM6DS0_SHARED_I2C */
+
+  msg = lsm6ds0I2CReadRegister(devp->config->i2cp, devp->config->slaveaddress,
+                               LSM6DS0_AD_FIFO_SRC, &src, 1);
+  if(msg == MSG_OK) {
+    n = (size_t)(src & LSM6DS0_FIFO_SRC_FSS_MASK);
+    if(n > *np)
+      n = *np;
+    if(n > 0U) {
+      msg = lsm6ds0I2CReadRegister(devp->config->i2cp,
+                                   devp->config->slaveaddress,
+                                   LSM6DS0_AD_OUT_X_L_XL, buff,
+                                   n * LSM6DS0_ACC_NUMBER_OF_AXES * 2);
+      if(msg != MSG_OK)
+        n = 0U;
+    }
+  }
+
+#if LSM6DS0_SHARED_I2C
+  i2cReleaseBus(devp->config->i2cp);
+#endif /* LSM6DS0_SHARED_I2C */
+#else /* !LSM6DS0_USE_I2C */
+  /* FIFO burst reads are only implemented on I2C.*/
+  (void)devp;
+  (void)buff;
+  msg = MSG_RESET;
+#endif /* LSM6DS0_USE_I2C */
+
+  *np = n;
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of raw data from the BaseAccelerometer FIFO.
+ * @note    The samples are fetched into the output buffer and then expanded
+ *          in place, starting from the last one.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with raw data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ */
+static msg_t acc_read_raw_batch(void *ip, int32_t axes[], size_t *np) {
+  LSM6DS0Driver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int16_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(LSM6DS0Driver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == LSM6DS0_READY),
+                "acc_read_raw_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * LSM6DS0_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = bp[2 * (i - 1)] + (bp[2 * (i - 1) + 1] << 8);
+    axes[i - 1] = (int32_t)tmp;
+  }
+  return msg;
+}
+
+/**
+ * @brief   Retrieves a batch of cooked data from the BaseAccelerometer FIFO.
+ * @note    This data is manipulated according to the formula
+ *          cooked = (raw * sensitivity) - bias.
+ * @note    Final data is expressed as milli-G.
+ *
+ * @param[in] ip        pointer to @p BaseAccelerometer interface.
+ * @param[out] axes     a buffer which would be filled with cooked data.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples read.
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ */
+static msg_t acc_read_cooked_batch(void *ip, float axes[], size_t *np) {
+  LSM6DS0Driver* devp;
+  uint8_t *bp = (uint8_t *)axes;
+  size_t i;
+  int16_t tmp;
+  msg_t msg;
+
+  osalDbgCheck((ip != NULL) && (axes != NULL) && (np != NULL));
+
+  /* Getting parent instance pointer.*/
+  devp = objGetInstance(LSM6DS0Driver*, (BaseAccelerometer*)ip);
+
+  osalDbgAssert((devp->state == LSM6DS0_READY),
+                "acc_read_cooked_batch(), invalid state");
+
+  msg = acc_read_fifo(devp, bp, np);
+  for(i = *np * LSM6DS0_ACC_NUMBER_OF_AXES; i > 0U; i--) {
+    tmp = bp[2 * (i - 1)] + (bp[2 * (i - 1) + 1] << 8);
+    axes[i - 1] = (float)tmp;
+  }
+  sensorCookBatch(axes, *np, LSM6DS0_ACC_NUMBER_OF_AXES,
+                  devp->accsensitivity, devp->accbias);
+  return msg;
+}
+#endif /* LSM6DS0_USE_FIFO */
+
 /**
  * @brief   Set bias values for the BaseAccelerometer.
  * @note    Bias must be expressed as milli-G.
@@ -797,12 +950,18 @@ static const struct LSM6DS0VMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct LSM6DS0VMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+#if LSM6DS0_USE_FIFO
+  acc_read_raw_batch, acc_read_cooked_batch,
+#else
+  NULL, NULL,
+#endif
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
 static const struct BaseGyroscopeVMT vmt_gyroscope = {
   sizeof(struct LSM6DS0VMT*) + sizeof(BaseAccelerometer),
   gyro_get_axes_number, gyro_read_raw, gyro_read_cooked,
+  NULL, NULL,
   gyro_sample_bias, gyro_set_bias, gyro_reset_bias,
   gyro_set_sensivity, gyro_reset_sensivity
 };
@@ -1005,6 +1164,9 @@ void lsm6ds0Start(LSM6DS0Driver *devp, const LSM6DS0Config *config) {
   /* Control register 9 configuration block.*/
   {
       cr[1] = 0;
+#if LSM6DS0_USE_FIFO || defined(__DOXYGEN__)
+      cr[1] |= LSM6DS0_CTRL_REG9_FIFO_EN;
+#endif
   }
 #if LSM6DS0_USE_I2C
 #if LSM6DS0_SHARED_I2C
@@ -1015,6 +1177,14 @@ void lsm6ds0Start(LSM6DS0Driver *devp, const LSM6DS0Config *config) {
   lsm6ds0I2CWriteRegister(devp->config->i2cp, devp->config->slaveaddress,
                           cr, 1);
 
+#if LSM6DS0_USE_FIFO || defined(__DOXYGEN__)
+  /* FIFO in continuous mode, the oldest samples are discarded on overrun.*/
+  cr[0] = LSM6DS0_AD_FIFO_CTRL;
+  cr[1] = LSM6DS0_FIFO_CTRL_FMODE_CONT;
+  lsm6ds0I2CWriteRegister(devp->config->i2cp, devp->config->slaveaddress,
+                          cr, 1);
+#endif
+
 #if LSM6DS0_SHARED_I2C
   i2cReleaseBus(devp->config->i2cp);
 #endif /* LSM6DS0_SHARED_I2C */
@@ -43,7 +43,7 @@
 /**
  * @brief   LSM6DS0 driver version string.
  */
-#define EX_LSM6DS0_VERSION                  "1.1.2"
+#define EX_LSM6DS0_VERSION                  "1.2.0"
 
 /**
  * @brief   LSM6DS0 driver version major number.
@@ -53,12 +53,12 @@
 /**
  * @brief   LSM6DS0 driver version minor number.
  */
-#define EX_LSM6DS0_MINOR                    1
+#define EX_LSM6DS0_MINOR                    2
 
 /**
  * @brief   LSM6DS0 driver version patch number.
  */
-#define EX_LSM6DS0_PATCH                    2
+#define EX_LSM6DS0_PATCH                    0
 /** @} */
 
 /**
@@ -82,6 +82,8 @@
 #define LSM6DS0_ACC_SENS_16G                0.732f
 
 #define LSM6DS0_ACC_BIAS                    0.0f
+
+#define LSM6DS0_ACC_FIFO_DEPTH              32U
 /** @} */
 
 /**
@@ -299,6 +301,30 @@
 #define LSM6DS0_CTRL_REG10_ST_G             (1 << 2)
 /** @} */
 
+/**
+ * @name    LSM6DS0_AD_FIFO_CTRL register bits definitions
+ * @{
+ */
+#define LSM6DS0_FIFO_CTRL_MASK              0xFF
+#define LSM6DS0_FIFO_CTRL_FTH_MASK          0x1F
+#define LSM6DS0_FIFO_CTRL_FMODE_MASK        0xE0
+#define LSM6DS0_FIFO_CTRL_FMODE_BYPASS      (0 << 5)
+#define LSM6DS0_FIFO_CTRL_FMODE_FIFO        (1 << 5)
+#define LSM6DS0_FIFO_CTRL_FMODE_CONT_FIFO   (3 << 5)
+#define LSM6DS0_FIFO_CTRL_FMODE_BYPASS_CONT (4 << 5)
+#define LSM6DS0_FIFO_CTRL_FMODE_CONT        (6 << 5)
+/** @} */
+
+/**
+ * @name    LSM6DS0_AD_FIFO_SRC register bits definitions
+ * @{
+ */
+#define LSM6DS0_FIFO_SRC_MASK               0xFF
+#define LSM6DS0_FIFO_SRC_FSS_MASK           0x3F
+#define LSM6DS0_FIFO_SRC_OVRN               (1 << 6)
+#define LSM6DS0_FIFO_SRC_FTH                (1 << 7)
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -354,6 +380,19 @@
 #define LSM6DS0_USE_ADVANCED                FALSE
 #endif
 
+/**
+ * @brief   LSM6DS0 FIFO switch.
+ * @details If set to @p TRUE the device FIFO is enabled in continuous mode
+ *          and the batch read methods of the BaseAccelerometer are
+ *          available.
+ * @note    With the FIFO enabled the single read methods return the oldest
+ *          sample stored in the FIFO.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(LSM6DS0_USE_FIFO) || defined(__DOXYGEN__)
+#define LSM6DS0_USE_FIFO                    FALSE
+#endif
+
 /**
  * @brief   Number of acquisitions for gyroscope bias removal.
  * @details This is the number of acquisitions performed to compute the
@@ -808,12 +808,14 @@ static const struct LSM6DSLVMT vmt_device = {
 static const struct BaseAccelerometerVMT vmt_accelerometer = {
   sizeof(struct LSM6DSLVMT*),
   acc_get_axes_number, acc_read_raw, acc_read_cooked,
+  NULL, NULL,
   acc_set_bias, acc_reset_bias, acc_set_sensivity, acc_reset_sensivity
 };
 
 static const struct BaseGyroscopeVMT vmt_gyroscope = {
   sizeof(struct LSM6DSLVMT*) + sizeof(BaseAccelerometer),
   gyro_get_axes_number, gyro_read_raw, gyro_read_cooked,
+  NULL, NULL,
   gyro_sample_bias, gyro_set_bias, gyro_reset_bias,
   gyro_set_sensivity, gyro_reset_sensivity
 };
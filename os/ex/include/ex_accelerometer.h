@@ -137,6 +137,46 @@ typedef struct {
 #define accelerometerReadCooked(ip, dp)                                     \
         (ip)->vmt->read_cooked(ip, dp)
 
+/**
+ * @brief   Accelerometer read a batch of raw data from the FIFO.
+ * @pre     The accelerometer must support batch reads, see
+ *          @p sensorHasBatch().
+ *
+ * @param[in] ip        pointer to a @p BaseAccelerometer class.
+ * @param[out] dp       pointer to a data array, it must be able to contain
+ *                      <tt>*np</tt> samples of all axes.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples actually read
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more errors occurred.
+ *
+ * @api
+ */
+#define accelerometerReadRawBatch(ip, dp, np)                               \
+        (ip)->vmt->read_raw_batch(ip, dp, np)
+
+/**
+ * @brief   Accelerometer read a batch of cooked data from the FIFO.
+ * @pre     The accelerometer must support batch reads, see
+ *          @p sensorHasBatch().
+ *
+ * @param[in] ip        pointer to a @p BaseAccelerometer class.
+ * @param[out] dp       pointer to a data array, it must be able to contain
+ *                      <tt>*np</tt> samples of all axes.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples actually read
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more errors occurred.
+ *
+ * @api
+ */
+#define accelerometerReadCookedBatch(ip, dp, np)                            \
+        (ip)->vmt->read_cooked_batch(ip, dp, np)
+
 /**
  * @brief   Updates accelerometer bias data from received buffer.
  * @note    The bias buffer must have the same length of the
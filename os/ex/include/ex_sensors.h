@@ -50,7 +50,11 @@
   /* Reads the sensor raw data.*/                                           \
   msg_t (*read_raw)(void *instance, int32_t axes[]);                        \
   /* Reads the sensor returning normalized data.*/                          \
-  msg_t (*read_cooked)(void *instance, float axes[]);
+  msg_t (*read_cooked)(void *instance, float axes[]);                       \
+  /* Drains the sensor FIFO returning raw data, can be NULL.*/              \
+  msg_t (*read_raw_batch)(void *instance, int32_t axes[], size_t *np);      \
+  /* Drains the sensor FIFO returning normalized data, can be NULL.*/       \
+  msg_t (*read_cooked_batch)(void *instance, float axes[], size_t *np);
 
 /**
  * @brief   BaseSensor specific methods with inherited ones.
@@ -132,6 +136,62 @@ typedef struct {
  * @api
  */
 #define sensorReadCooked(ip, dp) (ip)->vmt->read_cooked(ip, dp)
+
+/**
+ * @brief   Sensors batch acquisition support.
+ *
+ * @param[in] ip        pointer to a @p BaseSensor or derived class.
+ * @return              The batch support state.
+ * @retval false        if the sensor does not implement batch reads.
+ * @retval true         if the sensor implements batch reads.
+ *
+ * @api
+ */
+#define sensorHasBatch(ip) ((ip)->vmt->read_raw_batch != NULL)
+
+/**
+ * @brief   Sensors read a batch of raw data.
+ * @details All the samples buffered in the device FIFO, up to the buffer
+ *          capacity, are fetched in a single burst. Samples are stored
+ *          interleaved, each sample is composed by as many values as the
+ *          sensor channels number.
+ * @pre     The sensor must support batch reads, see @p sensorHasBatch().
+ *
+ * @param[in] ip        pointer to a @p BaseSensor or derived class.
+ * @param[out] dp       pointer to a data array, it must be able to contain
+ *                      <tt>*np * channels</tt> values.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples actually read
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more errors occurred.
+ *
+ * @api
+ */
+#define sensorReadRawBatch(ip, dp, np) (ip)->vmt->read_raw_batch(ip, dp, np)
+
+/**
+ * @brief   Sensors read a batch of cooked data.
+ * @details All the samples buffered in the device FIFO, up to the buffer
+ *          capacity, are fetched in a single burst then converted using
+ *          @p sensorCookBatch().
+ * @pre     The sensor must support batch reads, see @p sensorHasBatch().
+ *
+ * @param[in] ip        pointer to a @p BaseSensor or derived class.
+ * @param[out] dp       pointer to a data array, it must be able to contain
+ *                      <tt>*np * channels</tt> values.
+ * @param[in,out] np    on entry the buffer capacity in samples, on exit
+ *                      the number of samples actually read
+ *
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more errors occurred.
+ *
+ * @api
+ */
+#define sensorReadCookedBatch(ip, dp, np)                                   \
+        (ip)->vmt->read_cooked_batch(ip, dp, np)
 /** @} */
 
 /*===========================================================================*/
@@ -146,6 +206,42 @@ extern "C" {
 }
 #endif
 
+/*===========================================================================*/
+/* Driver inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a batch of samples in place.
+ * @details Applies <tt>cooked = (raw * sensitivity) - bias</tt> to @p n
+ *          interleaved samples of @p channels values each. The array is
+ *          expected to contain the raw values already converted to float,
+ *          this is exact for sensors up to 24 bits of resolution.
+ * @note    The loop has no dependencies between iterations and no
+ *          conditionals, when @p channels is a constant the compiler is
+ *          able to unroll and vectorize it using the FPU multiply-accumulate
+ *          instructions.
+ *
+ * @param[in,out] data      array of samples
+ * @param[in] n             number of samples
+ * @param[in] channels      number of values for each sample
+ * @param[in] sensitivity   per channel sensitivity array
+ * @param[in] bias          per channel bias array
+ *
+ * @notapi
+ */
+static inline void sensorCookBatch(float data[], size_t n, size_t channels,
+                                   const float sensitivity[],
+                                   const float bias[]) {
+  size_t i, j;
+
+  for (i = 0U; i < n; i++) {
+    for (j = 0U; j < channels; j++) {
+      data[j] = (data[j] * sensitivity[j]) - bias[j];
+    }
+    data += channels;
+  }
+}
+
 #endif /* EX_SENSORS_H */
 
 /** @} */
@@ -85,6 +85,14 @@
 #if !defined(SPI_SELECT_MODE) || defined(__DOXYGEN__)
 #define SPI_SELECT_MODE                     SPI_SELECT_MODE_PAD
 #endif
+
+/**
+ * @brief   Enables the transactions queue API.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_TRANSACTIONS) || defined(__DOXYGEN__)
+#define SPI_USE_TRANSACTIONS                FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -141,6 +149,107 @@ typedef struct hal_spi_config SPIConfig;
  */
 typedef void (*spicb_t)(SPIDriver *spip);
 
+#if (SPI_USE_TRANSACTIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an SPI transaction.
+ */
+typedef struct hal_spi_transaction spi_transaction_t;
+
+/**
+ * @brief   SPI transaction end callback type.
+ * @note    The callback is invoked from ISR context within a critical
+ *          zone, only I-class functions can be used.
+ *
+ * @param[in] spip              pointer to the @p SPIDriver object
+ * @param[in] stp               pointer to the completed transaction
+ */
+typedef void (*spitcb_t)(SPIDriver *spip, spi_transaction_t *stp);
+
+/**
+ * @brief   Segment of an SPI transaction.
+ * @note    If both buffers are specified an exchange is performed, if
+ *          only one is specified a send or a receive is performed, if
+ *          none is specified then @p n frames are ignored.
+ */
+typedef struct {
+  /**
+   * @brief   Number of frames to be transferred.
+   */
+  size_t                    n;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const void                *txbuf;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  void                      *rxbuf;
+} spi_segment_t;
+
+/**
+ * @brief   Structure representing an SPI transaction.
+ * @details A transaction is a sequence of segments performed with the
+ *          chip select asserted, the chip select line and the bus
+ *          settings are taken from the associated configuration.
+ */
+struct hal_spi_transaction {
+  /**
+   * @brief   Next transaction in the driver queue.
+   */
+  spi_transaction_t         *next;
+  /**
+   * @brief   Configuration to be used for this transaction.
+   */
+  const SPIConfig           *config;
+  /**
+   * @brief   Array of segments.
+   */
+  const spi_segment_t       *segments;
+  /**
+   * @brief   Number of segments.
+   */
+  size_t                    nsegments;
+  /**
+   * @brief   Transaction end callback or @p NULL.
+   */
+  spitcb_t                  end_cb;
+  /**
+   * @brief   Application parameter.
+   */
+  void                      *arg;
+  /**
+   * @brief   Transaction result.
+   */
+  msg_t                     status;
+  /**
+   * @brief   Index of the segment being transferred.
+   */
+  size_t                    index;
+};
+
+/**
+ * @brief   SPI transactions queue statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Completed transactions.
+   */
+  uint32_t                  transactions;
+  /**
+   * @brief   Transferred segments.
+   */
+  uint32_t                  segments;
+  /**
+   * @brief   Transactions started back-to-back from the completion ISR.
+   */
+  uint32_t                  chained;
+  /**
+   * @brief   Transactions terminated because an error.
+   */
+  uint32_t                  errors;
+} spi_tq_stats_t;
+#endif /* SPI_USE_TRANSACTIONS == TRUE */
+
 /* Including the low level driver header, it exports information required
    for completing types.*/
 #include "hal_spi_v2_lld.h"
@@ -234,6 +343,24 @@ struct hal_spi_driver {
    */
   mutex_t                   mutex;
 #endif /* SPI_USE_MUTUAL_EXCLUSION == TRUE */
+#if (SPI_USE_TRANSACTIONS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transaction being executed or @p NULL.
+   */
+  spi_transaction_t         *tqcurr;
+  /**
+   * @brief   Head of the queue of pending transactions.
+   */
+  spi_transaction_t         *tqhead;
+  /**
+   * @brief   Tail of the queue of pending transactions.
+   */
+  spi_transaction_t         *tqtail;
+  /**
+   * @brief   Transactions queue statistics.
+   */
+  spi_tq_stats_t            tqstats;
+#endif /* SPI_USE_TRANSACTIONS == TRUE */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -385,12 +512,27 @@ do {                                                                        \
 #define __spi_wakeup_isr(spip)
 #endif /* !SPI_USE_SYNCHRONIZATION */
 
+#if (SPI_USE_TRANSACTIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Evaluates to @p true if the transactions engine owns the driver.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+#define __spi_tq_is_active(spip) ((spip)->tqcurr != NULL)
+#else /* !SPI_USE_TRANSACTIONS */
+#define __spi_tq_is_active(spip) false
+#define __spi_tq_serve_isr(spip, msg)
+#endif /* !SPI_USE_TRANSACTIONS */
+
 /**
  * @brief   Common ISR code in linear mode.
  * @details This code handles the portable part of the ISR code:
  *          - Callback invocation.
  *          - Waiting thread wakeup, if any.
  *          - Driver state transitions.
+ *          - Transactions queue advancement, if active.
  *          .
  * @note    This macro is meant to be used in the low level drivers
  *          implementation only.
@@ -400,7 +542,10 @@ do {                                                                        \
  * @notapi
  */
 #define __spi_isr_complete_code(spip) {                                     \
-  if ((spip)->config->data_cb) {                                            \
+  if (__spi_tq_is_active(spip)) {                                           \
+    __spi_tq_serve_isr(spip, HAL_RET_SUCCESS);                              \
+  }                                                                         \
+  else if ((spip)->config->data_cb) {                                       \
     (spip)->state = SPI_COMPLETE;                                           \
     (spip)->config->data_cb(spip);                                          \
     if ((spip)->state == SPI_COMPLETE)                                      \
@@ -464,10 +609,15 @@ do {                                                                        \
  * @notapi
  */
 #define __spi_isr_error_code(spip, msg) {                                   \
-  if ((spip)->config->error_cb) {                                           \
-    (spip)->config->error_cb(spip);                                         \
+  if (__spi_tq_is_active(spip)) {                                           \
+    __spi_tq_serve_isr(spip, msg);                                          \
+  }                                                                         \
+  else {                                                                    \
+    if ((spip)->config->error_cb) {                                         \
+      (spip)->config->error_cb(spip);                                       \
+    }                                                                       \
+    __spi_wakeup_isr(spip, msg);                                            \
   }                                                                         \
-  __spi_wakeup_isr(spip, msg);                                              \
 }
 /** @} */
 
@@ -508,6 +658,11 @@ extern "C" {
   void spiAcquireBus(SPIDriver *spip);
   void spiReleaseBus(SPIDriver *spip);
 #endif
+#if SPI_USE_TRANSACTIONS == TRUE
+  msg_t spiQueueTransactionI(SPIDriver *spip, spi_transaction_t *stp);
+  msg_t spiQueueTransaction(SPIDriver *spip, spi_transaction_t *stp);
+  void __spi_tq_serve_isr(SPIDriver *spip, msg_t msg);
+#endif
 #ifdef __cplusplus
 }
 #endif
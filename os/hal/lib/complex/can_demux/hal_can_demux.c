@@ -0,0 +1,493 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_can_demux.c
+ * @brief   CAN frames demultiplexer code.
+ * @details The demultiplexer sits between a CAN driver and the threads
+ *          interested in specific identifiers. A thread calling
+ *          @p cdmxDispatch() drains the driver receive queue in batches,
+ *          frames are classified by identifier through a hash table and
+ *          copied, with a time stamp, into the ring of the subscriber
+ *          owning the identifier. Subscribers are notified once per batch.
+ *          The transmit side orders the frames queued by multiple threads
+ *          by arbitration priority so that only the highest priority frame
+ *          competes for the hardware mailboxes.
+ *
+ * @addtogroup HAL_CAN_DEMUX
+ * @{
+ */
+
+#include "hal.h"
+#include "hal_can_demux.h"
+
+#if (HAL_USE_CAN == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Key of the empty hash table slots.
+ */
+#define CDMX_EMPTY_KEY              0xFFFFFFFFU
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Hash table index of a key.
+ *
+ * @param[in] key       identifier key
+ * @return              The starting slot index.
+ */
+static inline unsigned cdmx_hash(uint32_t key) {
+
+  return (unsigned)((key * 0x9E3779B1U) >> (32U - CDMX_HASH_BITS));
+}
+
+/**
+ * @brief   Subscriber owning an identifier key.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[in] key       identifier key
+ * @return              The subscriber or @p NULL if there is no match.
+ */
+static cdmx_subscriber_t *cdmx_lookup(CANDemux *dmxp, uint32_t key) {
+  unsigned i;
+
+  /* Standard identifiers not in the bitmap are rejected without hashing.*/
+  if (((key & 0x80000000U) == 0U) &&
+      ((dmxp->stdmap[key >> 5] & (1U << (key & 31U))) == 0U)) {
+    return NULL;
+  }
+
+  /* Linear probing, the table is never full so an empty slot terminates
+     the search.*/
+  i = cdmx_hash(key);
+  while (dmxp->keys[i] != CDMX_EMPTY_KEY) {
+    if (dmxp->keys[i] == key) {
+      return dmxp->subs[i];
+    }
+    i = (i + 1U) & (CDMX_HASH_SIZE - 1U);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Arbitration key of a frame, lower keys win the bus.
+ * @details The 11 bits base identifier is compared first, a standard
+ *          frame wins over an extended frame with the same base identifier.
+ *
+ * @param[in] ctfp      pointer to the CAN frame
+ * @return              The arbitration key.
+ */
+static uint32_t cdmx_arbitration_key(const CANTxFrame *ctfp) {
+
+  if (ctfp->IDE) {
+    return (((uint32_t)ctfp->EID >> 18) << 19) | (1U << 18) |
+           ((uint32_t)ctfp->EID & 0x3FFFFU);
+  }
+  return (uint32_t)ctfp->SID << 19;
+}
+
+/**
+ * @brief   Time left before a timeout expires.
+ *
+ * @param[in] start     system time of the operation start
+ * @param[in] timeout   the operation timeout
+ * @return              The time left, @p TIME_IMMEDIATE if expired.
+ */
+static sysinterval_t cdmx_time_left(systime_t start, sysinterval_t timeout) {
+  sysinterval_t elapsed;
+
+  if ((timeout == TIME_INFINITE) || (timeout == TIME_IMMEDIATE)) {
+    return timeout;
+  }
+
+  elapsed = osalTimeDiffX(start, osalOsGetSystemTimeX());
+  if (elapsed >= timeout) {
+    return TIME_IMMEDIATE;
+  }
+
+  return timeout - elapsed;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] dmxp     pointer to the @p CANDemux object
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @init
+ */
+void cdmxObjectInit(CANDemux *dmxp, CANDriver *canp) {
+  unsigned i;
+
+  dmxp->canp    = canp;
+  dmxp->defsub  = NULL;
+  dmxp->filters = 0U;
+  for (i = 0U; i < (2048U / 32U); i++) {
+    dmxp->stdmap[i] = 0U;
+  }
+  for (i = 0U; i < CDMX_HASH_SIZE; i++) {
+    dmxp->keys[i] = CDMX_EMPTY_KEY;
+    dmxp->subs[i] = NULL;
+  }
+  dmxp->txhead  = NULL;
+  dmxp->stats.frames      = 0U;
+  dmxp->stats.unmatched   = 0U;
+  dmxp->stats.overruns    = 0U;
+  dmxp->stats.transmitted = 0U;
+}
+
+/**
+ * @brief   Initializes a subscriber.
+ *
+ * @param[out] subp     pointer to the @p cdmx_subscriber_t object
+ * @param[in] buffer    ring buffer
+ * @param[in] n         number of entries in the ring buffer, must be a
+ *                      power of two
+ *
+ * @init
+ */
+void cdmxSubscriberObjectInit(cdmx_subscriber_t *subp,
+                              cdmx_entry_t *buffer, size_t n) {
+
+  osalDbgCheck((subp != NULL) && (buffer != NULL) &&
+               (n > 0U) && ((n & (n - 1U)) == 0U));
+
+  subp->buffer   = buffer;
+  subp->mask     = n - 1U;
+  subp->wrptr    = 0U;
+  subp->rdptr    = 0U;
+  subp->wrnext   = 0U;
+  subp->dirty    = NULL;
+  subp->overruns = 0U;
+  subp->thread   = NULL;
+}
+
+/**
+ * @brief   Routes an identifier to a subscriber.
+ * @details If the identifier is already routed then the subscriber is
+ *          replaced.
+ * @note    Filters should be installed before starting the dispatching,
+ *          frames dispatched concurrently with the change can still be
+ *          routed to the previous destination.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[in] key       identifier key, see @p CDMX_STD_KEY() and
+ *                      @p CDMX_EXT_KEY()
+ * @param[in] subp      pointer to the @p cdmx_subscriber_t object
+ * @return              The operation status.
+ * @retval HAL_RET_SUCCESS      if the filter has been installed.
+ * @retval HAL_RET_NO_RESOURCE  if the filters table is full.
+ *
+ * @api
+ */
+msg_t cdmxSubscribe(CANDemux *dmxp, uint32_t key, cdmx_subscriber_t *subp) {
+  unsigned i;
+
+  osalDbgCheck((dmxp != NULL) && (subp != NULL) && (key != CDMX_EMPTY_KEY));
+
+  osalSysLock();
+
+  i = cdmx_hash(key);
+  while (dmxp->keys[i] != CDMX_EMPTY_KEY) {
+    if (dmxp->keys[i] == key) {
+      dmxp->subs[i] = subp;
+      osalSysUnlock();
+      return HAL_RET_SUCCESS;
+    }
+    i = (i + 1U) & (CDMX_HASH_SIZE - 1U);
+  }
+
+  if (dmxp->filters >= CDMX_MAX_FILTERS) {
+    osalSysUnlock();
+    return HAL_RET_NO_RESOURCE;
+  }
+
+  /* The subscriber is written before the key, the bitmap last.*/
+  dmxp->subs[i] = subp;
+  dmxp->keys[i] = key;
+  if ((key & 0x80000000U) == 0U) {
+    dmxp->stdmap[key >> 5] |= 1U << (key & 31U);
+  }
+  dmxp->filters++;
+
+  osalSysUnlock();
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Dispatches received frames to the subscribers.
+ * @details The function waits for a frame then drains up to
+ *          @p CDMX_DISPATCH_BATCH frames from the driver, frames are
+ *          time stamped and copied into the subscribers rings, frames
+ *          not matching any filter go to the default subscriber, if any.
+ *          Frames are dropped if the destination ring is full.
+ * @note    Only one thread can dispatch frames for a demultiplexer.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if one or more frames have been dispatched.
+ * @retval MSG_TIMEOUT  if no frames have been received within the
+ *                      specified timeout.
+ * @retval MSG_RESET    if the driver has been stopped while waiting.
+ *
+ * @api
+ */
+msg_t cdmxDispatch(CANDemux *dmxp, sysinterval_t timeout) {
+  CANRxFrame frames[CDMX_DISPATCH_BATCH];
+  cdmx_subscriber_t *subp, *dirty = NULL;
+  uint32_t unmatched = 0U, overruns = 0U;
+  systime_t now;
+  unsigned i, n = 1U;
+  msg_t msg;
+
+  osalDbgCheck(dmxp != NULL);
+
+  msg = canReceiveTimeout(dmxp->canp, CAN_ANY_MAILBOX, &frames[0], timeout);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  /* Draining the frames already queued in the driver.*/
+  osalSysLock();
+  while ((n < (unsigned)CDMX_DISPATCH_BATCH) &&
+         !canTryReceiveI(dmxp->canp, CAN_ANY_MAILBOX, &frames[n])) {
+    n++;
+  }
+  now = osalOsGetSystemTimeX();
+  osalSysUnlock();
+
+  /* Classification and copy, rings are private to the producer until
+     published.*/
+  for (i = 0U; i < n; i++) {
+    subp = cdmx_lookup(dmxp, cdmxFrameKey(&frames[i]));
+    if (subp == NULL) {
+      unmatched++;
+      subp = dmxp->defsub;
+      if (subp == NULL) {
+        continue;
+      }
+    }
+
+    if ((subp->wrnext - subp->rdptr) > subp->mask) {
+      subp->overruns++;
+      overruns++;
+      continue;
+    }
+
+    /* First frame of the batch for this subscriber.*/
+    if (subp->wrnext == subp->wrptr) {
+      subp->dirty = dirty;
+      dirty = subp;
+    }
+
+    subp->buffer[subp->wrnext & subp->mask].time  = now;
+    subp->buffer[subp->wrnext & subp->mask].frame = frames[i];
+    subp->wrnext++;
+  }
+
+  /* Publishing the batch.*/
+  osalSysLock();
+  while (dirty != NULL) {
+    subp  = dirty;
+    dirty = subp->dirty;
+    subp->wrptr = subp->wrnext;
+    osalThreadResumeI(&subp->thread, MSG_OK);
+  }
+  dmxp->stats.frames    += (uint32_t)n;
+  dmxp->stats.unmatched += unmatched;
+  dmxp->stats.overruns  += overruns;
+  osalOsRescheduleS();
+  osalSysUnlock();
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Fetches a frame from a subscriber ring.
+ * @note    Only one thread can receive from a subscriber.
+ *
+ * @param[in] subp      pointer to the @p cdmx_subscriber_t object
+ * @param[out] ep       pointer to the buffer where the frame is copied
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if a frame has been fetched.
+ * @retval MSG_TIMEOUT  if the ring remained empty for the specified
+ *                      timeout.
+ *
+ * @api
+ */
+msg_t cdmxReceiveTimeout(cdmx_subscriber_t *subp, cdmx_entry_t *ep,
+                         sysinterval_t timeout) {
+  size_t rd;
+
+  osalDbgCheck((subp != NULL) && (ep != NULL));
+
+  rd = subp->rdptr;
+  if (subp->wrptr == rd) {
+    msg_t msg = MSG_OK;
+
+    osalSysLock();
+    if (subp->wrptr == rd) {
+      msg = osalThreadSuspendTimeoutS(&subp->thread, timeout);
+    }
+    osalSysUnlock();
+
+    if (msg != MSG_OK) {
+      return msg;
+    }
+  }
+
+  *ep = subp->buffer[rd & subp->mask];
+  subp->rdptr = rd + 1U;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Transmits a frame in arbitration priority order.
+ * @details Frames queued by multiple threads are transmitted in the order
+ *          the bus would arbitrate them, frames with the same identifier
+ *          in FIFO order. Only the highest priority frame waits for a
+ *          free mailbox so a lower priority frame cannot take the mailbox
+ *          needed by a higher priority one.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if the frame has been queued for transmission.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ * @retval MSG_RESET    if the driver has been stopped.
+ *
+ * @api
+ */
+msg_t cdmxTransmitTimeout(CANDemux *dmxp, const CANTxFrame *ctfp,
+                          sysinterval_t timeout) {
+  CANDriver *canp = dmxp->canp;
+  cdmx_tx_request_t req, **pp;
+  systime_t start;
+  bool head;
+  msg_t msg;
+
+  osalDbgCheck((dmxp != NULL) && (ctfp != NULL));
+
+  start      = osalOsGetSystemTimeX();
+  req.key    = cdmx_arbitration_key(ctfp);
+  req.thread = NULL;
+
+  osalSysLock();
+
+  /* Queued after the requests with the same or higher priority.*/
+  pp = &dmxp->txhead;
+  while ((*pp != NULL) && ((*pp)->key <= req.key)) {
+    pp = &(*pp)->next;
+  }
+  req.next = *pp;
+  *pp = &req;
+
+  while (true) {
+    if ((canp->state != CAN_READY) && (canp->state != CAN_SLEEP)) {
+      msg = MSG_RESET;
+      break;
+    }
+    if (dmxp->txhead == &req) {
+      if ((canp->state == CAN_READY) &&
+          !canTryTransmitI(canp, CAN_ANY_MAILBOX, ctfp)) {
+        dmxp->stats.transmitted++;
+        msg = MSG_OK;
+        break;
+      }
+      msg = osalThreadEnqueueTimeoutS(&canp->txqueue,
+                                      cdmx_time_left(start, timeout));
+    }
+    else {
+      msg = osalThreadSuspendTimeoutS(&req.thread,
+                                      cdmx_time_left(start, timeout));
+    }
+    if (msg != MSG_OK) {
+      break;
+    }
+  }
+
+  /* Removing the request, the next one is resumed if it became head.*/
+  head = dmxp->txhead == &req;
+  pp = &dmxp->txhead;
+  while (*pp != &req) {
+    pp = &(*pp)->next;
+  }
+  *pp = req.next;
+  if (head && (dmxp->txhead != NULL)) {
+    osalThreadResumeI(&dmxp->txhead->thread, MSG_OK);
+  }
+
+  osalOsRescheduleS();
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Returns the demultiplexer statistics.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[out] statsp   pointer to the statistics structure to be filled
+ *
+ * @iclass
+ */
+void cdmxGetStatsI(CANDemux *dmxp, cdmx_stats_t *statsp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((dmxp != NULL) && (statsp != NULL));
+
+  *statsp = dmxp->stats;
+}
+
+#endif /* HAL_USE_CAN == TRUE */
+
+/** @} */
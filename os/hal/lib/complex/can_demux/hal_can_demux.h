@@ -0,0 +1,312 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_can_demux.h
+ * @brief   CAN frames demultiplexer header.
+ *
+ * @addtogroup HAL_CAN_DEMUX
+ * @{
+ */
+
+#ifndef HAL_CAN_DEMUX_H
+#define HAL_CAN_DEMUX_H
+
+#if (HAL_USE_CAN == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Identifier keys
+ * @{
+ */
+/**
+ * @brief   Key of a standard identifier.
+ */
+#define CDMX_STD_KEY(sid)           ((uint32_t)(sid) & 0x7FFU)
+
+/**
+ * @brief   Key of an extended identifier.
+ */
+#define CDMX_EXT_KEY(eid)           (((uint32_t)(eid) & 0x1FFFFFFFU) |     \
+                                     0x80000000U)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Number of bits of the filters hash table index.
+ * @details The table has <tt>2 ^ CDMX_HASH_BITS</tt> slots and can hold
+ *          up to three quarters of that number of filters, the default
+ *          allows 384 filters.
+ */
+#if !defined(CDMX_HASH_BITS) || defined(__DOXYGEN__)
+#define CDMX_HASH_BITS              9
+#endif
+
+/**
+ * @brief   Maximum number of frames dispatched per call.
+ * @details Subscribers are notified once per batch.
+ */
+#if !defined(CDMX_DISPATCH_BATCH) || defined(__DOXYGEN__)
+#define CDMX_DISPATCH_BATCH         16
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CDMX_HASH_BITS < 4) || (CDMX_HASH_BITS > 16)
+#error "invalid CDMX_HASH_BITS value"
+#endif
+
+#if CDMX_DISPATCH_BATCH < 1
+#error "invalid CDMX_DISPATCH_BATCH value"
+#endif
+
+/**
+ * @brief   Number of slots in the filters hash table.
+ */
+#define CDMX_HASH_SIZE              (1U << CDMX_HASH_BITS)
+
+/**
+ * @brief   Maximum number of filters.
+ */
+#define CDMX_MAX_FILTERS            ((CDMX_HASH_SIZE * 3U) / 4U)
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a CAN demultiplexer object.
+ */
+typedef struct can_demux CANDemux;
+
+/**
+ * @brief   Type of a demultiplexer subscriber.
+ */
+typedef struct cdmx_subscriber cdmx_subscriber_t;
+
+/**
+ * @brief   Type of a timestamped frame.
+ */
+typedef struct {
+  /**
+   * @brief   System time of the frame retrieval from the driver.
+   * @note    The @p TIME field of the frame, where supported by the low
+   *          level driver, keeps the hardware capture time.
+   */
+  systime_t                 time;
+  /**
+   * @brief   Received frame.
+   */
+  CANRxFrame                frame;
+} cdmx_entry_t;
+
+/**
+ * @brief   Structure representing a subscriber.
+ * @details A subscriber owns a single-producer single-consumer ring of
+ *          timestamped frames, the demultiplexer writes it without locking
+ *          and publishes new frames once per dispatched batch.
+ */
+struct cdmx_subscriber {
+  /**
+   * @brief   Ring buffer.
+   */
+  cdmx_entry_t              *buffer;
+  /**
+   * @brief   Ring size minus one, the size is a power of two.
+   */
+  size_t                    mask;
+  /**
+   * @brief   Published write counter, modified by the producer only.
+   */
+  volatile size_t           wrptr;
+  /**
+   * @brief   Read counter, modified by the consumer only.
+   */
+  volatile size_t           rdptr;
+  /**
+   * @brief   Write counter of the batch being dispatched.
+   */
+  size_t                    wrnext;
+  /**
+   * @brief   Next subscriber touched by the current batch.
+   */
+  cdmx_subscriber_t         *dirty;
+  /**
+   * @brief   Frames dropped because the ring was full.
+   */
+  uint32_t                  overruns;
+  /**
+   * @brief   Consumer thread waiting for frames or @p NULL.
+   */
+  thread_reference_t        thread;
+};
+
+/**
+ * @brief   Type of a transmit request.
+ */
+typedef struct cdmx_tx_request cdmx_tx_request_t;
+
+/**
+ * @brief   Structure representing a queued transmit request.
+ */
+struct cdmx_tx_request {
+  /**
+   * @brief   Next request in priority order.
+   */
+  cdmx_tx_request_t         *next;
+  /**
+   * @brief   Arbitration key, lower values have higher priority.
+   */
+  uint32_t                  key;
+  /**
+   * @brief   Thread waiting to become head of the queue or @p NULL.
+   */
+  thread_reference_t        thread;
+};
+
+/**
+ * @brief   CAN demultiplexer statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Dispatched frames.
+   */
+  uint32_t                  frames;
+  /**
+   * @brief   Frames not matching any filter.
+   */
+  uint32_t                  unmatched;
+  /**
+   * @brief   Frames dropped because of full subscriber rings.
+   */
+  uint32_t                  overruns;
+  /**
+   * @brief   Transmitted frames.
+   */
+  uint32_t                  transmitted;
+} cdmx_stats_t;
+
+/**
+ * @brief   Structure representing a CAN demultiplexer.
+ */
+struct can_demux {
+  /**
+   * @brief   Associated CAN driver.
+   */
+  CANDriver                 *canp;
+  /**
+   * @brief   Subscriber of the unmatched frames or @p NULL.
+   */
+  cdmx_subscriber_t         *defsub;
+  /**
+   * @brief   Number of installed filters.
+   */
+  size_t                    filters;
+  /**
+   * @brief   Standard identifiers membership bitmap.
+   */
+  uint32_t                  stdmap[2048U / 32U];
+  /**
+   * @brief   Hash table keys, empty slots are @p 0xFFFFFFFF.
+   */
+  uint32_t                  keys[CDMX_HASH_SIZE];
+  /**
+   * @brief   Hash table subscribers.
+   */
+  cdmx_subscriber_t         *subs[CDMX_HASH_SIZE];
+  /**
+   * @brief   Transmit requests in priority order.
+   */
+  cdmx_tx_request_t         *txhead;
+  /**
+   * @brief   Statistics.
+   */
+  cdmx_stats_t              stats;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Sets the subscriber of the frames not matching any filter.
+ *
+ * @param[in] dmxp      pointer to the @p CANDemux object
+ * @param[in] subp      pointer to the @p cdmx_subscriber_t object or
+ *                      @p NULL for discarding unmatched frames
+ *
+ * @xclass
+ */
+#define cdmxSetDefaultSubscriber(dmxp, subp) ((dmxp)->defsub = (subp))
+
+/**
+ * @brief   Number of frames available in a subscriber ring.
+ *
+ * @param[in] subp      pointer to the @p cdmx_subscriber_t object
+ * @return              The number of frames.
+ *
+ * @xclass
+ */
+#define cdmxGetUsedX(subp) ((size_t)((subp)->wrptr - (subp)->rdptr))
+
+/**
+ * @brief   Key of the identifier of a frame.
+ *
+ * @param[in] fp        pointer to a @p CANTxFrame or @p CANRxFrame
+ * @return              The identifier key.
+ */
+#define cdmxFrameKey(fp)                                                    \
+  ((fp)->IDE ? CDMX_EXT_KEY((fp)->EID) : CDMX_STD_KEY((fp)->SID))
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void cdmxObjectInit(CANDemux *dmxp, CANDriver *canp);
+  void cdmxSubscriberObjectInit(cdmx_subscriber_t *subp,
+                                cdmx_entry_t *buffer, size_t n);
+  msg_t cdmxSubscribe(CANDemux *dmxp, uint32_t key, cdmx_subscriber_t *subp);
+  msg_t cdmxDispatch(CANDemux *dmxp, sysinterval_t timeout);
+  msg_t cdmxReceiveTimeout(cdmx_subscriber_t *subp, cdmx_entry_t *ep,
+                           sysinterval_t timeout);
+  msg_t cdmxTransmitTimeout(CANDemux *dmxp, const CANTxFrame *ctfp,
+                            sysinterval_t timeout);
+  void cdmxGetStatsI(CANDemux *dmxp, cdmx_stats_t *statsp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_CAN == TRUE */
+
+#endif /* HAL_CAN_DEMUX_H */
+
+/** @} */
@@ -0,0 +1,9 @@
+# List of all the CAN demultiplexer files.
+CDMXSRC := $(CHIBIOS)/os/hal/lib/complex/can_demux/hal_can_demux.c
+
+# Required include directories
+CDMXINC := $(CHIBIOS)/os/hal/lib/complex/can_demux
+
+# Shared variables
+ALLCSRC += $(CDMXSRC)
+ALLINC  += $(CDMXINC)
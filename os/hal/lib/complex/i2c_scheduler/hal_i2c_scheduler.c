@@ -0,0 +1,424 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_i2c_scheduler.c
+ * @brief   I2C transactions scheduler code.
+ * @details The scheduler decouples the threads requesting I2C transfers
+ *          from the bus, requests are queued per device and served by
+ *          one or more threads calling @p i2csServe(). Devices are served
+ *          in priority order, among devices of equal priority the request
+ *          with the earliest deadline is served first, remaining ties are
+ *          served in round robin order.
+ *          Transfers are performed using the normal I2C driver API so any
+ *          I2C driver can be used, including the software fallback driver.
+ *
+ * @addtogroup HAL_I2C_SCHEDULER
+ * @{
+ */
+
+#include "hal.h"
+#include "hal_i2c_scheduler.h"
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Time left before a request deadline.
+ *
+ * @param[in] rqp       pointer to the request
+ * @param[in] now       current system time
+ * @return              The time left, zero if the deadline has been
+ *                      missed, @p TIME_INFINITE if there is no deadline.
+ */
+static sysinterval_t i2cs_slack(const i2cs_request_t *rqp, systime_t now) {
+  sysinterval_t elapsed;
+
+  if (rqp->deadline == TIME_INFINITE) {
+    return TIME_INFINITE;
+  }
+
+  elapsed = osalTimeDiffX(rqp->submitted, now);
+  if (elapsed >= rqp->deadline) {
+    return (sysinterval_t)0;
+  }
+
+  return rqp->deadline - elapsed;
+}
+
+/**
+ * @brief   Selects the device to be served.
+ * @details Devices with a transfer in progress are skipped, this keeps
+ *          the requests to a device in order when there are multiple
+ *          serving threads.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] now       current system time
+ * @return              The selected device.
+ * @retval NULL         if there are no requests that can be served.
+ */
+static i2cs_device_t *i2cs_select(I2CScheduler *schp, systime_t now) {
+  i2cs_device_t *devp, *bestp = NULL;
+  sysinterval_t slack, bestslack = TIME_INFINITE;
+
+  for (devp = schp->devices; devp != NULL; devp = devp->next) {
+    if ((devp->head == NULL) || (devp->active != NULL)) {
+      continue;
+    }
+
+    slack = i2cs_slack(devp->head, now);
+    if ((bestp == NULL) ||
+        (devp->prio > bestp->prio) ||
+        ((devp->prio == bestp->prio) && (slack < bestslack))) {
+      bestp     = devp;
+      bestslack = slack;
+    }
+  }
+
+  return bestp;
+}
+
+/**
+ * @brief   Moves a device at the end of the devices list.
+ * @details This makes devices with equal priority and deadline to be
+ *          served in round robin order.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] devp      pointer to the device
+ */
+static void i2cs_rotate(I2CScheduler *schp, i2cs_device_t *devp) {
+  i2cs_device_t **pp = &schp->devices;
+
+  if (devp->next == NULL) {
+    return;
+  }
+
+  while (*pp != devp) {
+    pp = &(*pp)->next;
+  }
+  *pp = devp->next;
+  while (*pp != NULL) {
+    pp = &(*pp)->next;
+  }
+  *pp = devp;
+  devp->next = NULL;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an I2C scheduler object.
+ *
+ * @param[out] schp     pointer to the @p I2CScheduler object
+ * @param[in] i2cp      pointer to the @p I2CDriver object to be scheduled
+ *
+ * @init
+ */
+void i2csObjectInit(I2CScheduler *schp, I2CDriver *i2cp) {
+
+  osalDbgCheck((schp != NULL) && (i2cp != NULL));
+
+  schp->i2cp                  = i2cp;
+  schp->devices               = NULL;
+  schp->pending               = 0U;
+  osalThreadQueueObjectInit(&schp->waiting);
+  osalEventObjectInit(&schp->event);
+  schp->stats.requests        = 0U;
+  schp->stats.errors          = 0U;
+  schp->stats.deadline_misses = 0U;
+  schp->stats.busy            = (sysinterval_t)0;
+  schp->stats.latency_total   = (sysinterval_t)0;
+  schp->stats.latency_max     = (sysinterval_t)0;
+}
+
+/**
+ * @brief   Initializes a device object and registers it on the scheduler.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[out] devp     pointer to the @p i2cs_device_t object
+ * @param[in] addr      slave address of the device
+ * @param[in] prio      priority of the device, higher values are served
+ *                      first
+ *
+ * @init
+ */
+void i2csDeviceObjectInit(I2CScheduler *schp, i2cs_device_t *devp,
+                          i2caddr_t addr, uint32_t prio) {
+
+  osalDbgCheck((schp != NULL) && (devp != NULL));
+
+  devp->addr = addr;
+  devp->prio = prio;
+  devp->head   = NULL;
+  devp->tail   = NULL;
+  devp->active = NULL;
+
+  osalSysLock();
+  devp->next    = schp->devices;
+  schp->devices = devp;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Submits a request.
+ * @details The request is appended to the device queue and a serving
+ *          thread is awakened.
+ * @note    The request object must not be modified until completion.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] devp      pointer to the target device
+ * @param[in] rqp       pointer to the @p i2cs_request_t object
+ *
+ * @iclass
+ */
+void i2csSubmitI(I2CScheduler *schp, i2cs_device_t *devp,
+                 i2cs_request_t *rqp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((schp != NULL) && (devp != NULL) && (rqp != NULL) &&
+               ((rqp->txbytes > 0U) || (rqp->rxbytes > 0U)));
+
+  rqp->next      = NULL;
+  rqp->status    = MSG_RESET;
+  rqp->errors    = I2C_NO_ERROR;
+  rqp->submitted = osalOsGetSystemTimeX();
+  rqp->thread    = NULL;
+
+  /* Appending to the device FIFO.*/
+  if (devp->head == NULL) {
+    devp->head = rqp;
+  }
+  else {
+    devp->tail->next = rqp;
+  }
+  devp->tail = rqp;
+  schp->pending++;
+
+  osalThreadDequeueNextI(&schp->waiting, MSG_OK);
+}
+
+/**
+ * @brief   Submits a request.
+ * @details The request is appended to the device queue and a serving
+ *          thread is awakened.
+ * @note    The request object must not be modified until completion.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] devp      pointer to the target device
+ * @param[in] rqp       pointer to the @p i2cs_request_t object
+ *
+ * @api
+ */
+void i2csSubmit(I2CScheduler *schp, i2cs_device_t *devp,
+                i2cs_request_t *rqp) {
+
+  osalSysLock();
+  i2csSubmitI(schp, devp, rqp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Submits a request and waits for its completion.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] devp      pointer to the target device
+ * @param[in] rqp       pointer to the @p i2cs_request_t object
+ * @return              The request result.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved from the request object.
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @api
+ */
+msg_t i2csSubmitAndWait(I2CScheduler *schp, i2cs_device_t *devp,
+                        i2cs_request_t *rqp) {
+  msg_t msg;
+
+  osalSysLock();
+  i2csSubmitI(schp, devp, rqp);
+  msg = osalThreadSuspendS(&rqp->thread);
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Serves one request.
+ * @details The invoking thread waits for a pending request then performs
+ *          the transfer and notifies its completion. This function is
+ *          meant to be called in loop by one or more serving threads.
+ * @note    Requests to a device with a transfer in progress are left
+ *          queued, they are served after its completion.
+ * @note    If a transfer times out the I2C driver is left in an unusable
+ *          state and must be restarted, see @p i2cMasterTransmitTimeout().
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] timeout   the number of ticks before giving up waiting for a
+ *                      request, the special values are handled as follow:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      - @a TIME_IMMEDIATE immediate return if there are
+ *                        no pending requests.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a request has been served.
+ * @retval MSG_TIMEOUT  if there were no requests within the timeout.
+ * @retval MSG_RESET    if the wait has been reset.
+ *
+ * @api
+ */
+msg_t i2csServe(I2CScheduler *schp, sysinterval_t timeout) {
+  i2cs_device_t *devp;
+  i2cs_request_t *rqp;
+  systime_t start, bus_start, end;
+  sysinterval_t latency;
+  i2cflags_t errors;
+  msg_t msg;
+
+  osalDbgCheck(schp != NULL);
+
+  osalSysLock();
+
+  /* Waiting for a request, another serving thread could get it first or
+     the pending requests could be addressed to devices being served.*/
+  while (true) {
+    start = osalOsGetSystemTimeX();
+    devp  = i2cs_select(schp, start);
+    if (devp != NULL) {
+      break;
+    }
+    msg = osalThreadEnqueueTimeoutS(&schp->waiting, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+
+  /* Removing the selected request from its device queue, the device is
+     busy until the transfer completes.*/
+  rqp          = devp->head;
+  devp->head   = rqp->next;
+  devp->active = rqp;
+  schp->pending--;
+  i2cs_rotate(schp, devp);
+
+  /* Queueing latency accounting.*/
+  latency = osalTimeDiffX(rqp->submitted, start);
+  schp->stats.latency_total += latency;
+  if (latency > schp->stats.latency_max) {
+    schp->stats.latency_max = latency;
+  }
+
+  osalSysUnlock();
+
+  /* Bus transfer, the bus is shared with threads using the I2C driver
+     directly.*/
+#if I2C_USE_MUTUAL_EXCLUSION == TRUE
+  i2cAcquireBus(schp->i2cp);
+#endif
+  bus_start = osalOsGetSystemTimeX();
+  if (rqp->txbytes > 0U) {
+    msg = i2cMasterTransmitTimeout(schp->i2cp, devp->addr,
+                                   rqp->txbuf, rqp->txbytes,
+                                   rqp->rxbuf, rqp->rxbytes,
+                                   rqp->timeout);
+  }
+  else {
+    msg = i2cMasterReceiveTimeout(schp->i2cp, devp->addr,
+                                  rqp->rxbuf, rqp->rxbytes,
+                                  rqp->timeout);
+  }
+  errors = msg == MSG_OK ? I2C_NO_ERROR : i2cGetErrors(schp->i2cp);
+  end = osalOsGetSystemTimeX();
+#if I2C_USE_MUTUAL_EXCLUSION == TRUE
+  i2cReleaseBus(schp->i2cp);
+#endif
+
+  osalSysLock();
+
+  /* The device can be served again, a serving thread is awakened if it
+     has more queued requests.*/
+  devp->active = NULL;
+  if (devp->head != NULL) {
+    osalThreadDequeueNextI(&schp->waiting, MSG_OK);
+  }
+
+  /* Bus occupancy and completion accounting.*/
+  schp->stats.busy += osalTimeDiffX(bus_start, end);
+  schp->stats.requests++;
+  if (msg != MSG_OK) {
+    schp->stats.errors++;
+  }
+  if ((rqp->deadline != TIME_INFINITE) &&
+      (osalTimeDiffX(rqp->submitted, end) > rqp->deadline)) {
+    schp->stats.deadline_misses++;
+  }
+
+  /* Completion notifications, the request object can be reused by the
+     callback.*/
+  rqp->status = msg;
+  rqp->errors = errors;
+  osalThreadResumeI(&rqp->thread, msg);
+  if (rqp->flags != (eventflags_t)0) {
+    osalEventBroadcastFlagsI(&schp->event, rqp->flags);
+  }
+  if (rqp->end_cb != NULL) {
+    rqp->end_cb(schp, rqp);
+  }
+  osalOsRescheduleS();
+
+  osalSysUnlock();
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Returns a copy of the scheduler statistics.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[out] statsp   pointer to the @p i2cs_stats_t object
+ *
+ * @iclass
+ */
+void i2csGetStatsI(I2CScheduler *schp, i2cs_stats_t *statsp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((schp != NULL) && (statsp != NULL));
+
+  *statsp = schp->stats;
+}
+
+#endif /* HAL_USE_I2C == TRUE */
+
+/** @} */
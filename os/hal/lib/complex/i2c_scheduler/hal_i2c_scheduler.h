@@ -0,0 +1,273 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_i2c_scheduler.h
+ * @brief   I2C transactions scheduler header.
+ *
+ * @addtogroup HAL_I2C_SCHEDULER
+ * @{
+ */
+
+#ifndef HAL_I2C_SCHEDULER_H
+#define HAL_I2C_SCHEDULER_H
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an I2C scheduler object.
+ */
+typedef struct i2c_scheduler I2CScheduler;
+
+/**
+ * @brief   Type of an I2C scheduler device.
+ */
+typedef struct i2cs_device i2cs_device_t;
+
+/**
+ * @brief   Type of an I2C scheduler request.
+ */
+typedef struct i2cs_request i2cs_request_t;
+
+/**
+ * @brief   Request end callback type.
+ * @note    The callback is invoked by the serving thread within a critical
+ *          zone, only I-class functions can be used.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @param[in] rqp       pointer to the completed request
+ */
+typedef void (*i2cscb_t)(I2CScheduler *schp, i2cs_request_t *rqp);
+
+/**
+ * @brief   Structure representing an I2C request.
+ * @details A request is a write, a read or a write followed by a read
+ *          addressed to a device.
+ */
+struct i2cs_request {
+  /**
+   * @brief   Next request in the device queue.
+   */
+  i2cs_request_t            *next;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief   Number of bytes to be transmitted.
+   */
+  size_t                    txbytes;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief   Number of bytes to be received.
+   */
+  size_t                    rxbytes;
+  /**
+   * @brief   Relative deadline or @p TIME_INFINITE.
+   * @details Among devices of equal priority the request with the earliest
+   *          deadline is served first.
+   */
+  sysinterval_t             deadline;
+  /**
+   * @brief   Transfer timeout.
+   */
+  sysinterval_t             timeout;
+  /**
+   * @brief   Request end callback or @p NULL.
+   */
+  i2cscb_t                  end_cb;
+  /**
+   * @brief   Flags broadcast on the scheduler event source on completion.
+   */
+  eventflags_t              flags;
+  /**
+   * @brief   Application parameter.
+   */
+  void                      *arg;
+  /**
+   * @brief   Request result.
+   */
+  msg_t                     status;
+  /**
+   * @brief   I2C errors of a failed request.
+   */
+  i2cflags_t                errors;
+  /**
+   * @brief   System time of submission.
+   */
+  systime_t                 submitted;
+  /**
+   * @brief   Thread waiting for completion or @p NULL.
+   */
+  thread_reference_t        thread;
+};
+
+/**
+ * @brief   Structure representing a device on a scheduled bus.
+ * @details Each device owns a FIFO queue of requests, requests addressed
+ *          to the same device are never reordered. A device is not served
+ *          again until its current transfer has completed, also when there
+ *          are multiple serving threads.
+ */
+struct i2cs_device {
+  /**
+   * @brief   Next device on the bus.
+   */
+  i2cs_device_t             *next;
+  /**
+   * @brief   Device slave address.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief   Device priority, higher values are served first.
+   */
+  uint32_t                  prio;
+  /**
+   * @brief   Head of the requests queue.
+   */
+  i2cs_request_t            *head;
+  /**
+   * @brief   Tail of the requests queue.
+   */
+  i2cs_request_t            *tail;
+  /**
+   * @brief   Request being transferred or @p NULL.
+   */
+  i2cs_request_t            *active;
+};
+
+/**
+ * @brief   I2C scheduler statistics.
+ * @note    Times are expressed in system ticks.
+ */
+typedef struct {
+  /**
+   * @brief   Completed requests.
+   */
+  uint32_t                  requests;
+  /**
+   * @brief   Failed requests.
+   */
+  uint32_t                  errors;
+  /**
+   * @brief   Requests completed after their deadline.
+   */
+  uint32_t                  deadline_misses;
+  /**
+   * @brief   Cumulative bus occupancy.
+   * @note    The time spent waiting for the bus mutex is not included.
+   */
+  sysinterval_t             busy;
+  /**
+   * @brief   Cumulative queueing latency.
+   */
+  sysinterval_t             latency_total;
+  /**
+   * @brief   Worst queueing latency.
+   */
+  sysinterval_t             latency_max;
+} i2cs_stats_t;
+
+/**
+ * @brief   Structure representing an I2C scheduler.
+ */
+struct i2c_scheduler {
+  /**
+   * @brief   Associated I2C driver.
+   */
+  I2CDriver                 *i2cp;
+  /**
+   * @brief   List of the registered devices.
+   */
+  i2cs_device_t             *devices;
+  /**
+   * @brief   Number of queued requests, not yet being transferred.
+   */
+  uint32_t                  pending;
+  /**
+   * @brief   Queue of the serving threads waiting for requests.
+   */
+  threads_queue_t           waiting;
+  /**
+   * @brief   Completion events source.
+   */
+  event_source_t            event;
+  /**
+   * @brief   Statistics.
+   */
+  i2cs_stats_t              stats;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the completion events source.
+ *
+ * @param[in] schp      pointer to the @p I2CScheduler object
+ * @return              Pointer to the @p event_source_t object.
+ *
+ * @xclass
+ */
+#define i2csGetEventSource(schp) (&(schp)->event)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void i2csObjectInit(I2CScheduler *schp, I2CDriver *i2cp);
+  void i2csDeviceObjectInit(I2CScheduler *schp, i2cs_device_t *devp,
+                            i2caddr_t addr, uint32_t prio);
+  void i2csSubmitI(I2CScheduler *schp, i2cs_device_t *devp,
+                   i2cs_request_t *rqp);
+  void i2csSubmit(I2CScheduler *schp, i2cs_device_t *devp,
+                  i2cs_request_t *rqp);
+  msg_t i2csSubmitAndWait(I2CScheduler *schp, i2cs_device_t *devp,
+                          i2cs_request_t *rqp);
+  msg_t i2csServe(I2CScheduler *schp, sysinterval_t timeout);
+  void i2csGetStatsI(I2CScheduler *schp, i2cs_stats_t *statsp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_I2C == TRUE */
+
+#endif /* HAL_I2C_SCHEDULER_H */
+
+/** @} */
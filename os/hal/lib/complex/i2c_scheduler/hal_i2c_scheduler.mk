@@ -0,0 +1,9 @@
+# List of all the I2C scheduler files.
+I2CSSRC := $(CHIBIOS)/os/hal/lib/complex/i2c_scheduler/hal_i2c_scheduler.c
+
+# Required include directories
+I2CSINC := $(CHIBIOS)/os/hal/lib/complex/i2c_scheduler
+
+# Shared variables
+ALLCSRC += $(I2CSSRC)
+ALLINC  += $(I2CSINC)
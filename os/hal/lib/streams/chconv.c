@@ -0,0 +1,1206 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chconv.c
+ * @brief   Numeric conversions shared by the formatter utilities.
+ *
+ * @addtogroup HAL_CHCONV
+ * @details Integer and floating point conversions used by @p chprintf()
+ *          and @p chscanf(). Parsers operate on a span of characters
+ *          delimited by an end pointer, no terminator is required.
+ *          Conversions to floating point are correctly rounded: values
+ *          with up to 15 significant digits and small exponents are
+ *          converted with a single exact floating point operation, other
+ *          values are approximated and then corrected by comparing them
+ *          exactly against the rounding boundaries. Accumulators keep
+ *          the first 19 significant digits, when the dropped digits are
+ *          needed to decide the rounding the span parsers compare all the
+ *          digits of the input, the accumulator functions can be off by
+ *          one unit in the last place in this case.
+ * @{
+ */
+
+#include <float.h>
+
+#include "hal.h"
+#include "chconv.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the integer comparisons in 32 bits words.
+ * @note    Inputs are range-checked so that the largest comparison, close
+ *          to the smallest double, takes less than 900 bits.
+ */
+#define BIG_WORDS                   40U
+
+/**
+ * @brief   Exponent saturation for the accumulators.
+ */
+#define FNUM_EXP_MAX                100000L
+
+/**
+ * @brief   Maximum precision of @p ch_ftoa().
+ */
+#define FTOA_PRECISION              9U
+
+/**
+ * @brief   Floating point expressions are evaluated in their own type.
+ * @details When true, a single operation on exact operands is correctly
+ *          rounded, this enables the fast conversion paths. It is false,
+ *          for example, on x87 FPUs using extended precision.
+ */
+#if (defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)) ||                 \
+    defined(__DOXYGEN__)
+#define FNUM_EXACT_FAST_PATH        TRUE
+#else
+#define FNUM_EXACT_FAST_PATH        FALSE
+#endif
+
+/**
+ * @brief   Kind of a parsed floating point token.
+ */
+#define FNUM_NUMBER                 0U
+#define FNUM_INFINITY               1U
+#define FNUM_NAN                    2U
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   IEEE 754 binary format parameters.
+ */
+typedef struct {
+  unsigned                  mantbits;
+  unsigned                  expbits;
+} ieee_format_t;
+
+/**
+ * @brief   Significand of a decimal number in its source span.
+ */
+typedef struct {
+  /**
+   * @brief   First character of the significand.
+   */
+  const char                *p;
+  /**
+   * @brief   End of the significand.
+   */
+  const char                *end;
+  /**
+   * @brief   Explicit exponent.
+   */
+  int32_t                   exp;
+} fnum_digits_t;
+
+/**
+ * @brief   Reader of the significant digits of a decimal number.
+ */
+typedef struct {
+  const char                *p;
+  const char                *end;
+  /**
+   * @brief   Implicit zeros preceding the remaining digits.
+   */
+  int32_t                   zeros;
+} digits_reader_t;
+
+/**
+ * @brief   Unsigned integer used for exact comparisons.
+ */
+typedef struct {
+  uint32_t                  w[BIG_WORDS];
+  unsigned                  n;
+} bigint_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static const ieee_format_t float_format = {23U, 8U};
+
+#if (DBL_MANT_DIG == 53) || defined(__DOXYGEN__)
+static const ieee_format_t double_format = {52U, 11U};
+#endif
+
+/**
+ * @brief   Powers of ten exactly representable as doubles.
+ */
+static const double pow10_tab[23] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#if (FNUM_EXACT_FAST_PATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Powers of ten exactly representable as floats.
+ */
+static const float pow10f_tab[11] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+#endif
+
+/**
+ * @brief   Powers of five fitting 32 bits.
+ */
+static const uint32_t pow5_tab[14] = {
+  1U, 5U, 25U, 125U, 625U, 3125U, 15625U, 78125U, 390625U, 1953125U,
+  9765625U, 48828125U, 244140625U, 1220703125U
+};
+
+/**
+ * @brief   Fractional digits scaling of @p ch_ftoa().
+ */
+static const unsigned long ftoa_pow10[FTOA_PRECISION] = {
+  10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL,
+  100000000UL, 1000000000UL
+};
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static void big_set(bigint_t *bp, uint64_t v) {
+
+  bp->w[0] = (uint32_t)v;
+  bp->w[1] = (uint32_t)(v >> 32);
+  bp->n    = bp->w[1] != 0U ? 2U : 1U;
+}
+
+static void big_mul32(bigint_t *bp, uint32_t m) {
+  uint64_t carry = 0U;
+  unsigned i;
+
+  for (i = 0U; i < bp->n; i++) {
+    carry += (uint64_t)bp->w[i] * m;
+    bp->w[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if ((carry != 0U) && (bp->n < BIG_WORDS)) {
+    bp->w[bp->n++] = (uint32_t)carry;
+  }
+}
+
+static void big_add32(bigint_t *bp, uint32_t a) {
+  uint64_t carry = a;
+  unsigned i;
+
+  for (i = 0U; (i < bp->n) && (carry != 0U); i++) {
+    carry += bp->w[i];
+    bp->w[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if ((carry != 0U) && (bp->n < BIG_WORDS)) {
+    bp->w[bp->n++] = (uint32_t)carry;
+  }
+}
+
+/**
+ * @brief   Splits a number in its bits above and below a position.
+ *
+ * @param[in,out] bp    the number, only the bits below @p s are kept
+ * @param[in] s         the bit position
+ * @return              The bits above @p s, they must fit 32 bits.
+ */
+static uint32_t big_split(bigint_t *bp, unsigned s) {
+  unsigned wi = s / 32U;
+  unsigned bi = s % 32U;
+  uint64_t v = 0U;
+
+  if (wi < bp->n) {
+    v = (uint64_t)bp->w[wi] >> bi;
+    if ((bi != 0U) && (wi + 1U < bp->n)) {
+      v |= (uint64_t)bp->w[wi + 1U] << (32U - bi);
+    }
+    bp->w[wi] &= bi != 0U ? ((uint32_t)1 << bi) - 1U : 0U;
+    bp->n = wi + 1U;
+    while ((bp->n > 1U) && (bp->w[bp->n - 1U] == 0U)) {
+      bp->n--;
+    }
+  }
+
+  return (uint32_t)v;
+}
+
+static bool big_is_zero(const bigint_t *bp) {
+
+  return (bp->n == 1U) && (bp->w[0] == 0U);
+}
+
+static void big_mul_pow5(bigint_t *bp, unsigned e) {
+
+  while (e >= 13U) {
+    big_mul32(bp, pow5_tab[13]);
+    e -= 13U;
+  }
+  if (e > 0U) {
+    big_mul32(bp, pow5_tab[e]);
+  }
+}
+
+static void big_shl(bigint_t *bp, unsigned s) {
+  unsigned words = s / 32U;
+  unsigned bits = s % 32U;
+  unsigned i;
+
+  if (bits != 0U) {
+    uint32_t carry = 0U;
+
+    for (i = 0U; i < bp->n; i++) {
+      uint32_t w = bp->w[i];
+
+      bp->w[i] = (w << bits) | carry;
+      carry = w >> (32U - bits);
+    }
+    if ((carry != 0U) && (bp->n < BIG_WORDS)) {
+      bp->w[bp->n++] = carry;
+    }
+  }
+  if (words > 0U) {
+    if (bp->n + words > BIG_WORDS) {
+      words = BIG_WORDS - bp->n;
+    }
+    for (i = bp->n; i > 0U; i--) {
+      bp->w[i - 1U + words] = bp->w[i - 1U];
+    }
+    for (i = 0U; i < words; i++) {
+      bp->w[i] = 0U;
+    }
+    bp->n += words;
+  }
+}
+
+static int big_cmp(const bigint_t *ap, const bigint_t *bp) {
+  unsigned i;
+
+  if (ap->n != bp->n) {
+    return ap->n > bp->n ? 1 : -1;
+  }
+  for (i = ap->n; i > 0U; i--) {
+    if (ap->w[i - 1U] != bp->w[i - 1U]) {
+      return ap->w[i - 1U] > bp->w[i - 1U] ? 1 : -1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Returns the point halfway between a floating point number and
+ *          the next one.
+ *
+ * @param[in] ffp       target format
+ * @param[in] bits      binary representation of the floating point number
+ * @param[out] hp       halfway point significand
+ * @return              The halfway point binary exponent.
+ */
+static int32_t fnum_halfway(const ieee_format_t *ffp, uint64_t bits,
+                            uint64_t *hp) {
+  uint64_t mb;
+  int32_t e;
+  int32_t bias = ((int32_t)1 << (ffp->expbits - 1U)) - 1;
+  uint32_t ef = (uint32_t)(bits >> ffp->mantbits);
+
+  /* Floating point number as mb * 2^e, the halfway point is
+     (2 * mb + 1) * 2^(e - 1).*/
+  mb = bits & (((uint64_t)1 << ffp->mantbits) - 1U);
+  if (ef == 0U) {
+    e = 1 - bias - (int32_t)ffp->mantbits;
+  }
+  else {
+    mb |= (uint64_t)1 << ffp->mantbits;
+    e = (int32_t)ef - bias - (int32_t)ffp->mantbits;
+  }
+  *hp = (2U * mb) + 1U;
+
+  return e - 1;
+}
+
+/**
+ * @brief   Compares the accumulated value with the point halfway between
+ *          a floating point number and the next one.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] ffp       target format
+ * @param[in] bits      binary representation of the floating point number
+ * @param[in] halves    halves of unit added to the accumulated significand,
+ *                      from zero to two
+ * @return              The sign of the difference.
+ */
+static int fnum_cmp_halfway(const ch_fnum_t *fp, const ieee_format_t *ffp,
+                            uint64_t bits, unsigned halves) {
+  bigint_t a, b;
+  uint64_t h;
+  int32_t e2a, e2b, e5;
+
+  e2b = fnum_halfway(ffp, bits, &h);
+  big_set(&b, h);
+
+  /* Accumulated value as mant * 2^e2a * 5^e5.*/
+  e2a = fp->exp;
+  e5  = fp->base == 16U ? 0 : fp->exp;
+  if (halves == 1U) {
+    big_set(&a, fp->mant);
+    big_shl(&a, 1U);
+    a.w[0] |= 1U;
+    e2a -= 1;
+  }
+  else {
+    big_set(&a, fp->mant + (halves / 2U));
+  }
+
+  /* Bringing both to integers with the same scale.*/
+  if (e5 > 0) {
+    big_mul_pow5(&a, (unsigned)e5);
+  }
+  else {
+    big_mul_pow5(&b, (unsigned)-e5);
+  }
+  if (e2a > e2b) {
+    big_shl(&a, (unsigned)(e2a - e2b));
+  }
+  else {
+    big_shl(&b, (unsigned)(e2b - e2a));
+  }
+
+  return big_cmp(&a, &b);
+}
+
+/**
+ * @brief   Starts reading the significant digits of a decimal number.
+ *
+ * @param[in] dsp       the number significand
+ * @param[out] rp       the reader
+ * @return              The decimal exponent @p dp of the number expressed
+ *                      as 0.d1d2d3... * 10^dp, where d1 is not zero.
+ */
+static int32_t digits_start(const fnum_digits_t *dsp, digits_reader_t *rp) {
+  const char *p = dsp->p;
+  int32_t dp = 0;
+  bool frac = false;
+
+  while ((p < dsp->end) && ((*p == '0') || (*p == '.'))) {
+    if (*p == '.') {
+      frac = true;
+    }
+    else if (frac) {
+      dp--;
+    }
+    p++;
+  }
+  rp->p     = p;
+  rp->end   = dsp->end;
+  rp->zeros = 0;
+  if (!frac) {
+    while ((p < dsp->end) && (*p != '.')) {
+      dp++;
+      p++;
+    }
+  }
+
+  return dp + dsp->exp;
+}
+
+/**
+ * @brief   Returns the next digit, zero after the last one.
+ */
+static unsigned digits_next(digits_reader_t *rp) {
+
+  if (rp->zeros > 0) {
+    rp->zeros--;
+    return 0U;
+  }
+  while (rp->p < rp->end) {
+    char c = *rp->p++;
+
+    if (c != '.') {
+      return (unsigned)c - (unsigned)'0';
+    }
+  }
+
+  return 0U;
+}
+
+/**
+ * @brief   Checks for non-zero digits left.
+ */
+static bool digits_nonzero(digits_reader_t *rp) {
+
+  while (rp->p < rp->end) {
+    char c = *rp->p++;
+
+    if ((c != '.') && (c != '0')) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Compares all the digits of a decimal number with the point
+ *          halfway between a floating point number and the next one.
+ * @details The decimal expansion of the halfway point is generated nine
+ *          digits at time and compared with the input digits, their
+ *          number is not limited.
+ *
+ * @param[in] dsp       the number significand
+ * @param[in] ffp       target format
+ * @param[in] bits      binary representation of the floating point number
+ * @return              The sign of the difference.
+ */
+static int digits_cmp_halfway(const fnum_digits_t *dsp,
+                              const ieee_format_t *ffp, uint64_t bits) {
+  digits_reader_t r;
+  bigint_t a, b;
+  uint64_t h, u;
+  int32_t e, dp, i;
+  uint32_t hd, d;
+  unsigned s;
+  int c;
+
+  e  = fnum_halfway(ffp, bits, &h);
+  dp = digits_start(dsp, &r);
+
+  if (e >= 0) {
+    /* Integer halfway point, comparing the integer part of the number then
+       checking its fractional digits.*/
+    if (dp <= 0) {
+      return -1;
+    }
+    big_set(&a, 0U);
+    for (i = 0; i < dp; i++) {
+      big_mul32(&a, 10U);
+      big_add32(&a, digits_next(&r));
+    }
+    big_set(&b, h);
+    big_shl(&b, (unsigned)e);
+    c = big_cmp(&a, &b);
+    if (c != 0) {
+      return c;
+    }
+    return digits_nonzero(&r) ? 1 : 0;
+  }
+
+  /* Comparing the integer parts, the halfway point one is less than 2^55.*/
+  s = (unsigned)-e;
+  if (dp > 19) {
+    return 1;
+  }
+  u = 0U;
+  for (i = 0; i < dp; i++) {
+    u = (u * 10U) + digits_next(&r);
+  }
+  h = s < 64U ? h >> s : 0U;
+  if (u != h) {
+    return u > h ? 1 : -1;
+  }
+
+  /* Comparing the fractional parts, the halfway point one is f / 2^s.*/
+  if (dp < 0) {
+    r.zeros = -dp;
+  }
+  fnum_halfway(ffp, bits, &h);
+  big_set(&b, s < 64U ? h & (((uint64_t)1 << s) - 1U) : h);
+  while (!big_is_zero(&b)) {
+    big_mul32(&b, 1000000000U);
+    hd = big_split(&b, s);
+    d = 0U;
+    for (i = 0; i < 9; i++) {
+      d = (d * 10U) + digits_next(&r);
+    }
+    if (d != hd) {
+      return d > hd ? 1 : -1;
+    }
+  }
+
+  return digits_nonzero(&r) ? 1 : 0;
+}
+
+/**
+ * @brief   Compares the value with the point halfway between a floating
+ *          point number and the next one.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] dsp       the number digits or @p NULL if not available
+ * @param[in] ffp       target format
+ * @param[in] bits      binary representation of the floating point number
+ * @return              The sign of the difference.
+ */
+static int fnum_cmp(const ch_fnum_t *fp, const fnum_digits_t *dsp,
+                    const ieee_format_t *ffp, uint64_t bits) {
+
+  if (!fp->sticky) {
+    return fnum_cmp_halfway(fp, ffp, bits, 0U);
+  }
+
+  /* Hexadecimal significands keep at least 61 bits, the dropped digits
+     cannot straddle a halfway point and count as half unit.*/
+  if (fp->base == 16U) {
+    return fnum_cmp_halfway(fp, ffp, bits, 1U);
+  }
+
+  /* The exact value is strictly between the accumulated significand and
+     the next one, the dropped digits are only needed if the halfway point
+     is in between.*/
+  if (fnum_cmp_halfway(fp, ffp, bits, 0U) >= 0) {
+    return 1;
+  }
+  if (fnum_cmp_halfway(fp, ffp, bits, 2U) <= 0) {
+    return -1;
+  }
+  if (dsp != NULL) {
+    return digits_cmp_halfway(dsp, ffp, bits);
+  }
+  return fnum_cmp_halfway(fp, ffp, bits, 1U);
+}
+
+/**
+ * @brief   Checks the magnitude of the accumulated value.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] ffp       target format
+ * @return              The check result.
+ * @retval -1           if the value rounds to zero.
+ * @retval 1            if the value rounds to infinity.
+ * @retval 0            if the value must be converted.
+ */
+static int fnum_range(const ch_fnum_t *fp, const ieee_format_t *ffp) {
+  int32_t bias = ((int32_t)1 << (ffp->expbits - 1U)) - 1;
+  int32_t l = 0;
+  uint64_t m = fp->mant;
+
+  /* Binary logarithm estimate, within a couple of units, log2(5) is
+     approximated as 2378/1024.*/
+  while (m != 0U) {
+    l++;
+    m >>= 1;
+  }
+  l += fp->exp;
+  if (fp->base != 16U) {
+    l += (fp->exp * 2378) / 1024;
+  }
+
+  if (l > bias + 5) {
+    return 1;
+  }
+  if (l < -(bias + (int32_t)ffp->mantbits) - 4) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief   Approximates the accumulated value.
+ * @details The result is within a few units in the last place from the
+ *          exact value.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @return              The approximated value.
+ */
+static double fnum_approx(const ch_fnum_t *fp) {
+  double x = (double)fp->mant;
+  int32_t e = fp->exp;
+
+  if (fp->base == 16U) {
+    while (e > 60) {
+      x *= 0x1p60;
+      e -= 60;
+    }
+    while (e < -60) {
+      x *= 0x1p-60;
+      e += 60;
+    }
+    if (e >= 0) {
+      x *= (double)((uint64_t)1 << e);
+    }
+    else {
+      x /= (double)((uint64_t)1 << -e);
+    }
+  }
+  else {
+    while (e > 22) {
+      x *= 1e22;
+      e -= 22;
+    }
+    while (e < -22) {
+      x /= 1e22;
+      e += 22;
+    }
+    if (e >= 0) {
+      x *= pow10_tab[e];
+    }
+    else {
+      x /= pow10_tab[-e];
+    }
+  }
+
+  return x;
+}
+
+/**
+ * @brief   Correctly rounds the accumulated value.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] dsp       the number digits or @p NULL if not available
+ * @param[in] ffp       target format
+ * @param[in] bits      binary representation of an approximation
+ * @return              The binary representation of the nearest floating
+ *                      point number, ties to even.
+ */
+static uint64_t fnum_round(const ch_fnum_t *fp, const fnum_digits_t *dsp,
+                           const ieee_format_t *ffp, uint64_t bits) {
+  uint64_t inf = (((uint64_t)1 << ffp->expbits) - 1U) << ffp->mantbits;
+  int c;
+
+  if (bits >= inf) {
+    bits = inf - 1U;
+  }
+
+  /* Moving toward the value until it lies between the halfway points
+     around the candidate, the approximation is close so few iterations
+     are required.*/
+  while (true) {
+    c = fnum_cmp(fp, dsp, ffp, bits);
+    if ((c > 0) || ((c == 0) && ((bits & 1U) != 0U))) {
+      bits++;
+      if (bits == inf) {
+        break;
+      }
+      continue;
+    }
+    if (bits == 0U) {
+      break;
+    }
+    c = fnum_cmp(fp, dsp, ffp, bits - 1U);
+    if ((c < 0) || ((c == 0) && ((bits & 1U) != 0U))) {
+      bits--;
+      continue;
+    }
+    break;
+  }
+
+  return bits;
+}
+
+static const char *match_word(const char *p, const char *end,
+                              const char *word) {
+
+  while (*word != '\0') {
+    if ((p >= end) || (((unsigned)*p | 0x20U) != (unsigned)*word)) {
+      return NULL;
+    }
+    p++;
+    word++;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Parses a floating point number.
+ *
+ * @param[in] s         first character
+ * @param[in] end       end of the span
+ * @param[out] fp       accumulator receiving the number
+ * @param[out] dsp      significand span of the number
+ * @param[out] negp     sign of the number
+ * @param[out] kindp    kind of the number
+ * @return              Pointer after the last character of the number,
+ *                      @p s if there is no number.
+ */
+static const char *parse_float(const char *s, const char *end, ch_fnum_t *fp,
+                               fnum_digits_t *dsp, bool *negp,
+                               unsigned *kindp) {
+  const char *p = s, *q;
+  unsigned base = 10U;
+  bool frac = false, digits = false;
+  int d;
+
+  *negp  = false;
+  *kindp = FNUM_NUMBER;
+
+  if ((p < end) && ((*p == '+') || (*p == '-'))) {
+    *negp = *p == '-';
+    p++;
+  }
+
+  /* Special values.*/
+  q = match_word(p, end, "inf");
+  if (q != NULL) {
+    *kindp = FNUM_INFINITY;
+    p = match_word(q, end, "inity");
+    return p != NULL ? p : q;
+  }
+  q = match_word(p, end, "nan");
+  if (q != NULL) {
+    *kindp = FNUM_NAN;
+    return q;
+  }
+
+  /* Hexadecimal prefix, only if followed by a digit.*/
+  if ((end - p > 2) && (p[0] == '0') && ((p[1] | 0x20) == 'x')) {
+    q = p + 2;
+    if ((q < end) && (*q == '.')) {
+      q++;
+    }
+    if ((q < end) && (ch_digit_value(*q, 16U) >= 0)) {
+      base = 16U;
+      p += 2;
+    }
+  }
+
+  /* Significand.*/
+  ch_fnum_init(fp, base);
+  dsp->p   = p;
+  dsp->exp = 0;
+  while (p < end) {
+    if ((*p == '.') && !frac) {
+      frac = true;
+    }
+    else {
+      d = ch_digit_value(*p, base);
+      if (d < 0) {
+        break;
+      }
+      ch_fnum_add_digit(fp, (unsigned)d, frac);
+      digits = true;
+    }
+    p++;
+  }
+  if (!digits) {
+    return s;
+  }
+  dsp->end = p;
+
+  /* Optional exponent, it is not consumed if not followed by digits.*/
+  if ((p < end) && (((unsigned)*p | 0x20U) == (base == 16U ? 'p' : 'e'))) {
+    long e = 0;
+    bool eneg = false;
+
+    q = p + 1;
+    if ((q < end) && ((*q == '+') || (*q == '-'))) {
+      eneg = *q == '-';
+      q++;
+    }
+    if ((q < end) && ((unsigned)*q - (unsigned)'0' < 10U)) {
+      do {
+        if (e < FNUM_EXP_MAX) {
+          e = (e * 10L) + (long)(*q - '0');
+        }
+        q++;
+      } while ((q < end) && ((unsigned)*q - (unsigned)'0' < 10U));
+      ch_fnum_add_exp(fp, eneg ? -e : e);
+      dsp->exp = (int32_t)(eneg ? -e : e);
+      p = q;
+    }
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Converts an accumulator to a float.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] dsp       the number digits or @p NULL if not available
+ * @return              The correctly rounded value.
+ */
+static float fnum_to_float(const ch_fnum_t *fp, const fnum_digits_t *dsp) {
+  union {
+    float           f;
+    uint32_t        u;
+  } v;
+  int r;
+
+  if (fp->mant == 0U) {
+    return 0.0f;
+  }
+
+#if FNUM_EXACT_FAST_PATH == TRUE
+  if ((fp->base == 10U) && !fp->sticky && (fp->mant <= ((uint64_t)1 << 24)) &&
+      (fp->exp >= -10) && (fp->exp <= 10)) {
+    if (fp->exp >= 0) {
+      return (float)fp->mant * pow10f_tab[fp->exp];
+    }
+    return (float)fp->mant / pow10f_tab[-fp->exp];
+  }
+#endif
+
+  r = fnum_range(fp, &float_format);
+  if (r < 0) {
+    return 0.0f;
+  }
+  if (r > 0) {
+    v.u = 0x7F800000U;
+    return v.f;
+  }
+
+  v.f = (float)fnum_approx(fp);
+  v.u = (uint32_t)fnum_round(fp, dsp, &float_format, (uint64_t)v.u);
+
+  return v.f;
+}
+
+/**
+ * @brief   Converts an accumulator to a double.
+ *
+ * @param[in] fp        pointer to the accumulator
+ * @param[in] dsp       the number digits or @p NULL if not available
+ * @return              The correctly rounded value.
+ */
+static double fnum_to_double(const ch_fnum_t *fp, const fnum_digits_t *dsp) {
+#if (DBL_MANT_DIG == 53) || defined(__DOXYGEN__)
+  union {
+    double          d;
+    uint64_t        u;
+  } v;
+  int r;
+
+  if (fp->mant == 0U) {
+    return 0.0;
+  }
+
+#if FNUM_EXACT_FAST_PATH == TRUE
+  if ((fp->base == 10U) && !fp->sticky && (fp->mant <= ((uint64_t)1 << 53)) &&
+      (fp->exp >= -22) && (fp->exp <= 22)) {
+    if (fp->exp >= 0) {
+      return (double)fp->mant * pow10_tab[fp->exp];
+    }
+    return (double)fp->mant / pow10_tab[-fp->exp];
+  }
+#endif
+
+  r = fnum_range(fp, &double_format);
+  if (r < 0) {
+    return 0.0;
+  }
+  if (r > 0) {
+    v.u = 0x7FF0000000000000U;
+    return v.d;
+  }
+
+  v.d = fnum_approx(fp);
+  v.u = fnum_round(fp, dsp, &double_format, v.u);
+
+  return v.d;
+#else
+  /* Double is not wider than float on this target.*/
+  return (double)fnum_to_float(fp, dsp);
+#endif
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts an unsigned long to a string.
+ * @note    The output is not terminated.
+ *
+ * @param[out] p        pointer to the output buffer
+ * @param[in] num       the number to be converted
+ * @param[in] radix     the radix, from 2 to 16
+ * @param[in] digits    minimum number of digits, leading zeros are added
+ *                      if required
+ * @return              Pointer after the last written character.
+ */
+char *ch_ultoa(char *p, unsigned long num, unsigned radix, unsigned digits) {
+  char buf[sizeof (unsigned long) * 8U];
+  char *q = buf + sizeof buf;
+  unsigned i;
+
+  if (radix == 10U) {
+    /* Division by a constant, compilers turn it into a multiplication.*/
+    do {
+      unsigned long r = num / 10UL;
+
+      *--q = (char)('0' + (num - (r * 10UL)));
+      num = r;
+    } while (num != 0UL);
+  }
+  else if ((radix & (radix - 1U)) == 0U) {
+    unsigned shift = radix == 16U ? 4U : radix == 8U ? 3U :
+                     radix == 4U ? 2U : 1U;
+
+    do {
+      i = (unsigned)(num & (radix - 1U));
+      *--q = (char)(i < 10U ? '0' + i : 'A' - 10U + i);
+      num >>= shift;
+    } while (num != 0UL);
+  }
+  else {
+    do {
+      i = (unsigned)(num % radix);
+      *--q = (char)(i < 10U ? '0' + i : 'A' - 10U + i);
+      num /= radix;
+    } while (num != 0UL);
+  }
+
+  while ((q > buf) && ((unsigned)(buf + sizeof buf - q) < digits)) {
+    *--q = '0';
+  }
+  while (q < buf + sizeof buf) {
+    *p++ = *q++;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Converts a double to a fixed point string.
+ * @note    The output is not terminated.
+ * @note    Fractional digits are truncated, not rounded.
+ *
+ * @param[out] p        pointer to the output buffer
+ * @param[in] num       the number to be converted, its integer part must
+ *                      fit an unsigned long
+ * @param[in] precision number of fractional digits, zero or values greater
+ *                      than nine mean nine digits
+ * @return              Pointer after the last written character.
+ */
+char *ch_ftoa(char *p, double num, unsigned precision) {
+  unsigned long l;
+
+  if (num < 0.0) {
+    *p++ = '-';
+    num = -num;
+  }
+  if ((precision == 0U) || (precision > FTOA_PRECISION)) {
+    precision = FTOA_PRECISION;
+  }
+
+  l = (unsigned long)num;
+  p = ch_ultoa(p, l, 10U, 1U);
+  *p++ = '.';
+  l = (unsigned long)((num - (double)l) * (double)ftoa_pow10[precision - 1U]);
+
+  return ch_ultoa(p, l, 10U, precision);
+}
+
+/**
+ * @brief   Converts a span of characters to an unsigned long.
+ * @details The syntax is that of @p strtoul() except that leading white
+ *          spaces are not skipped: an optional sign followed by digits,
+ *          with base 16 an optional "0x" prefix is accepted, with base 0
+ *          the base is inferred from the prefix. A minus sign negates
+ *          the result in unsigned arithmetic, overflows wrap around.
+ *
+ * @param[in] s         first character
+ * @param[in] end       end of the span
+ * @param[out] endp     pointer after the last character of the number or
+ *                      @p s if there is no number, can be @p NULL
+ * @param[in] base      the base, 0 or from 2 to 36
+ * @return              The converted number, zero if there is no number.
+ */
+unsigned long ch_strntoul(const char *s, const char *end,
+                          const char **endp, unsigned base) {
+  const char *p = s, *start;
+  unsigned long v = 0UL;
+  bool neg = false;
+  int d;
+
+  if ((p < end) && ((*p == '+') || (*p == '-'))) {
+    neg = *p == '-';
+    p++;
+  }
+
+  if (((base == 0U) || (base == 16U)) && (p < end) && (*p == '0')) {
+    if ((end - p > 2) && ((p[1] | 0x20) == 'x') &&
+        (ch_digit_value(p[2], 16U) >= 0)) {
+      base = 16U;
+      p += 2;
+    }
+    else if (base == 0U) {
+      base = 8U;
+    }
+  }
+  else if (base == 0U) {
+    base = 10U;
+  }
+
+  start = p;
+  if (base == 10U) {
+    unsigned c;
+
+    while ((p < end) && ((c = (unsigned)*p - (unsigned)'0') < 10U)) {
+      v = (v * 10UL) + c;
+      p++;
+    }
+  }
+  else {
+    while ((p < end) && ((d = ch_digit_value(*p, base)) >= 0)) {
+      v = (v * base) + (unsigned long)d;
+      p++;
+    }
+  }
+
+  if (p == start) {
+    p = s;
+  }
+  if (endp != NULL) {
+    *endp = p;
+  }
+
+  return neg ? 0UL - v : v;
+}
+
+/**
+ * @brief   Adds to the exponent of a floating point number accumulator.
+ * @details For decimal numbers the exponent is a power of ten, for
+ *          hexadecimal numbers it is a power of two.
+ *
+ * @param[in,out] fp    pointer to a @p ch_fnum_t structure
+ * @param[in] exp       the exponent
+ */
+void ch_fnum_add_exp(ch_fnum_t *fp, long exp) {
+  long e = (long)fp->exp + exp;
+
+  if (e > FNUM_EXP_MAX) {
+    e = FNUM_EXP_MAX;
+  }
+  else if (e < -FNUM_EXP_MAX) {
+    e = -FNUM_EXP_MAX;
+  }
+  fp->exp = (int32_t)e;
+}
+
+/**
+ * @brief   Converts an accumulator to a float.
+ *
+ * @param[in] fp        pointer to a @p ch_fnum_t structure
+ * @return              The correctly rounded value.
+ */
+float ch_fnum_to_float(const ch_fnum_t *fp) {
+
+  return fnum_to_float(fp, NULL);
+}
+
+/**
+ * @brief   Converts an accumulator to a double.
+ *
+ * @param[in] fp        pointer to a @p ch_fnum_t structure
+ * @return              The correctly rounded value.
+ */
+double ch_fnum_to_double(const ch_fnum_t *fp) {
+
+  return fnum_to_double(fp, NULL);
+}
+
+/**
+ * @brief   Converts a span of characters to a float.
+ * @details The syntax is that of @p strtof() except that leading white
+ *          spaces are not skipped: an optional sign followed by a decimal
+ *          number with optional exponent, a hexadecimal number with
+ *          optional binary exponent, "inf", "infinity" or "nan", case
+ *          insensitive.
+ *
+ * @param[in] s         first character
+ * @param[in] end       end of the span
+ * @param[out] endp     pointer after the last character of the number or
+ *                      @p s if there is no number, can be @p NULL
+ * @return              The correctly rounded number, zero if there is no
+ *                      number.
+ */
+float ch_strntof(const char *s, const char *end, const char **endp) {
+  union {
+    float           f;
+    uint32_t        u;
+  } v;
+  ch_fnum_t fnum;
+  fnum_digits_t digits;
+  bool neg;
+  unsigned kind;
+  const char *p;
+
+  p = parse_float(s, end, &fnum, &digits, &neg, &kind);
+  if (endp != NULL) {
+    *endp = p;
+  }
+  if (p == s) {
+    return 0.0f;
+  }
+
+  if (kind == FNUM_INFINITY) {
+    v.u = 0x7F800000U;
+  }
+  else if (kind == FNUM_NAN) {
+    v.u = 0x7FC00000U;
+  }
+  else {
+    v.f = fnum_to_float(&fnum, &digits);
+  }
+
+  return neg ? -v.f : v.f;
+}
+
+/**
+ * @brief   Converts a span of characters to a double.
+ * @details The syntax is that of @p strtod() except that leading white
+ *          spaces are not skipped, see @p ch_strntof().
+ *
+ * @param[in] s         first character
+ * @param[in] end       end of the span
+ * @param[out] endp     pointer after the last character of the number or
+ *                      @p s if there is no number, can be @p NULL
+ * @return              The correctly rounded number, zero if there is no
+ *                      number.
+ */
+double ch_strntod(const char *s, const char *end, const char **endp) {
+#if (DBL_MANT_DIG == 53) || defined(__DOXYGEN__)
+  union {
+    double          d;
+    uint64_t        u;
+  } v;
+  ch_fnum_t fnum;
+  fnum_digits_t digits;
+  bool neg;
+  unsigned kind;
+  const char *p;
+
+  p = parse_float(s, end, &fnum, &digits, &neg, &kind);
+  if (endp != NULL) {
+    *endp = p;
+  }
+  if (p == s) {
+    return 0.0;
+  }
+
+  if (kind == FNUM_INFINITY) {
+    v.u = 0x7FF0000000000000U;
+  }
+  else if (kind == FNUM_NAN) {
+    v.u = 0x7FF8000000000000U;
+  }
+  else {
+    v.d = fnum_to_double(&fnum, &digits);
+  }
+
+  return neg ? -v.d : v.d;
+#else
+  return (double)ch_strntof(s, end, endp);
+#endif
+}
+
+/** @} */
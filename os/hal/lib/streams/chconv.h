@@ -0,0 +1,188 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chconv.h
+ * @brief   Numeric conversions shared by the formatter utilities.
+ *
+ * @addtogroup HAL_CHCONV
+ * @{
+ */
+
+#ifndef CHCONV_H
+#define CHCONV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum significant digits kept by a @p ch_fnum_t accumulator.
+ * @note    Further digits only contribute to rounding.
+ */
+#define CH_FNUM_DEC_DIGITS          19U
+
+/**
+ * @brief   Maximum significant hexadecimal digits kept by a @p ch_fnum_t
+ *          accumulator.
+ */
+#define CH_FNUM_HEX_DIGITS          16U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Floating point number accumulator.
+ * @details Digits of a decimal or hexadecimal floating point number are
+ *          accumulated exactly, the conversion to a @p float or @p double
+ *          happens once at the end and is correctly rounded.
+ */
+typedef struct {
+  /**
+   * @brief   Significant digits.
+   */
+  uint64_t                  mant;
+  /**
+   * @brief   Exponent to be applied to @p mant, it is a power of ten for
+   *          decimal numbers and a power of two for hexadecimal numbers.
+   */
+  int32_t                   exp;
+  /**
+   * @brief   Number base, 10 or 16.
+   */
+  uint8_t                   base;
+  /**
+   * @brief   Number of digits in @p mant.
+   */
+  uint8_t                   ndigits;
+  /**
+   * @brief   Non-zero digits have been dropped.
+   */
+  bool                      sticky;
+} ch_fnum_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  char *ch_ultoa(char *p, unsigned long num, unsigned radix, unsigned digits);
+  char *ch_ftoa(char *p, double num, unsigned precision);
+  unsigned long ch_strntoul(const char *s, const char *end,
+                            const char **endp, unsigned base);
+  void ch_fnum_add_exp(ch_fnum_t *fp, long exp);
+  float ch_fnum_to_float(const ch_fnum_t *fp);
+  double ch_fnum_to_double(const ch_fnum_t *fp);
+  float ch_strntof(const char *s, const char *end, const char **endp);
+  double ch_strntod(const char *s, const char *end, const char **endp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the value of a digit.
+ *
+ * @param[in] c         the character
+ * @param[in] base      the number base, from 2 to 36
+ * @return              The digit value or -1 if @p c is not a valid digit
+ *                      in the specified base.
+ */
+static inline int ch_digit_value(int c, unsigned base) {
+  unsigned d = (unsigned)c - (unsigned)'0';
+
+  if (d > 9U) {
+    d = ((unsigned)c | 0x20U) - (unsigned)'a';
+    d = d < 26U ? d + 10U : 36U;
+  }
+
+  return d < base ? (int)d : -1;
+}
+
+/**
+ * @brief   Initializes a floating point number accumulator.
+ *
+ * @param[out] fp       pointer to a @p ch_fnum_t structure
+ * @param[in] base      number base, 10 or 16
+ */
+static inline void ch_fnum_init(ch_fnum_t *fp, unsigned base) {
+
+  fp->mant    = 0U;
+  fp->exp     = 0;
+  fp->base    = (uint8_t)base;
+  fp->ndigits = 0U;
+  fp->sticky  = false;
+}
+
+/**
+ * @brief   Adds a digit to a floating point number accumulator.
+ *
+ * @param[in,out] fp    pointer to a @p ch_fnum_t structure
+ * @param[in] d         the digit value
+ * @param[in] frac      the digit is part of the fractional part
+ */
+static inline void ch_fnum_add_digit(ch_fnum_t *fp, unsigned d, bool frac) {
+  int32_t step = fp->base == 16U ? 4 : 1;
+
+  if ((fp->ndigits == 0U) && (d == 0U)) {
+    /* Leading zeros are not significant.*/
+    if (frac) {
+      fp->exp -= step;
+    }
+  }
+  else if (fp->ndigits < (fp->base == 16U ? CH_FNUM_HEX_DIGITS :
+                                              CH_FNUM_DEC_DIGITS)) {
+    fp->mant = (fp->mant * fp->base) + d;
+    fp->ndigits++;
+    if (frac) {
+      fp->exp -= step;
+    }
+  }
+  else {
+    if (d != 0U) {
+      fp->sticky = true;
+    }
+    if (!frac) {
+      fp->exp += step;
+    }
+  }
+}
+
+#endif /* CHCONV_H */
+
+/** @} */
@@ -31,70 +31,9 @@
 #include "hal.h"
 #include "chprintf.h"
 #include "memstreams.h"
+#include "chconv.h"
 
 #define MAX_FILLER 11
-#define FLOAT_PRECISION 9
-
-static char *long_to_string_with_divisor(char *p,
-                                         long num,
-                                         unsigned radix,
-                                         long divisor) {
-  int i;
-  char *q;
-  long l, ll;
-
-  l = num;
-  if (divisor == 0) {
-    ll = num;
-  } else {
-    ll = divisor;
-  }
-
-  q = p + MAX_FILLER;
-  do {
-    i = (int)(l % radix);
-    i += '0';
-    if (i > '9') {
-      i += 'A' - '0' - 10;
-    }
-    *--q = i;
-    l /= radix;
-  } while ((ll /= radix) != 0);
-
-  i = (int)(p + MAX_FILLER - q);
-  do
-    *p++ = *q++;
-  while (--i);
-
-  return p;
-}
-
-static char *ch_ltoa(char *p, long num, unsigned radix) {
-
-  return long_to_string_with_divisor(p, num, radix, 0);
-}
-
-#if CHPRINTF_USE_FLOAT
-static const long pow10[FLOAT_PRECISION] = {
-    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
-};
-
-static char *ftoa(char *p, double num, unsigned long precision) {
-  long l;
-
-  if ((precision == 0) || (precision > FLOAT_PRECISION)) {
-    precision = FLOAT_PRECISION;
-  }
-  precision = pow10[precision - 1];
-
-  l = (long)num;
-  p = long_to_string_with_divisor(p, l, 10, 0);
-  *p++ = '.';
-  l = (long)((num - l) * precision);
-
-  return long_to_string_with_divisor(p, l, 10, precision / 10);
-}
-#endif
 
 /**
  * @brief   System formatted output function.
@@ -128,6 +67,7 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
   int n = 0;
   bool is_long, left_align, do_sign;
   long l;
+  unsigned long u;
 #if CHPRINTF_USE_FLOAT
   float f;
   char tmpbuf[2*MAX_FILLER + 1];
@@ -258,13 +198,15 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       }
       if (l < 0) {
         *p++ = '-';
-        l = -l;
+        u = 0UL - (unsigned long)l;
       }
-      else
+      else {
         if (do_sign) {
           *p++ = '+';
         }
-      p = ch_ltoa(p, l, 10);
+        u = (unsigned long)l;
+      }
+      p = ch_ultoa(p, u, 10U, 1U);
       break;
 #if CHPRINTF_USE_FLOAT
     case 'f':
@@ -278,7 +220,7 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
           *p++ = '+';
         }
       }
-      p = ftoa(p, f, precision);
+      p = ch_ftoa(p, f, (unsigned)precision);
       break;
 #endif
     case 'X':
@@ -296,12 +238,12 @@ int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap) {
       c = 8;
 unsigned_common:
       if (is_long) {
-        l = va_arg(ap, unsigned long);
+        u = va_arg(ap, unsigned long);
       }
       else {
-        l = va_arg(ap, unsigned int);
+        u = va_arg(ap, unsigned int);
       }
-      p = ch_ltoa(p, l, c);
+      p = ch_ultoa(p, u, (unsigned)c, 1U);
       break;
     default:
       *p++ = c;
@@ -28,58 +28,23 @@
  */
 
 #include <ctype.h>
+#include <string.h>
 
 #include "hal.h"
 #include "chscanf.h"
-#include "memstreams.h"
+#include "chconv.h"
 
-static long sym_to_val(char sym, int base)
-{
-  sym = tolower(sym);
-  if (sym <= '7' && sym >= '0') {
-    return sym - '0';
-  }
-  switch (base) {
-  case 16:
-    if (sym <= 'f' && sym >= 'a') {
-      return (sym - 'a' + 0xa);
-    }
-    /* fallthrough */
-  case 10:
-    if (sym == '8') {
-      return 8;
-    }
-    if (sym == '9') {
-      return 9;
-    }
-    /* fallthrough */
-  default:
-    return -1;
-  }
-}
-
-#if CHSCANF_USE_FLOAT
-
-/* Custom mixed-type power function. The internal promotion of the result to a double
-   allows for a greater dynamic range than integral types. This function is mostly for
-   simplicity, to allow us to do floating point math without either requiring any
-   libc linkages, or actually having to write floating point algorithms ourselves */
-static inline double ch_mpow(double x, unsigned long y)
-{
-  double res = 1;
-
-  do {
-    if (y & 1) {
-      res *= x;
-    }
-    x *= x;
-  } while (y >>= 1);
+/**
+ * @brief   Skips white spaces in a span.
+ */
+static inline const char *skip_spaces(const char *p, const char *end) {
 
-  return res;
+  while ((p < end) && isspace((unsigned char)*p)) {
+    p++;
+  }
+  return p;
 }
 
-#endif
-
 /**
  * @brief   System formatted input function.
  * @details This function implements a minimal @p vscanf()-like functionality
@@ -96,6 +61,8 @@ static inline double ch_mpow(double x, unsigned long y)
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, <b>lf</b> double, if @p CHSCANF_USE_FLOAT is
+ *            enabled.
  *          .
  *
  * @param[in] chp       pointer to a @p BufferedStream implementing object
@@ -118,13 +85,12 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
   bool  is_long, is_signed, is_positive;
   long  vall, digit;
 #if CHSCANF_USE_FLOAT
-  long   exp;
-  double valf;
-  char   exp_char;
-  int    exp_base;
-  bool   exp_is_positive, initial_digit;
-  char*  match;
-  int    fixed_point;
+  long      exp;
+  double    valf;
+  char      exp_char;
+  bool      exp_is_positive, initial_digit;
+  char*     match;
+  ch_fnum_t fnum;
 #endif
 
   /* Peek the first character of the format string. If it is null,
@@ -213,7 +179,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
 
     case 'c':
       /* Not supporting wchar_t, is_long is just ignored */
-      if (width == 0) {
+      if (width == -1) {
         width = 1;
       }
       for (i = 0; i < width; ++i) {
@@ -271,10 +237,7 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
 
 #if CHSCANF_USE_FLOAT
     case 'f':
-      valf          = -1;
       exp_char      = 'e';
-      exp_base      = 10;
-      fixed_point   = 0;
       initial_digit = false;
       while (isspace(c)) {
         c = streamGet(chp);
@@ -375,54 +338,49 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
         if (c == 'x' || c == 'X') {
           base     = 16;
           exp_char = 'p';
-          exp_base = 2;
           c        = streamGet(chp);
           if (--width == 0) {
             streamUnget(chp, c);
             return n;
           }
         } else {
-          valf = 0;
+          initial_digit = true;
         }
       }
 
-      if (sym_to_val(c, base) != -1) {
-        valf = 0;
-      }
+      /* Digits are accumulated exactly, the conversion happens once at the
+         end and is correctly rounded.*/
+      ch_fnum_init(&fnum, base);
 
       while (width--) {
-        digit = sym_to_val(c, base);
+        digit = ch_digit_value(c, base);
         if (digit == -1) {
           break;
         }
-        valf = (valf * base) + (double)digit;
-        c    = streamGet(chp);
+        ch_fnum_add_digit(&fnum, (unsigned)digit, false);
+        initial_digit = true;
+        c = streamGet(chp);
       }
 
       if (c == '.') {
         c = streamGet(chp);
 
         while (width--) {
-          digit = sym_to_val(c, base);
+          digit = ch_digit_value(c, base);
           if (digit == -1) {
             break;
           }
-          if (valf == -1) {
-            valf = 0;
-          }
-          valf = (valf * base) + (double)digit;
-          ++fixed_point;
+          ch_fnum_add_digit(&fnum, (unsigned)digit, true);
+          initial_digit = true;
           c = streamGet(chp);
         }
       }
 
-      if (valf == -1.0) {
+      if (!initial_digit) {
         streamUnget(chp, c);
         return n;
       }
 
-      valf = valf / ch_mpow(base, fixed_point);
-
       if (tolower(c) == exp_char) {
         if (width-- == 0) {
           return n;
@@ -451,25 +409,29 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
          error (the consumed sequence cannot be converted to a floating-point number), with "r"
          remaining." (https://en.cppreference.com/w/c/io/fscanf)
         */
-        digit = sym_to_val(c, 10);
+        digit = ch_digit_value(c, 10);
         if (digit == -1) {
           streamUnget(chp, c);
           return n;
         }
         while (width--) {
           /* Even if the significand was hex, the exponent is decimal */
-          digit = sym_to_val(c, 10);
+          digit = ch_digit_value(c, 10);
           if (digit == -1) {
             break;
           }
-          exp = (exp * 10) + digit;
-          c   = streamGet(chp);
-        }
-        if (exp_is_positive) {
-          valf = valf * (double)ch_mpow(exp_base, exp);
-        } else {
-          valf = valf / (double)ch_mpow(exp_base, exp);
+          if (exp < 100000L) {
+            exp = (exp * 10) + digit;
+          }
+          c = streamGet(chp);
         }
+        ch_fnum_add_exp(&fnum, exp_is_positive ? exp : -exp);
+      }
+
+      if (is_long) {
+        valf = ch_fnum_to_double(&fnum);
+      } else {
+        valf = (double)ch_fnum_to_float(&fnum);
       }
 
     float_common:
@@ -630,12 +592,12 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
     vall = 0UL;
 
     /* If we don't have at least one additional eligible character, it's a matching failure */
-    if (sym_to_val(c, base) == -1) {
+    if (ch_digit_value(c, base) == -1) {
       break;
     }
 
     while (width--) {
-      digit = sym_to_val(c, base);
+      digit = ch_digit_value(c, base);
       if (digit == -1) {
         break;
       }
@@ -681,6 +643,8 @@ int chvscanf(BaseBufferedStream *chp, const char *fmt, va_list ap)
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, <b>lf</b> double, if @p CHSCANF_USE_FLOAT is
+ *            enabled.
  *          .
  *
  * @param[in] chp       pointer to a @p BufferedStream implementing object
@@ -707,6 +671,10 @@ int chscanf(BaseBufferedStream *chp, const char *fmt, ...)
 /**
  * @brief   System formatted input function.
  * @details This function implements a minimal @p snscanf()-like functionality.
+ *          The buffer is parsed in place, without an intermediate stream,
+ *          up to the first NUL or to @p size characters. Numbers are
+ *          converted with @p strtoul()/@p strtod() semantics on the
+ *          field, floats are correctly rounded.
  *          The general parameters format is: %[*][width][l|L]p
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
@@ -719,6 +687,8 @@ int chscanf(BaseBufferedStream *chp, const char *fmt, ...)
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, <b>lf</b> double, if @p CHSCANF_USE_FLOAT is
+ *            enabled.
  *          .
  *
  * @param[in] str       pointer to a buffer
@@ -748,6 +718,10 @@ int chsnscanf(char *str, size_t size, const char *fmt, ...)
 /**
  * @brief   System formatted input function.
  * @details This function implements a minimal @p vsnscanf()-like functionality.
+ *          The buffer is parsed in place, without an intermediate stream,
+ *          up to the first NUL or to @p size characters. Numbers are
+ *          converted with @p strtoul()/@p strtod() semantics on the
+ *          field, floats are correctly rounded.
  *          The general parameters format is: %[*][width][l|L]p
  *          The following parameter types (p) are supported:
  *          - <b>x</b> hexadecimal integer.
@@ -760,6 +734,8 @@ int chsnscanf(char *str, size_t size, const char *fmt, ...)
  *          - <b>U</b> decimal unsigned long.
  *          - <b>c</b> character.
  *          - <b>s</b> string.
+ *          - <b>f</b> float, <b>lf</b> double, if @p CHSCANF_USE_FLOAT is
+ *            enabled.
  *          .
  *
  * @param[in] str       pointer to a buffer
@@ -775,21 +751,182 @@ int chsnscanf(char *str, size_t size, const char *fmt, ...)
  */
 int chvsnscanf(char *str, size_t size, const char *fmt, va_list ap)
 {
-  MemoryStream   ms;
-  size_t         size_wo_nul;
+  const char    *p, *end, *lim, *q;
+  char          f;
+  int           width, i;
+  int           n = 0;
+  unsigned      base;
+  void*         buf;
+  bool          is_long, is_signed;
+  unsigned long vall;
+
+  /* The input is the span up to the first NUL or to the end of the
+     buffer, it is parsed in place.*/
+  p   = str;
+  end = size > 0U ? memchr(str, 0, size) : NULL;
+  if (end == NULL) {
+    end = str + size;
+  }
+
+  while ((f = *fmt++) != 0) {
+
+    if (isspace((unsigned char)f)) {
+      p = skip_spaces(p, end);
+      continue;
+    }
+
+    /* Literals, including %%, must match 1:1.*/
+    if ((f != '%') || (*fmt == '%')) {
+      if (f == '%') {
+        fmt++;
+      }
+      if ((p >= end) || (*p != f)) {
+        break;
+      }
+      p++;
+      continue;
+    }
+
+    f = *fmt++;
+    if (f == '*') {
+      buf = NULL;
+      f   = *fmt++;
+    } else {
+      buf = va_arg(ap, void*);
+    }
+
+    /* Parse the optional width specifier */
+    width = 0;
+    while (isdigit((unsigned char)f)) {
+      width = (width * 10) + (f - '0');
+      f     = *fmt++;
+    }
+
+    /* Parse the optional length specifier */
+    if (f == 'l' || f == 'L') {
+      is_long = true;
+      f       = *fmt++;
+    } else {
+      is_long = isupper((unsigned char)f);
+    }
+
+    if (f == 'c') {
+      if (width == 0) {
+        width = 1;
+      }
+      if (end - p < width) {
+        break;
+      }
+      if (buf) {
+        memcpy(buf, p, (size_t)width);
+      }
+      p += width;
+      ++n;
+      continue;
+    }
+
+    /* All the other conversions discard leading whitespace, the field is
+       limited by the width, if specified.*/
+    p   = skip_spaces(p, end);
+    lim = (width > 0) && (width < end - p) ? p + width : end;
+
+    if (f == 's') {
+      if (p >= lim) {
+        break;
+      }
+      q = p;
+      while ((q < lim) && !isspace((unsigned char)*q)) {
+        q++;
+      }
+      if (buf) {
+        i = (int)(q - p);
+        memcpy(buf, p, (size_t)i);
+        ((char*)buf)[i] = 0;
+      }
+      p = q;
+      ++n;
+      continue;
+    }
+
+#if CHSCANF_USE_FLOAT
+    if (f == 'f') {
+      if (is_long) {
+        double d = ch_strntod(p, lim, &q);
+
+        if (q == p) {
+          break;
+        }
+        if (buf) {
+          *(double*)buf = d;
+        }
+      } else {
+        float x = ch_strntof(p, lim, &q);
+
+        if (q == p) {
+          break;
+        }
+        if (buf) {
+          *(float*)buf = x;
+        }
+      }
+      p = q;
+      ++n;
+      continue;
+    }
+#endif
+
+    is_signed = true;
+    switch (f) {
+    case 'i':
+    case 'I':
+      base = 0U;
+      break;
+    case 'd':
+    case 'D':
+      base = 10U;
+      break;
+    case 'X':
+    case 'x':
+    case 'P':
+    case 'p':
+      is_signed = false;
+      base      = 16U;
+      break;
+    case 'U':
+    case 'u':
+      is_signed = false;
+      base      = 10U;
+      break;
+    case 'O':
+    case 'o':
+      is_signed = false;
+      base      = 8U;
+      break;
+    default:
+      return n;
+    }
 
-  if (size > 0)
-    size_wo_nul = size - 1;
-  else
-    size_wo_nul = 0;
+    vall = ch_strntoul(p, lim, &q, base);
+    if (q == p) {
+      break;
+    }
 
-  /* Memory stream object to be used as a string writer, reserving one
-     byte for the final zero. */
-  msObjectInit(&ms, (uint8_t*)str, size_wo_nul, 0);
+    if (buf) {
+      if (is_long && is_signed) {
+        *((signed long*)buf) = (signed long)vall;
+      } else if (is_long && !is_signed) {
+        *((unsigned long*)buf) = vall;
+      } else if (!is_long && is_signed) {
+        *((signed int*)buf) = (signed int)vall;
+      } else {
+        *((unsigned int*)buf) = (unsigned int)vall;
+      }
+    }
+    p = q;
+    ++n;
+  }
 
-  /* Performing the scan operation using the common code and
-     return number of receiving arguments successfully assigned. */
-  return chvscanf((BaseBufferedStream *)&ms, fmt, ap);
+  return n;
 }
 
 /** @} */
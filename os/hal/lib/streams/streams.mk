@@ -1,5 +1,6 @@
 # RT Shell files.
-STREAMSSRC = $(CHIBIOS)/os/hal/lib/streams/chprintf.c \
+STREAMSSRC = $(CHIBIOS)/os/hal/lib/streams/chconv.c \
+             $(CHIBIOS)/os/hal/lib/streams/chprintf.c \
              $(CHIBIOS)/os/hal/lib/streams/chscanf.c \
              $(CHIBIOS)/os/hal/lib/streams/memstreams.c \
              $(CHIBIOS)/os/hal/lib/streams/nullstreams.c \
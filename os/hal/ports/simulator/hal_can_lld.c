@@ -0,0 +1,425 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/hal_can_lld.c
+ * @brief   Simulator CAN subsystem low level driver source.
+ *
+ * @addtogroup CAN
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_CAN || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Mask of all the transmit mailboxes.
+ */
+#define CAN_SIM_TX_ALL              ((1U << CAN_TX_MAILBOXES) - 1U)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN1 driver identifier.
+ */
+#if (USE_SIM_CAN1 == TRUE) || defined(__DOXYGEN__)
+CANDriver CAND1;
+#endif
+
+/**
+ * @brief   CAN2 driver identifier.
+ */
+#if (USE_SIM_CAN2 == TRUE) || defined(__DOXYGEN__)
+CANDriver CAND2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Nodes attached to the virtual bus.
+ */
+static CANDriver * const sim_can_nodes[] = {
+#if USE_SIM_CAN1 == TRUE
+  &CAND1,
+#endif
+#if USE_SIM_CAN2 == TRUE
+  &CAND2,
+#endif
+};
+
+#define SIM_CAN_NODES   (sizeof sim_can_nodes / sizeof sim_can_nodes[0])
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Arbitration key of a frame, lower keys win the bus.
+ * @details The 11 bits base identifier is compared first, a standard
+ *          frame wins over an extended frame with the same base identifier.
+ *
+ * @param[in] ctfp      pointer to the CAN frame
+ * @return              The arbitration key.
+ */
+static uint32_t can_lld_key(const CANTxFrame *ctfp) {
+
+  if (ctfp->IDE) {
+    return (((uint32_t)ctfp->EID >> 18) << 19) | (1U << 18) |
+           ((uint32_t)ctfp->EID & 0x3FFFFU);
+  }
+  return (uint32_t)ctfp->SID << 19;
+}
+
+/**
+ * @brief   Pushes a frame into a node receive FIFO.
+ *
+ * @param[in] canp      pointer to the receiving @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame on the bus
+ * @param[in] now       reception time
+ * @return              The reception result.
+ * @retval false        if the FIFO overflowed and the frame was lost.
+ * @retval true         if the frame has been stored.
+ */
+static bool can_lld_push(CANDriver *canp, const CANTxFrame *ctfp,
+                         systime_t now) {
+  CANRxFrame *crfp;
+
+  if (canp->rx_count >= (size_t)SIM_CAN_RX_FIFO_SIZE) {
+    canp->rx_overflow = true;
+    return false;
+  }
+
+  crfp = &canp->rx_fifo[(canp->rx_head + canp->rx_count) %
+                        (size_t)SIM_CAN_RX_FIFO_SIZE];
+  canp->rx_count++;
+
+  crfp->FMI     = 0U;
+  crfp->TIME    = (uint16_t)now;
+  crfp->DLC     = ctfp->DLC;
+  crfp->RTR     = ctfp->RTR;
+  crfp->IDE     = ctfp->IDE;
+  if (ctfp->IDE) {
+    crfp->EID   = ctfp->EID;
+  }
+  else {
+    crfp->EID   = 0U;
+    crfp->SID   = ctfp->SID;
+  }
+  crfp->data64[0] = ctfp->data64[0];
+
+  return true;
+}
+
+/**
+ * @brief   Performs one bus arbitration round.
+ * @details The pending frame with the lowest arbitration key among all the
+ *          active nodes is delivered to the receiving nodes.
+ *
+ * @param[out] txdone   transmit mailboxes completed for each node
+ * @param[out] rxnew    new frames flags for each node
+ * @param[in] now       reception time
+ * @return              The arbitration result.
+ * @retval false        if no frames were pending.
+ * @retval true         if a frame has been delivered.
+ */
+static bool can_lld_arbitrate(uint32_t txdone[], bool rxnew[],
+                              systime_t now) {
+  CANDriver *canp;
+  const CANTxFrame *ctfp;
+  uint32_t key, best = 0xFFFFFFFFU;
+  unsigned i, mbx, node = 0U, bmbx = 0U;
+  bool found = false;
+
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    canp = sim_can_nodes[i];
+    if ((canp->state != CAN_READY) || (canp->tx_pending == 0U)) {
+      continue;
+    }
+    for (mbx = 0U; mbx < (unsigned)CAN_TX_MAILBOXES; mbx++) {
+      if ((canp->tx_pending & (1U << mbx)) != 0U) {
+        key = can_lld_key(&canp->tx_mbox[mbx]);
+        if (!found || (key < best)) {
+          found = true;
+          best  = key;
+          node  = i;
+          bmbx  = mbx;
+        }
+      }
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  /* Winner frame leaving its mailbox, frames are always acknowledged.*/
+  canp = sim_can_nodes[node];
+  ctfp = &canp->tx_mbox[bmbx];
+  canp->tx_pending &= ~(1U << bmbx);
+  txdone[node] |= CAN_MAILBOX_TO_MASK(bmbx + 1U);
+
+  /* Delivery to the listening nodes.*/
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    if (sim_can_nodes[i]->state != CAN_READY) {
+      continue;
+    }
+    if (i == node) {
+      if ((canp->config->mode & CAN_SIM_LOOPBACK) == 0U) {
+        continue;
+      }
+    }
+    else if ((canp->config->mode & CAN_SIM_SILENT) != 0U) {
+      continue;
+    }
+    rxnew[i] |= can_lld_push(sim_can_nodes[i], ctfp, now);
+  }
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level CAN driver initialization.
+ *
+ * @notapi
+ */
+void can_lld_init(void) {
+  unsigned i;
+
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    canObjectInit(sim_can_nodes[i]);
+    sim_can_nodes[i]->tx_pending  = 0U;
+    sim_can_nodes[i]->rx_head     = 0U;
+    sim_can_nodes[i]->rx_count    = 0U;
+    sim_can_nodes[i]->rx_overflow = false;
+  }
+}
+
+/**
+ * @brief   Configures and activates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_start(CANDriver *canp) {
+
+  osalDbgCheck(canp->config != NULL);
+
+  canp->tx_pending  = 0U;
+  canp->rx_head     = 0U;
+  canp->rx_count    = 0U;
+  canp->rx_overflow = false;
+}
+
+/**
+ * @brief   Deactivates the CAN peripheral.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_stop(CANDriver *canp) {
+
+  canp->tx_pending = 0U;
+  canp->rx_count   = 0U;
+}
+
+/**
+ * @brief   Determines whether a frame can be transmitted.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue space availability.
+ * @retval false        no space in the transmit queue.
+ * @retval true         transmit slot available.
+ *
+ * @notapi
+ */
+bool can_lld_is_tx_empty(CANDriver *canp, canmbx_t mailbox) {
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    return canp->tx_pending != CAN_SIM_TX_ALL;
+  }
+  return (canp->tx_pending & CAN_MAILBOX_TO_MASK(mailbox)) == 0U;
+}
+
+/**
+ * @brief   Inserts a frame into the transmit queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] ctfp      pointer to the CAN frame to be transmitted
+ * @param[in] mailbox   mailbox number,  @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @notapi
+ */
+void can_lld_transmit(CANDriver *canp,
+                      canmbx_t mailbox,
+                      const CANTxFrame *ctfp) {
+
+  if (mailbox == CAN_ANY_MAILBOX) {
+    mailbox = 1U;
+    while ((canp->tx_pending & CAN_MAILBOX_TO_MASK(mailbox)) != 0U) {
+      mailbox++;
+    }
+  }
+
+  canp->tx_mbox[mailbox - 1U] = *ctfp;
+  canp->tx_pending |= CAN_MAILBOX_TO_MASK(mailbox);
+}
+
+/**
+ * @brief   Determines whether a frame has been received.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ *
+ * @return              The queue status.
+ * @retval false        the receive queue is empty.
+ * @retval true         a frame is available.
+ *
+ * @notapi
+ */
+bool can_lld_is_rx_nonempty(CANDriver *canp, canmbx_t mailbox) {
+
+  (void)mailbox;
+
+  return canp->rx_count > 0U;
+}
+
+/**
+ * @brief   Receives a frame from the input queue.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number, @p CAN_ANY_MAILBOX for any mailbox
+ * @param[out] crfp     pointer to the buffer where the CAN frame is copied
+ *
+ * @notapi
+ */
+void can_lld_receive(CANDriver *canp,
+                     canmbx_t mailbox,
+                     CANRxFrame *crfp) {
+
+  (void)mailbox;
+
+  *crfp = canp->rx_fifo[canp->rx_head];
+  canp->rx_head = (canp->rx_head + 1U) % (size_t)SIM_CAN_RX_FIFO_SIZE;
+  canp->rx_count--;
+}
+
+/**
+ * @brief   Tries to abort an ongoing transmission.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number
+ *
+ * @notapi
+ */
+void can_lld_abort(CANDriver *canp,
+                   canmbx_t mailbox) {
+
+  canp->tx_pending &= ~CAN_MAILBOX_TO_MASK(mailbox);
+}
+
+#if CAN_USE_SLEEP_MODE || defined(__DOXYGEN__)
+/**
+ * @brief   Enters the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_sleep(CANDriver *canp) {
+
+  (void)canp;
+}
+
+/**
+ * @brief   Enforces leaving the sleep mode.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+void can_lld_wakeup(CANDriver *canp) {
+
+  (void)canp;
+}
+#endif /* CAN_USE_SLEEP_MODE */
+
+/**
+ * @brief   Delivers the pending transmissions on the virtual bus.
+ *
+ * @return              The interrupt status.
+ * @retval false        if no interrupt was pending.
+ * @retval true         if an interrupt has been served.
+ *
+ * @notapi
+ */
+bool can_lld_interrupt_pending(void) {
+  uint32_t txdone[SIM_CAN_NODES] = {0U};
+  bool rxnew[SIM_CAN_NODES] = {false};
+  systime_t now = osalOsGetSystemTimeX();
+  unsigned i;
+  bool b = false;
+
+  OSAL_IRQ_PROLOGUE();
+
+  while (can_lld_arbitrate(txdone, rxnew, now)) {
+    b = true;
+  }
+
+  for (i = 0U; i < SIM_CAN_NODES; i++) {
+    CANDriver *canp = sim_can_nodes[i];
+
+    if (canp->rx_overflow) {
+      canp->rx_overflow = false;
+      _can_error_isr(canp, CAN_OVERFLOW_ERROR);
+      b = true;
+    }
+    if (rxnew[i]) {
+      _can_rx_full_isr(canp, CAN_MAILBOX_TO_MASK(1U));
+    }
+    if (txdone[i] != 0U) {
+      _can_tx_empty_isr(canp, txdone[i]);
+    }
+  }
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_CAN */
+
+/** @} */
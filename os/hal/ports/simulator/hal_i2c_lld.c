@@ -0,0 +1,261 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/hal_i2c_lld.c
+ * @brief   Simulator I2C subsystem low level driver source.
+ *
+ * @addtogroup I2C
+ * @{
+ */
+
+#include "hal.h"
+
+#if HAL_USE_I2C || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   I2C1 driver identifier.
+ */
+#if (USE_SIM_I2C1 == TRUE) || defined(__DOXYGEN__)
+I2CDriver I2CD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Waits for the bus time of a transfer.
+ * @details Each byte takes nine bits including the acknowledge, plus one
+ *          bit for the start or restart condition and one for the stop.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] bytes     number of bytes on the bus including addresses
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The operation status.
+ * @retval MSG_OK       if the transfer time elapsed.
+ * @retval MSG_TIMEOUT  if the timeout expired first.
+ */
+static msg_t i2c_lld_bus_wait(I2CDriver *i2cp, size_t bytes,
+                              sysinterval_t timeout) {
+  sysinterval_t ticks;
+  uint32_t us;
+
+  if (i2cp->config->clock_speed == 0U) {
+    return MSG_OK;
+  }
+
+  us = (uint32_t)((((uint64_t)bytes * 9U + 2U) * 1000000U) /
+                  i2cp->config->clock_speed);
+  ticks = OSAL_US2I(us);
+  if ((timeout != TIME_INFINITE) && (ticks > timeout)) {
+    osalThreadSleepS(timeout);
+    return MSG_TIMEOUT;
+  }
+  if (ticks > (sysinterval_t)0) {
+    osalThreadSleepS(ticks);
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Returns the simulated slave at an address.
+ *
+ * @param[in] addr      slave address
+ * @return              The slave index.
+ * @retval -1           if there is no slave at the address.
+ */
+static int i2c_lld_slave(i2caddr_t addr) {
+
+  if ((addr < I2C_SIM_SLAVE_BASE) ||
+      (addr >= (I2C_SIM_SLAVE_BASE + I2C_SIM_NUM_SLAVES))) {
+    return -1;
+  }
+
+  return (int)(addr - I2C_SIM_SLAVE_BASE);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level I2C driver initialization.
+ *
+ * @notapi
+ */
+void i2c_lld_init(void) {
+
+#if USE_SIM_I2C1 == TRUE
+  i2cObjectInit(&I2CD1);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the I2C peripheral.
+ * @details The simulated slaves registers are cleared.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_start(I2CDriver *i2cp) {
+  unsigned i, j;
+
+  for (i = 0U; i < I2C_SIM_NUM_SLAVES; i++) {
+    for (j = 0U; j < 256U; j++) {
+      i2cp->regs[i][j] = 0U;
+    }
+    i2cp->index[i] = 0U;
+  }
+}
+
+/**
+ * @brief   Deactivates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_stop(I2CDriver *i2cp) {
+
+  (void)i2cp;
+}
+
+/**
+ * @brief   Receives data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                     uint8_t *rxbuf, size_t rxbytes,
+                                     sysinterval_t timeout) {
+  int n = i2c_lld_slave(addr);
+  msg_t msg;
+
+  if (n < 0) {
+    msg = i2c_lld_bus_wait(i2cp, 1U, timeout);
+    if (msg == MSG_OK) {
+      i2cp->errors |= I2C_ACK_FAILURE;
+      msg = MSG_RESET;
+    }
+    return msg;
+  }
+
+  msg = i2c_lld_bus_wait(i2cp, 1U + rxbytes, timeout);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  while (rxbytes > 0U) {
+    *rxbuf++ = i2cp->regs[n][i2cp->index[n]++];
+    rxbytes--;
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Transmits data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                      const uint8_t *txbuf, size_t txbytes,
+                                      uint8_t *rxbuf, size_t rxbytes,
+                                      sysinterval_t timeout) {
+  int n = i2c_lld_slave(addr);
+  msg_t msg;
+
+  if (n < 0) {
+    msg = i2c_lld_bus_wait(i2cp, 1U, timeout);
+    if (msg == MSG_OK) {
+      i2cp->errors |= I2C_ACK_FAILURE;
+      msg = MSG_RESET;
+    }
+    return msg;
+  }
+
+  msg = i2c_lld_bus_wait(i2cp,
+                         1U + txbytes + (rxbytes > 0U ? 1U + rxbytes : 0U),
+                         timeout);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  /* The first byte selects the register.*/
+  i2cp->index[n] = *txbuf++;
+  while (--txbytes > 0U) {
+    i2cp->regs[n][i2cp->index[n]++] = *txbuf++;
+  }
+  while (rxbytes > 0U) {
+    *rxbuf++ = i2cp->regs[n][i2cp->index[n]++];
+    rxbytes--;
+  }
+
+  return MSG_OK;
+}
+
+#endif /* HAL_USE_I2C */
+
+/** @} */
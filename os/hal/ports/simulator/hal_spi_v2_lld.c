@@ -0,0 +1,346 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/hal_spi_v2_lld.c
+ * @brief   Simulator SPI (v2) subsystem low level driver source.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   SPI1 driver identifier.
+ */
+#if (USE_SIM_SPI1 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Performs a loopback transfer.
+ * @details The data is moved immediately, the completion is notified by
+ *          the first simulated interrupt after the transfer bus time.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of frames, the buffers hold 8 bits or 16 bits
+ *                      frames depending on the configuration
+ * @param[in] txbuf     the pointer to the transmit buffer or @p NULL
+ * @param[out] rxbuf    the pointer to the receive buffer or @p NULL
+ */
+static void spi_lld_transfer(SPIDriver *spip, size_t n,
+                             const void *txbuf, void *rxbuf) {
+
+  if (rxbuf != NULL) {
+    size_t i;
+
+    if (txbuf != NULL) {
+      memmove(rxbuf, txbuf, spip->config->frame16 ? n * 2U : n);
+    }
+    else if (spip->config->frame16) {
+      uint16_t *p = (uint16_t *)rxbuf;
+
+      for (i = 0U; i < n; i++) {
+        p[i] = (uint16_t)SPI_SIM_IDLE_FRAME;
+      }
+    }
+    else {
+      uint8_t *p = (uint8_t *)rxbuf;
+
+      for (i = 0U; i < n; i++) {
+        p[i] = (uint8_t)SPI_SIM_IDLE_FRAME;
+      }
+    }
+  }
+
+  spip->remaining = n;
+  spip->start     = port_rt_get_counter_value();
+  if (spip->config->bitrate > 0U) {
+    spip->duration = (rtcnt_t)(((uint64_t)n *
+                                (spip->config->frame16 ? 16U : 8U) *
+                                1000000U) / spip->config->bitrate);
+  }
+  else {
+    spip->duration = (rtcnt_t)0;
+  }
+  spip->pending   = true;
+}
+
+/**
+ * @brief   Serves a pending transfer completion, if any.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The interrupt status.
+ * @retval false        if no interrupt was pending.
+ * @retval true         if an interrupt has been served.
+ */
+static bool spi_lld_serve_interrupt(SPIDriver *spip) {
+
+  if (!spip->pending) {
+    return false;
+  }
+
+  /* The port realtime counter counts microseconds.*/
+  if ((rtcnt_t)(port_rt_get_counter_value() - spip->start) <
+      spip->duration) {
+    return false;
+  }
+
+  spip->pending   = false;
+  spip->remaining = 0U;
+  __spi_isr_complete_code(spip);
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if USE_SIM_SPI1 == TRUE
+  spiObjectInit(&SPID1);
+  SPID1.pending   = false;
+  SPID1.remaining = 0U;
+  SPID1.start     = (rtcnt_t)0;
+  SPID1.duration  = (rtcnt_t)0;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_start(SPIDriver *spip) {
+
+  (void)spip;
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  spip->pending = false;
+}
+
+#if (SPI_SELECT_MODE == SPI_SELECT_MODE_LLD) || defined(__DOXYGEN__)
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  (void)spip;
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  (void)spip;
+}
+#endif
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  spi_lld_transfer(spip, n, NULL, NULL);
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ * @details The transmitted frames are received back.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_exchange(SPIDriver *spip, size_t n,
+                       const void *txbuf, void *rxbuf) {
+
+  spi_lld_transfer(spip, n, txbuf, rxbuf);
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  spi_lld_transfer(spip, n, txbuf, NULL);
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ * @details Idle frames are received.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  spi_lld_transfer(spip, n, NULL, rxbuf);
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Aborts the ongoing SPI operation, if any.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[out] sizep    pointer to the counter of frames not yet transferred
+ *                      or @p NULL
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t spi_lld_stop_transfer(SPIDriver *spip, size_t *sizep) {
+
+  if (sizep != NULL) {
+    rtcnt_t elapsed = (rtcnt_t)(port_rt_get_counter_value() - spip->start);
+
+    if (!spip->pending || (elapsed >= spip->duration)) {
+      *sizep = 0U;
+    }
+    else {
+      *sizep = spip->remaining -
+               (size_t)(((uint64_t)spip->remaining * elapsed) /
+                        spip->duration);
+    }
+  }
+  spip->pending   = false;
+  spip->remaining = 0U;
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ *
+ * @notapi
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+
+  return spip->config->frame16 ? frame : (uint16_t)(frame & 0xFFU);
+}
+
+/**
+ * @brief   Checks for pending simulated SPI interrupts.
+ *
+ * @return              The interrupt status.
+ * @retval false        if no interrupt was served.
+ * @retval true         if an interrupt has been served.
+ */
+bool spi_lld_interrupt_pending(void) {
+  bool b = false;
+
+  OSAL_IRQ_PROLOGUE();
+
+#if USE_SIM_SPI1 == TRUE
+  b = spi_lld_serve_interrupt(&SPID1);
+#endif
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_SPI */
+
+/** @} */
@@ -0,0 +1,408 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkfile.c
+ * @brief   Simulator file-backed block device code.
+ *
+ * @addtogroup POSIX_BLKFILE
+ * @{
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hal.h"
+#include "blkfile.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static bool blkfile_is_inserted(void *ip) {
+
+  (void)ip;
+
+  return true;
+}
+
+static bool blkfile_is_protected(void *ip) {
+
+  return ((BlockFile *)ip)->config->read_only;
+}
+
+static const struct BlockFileVMT vmt = {
+  (size_t)0,
+  blkfile_is_inserted,
+  blkfile_is_protected,
+  (bool (*)(void *))blkfileConnect,
+  (bool (*)(void *))blkfileDisconnect,
+  (bool (*)(void *, uint32_t, uint8_t *, uint32_t))blkfileRead,
+  (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))blkfileWrite,
+  (bool (*)(void *))blkfileSync,
+  (bool (*)(void *, BlockDeviceInfo *))blkfileGetInfo
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Spends the modeled time of an operation.
+ * @details Delays shorter than a system tick are accumulated, the calling
+ *          thread sleeps once a whole tick is owed. The owed time is kept
+ *          in microseconds multiplied by the system tick frequency so the
+ *          conversion is exact for any frequency, including frequencies
+ *          above 1MHz.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @param[in] us        operation time in microseconds
+ */
+static void blkfile_delay(BlockFile *bfp, uint32_t us) {
+  uint64_t ticks;
+
+  bfp->stats.busy_us += us;
+  bfp->debt += (uint64_t)us * (uint64_t)OSAL_ST_FREQUENCY;
+  ticks = bfp->debt / 1000000U;
+  if (ticks > 0U) {
+    bfp->debt -= ticks * 1000000U;
+    osalThreadSleep((sysinterval_t)ticks);
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a file-backed block device object.
+ *
+ * @param[out] bfp      pointer to the @p BlockFile object
+ *
+ * @init
+ */
+void blkfileObjectInit(BlockFile *bfp) {
+
+  bfp->vmt    = &vmt;
+  bfp->state  = BLK_STOP;
+  bfp->config = NULL;
+  bfp->fd     = -1;
+  bfp->image  = NULL;
+}
+
+/**
+ * @brief   Configures and activates the device.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @param[in] config    pointer to the @p BlockFileConfig object
+ *
+ * @api
+ */
+void blkfileStart(BlockFile *bfp, const BlockFileConfig *config) {
+
+  osalDbgCheck((bfp != NULL) && (config != NULL) &&
+               (config->path != NULL) && (config->blk_size > 0U));
+  osalDbgAssert((bfp->state == BLK_STOP) || (bfp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bfp->config = config;
+  blkfileResetStats(bfp);
+  bfp->state  = BLK_ACTIVE;
+}
+
+/**
+ * @brief   Deactivates the device.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ *
+ * @api
+ */
+void blkfileStop(BlockFile *bfp) {
+
+  osalDbgCheck(bfp != NULL);
+  osalDbgAssert((bfp->state == BLK_STOP) || (bfp->state == BLK_ACTIVE),
+                "invalid state");
+
+  bfp->config = NULL;
+  bfp->state  = BLK_STOP;
+}
+
+/**
+ * @brief   Opens and maps the disk image.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileConnect(BlockFile *bfp) {
+  const BlockFileConfig *cfg;
+  struct stat st;
+  off_t size;
+  void *p;
+
+  osalDbgCheck(bfp != NULL);
+  osalDbgAssert((bfp->state == BLK_ACTIVE) || (bfp->state == BLK_READY),
+                "invalid state");
+
+  if (bfp->state == BLK_READY) {
+    return HAL_SUCCESS;
+  }
+
+  cfg = bfp->config;
+  bfp->state = BLK_CONNECTING;
+
+  bfp->fd = open(cfg->path, cfg->read_only ? O_RDONLY : O_RDWR | O_CREAT,
+                 0644);
+  if ((bfp->fd == -1) || (fstat(bfp->fd, &st) != 0)) {
+    goto failed;
+  }
+
+  size = (off_t)cfg->blk_num * (off_t)cfg->blk_size;
+  if (size == 0) {
+    size = st.st_size - (st.st_size % (off_t)cfg->blk_size);
+  }
+  else if ((st.st_size < size) &&
+           (cfg->read_only || (ftruncate(bfp->fd, size) != 0))) {
+    goto failed;
+  }
+  if (size == 0) {
+    goto failed;
+  }
+
+  p = mmap(NULL, (size_t)size,
+           cfg->read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+           MAP_SHARED, bfp->fd, 0);
+  if (p == MAP_FAILED) {
+    goto failed;
+  }
+
+  bfp->image      = (uint8_t *)p;
+  bfp->blk_num    = (uint32_t)(size / (off_t)cfg->blk_size);
+  bfp->next_write = 0xFFFFFFFFU;
+  bfp->debt       = 0U;
+  bfp->state      = BLK_READY;
+  return HAL_SUCCESS;
+
+failed:
+  printf("%s: unable to map block device image\n", cfg->path);
+  if (bfp->fd != -1) {
+    close(bfp->fd);
+    bfp->fd = -1;
+  }
+  bfp->state = BLK_ACTIVE;
+  return HAL_FAILED;
+}
+
+/**
+ * @brief   Writes back and unmaps the disk image.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileDisconnect(BlockFile *bfp) {
+  size_t size;
+  bool err = HAL_SUCCESS;
+
+  osalDbgCheck(bfp != NULL);
+  osalDbgAssert((bfp->state == BLK_ACTIVE) || (bfp->state == BLK_READY),
+                "invalid state");
+
+  if (bfp->state == BLK_ACTIVE) {
+    return HAL_SUCCESS;
+  }
+
+  bfp->state = BLK_DISCONNECTING;
+  size = (size_t)bfp->blk_num * bfp->config->blk_size;
+  if (!bfp->config->read_only && (msync(bfp->image, size, MS_SYNC) != 0)) {
+    err = HAL_FAILED;
+  }
+  (void) munmap(bfp->image, size);
+  close(bfp->fd);
+  bfp->image = NULL;
+  bfp->fd    = -1;
+  bfp->state = BLK_ACTIVE;
+
+  return err;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileRead(BlockFile *bfp, uint32_t startblk,
+                 uint8_t *buffer, uint32_t n) {
+  const BlockFileConfig *cfg;
+
+  osalDbgCheck((bfp != NULL) && (buffer != NULL) && (n > 0U));
+  osalDbgAssert(bfp->state == BLK_READY, "invalid state");
+
+  cfg = bfp->config;
+  if ((startblk >= bfp->blk_num) || (n > bfp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  bfp->state = BLK_READING;
+  memcpy(buffer, &bfp->image[(size_t)startblk * cfg->blk_size],
+         (size_t)n * cfg->blk_size);
+  bfp->stats.reads++;
+  bfp->stats.blocks_read += n;
+  if (cfg->latency != NULL) {
+    blkfile_delay(bfp, cfg->latency->read_cmd +
+                       (n * cfg->latency->read_block));
+  }
+  bfp->state = BLK_READY;
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileWrite(BlockFile *bfp, uint32_t startblk,
+                  const uint8_t *buffer, uint32_t n) {
+  const BlockFileConfig *cfg;
+
+  osalDbgCheck((bfp != NULL) && (buffer != NULL) && (n > 0U));
+  osalDbgAssert(bfp->state == BLK_READY, "invalid state");
+
+  cfg = bfp->config;
+  if (cfg->read_only || (startblk >= bfp->blk_num) ||
+      (n > bfp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  bfp->state = BLK_WRITING;
+  memcpy(&bfp->image[(size_t)startblk * cfg->blk_size], buffer,
+         (size_t)n * cfg->blk_size);
+  bfp->stats.writes++;
+  bfp->stats.blocks_written += n;
+  if (cfg->latency != NULL) {
+    const blkfile_latency_t *lp = cfg->latency;
+    uint32_t us = lp->write_cmd + (n * lp->write_block);
+
+    if (n > 1U) {
+      us += lp->write_multi;
+    }
+    if (startblk != bfp->next_write) {
+      us += lp->write_random;
+    }
+    blkfile_delay(bfp, us);
+  }
+  bfp->next_write = startblk + n;
+  bfp->state = BLK_READY;
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for the pending writes.
+ * @note    The host image is not flushed, this happens on disconnection.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileSync(BlockFile *bfp) {
+
+  osalDbgCheck(bfp != NULL);
+  osalDbgAssert(bfp->state == BLK_READY, "invalid state");
+
+  bfp->stats.syncs++;
+  if (bfp->config->latency != NULL) {
+    blkfile_delay(bfp, bfp->config->latency->sync);
+  }
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Returns the media info.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @param[out] bdip     pointer to a @p BlockDeviceInfo structure
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool blkfileGetInfo(BlockFile *bfp, BlockDeviceInfo *bdip) {
+
+  osalDbgCheck((bfp != NULL) && (bdip != NULL));
+
+  if (bfp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+
+  bdip->blk_size = bfp->config->blk_size;
+  bdip->blk_num  = bfp->blk_num;
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Resets the device counters.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ *
+ * @api
+ */
+void blkfileResetStats(BlockFile *bfp) {
+
+  osalDbgCheck(bfp != NULL);
+
+  memset(&bfp->stats, 0, sizeof bfp->stats);
+}
+
+/** @} */
@@ -0,0 +1,227 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkfile.h
+ * @brief   Simulator file-backed block device header.
+ * @details The block device maps a host disk image, an optional latency
+ *          model makes operations take the time a real card would take.
+ *          Modeled time is also accumulated in the counters so that
+ *          throughput can be computed independently from the host load.
+ *
+ * @addtogroup POSIX_BLKFILE
+ * @{
+ */
+
+#ifndef BLKFILE_H
+#define BLKFILE_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Latency model of a block device.
+ * @details All times are in microseconds.
+ */
+typedef struct {
+  /**
+   * @brief   Read command overhead.
+   */
+  uint32_t                  read_cmd;
+  /**
+   * @brief   Read time per block.
+   */
+  uint32_t                  read_block;
+  /**
+   * @brief   Write command overhead.
+   */
+  uint32_t                  write_cmd;
+  /**
+   * @brief   Write time per block.
+   */
+  uint32_t                  write_block;
+  /**
+   * @brief   Additional overhead of multi-block write commands.
+   * @details Models the pre-erase and stop transmission of SD cards.
+   */
+  uint32_t                  write_multi;
+  /**
+   * @brief   Additional overhead of writes not continuing the previous one.
+   * @details Models the allocation unit switch of SD cards, small random
+   *          writes are much slower than sequential ones.
+   */
+  uint32_t                  write_random;
+  /**
+   * @brief   Sync operation time.
+   */
+  uint32_t                  sync;
+} blkfile_latency_t;
+
+/**
+ * @brief   File-backed block device configuration.
+ */
+typedef struct {
+  /**
+   * @brief   Path of the host disk image.
+   */
+  const char                *path;
+  /**
+   * @brief   Block size in bytes.
+   */
+  uint32_t                  blk_size;
+  /**
+   * @brief   Number of blocks.
+   * @details The image is created or extended to this size, zero uses the
+   *          size of an existing image.
+   */
+  uint32_t                  blk_num;
+  /**
+   * @brief   Write protection.
+   */
+  bool                      read_only;
+  /**
+   * @brief   Latency model or @p NULL for no delays.
+   */
+  const blkfile_latency_t   *latency;
+} BlockFileConfig;
+
+/**
+ * @brief   File-backed block device counters.
+ */
+typedef struct {
+  /**
+   * @brief   Read commands.
+   */
+  uint32_t                  reads;
+  /**
+   * @brief   Write commands.
+   */
+  uint32_t                  writes;
+  /**
+   * @brief   Blocks read.
+   */
+  uint32_t                  blocks_read;
+  /**
+   * @brief   Blocks written.
+   */
+  uint32_t                  blocks_written;
+  /**
+   * @brief   Sync commands.
+   */
+  uint32_t                  syncs;
+  /**
+   * @brief   Modeled busy time in microseconds.
+   */
+  uint64_t                  busy_us;
+} blkfile_stats_t;
+
+/**
+ * @brief   @p BlockFile specific methods.
+ */
+#define _block_file_methods                                                 \
+  _base_block_device_methods
+
+/**
+ * @brief   @p BlockFile specific data.
+ */
+#define _block_file_data                                                    \
+  _base_block_device_data                                                   \
+  /* Current configuration data.*/                                          \
+  const BlockFileConfig     *config;                                        \
+  /* Image file descriptor.*/                                               \
+  int                       fd;                                             \
+  /* Mapped image.*/                                                        \
+  uint8_t                   *image;                                         \
+  /* Number of blocks.*/                                                    \
+  uint32_t                  blk_num;                                        \
+  /* Block following the last written one.*/                                \
+  uint32_t                  next_write;                                     \
+  /* Owed modeled time, microseconds multiplied by the tick frequency.*/    \
+  uint64_t                  debt;                                           \
+  /* Counters.*/                                                            \
+  blkfile_stats_t           stats;
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p BlockFile virtual methods table.
+ */
+struct BlockFileVMT {
+  _block_file_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   File-backed block device object.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BlockFileVMT *vmt;
+  _block_file_data
+} BlockFile;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the device counters.
+ *
+ * @param[in] bfp       pointer to the @p BlockFile object
+ * @return              Pointer to the @p blkfile_stats_t structure.
+ */
+#define blkfileGetStats(bfp) (&(bfp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void blkfileObjectInit(BlockFile *bfp);
+  void blkfileStart(BlockFile *bfp, const BlockFileConfig *config);
+  void blkfileStop(BlockFile *bfp);
+  bool blkfileConnect(BlockFile *bfp);
+  bool blkfileDisconnect(BlockFile *bfp);
+  bool blkfileRead(BlockFile *bfp, uint32_t startblk,
+                   uint8_t *buffer, uint32_t n);
+  bool blkfileWrite(BlockFile *bfp, uint32_t startblk,
+                    const uint8_t *buffer, uint32_t n);
+  bool blkfileSync(BlockFile *bfp);
+  bool blkfileGetInfo(BlockFile *bfp, BlockDeviceInfo *bdip);
+  void blkfileResetStats(BlockFile *bfp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLKFILE_H */
+
+/** @} */
@@ -49,6 +49,11 @@
 #define PLATFORM_NAME   "Posix Simulator"
 #endif
 
+/**
+ * @brief   Requires use of SPIv2 driver model.
+ */
+#define HAL_LLD_SELECT_SPI_V2           TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -0,0 +1,729 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_mac_lld.c
+ * @brief   Posix simulator low level MAC driver code.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @name    Buffers states
+ * @{
+ */
+#define SIM_MAC_FREE                0U  /**< @brief Owned by the link.      */
+#define SIM_MAC_CPU                 1U  /**< @brief Owned by the driver user.*/
+#define SIM_MAC_READY               2U  /**< @brief Handed to the other side.*/
+/** @} */
+
+/**
+ * @name    pcap file format constants
+ * @{
+ */
+#define PCAP_MAGIC_US               0xA1B2C3D4U
+#define PCAP_MAGIC_NS               0xA1B23C4DU
+#define PCAP_LINKTYPE_ETHERNET      1U
+/** @} */
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Ethernet driver 1.
+ */
+MACDriver ETHD1;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   pcap file header.
+ */
+typedef struct {
+  uint32_t              magic;
+  uint16_t              version_major;
+  uint16_t              version_minor;
+  int32_t               thiszone;
+  uint32_t              sigfigs;
+  uint32_t              snaplen;
+  uint32_t              network;
+} pcap_header_t;
+
+/**
+ * @brief   pcap record header.
+ */
+typedef struct {
+  uint32_t              ts_sec;
+  uint32_t              ts_usec;
+  uint32_t              incl_len;
+  uint32_t              orig_len;
+} pcap_record_t;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Host monotonic time in nanoseconds.
+ *
+ * @return              The current time.
+ */
+static uint64_t mac_lld_host_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief   Appends a frame to the record file, if any.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[in] buf       frame data
+ * @param[in] size      frame size
+ */
+static void mac_lld_record(MACDriver *macp, const uint8_t *buf, size_t size) {
+  pcap_record_t rec;
+  struct timeval tv;
+
+  if (macp->record == NULL) {
+    return;
+  }
+
+  gettimeofday(&tv, NULL);
+  rec.ts_sec   = (uint32_t)tv.tv_sec;
+  rec.ts_usec  = (uint32_t)tv.tv_usec;
+  rec.incl_len = (uint32_t)size;
+  rec.orig_len = (uint32_t)size;
+  (void) fwrite(&rec, sizeof rec, 1U, macp->record);
+  (void) fwrite(buf, 1U, size, macp->record);
+}
+
+/**
+ * @brief   Reads the next frame from the replay file, if any.
+ * @details The file is closed after the last frame or on error.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] buf      frame buffer of @p SIM_MAC_BUFFERS_SIZE bytes
+ * @return              The frame size, zero if there are no more frames.
+ */
+static size_t mac_lld_replay(MACDriver *macp, uint8_t *buf) {
+  pcap_record_t rec;
+
+  while (macp->replay != NULL) {
+    if ((fread(&rec, sizeof rec, 1U, macp->replay) != 1U) ||
+        (rec.incl_len > 0xFFFFU)) {
+      fclose(macp->replay);
+      macp->replay = NULL;
+      break;
+    }
+
+    /* Truncated or oversized frames are skipped.*/
+    if ((rec.incl_len != rec.orig_len) ||
+        (rec.incl_len > (uint32_t)SIM_MAC_BUFFERS_SIZE)) {
+      (void) fseek(macp->replay, (long)rec.incl_len, SEEK_CUR);
+      continue;
+    }
+
+    if (fread(buf, 1U, rec.incl_len, macp->replay) == rec.incl_len) {
+      return (size_t)rec.incl_len;
+    }
+  }
+
+  return 0U;
+}
+
+/**
+ * @brief   Puts the ready transmit buffers on the link.
+ * @details Frames leave when the simulated wire is free, frames can be
+ *          lost with the configured probability.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The transmit status.
+ * @retval false        if no buffers have been freed.
+ * @retval true         if one or more buffers have been freed.
+ */
+static bool mac_lld_serve_tx(MACDriver *macp) {
+  const MACConfig *cfg = macp->config;
+  uint64_t now = mac_lld_host_ns();
+  bool done = false;
+
+  while (macp->txstate[macp->txsend] == SIM_MAC_READY) {
+    unsigned i = macp->txsend;
+    size_t size = macp->txsize[i];
+
+    if (now < macp->wire_free) {
+      break;
+    }
+
+    macp->lcg = (macp->lcg * 1664525U) + 1013904223U;
+    if ((cfg->loss_ppm > 0U) &&
+        ((macp->lcg >> 8) % 1000000U) < cfg->loss_ppm) {
+      macp->stats.tx_lost++;
+    }
+    else {
+      ssize_t sent;
+
+      if (macp->peerlen > 0U) {
+        sent = sendto(macp->txfd, macp->txbuf[i], size, MSG_DONTWAIT,
+                      (const struct sockaddr *)&macp->peer, macp->peerlen);
+      }
+      else {
+        sent = send(macp->txfd, macp->txbuf[i], size, MSG_DONTWAIT);
+      }
+      if (sent < 0) {
+        /* Peer absent or not keeping up, the frame is lost like on a
+           real link.*/
+        macp->stats.tx_lost++;
+      }
+      else {
+        macp->stats.tx_frames++;
+        macp->stats.tx_bytes += size;
+      }
+      mac_lld_record(macp, macp->txbuf[i], size);
+    }
+
+    /* Wire occupancy including preamble and inter-frame gap.*/
+    if (cfg->link_speed > 0U) {
+      macp->wire_free = now + (((uint64_t)(size + 20U) * 8U * 1000000000U) /
+                               cfg->link_speed);
+    }
+
+    macp->txstate[i] = SIM_MAC_FREE;
+    macp->txsend = (i + 1U) % (unsigned)SIM_MAC_TRANSMIT_BUFFERS;
+    done = true;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Fills the free receive buffers.
+ * @details Reception stops at the first buffer not yet released, further
+ *          frames wait in the socket.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The receive status.
+ * @retval false        if no frames have been received.
+ * @retval true         if one or more frames have been received.
+ */
+static bool mac_lld_serve_rx(MACDriver *macp) {
+  bool done = false;
+
+  while (macp->rxstate[macp->rxfill] == SIM_MAC_FREE) {
+    unsigned i = macp->rxfill;
+    ssize_t n;
+
+    n = (ssize_t)mac_lld_replay(macp, macp->rxbuf[i]);
+    if (n == 0) {
+      n = recv(macp->rxfd, macp->rxbuf[i], SIM_MAC_BUFFERS_SIZE,
+               MSG_DONTWAIT);
+      if (n <= 0) {
+        break;
+      }
+      mac_lld_record(macp, macp->rxbuf[i], (size_t)n);
+    }
+
+    macp->stats.rx_frames++;
+    macp->stats.rx_bytes += (uint64_t)n;
+    macp->rxsize[i]  = (size_t)n;
+    macp->rxstate[i] = SIM_MAC_READY;
+    macp->rxfill = (i + 1U) % (unsigned)SIM_MAC_RECEIVE_BUFFERS;
+    done = true;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Opens the pcap files.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The operation status.
+ */
+static msg_t mac_lld_open_pcap(MACDriver *macp) {
+  const MACConfig *cfg = macp->config;
+  pcap_header_t hdr;
+
+  if (cfg->replay != NULL) {
+    macp->replay = fopen(cfg->replay, "rb");
+    if ((macp->replay == NULL) ||
+        (fread(&hdr, sizeof hdr, 1U, macp->replay) != 1U) ||
+        ((hdr.magic != PCAP_MAGIC_US) && (hdr.magic != PCAP_MAGIC_NS)) ||
+        (hdr.network != PCAP_LINKTYPE_ETHERNET)) {
+      printf("ETHD1: Invalid pcap file %s\n", cfg->replay);
+      return HAL_RET_CONFIG_ERROR;
+    }
+  }
+
+  if (cfg->record != NULL) {
+    macp->record = fopen(cfg->record, "wb");
+    if (macp->record == NULL) {
+      printf("ETHD1: Unable to create %s\n", cfg->record);
+      return HAL_RET_CONFIG_ERROR;
+    }
+    hdr.magic         = PCAP_MAGIC_US;
+    hdr.version_major = 2U;
+    hdr.version_minor = 4U;
+    hdr.thiszone      = 0;
+    hdr.sigfigs       = 0U;
+    hdr.snaplen       = (uint32_t)SIM_MAC_BUFFERS_SIZE;
+    hdr.network       = PCAP_LINKTYPE_ETHERNET;
+    (void) fwrite(&hdr, sizeof hdr, 1U, macp->record);
+  }
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Closes sockets and files.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ */
+static void mac_lld_close(MACDriver *macp) {
+
+  if (macp->txfd != -1) {
+    close(macp->txfd);
+  }
+  if ((macp->rxfd != -1) && (macp->rxfd != macp->txfd)) {
+    close(macp->rxfd);
+  }
+  macp->txfd = -1;
+  macp->rxfd = -1;
+
+  if (macp->replay != NULL) {
+    fclose(macp->replay);
+    macp->replay = NULL;
+  }
+  if (macp->record != NULL) {
+    fclose(macp->record);
+    macp->record = NULL;
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+  macObjectInit(&ETHD1);
+  ETHD1.txfd   = -1;
+  ETHD1.rxfd   = -1;
+  ETHD1.replay = NULL;
+  ETHD1.record = NULL;
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+msg_t mac_lld_start(MACDriver *macp) {
+  const MACConfig *cfg = macp->config;
+  unsigned i;
+  msg_t msg;
+
+  macp->peerlen = 0U;
+  if (cfg->path == NULL) {
+    int fds[2];
+
+    /* Loopback, transmitted frames come back from the other end.*/
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) != 0) {
+      printf("ETHD1: Error creating loopback sockets\n");
+      return HAL_RET_HW_FAILURE;
+    }
+    macp->txfd = fds[0];
+    macp->rxfd = fds[1];
+  }
+  else {
+    struct sockaddr_un sun;
+
+    macp->txfd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (macp->txfd == -1) {
+      printf("ETHD1: Error creating socket\n");
+      return HAL_RET_HW_FAILURE;
+    }
+    macp->rxfd = macp->txfd;
+
+    memset(&sun, 0, sizeof sun);
+    sun.sun_family = AF_UNIX;
+    strncpy(sun.sun_path, cfg->path, sizeof sun.sun_path - 1U);
+    (void) unlink(cfg->path);
+    if (bind(macp->txfd, (struct sockaddr *)&sun, sizeof sun) != 0) {
+      printf("ETHD1: Error binding socket %s\n", cfg->path);
+      mac_lld_close(macp);
+      return HAL_RET_HW_FAILURE;
+    }
+
+    /* The socket is not connected, the peer may not exist yet or be
+       restarted, each frame is addressed to its path.*/
+    if (cfg->peer != NULL) {
+      memset(&macp->peer, 0, sizeof macp->peer);
+      macp->peer.sun_family = AF_UNIX;
+      strncpy(macp->peer.sun_path, cfg->peer,
+              sizeof macp->peer.sun_path - 1U);
+      macp->peerlen = (socklen_t)sizeof macp->peer;
+    }
+    printf("ETHD1: Datagram link %s -> %s\n", cfg->path,
+           cfg->peer != NULL ? cfg->peer : "none");
+  }
+
+  msg = mac_lld_open_pcap(macp);
+  if (msg != HAL_RET_SUCCESS) {
+    mac_lld_close(macp);
+    return msg;
+  }
+
+  for (i = 0U; i < (unsigned)SIM_MAC_TRANSMIT_BUFFERS; i++) {
+    macp->txstate[i] = SIM_MAC_FREE;
+  }
+  for (i = 0U; i < (unsigned)SIM_MAC_RECEIVE_BUFFERS; i++) {
+    macp->rxstate[i] = SIM_MAC_FREE;
+  }
+  macp->txnext    = 0U;
+  macp->txsend    = 0U;
+  macp->rxfill    = 0U;
+  macp->rxnext    = 0U;
+  macp->wire_free = 0U;
+  macp->lcg       = 0x12345678U;
+  memset(&macp->stats, 0, sizeof macp->stats);
+
+  return HAL_RET_SUCCESS;
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+
+  mac_lld_close(macp);
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  unsigned i = macp->txnext;
+
+  if (macp->txstate[i] != SIM_MAC_FREE) {
+    return MSG_TIMEOUT;
+  }
+
+  macp->txstate[i] = SIM_MAC_CPU;
+  macp->txnext = (i + 1U) % (unsigned)SIM_MAC_TRANSMIT_BUFFERS;
+
+  tdp->offset = 0U;
+  tdp->size   = SIM_MAC_BUFFERS_SIZE;
+  tdp->macp   = macp;
+  tdp->index  = i;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+  MACDriver *macp = tdp->macp;
+
+  osalDbgAssert(macp->txstate[tdp->index] == SIM_MAC_CPU,
+                "attempt to release descriptor not owned");
+
+  osalSysLock();
+  macp->txsize[tdp->index]  = tdp->offset;
+  macp->txstate[tdp->index] = SIM_MAC_READY;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  unsigned i = macp->rxnext;
+
+  if (macp->rxstate[i] != SIM_MAC_READY) {
+    return MSG_TIMEOUT;
+  }
+
+  macp->rxstate[i] = SIM_MAC_CPU;
+  macp->rxnext = (i + 1U) % (unsigned)SIM_MAC_RECEIVE_BUFFERS;
+
+  rdp->offset = 0U;
+  rdp->size   = macp->rxsize[i];
+  rdp->macp   = macp;
+  rdp->index  = i;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+  MACDriver *macp = rdp->macp;
+
+  osalDbgAssert(macp->rxstate[rdp->index] == SIM_MAC_CPU,
+                "attempt to release descriptor not owned");
+
+  osalSysLock();
+  macp->rxstate[rdp->index] = SIM_MAC_FREE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+
+  return macp->state == MAC_ACTIVE;
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  if (size > tdp->size - tdp->offset) {
+    size = tdp->size - tdp->offset;
+  }
+
+  if (size > 0U) {
+    memcpy(&tdp->macp->txbuf[tdp->index][tdp->offset], buf, size);
+    tdp->offset += size;
+  }
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  if (size > rdp->size - rdp->offset) {
+    size = rdp->size - rdp->offset;
+  }
+
+  if (size > 0U) {
+    memcpy(buf, &rdp->macp->rxbuf[rdp->index][rdp->offset], size);
+    rdp->offset += size;
+  }
+  return size;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+
+  if (tdp->offset == 0U) {
+    *sizep      = tdp->size;
+    tdp->offset = size;
+    return tdp->macp->txbuf[tdp->index];
+  }
+  *sizep = 0U;
+  return NULL;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+
+  if (rdp->size > 0U) {
+    *sizep      = rdp->size;
+    rdp->offset = rdp->size;
+    rdp->size   = 0U;
+    return rdp->macp->rxbuf[rdp->index];
+  }
+  *sizep = 0U;
+  return NULL;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+/**
+ * @brief   Moves frames between the buffers and the link.
+ *
+ * @return              The interrupt status.
+ * @retval false        if no interrupt was pending.
+ * @retval true         if an interrupt has been served.
+ *
+ * @notapi
+ */
+bool mac_lld_interrupt_pending(void) {
+  MACDriver *macp = &ETHD1;
+  bool tx, rx;
+
+  if (macp->state != MAC_ACTIVE) {
+    return false;
+  }
+
+  tx = mac_lld_serve_tx(macp);
+  rx = mac_lld_serve_rx(macp);
+  if (!tx && !rx) {
+    return false;
+  }
+
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysLockFromISR();
+  if (rx) {
+    osalThreadDequeueAllI(&macp->rdqueue, MSG_RESET);
+#if MAC_USE_EVENTS
+    osalEventBroadcastFlagsI(&macp->rdevent, 0);
+#endif
+  }
+  if (tx) {
+    osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+  }
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
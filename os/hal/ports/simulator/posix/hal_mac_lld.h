@@ -0,0 +1,373 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_mac_lld.h
+ * @brief   Posix simulator low level MAC driver header.
+ * @details Ethernet frames are exchanged as datagrams over Unix domain
+ *          sockets, two simulator instances can be connected by binding
+ *          each one to the path the other sends to. Without a peer the
+ *          transmitted frames are looped back. Frames can also be replayed
+ *          from and recorded into pcap files.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#ifndef HAL_MAC_LLD_H
+#define HAL_MAC_LLD_H
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the zero-copy mode API.
+ */
+#define MAC_SUPPORTS_ZERO_COPY      TRUE
+
+/**
+ * @brief   The start function returns a status.
+ */
+#define MAC_LLD_ENHANCED_API
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Number of available transmit buffers.
+ */
+#if !defined(SIM_MAC_TRANSMIT_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_BUFFERS    4
+#endif
+
+/**
+ * @brief   Number of available receive buffers.
+ */
+#if !defined(SIM_MAC_RECEIVE_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_RECEIVE_BUFFERS     8
+#endif
+
+/**
+ * @brief   Maximum supported frame size.
+ */
+#if !defined(SIM_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS_SIZE        1536
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (SIM_MAC_TRANSMIT_BUFFERS < 1) || (SIM_MAC_RECEIVE_BUFFERS < 1)
+#error "invalid number of MAC buffers"
+#endif
+
+#if SIM_MAC_BUFFERS_SIZE < 64
+#error "invalid SIM_MAC_BUFFERS_SIZE value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief MAC address.
+   */
+  uint8_t               *mac_address;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Path of the local socket or @p NULL for loopback.
+   * @note  An existing socket file is removed.
+   */
+  const char            *path;
+  /**
+   * @brief Path of the peer socket, ignored in loopback mode.
+   */
+  const char            *peer;
+  /**
+   * @brief Simulated link speed in bits per second, zero for unlimited.
+   * @details Transmissions are paced as if the frames occupied the wire.
+   */
+  uint32_t              link_speed;
+  /**
+   * @brief Transmitted frames loss probability in parts per million.
+   */
+  uint32_t              loss_ppm;
+  /**
+   * @brief pcap file of frames to be received or @p NULL.
+   * @details The frames are received as soon as buffers are available,
+   *          after the file end the peer socket is used.
+   */
+  const char            *replay;
+  /**
+   * @brief pcap file recording the transmitted and received frames or
+   *        @p NULL.
+   */
+  const char            *record;
+} MACConfig;
+
+/**
+ * @brief   MAC driver statistics.
+ */
+typedef struct {
+  /**
+   * @brief Frames transmitted on the link.
+   */
+  uint32_t              tx_frames;
+  /**
+   * @brief Bytes transmitted on the link.
+   */
+  uint64_t              tx_bytes;
+  /**
+   * @brief Frames lost on the link.
+   */
+  uint32_t              tx_lost;
+  /**
+   * @brief Frames received.
+   */
+  uint32_t              rx_frames;
+  /**
+   * @brief Bytes received.
+   */
+  uint64_t              rx_bytes;
+} sim_mac_stats_t;
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+struct MACDriver {
+  /**
+   * @brief Driver state.
+   */
+  macstate_t            state;
+  /**
+   * @brief Current configuration data.
+   */
+  const MACConfig       *config;
+  /**
+   * @brief Transmit semaphore.
+   */
+  threads_queue_t       tdqueue;
+  /**
+   * @brief Receive semaphore.
+   */
+  threads_queue_t       rdqueue;
+#if MAC_USE_EVENTS || defined(__DOXYGEN__)
+  /**
+   * @brief Receive event.
+   */
+  event_source_t        rdevent;
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Transmit socket.
+   */
+  int                   txfd;
+  /**
+   * @brief Receive socket.
+   */
+  int                   rxfd;
+  /**
+   * @brief Peer socket address.
+   * @note  Each frame is addressed to the peer path so a peer started
+   *        late or restarted is reached without reconnecting.
+   */
+  struct sockaddr_un    peer;
+  /**
+   * @brief Peer socket address size, zero if frames are not addressed.
+   */
+  socklen_t             peerlen;
+  /**
+   * @brief pcap replay file.
+   */
+  FILE                  *replay;
+  /**
+   * @brief pcap record file.
+   */
+  FILE                  *record;
+  /**
+   * @brief Host time in nanoseconds when the wire becomes free.
+   */
+  uint64_t              wire_free;
+  /**
+   * @brief Loss generator state.
+   */
+  uint32_t              lcg;
+  /**
+   * @brief Next transmit buffer to be returned.
+   */
+  unsigned              txnext;
+  /**
+   * @brief Next transmit buffer to be put on the link.
+   */
+  unsigned              txsend;
+  /**
+   * @brief Next receive buffer to be filled.
+   */
+  unsigned              rxfill;
+  /**
+   * @brief Next receive buffer to be returned.
+   */
+  unsigned              rxnext;
+  /**
+   * @brief Transmit buffers state.
+   */
+  uint8_t               txstate[SIM_MAC_TRANSMIT_BUFFERS];
+  /**
+   * @brief Receive buffers state.
+   */
+  uint8_t               rxstate[SIM_MAC_RECEIVE_BUFFERS];
+  /**
+   * @brief Transmit frames sizes.
+   */
+  size_t                txsize[SIM_MAC_TRANSMIT_BUFFERS];
+  /**
+   * @brief Receive frames sizes.
+   */
+  size_t                rxsize[SIM_MAC_RECEIVE_BUFFERS];
+  /**
+   * @brief Transmit buffers.
+   */
+  uint8_t               txbuf[SIM_MAC_TRANSMIT_BUFFERS][SIM_MAC_BUFFERS_SIZE];
+  /**
+   * @brief Receive buffers.
+   */
+  uint8_t               rxbuf[SIM_MAC_RECEIVE_BUFFERS][SIM_MAC_BUFFERS_SIZE];
+  /**
+   * @brief Statistics.
+   */
+  sim_mac_stats_t       stats;
+};
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current write offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available space size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Buffer index.
+   */
+  unsigned              index;
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current read offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available data size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Buffer index.
+   */
+  unsigned              index;
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the driver statistics.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              Pointer to the @p sim_mac_stats_t structure.
+ */
+#define simMacGetStats(macp) (&(macp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern MACDriver ETHD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  msg_t mac_lld_start(MACDriver *macp);
+  void mac_lld_stop(MACDriver *macp);
+  msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+#endif /* MAC_USE_ZERO_COPY */
+  bool mac_lld_interrupt_pending(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* HAL_MAC_LLD_H */
+
+/** @} */
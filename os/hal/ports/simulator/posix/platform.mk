@@ -1,8 +1,13 @@
 # List of all the Posix platform files.
 PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/posix/hal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/posix/blkfile.c \
+              ${CHIBIOS}/os/hal/ports/simulator/posix/hal_mac_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/posix/hal_serial_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/console.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_can_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_i2c_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_pal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_spi_v2_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_st_lld.c
 
 # Required include directories
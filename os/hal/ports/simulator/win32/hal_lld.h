@@ -37,6 +37,11 @@
  */
 #define PLATFORM_NAME   "Win32 Simulator"
 
+/**
+ * @brief   Requires use of SPIv2 driver model.
+ */
+#define HAL_LLD_SELECT_SPI_V2           TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -2,7 +2,10 @@
 PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/win32/hal_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/win32/hal_serial_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/console.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_can_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_i2c_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_pal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/hal_spi_v2_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_st_lld.c
 
 # Required include directories
@@ -47,6 +47,17 @@
 #define CH_CFG_FACTORY_MAX_NAMES_LENGTH     8
 #endif
 
+/**
+ * @brief   Size of the names hash index of each objects list.
+ * @details If non-zero the objects lists are indexed by a hash of the
+ *          names, find and release operations only scan the objects
+ *          sharing the same slot. If zero the lists are scanned linearly.
+ * @note    Must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_SIZE            0
+#endif
+
 /**
  * @brief   Enables the registry of generic objects.
  */
@@ -143,6 +154,11 @@
 #error "invalid CH_CFG_FACTORY_MAX_NAMES_LENGTH value"
 #endif
 
+#if (CH_CFG_FACTORY_HASH_SIZE < 0) ||                                       \
+    ((CH_CFG_FACTORY_HASH_SIZE & (CH_CFG_FACTORY_HASH_SIZE - 1)) != 0)
+#error "CH_CFG_FACTORY_HASH_SIZE must be zero or a power of two"
+#endif
+
 #if (CH_CFG_USE_MUTEXES == FALSE) && (CH_CFG_USE_SEMAPHORES == FALSE)
 #error "CH_CFG_USE_FACTORY requires CH_CFG_USE_MUTEXES and/or CH_CFG_USE_SEMAPHORES"
 #endif
@@ -175,6 +191,12 @@ typedef struct ch_dyn_element {
    * @brief   Number of references to this object.
    */
   ucnt_t                refs;
+#if (CH_CFG_FACTORY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Hash of the object name.
+   */
+  uint32_t              hash;
+#endif
 #if (CH_CFG_FACTORY_MAX_NAMES_LENGTH > 0) || defined(__DOXYGEN__)
   char                  name[CH_CFG_FACTORY_MAX_NAMES_LENGTH];
 #else
@@ -186,7 +208,14 @@ typedef struct ch_dyn_element {
  * @brief   Type of a dynamic object list.
  */
 typedef struct ch_dyn_list {
-    dyn_element_t       *next;
+#if (CH_CFG_FACTORY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Hash slots, each one is a @p NULL terminated list.
+   */
+  dyn_element_t         *slots[CH_CFG_FACTORY_HASH_SIZE];
+#else
+  dyn_element_t         *next;
+#endif
 } dyn_list_t;
 
 #if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
@@ -95,6 +95,85 @@ static void copy_name(const char *sp, char *dp) {
   } while ((c != (char)0) && (i > 0U));
 }
 
+#if (CH_CFG_FACTORY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/*
+ * FNV-1a hash of a name, limited to the stored part of the name.
+ */
+static uint32_t dyn_name_hash(const char *name) {
+  uint32_t h = 2166136261U;
+#if CH_CFG_FACTORY_MAX_NAMES_LENGTH > 0
+  unsigned i = CH_CFG_FACTORY_MAX_NAMES_LENGTH;
+
+  while ((*name != (char)0) && (i > 0U)) {
+    h = (h ^ (uint32_t)(uint8_t)*name++) * 16777619U;
+    i--;
+  }
+#else
+  while (*name != (char)0) {
+    h = (h ^ (uint32_t)(uint8_t)*name++) * 16777619U;
+  }
+#endif
+
+  return h;
+}
+
+static inline dyn_element_t **dyn_list_slot(dyn_list_t *dlp, uint32_t h) {
+
+  return &dlp->slots[h & (uint32_t)(CH_CFG_FACTORY_HASH_SIZE - 1)];
+}
+
+static inline void dyn_list_init(dyn_list_t *dlp) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_FACTORY_HASH_SIZE; i++) {
+    dlp->slots[i] = NULL;
+  }
+}
+
+static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
+  uint32_t h = dyn_name_hash(name);
+  dyn_element_t *p = *dyn_list_slot(dlp, h);
+
+  while (p != NULL) {
+    if ((p->hash == h) &&
+        (strncmp(p->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH) == 0)) {
+      return p;
+    }
+    p = p->next;
+  }
+
+  return NULL;
+}
+
+static void dyn_list_insert(dyn_element_t *element, dyn_list_t *dlp) {
+  dyn_element_t **slotp;
+
+  element->hash = dyn_name_hash(element->name);
+  slotp = dyn_list_slot(dlp, element->hash);
+  element->next = *slotp;
+  *slotp = element;
+}
+
+static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
+                                      dyn_list_t *dlp) {
+  dyn_element_t **prevp = dyn_list_slot(dlp, element->hash);
+
+  /* Scanning the slot.*/
+  while (*prevp != NULL) {
+    if (*prevp == element) {
+      /* Found.*/
+      *prevp = element->next;
+      return element;
+    }
+
+    /* Next element in the slot.*/
+    prevp = &(*prevp)->next;
+  }
+
+  return NULL;
+}
+
+#else /* CH_CFG_FACTORY_HASH_SIZE == 0 */
 static inline void dyn_list_init(dyn_list_t *dlp) {
 
   dlp->next = (dyn_element_t *)dlp;
@@ -113,6 +192,12 @@ static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
   return NULL;
 }
 
+static void dyn_list_insert(dyn_element_t *element, dyn_list_t *dlp) {
+
+  element->next = dlp->next;
+  dlp->next = element;
+}
+
 static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
                                       dyn_list_t *dlp) {
   dyn_element_t *prev = (dyn_element_t *)dlp;
@@ -131,6 +216,7 @@ static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
 
   return NULL;
 }
+#endif /* CH_CFG_FACTORY_HASH_SIZE == 0 */
 
 #if CH_FACTORY_REQUIRES_HEAP || defined(__DOXYGEN__)
 static dyn_element_t *dyn_create_object_heap(const char *name,
@@ -156,10 +242,9 @@ static dyn_element_t *dyn_create_object_heap(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
@@ -201,10 +286,9 @@ static dyn_element_t *dyn_create_object_pool(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = (dyn_element_t *)dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
@@ -355,10 +439,29 @@ registered_object_t *chFactoryFindObject(const char *name) {
  * @api
  */
 registered_object_t *chFactoryFindObjectByPointer(void *objp) {
-  registered_object_t *rop = (registered_object_t *)ch_factory.obj_list.next;
+  registered_object_t *rop;
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  unsigned i;
+#endif
 
   F_LOCK();
 
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  for (i = 0U; i < (unsigned)CH_CFG_FACTORY_HASH_SIZE; i++) {
+    rop = (registered_object_t *)ch_factory.obj_list.slots[i];
+    while (rop != NULL) {
+      if (rop->objp == objp) {
+        rop->element.refs++;
+
+        F_UNLOCK();
+
+        return rop;
+      }
+      rop = (registered_object_t *)rop->element.next;
+    }
+  }
+#else
+  rop = (registered_object_t *)ch_factory.obj_list.next;
   while ((void *)rop != (void *)&ch_factory.obj_list) {
     if (rop->objp == objp) {
       rop->element.refs++;
@@ -369,6 +472,7 @@ registered_object_t *chFactoryFindObjectByPointer(void *objp) {
     }
     rop = (registered_object_t *)rop->element.next;
   }
+#endif
 
   F_UNLOCK();
 
@@ -257,6 +257,7 @@ void chCacheObjectInit(objects_cache_t *ocp,
   ocp->hashn            = hashn;
   ocp->hashp            = hashp;
   ocp->objn             = objn;
+  ocp->objsz            = objsz;
   ocp->objvp            = objvp;
   ocp->readf            = readf;
   ocp->writef           = writef;
@@ -323,9 +324,12 @@ oc_object_t *chCacheGetObject(objects_cache_t *ocp,
       chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
                   "not in LRU");
 
-      /* Removing the object from LRU, now it is "owned".*/
+      /* Removing the object from LRU, now it is "owned". The LRU counter
+         must follow the list content, there is no wait because the object
+         was in the LRU list.*/
       LRU_REMOVE(objp);
       objp->obj_flags &= ~OC_FLAG_INLRU;
+      chSemFastWaitI(&ocp->lru_sem);
 
       /* Getting the object semaphore, we know there is no wait so
          using the "fast" variant.*/
@@ -46,12 +46,58 @@
 #if !defined(CH_DBG_STACK_FILL_VALUE) || defined(__DOXYGEN__)
 #define CH_DBG_STACK_FILL_VALUE             0x55
 #endif
+
+/**
+ * @brief   Stack usage tracking.
+ * @details If enabled then threads working areas are painted incrementally,
+ *          starting from the initial stack pointer and proceeding downward,
+ *          and the stack high-water mark can be measured at runtime using
+ *          @p chThdGetStackUsage().
+ * @note    Unlike @p CH_DBG_FILL_THREADS this option has a bounded cost at
+ *          thread creation and is suitable for production builds.
+ */
+#if !defined(CH_DBG_STACK_USAGE) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_USAGE                  FALSE
+#endif
+
+/**
+ * @brief   Size of the stack area painted in a single step.
+ * @note    Painting is performed inside a critical zone so this value
+ *          directly affects the worst case latency.
+ */
+#if !defined(CH_DBG_STACK_USAGE_CHUNK) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_USAGE_CHUNK            256U
+#endif
+
+/**
+ * @brief   Number of stack words checked by each measurement probe.
+ * @details Stack frames can contain areas never written, a probe only
+ *          considers a position untouched if this number of consecutive
+ *          words still contains the fill pattern.
+ */
+#if !defined(CH_DBG_STACK_USAGE_PROBE) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_USAGE_PROBE            8U
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_DBG_STACK_USAGE == TRUE
+#if (CH_DBG_ENABLE_STACK_CHECK == FALSE) && (CH_CFG_USE_DYNAMIC == FALSE)
+#error "CH_DBG_STACK_USAGE requires CH_DBG_ENABLE_STACK_CHECK or CH_CFG_USE_DYNAMIC"
+#endif
+
+#if CH_DBG_STACK_USAGE_CHUNK == 0U
+#error "invalid CH_DBG_STACK_USAGE_CHUNK value"
+#endif
+
+#if CH_DBG_STACK_USAGE_PROBE == 0U
+#error "invalid CH_DBG_STACK_USAGE_PROBE value"
+#endif
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
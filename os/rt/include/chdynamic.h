@@ -61,6 +61,25 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Working areas cache descriptor.
+ * @details A cache is composed by an array of memory pools, one for each
+ *          size class, ordered by increasing objects size. The working
+ *          areas of terminated threads are returned to their own pool when
+ *          the last reference is released and are reused by subsequent
+ *          thread creations.
+ */
+typedef struct {
+  memory_pool_t         *pools;         /**< @brief Size classes pools.     */
+  unsigned              n;              /**< @brief Number of size classes. */
+  ucnt_t                hits;           /**< @brief Creations served using a
+                                                    cached working area.    */
+  ucnt_t                misses;         /**< @brief Creations served using a
+                                                    new working area.       */
+} thread_cache_t;
+#endif
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -83,6 +102,11 @@ extern "C" {
 #if CH_CFG_USE_MEMPOOLS == TRUE
   thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
                                       tprio_t prio, tfunc_t pf, void *arg);
+  void chThdCacheObjectInit(thread_cache_t *tcp,
+                            memory_pool_t *pools, unsigned n);
+  thread_t *chThdCreateFromCache(thread_cache_t *tcp, size_t size,
+                                 const char *name, tprio_t prio,
+                                 tfunc_t pf, void *arg);
 #endif
 #ifdef __cplusplus
 }
@@ -46,6 +46,29 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Message buffer descriptor.
+ * @details A buffer lent by a client to a server for the duration of a
+ *          message exchange, the server accesses the buffer in place, no
+ *          data copy is involved.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the buffer.
+   */
+  void                  *buffer;
+  /**
+   * @brief   Size of the buffer.
+   */
+  size_t                size;
+  /**
+   * @brief   Number of valid bytes in the buffer.
+   * @note    Set by the client before sending and optionally updated by
+   *          the server before releasing the client.
+   */
+  size_t                n;
+} msg_buffer_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -68,6 +91,7 @@ extern "C" {
   thread_t *chMsgWaitTimeoutS(sysinterval_t timeout);
   thread_t *chMsgPollS(void);
   void chMsgRelease(thread_t *tp, msg_t msg);
+  thread_t *chMsgReleaseAndWaitS(thread_t *tp, msg_t msg);
 #ifdef __cplusplus
 }
 #endif
@@ -211,6 +235,65 @@ static inline void chMsgReleaseS(thread_t *tp, msg_t msg) {
   chSchWakeupS(tp, msg);
 }
 
+/**
+ * @brief   Releases a sender thread and waits for the next message.
+ * @details Combined @p chMsgRelease() and @p chMsgWait() operation, the
+ *          server enters the wait state atomically with the sender release.
+ * @pre     Invoke this function only after a message has been received
+ *          using @p chMsgWait().
+ *
+ * @param[in] tp        pointer to the thread to be released
+ * @param[in] msg       message to be returned to the sender
+ * @return              A pointer to the thread carrying the next message.
+ *
+ * @api
+ */
+static inline thread_t *chMsgReleaseAndWait(thread_t *tp, msg_t msg) {
+
+  chSysLock();
+  tp = chMsgReleaseAndWaitS(tp, msg);
+  chSysUnlock();
+
+  return tp;
+}
+
+/**
+ * @brief   Sends a buffer to the specified thread.
+ * @details The buffer descriptor is passed as message, the sender is
+ *          stopped until the receiver executes a @p chMsgRelease() so the
+ *          receiver can access the buffer in place.
+ *
+ * @param[in] tp        the pointer to the thread
+ * @param[in] mbp       pointer to the message buffer descriptor
+ * @return              The answer message from @p chMsgRelease().
+ *
+ * @api
+ */
+static inline msg_t chMsgSendBuffer(thread_t *tp, msg_buffer_t *mbp) {
+
+  chDbgCheck(mbp != NULL);
+
+  return chMsgSend(tp, (msg_t)mbp);
+}
+
+/**
+ * @brief   Returns the buffer descriptor carried by the specified thread.
+ * @pre     This function must be invoked immediately after exiting a call
+ *          to @p chMsgWait() for a message sent using
+ *          @p chMsgSendBuffer().
+ * @note    The buffer is stable until @p chMsgRelease() is invoked because
+ *          the sending thread is suspended until then.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The buffer descriptor carried by the sender.
+ *
+ * @api
+ */
+static inline msg_buffer_t *chMsgGetBuffer(thread_t *tp) {
+
+  return (msg_buffer_t *)chMsgGet(tp);
+}
+
 #endif /* CH_CFG_USE_MESSAGES == TRUE */
 
 #endif /* CHMSG_H */
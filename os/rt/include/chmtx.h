@@ -99,10 +99,13 @@ struct ch_mutex {
 #ifdef __cplusplus
 extern "C" {
 #endif
+  void __mtx_timeout(thread_t *tp);
   void chMtxObjectInit(mutex_t *mp);
   void chMtxObjectDispose(mutex_t *mp);
   void chMtxLock(mutex_t *mp);
   void chMtxLockS(mutex_t *mp);
+  msg_t chMtxLockTimeout(mutex_t *mp, sysinterval_t timeout);
+  msg_t chMtxLockTimeoutS(mutex_t *mp, sysinterval_t timeout);
   bool chMtxTryLock(mutex_t *mp);
   bool chMtxTryLockS(mutex_t *mp);
   void chMtxUnlock(mutex_t *mp);
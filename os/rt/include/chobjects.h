@@ -36,6 +36,28 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Earliest deadline first scheduling band.
+ * @details If enabled then the ready threads having priority
+ *          @p CH_CFG_EDF_PRIORITY are ordered by absolute deadline instead
+ *          of arrival order, threads at other priority levels keep the
+ *          fixed priority scheduling.
+ */
+#if !defined(CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
+/**
+ * @brief   Priority level of the EDF band.
+ * @note    Must be in the range (IDLEPRIO, HIGHPRIO].
+ * @note    Threads at this level without a deadline are scheduled behind
+ *          all the jobs in FIFO order, with the default @p NORMALPRIO this
+ *          includes the main thread.
+ */
+#if !defined(CH_CFG_EDF_PRIORITY) || defined(__DOXYGEN__)
+#define CH_CFG_EDF_PRIORITY                 NORMALPRIO
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -147,6 +169,19 @@ typedef struct ch_threads_queue {
   ch_queue_t                    queue;
 } threads_queue_t;
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of the deadline statistics of a thread.
+ */
+typedef struct ch_edf_stats {
+  ucnt_t                        jobs;       /**< @brief Completed jobs.     */
+  ucnt_t                        misses;     /**< @brief Jobs completed after
+                                                        their deadline.     */
+  sysinterval_t                 lateness;   /**< @brief Worst lateness in
+                                                        system ticks.       */
+} edf_stats_t;
+#endif
+
 /**
  * @brief   Structure representing a thread.
  * @note    Not all the listed fields are always needed, by switching off some
@@ -199,6 +234,18 @@ struct ch_thread {
    *          dynamic threading.
    */
   stkalign_t                    *wabase;
+#endif
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Lower boundary of the painted stack area.
+   * @note    The stack area between this pointer and @p stktop is
+   *          painted, @p NULL if the stack is not tracked.
+   */
+  uint32_t                      *stkmark;
+  /**
+   * @brief   Upper boundary of the tracked stack area.
+   */
+  uint32_t                      *stktop;
 #endif
   /**
    * @brief   Current thread state.
@@ -336,6 +383,18 @@ struct ch_thread {
    */
   time_measurement_t            stats;
 #endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Absolute deadline of the current job.
+   * @note    The deadline only affects the scheduling while the thread
+   *          priority is @p CH_CFG_EDF_PRIORITY.
+   */
+  systime_t                     deadline;
+  /**
+   * @brief   Deadline statistics.
+   */
+  edf_stats_t                   edfstats;
+#endif
 #if defined(CH_CFG_THREAD_EXTRA_FIELDS)
   /* Extra fields defined in chconf.h.*/
   CH_CFG_THREAD_EXTRA_FIELDS
@@ -212,6 +212,28 @@ static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 #endif
 }
 
+/**
+ * @brief   Returns the stack high-water mark of the specified thread.
+ * @pre     This function only returns the measured value if the option
+ *          @p CH_DBG_STACK_USAGE is enabled else zero is returned.
+ * @note    See @p chThdGetStackUsage() for the measurement limits.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The maximum number of stack bytes used by the thread.
+ * @retval 0            if the thread stack is not tracked.
+ *
+ * @api
+ */
+static inline size_t chRegGetThreadStackUsage(thread_t *tp) {
+
+#if CH_DBG_STACK_USAGE == TRUE
+  return chThdGetStackUsage(tp);
+#else
+  (void)tp;
+  return (size_t)0;
+#endif
+}
+
 #endif /* CHREGISTRY_H */
 
 /** @} */
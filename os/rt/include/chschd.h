@@ -104,6 +104,8 @@
                                                  from a Memory Pool.        */
 #define CH_FLAG_TERMINATE   (tmode_t)4U     /**< @brief Termination requested
                                                  flag.                      */
+#define CH_FLAG_EDF_JOB     (tmode_t)8U     /**< @brief A job with deadline
+                                                 is in progress.            */
 /** @} */
 
 /*===========================================================================*/
@@ -151,6 +153,9 @@ extern "C" {
   thread_t *chSchReadyI(thread_t *tp);
   void chSchGoSleepS(tstate_t newstate);
   msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout);
+  msg_t chSchGoSleepTimeoutWithSlackS(tstate_t newstate,
+                                      sysinterval_t timeout,
+                                      sysinterval_t slack);
   void chSchWakeupS(thread_t *ntp, msg_t msg);
   void chSchRescheduleS(void);
   bool chSchIsPreemptionRequired(void);
@@ -186,6 +191,27 @@ static inline void ch_sch_prio_insert(ch_queue_t *qp, ch_queue_t *tp) {
 }
 #endif /* CH_CFG_OPTIMIZE_SPEED == TRUE */
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Compares two absolute deadlines.
+ * @note    Deadlines are assumed to be less than half of the system time
+ *          range apart, this makes the comparison wrap-around safe.
+ *
+ * @param[in] d1        first absolute deadline
+ * @param[in] d2        second absolute deadline
+ * @return              The comparison result.
+ * @retval true         if @p d1 is strictly earlier than @p d2.
+ * @retval false        if @p d1 is equal or later than @p d2.
+ *
+ * @notapi
+ */
+static inline bool ch_sch_deadline_precedes(systime_t d1, systime_t d2) {
+  systime_t diff = (systime_t)(d2 - d1);
+
+  return (diff > (systime_t)0) && (diff <= ((systime_t)-1 / (systime_t)2));
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 #endif /* CHSCHD_H */
 
 /** @} */
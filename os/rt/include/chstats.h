@@ -38,6 +38,17 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of bins of the timers lateness histogram.
+ * @details Bin zero counts the timers served on time, bin @p n counts the
+ *          timers served with a lateness in the range [2^(n-1), 2^n) ticks,
+ *          the last bin also counts all the larger values.
+ * @note    The histogram is only collected in tick-less mode.
+ */
+#if !defined(CH_DBG_STATISTICS_LATENESS_BINS) || defined(__DOXYGEN__)
+#define CH_DBG_STATISTICS_LATENESS_BINS     8
+#endif
+
 #if CH_CFG_USE_TM == FALSE
 #error "CH_DBG_STATISTICS requires CH_CFG_USE_TM"
 #endif
@@ -46,6 +57,11 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_DBG_STATISTICS_LATENESS_BINS < 1) ||                                \
+    (CH_DBG_STATISTICS_LATENESS_BINS > 32)
+#error "invalid CH_DBG_STATISTICS_LATENESS_BINS value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -60,6 +76,26 @@ typedef struct {
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
                                                 zones duration.             */
+  ucnt_t                n_vt_coalesced;
+                                    /**< @brief Number of timers coalesced
+                                                with another timer.         */
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  ucnt_t                n_edf_jobs; /**< @brief Number of completed jobs
+                                                with deadline.              */
+  ucnt_t                n_edf_misses;
+                                    /**< @brief Number of jobs completed
+                                                after their deadline.       */
+#endif
+#if (CH_CFG_ST_TIMEDELTA > 0) || defined(__DOXYGEN__)
+  ucnt_t                n_vt_alarms;/**< @brief Number of served alarms.    */
+  ucnt_t                n_vt_retries;
+                                    /**< @brief Number of alarm setup
+                                                retries caused by an
+                                                insufficient delta.         */
+  ucnt_t                vt_lateness[CH_DBG_STATISTICS_LATENESS_BINS];
+                                    /**< @brief Histogram of the timers
+                                                lateness.                   */
+#endif
 } kernel_stats_t;
 
 /*===========================================================================*/
@@ -80,6 +116,16 @@ extern "C" {
   void __stats_stop_measure_crit_thd(void);
   void __stats_start_measure_crit_isr(void);
   void __stats_stop_measure_crit_isr(void);
+  void __stats_vt_coalesced(void);
+#if CH_CFG_USE_EDF == TRUE
+  void __stats_edf_job(bool missed);
+#endif
+#if CH_CFG_ST_TIMEDELTA > 0
+  void __stats_vt_alarm(void);
+  void __stats_vt_retries(sysinterval_t n);
+  void __stats_vt_lateness(sysinterval_t late);
+#endif
+  void chStatsGetKernel(kernel_stats_t *ksp);
 #ifdef __cplusplus
 }
 #endif
@@ -102,8 +148,36 @@ static inline void __stats_object_init(kernel_stats_t *ksp) {
   ksp->n_ctxswc = (ucnt_t)0;
   chTMObjectInit(&ksp->m_crit_thd);
   chTMObjectInit(&ksp->m_crit_isr);
+  ksp->n_vt_coalesced = (ucnt_t)0;
+#if CH_CFG_USE_EDF == TRUE
+  ksp->n_edf_jobs     = (ucnt_t)0;
+  ksp->n_edf_misses   = (ucnt_t)0;
+#endif
+#if CH_CFG_ST_TIMEDELTA > 0
+  {
+    unsigned i;
+
+    ksp->n_vt_alarms  = (ucnt_t)0;
+    ksp->n_vt_retries = (ucnt_t)0;
+    for (i = 0U; i < (unsigned)CH_DBG_STATISTICS_LATENESS_BINS; i++) {
+      ksp->vt_lateness[i] = (ucnt_t)0;
+    }
+  }
+#endif
 }
 
+#if CH_CFG_ST_TIMEDELTA == 0
+/* Stub functions for when the tick mode is used. */
+#define __stats_vt_alarm()
+#define __stats_vt_retries(n)
+#define __stats_vt_lateness(late)
+#endif
+
+#if CH_CFG_USE_EDF == FALSE
+/* Stub functions for when the EDF band is disabled. */
+#define __stats_edf_job(missed)
+#endif
+
 #else /* CH_DBG_STATISTICS == FALSE */
 
 /* Stub functions for when the statistics module is disabled. */
@@ -113,6 +187,11 @@ static inline void __stats_object_init(kernel_stats_t *ksp) {
 #define __stats_stop_measure_crit_thd()
 #define __stats_start_measure_crit_isr()
 #define __stats_stop_measure_crit_isr()
+#define __stats_vt_coalesced()
+#define __stats_edf_job(missed)
+#define __stats_vt_alarm()
+#define __stats_vt_retries(n)
+#define __stats_vt_lateness(late)
 
 #endif /* CH_DBG_STATISTICS == FALSE */
 
@@ -292,6 +292,10 @@ extern "C" {
                                tprio_t prio);
 #if CH_DBG_FILL_THREADS == TRUE
   void __thd_stackfill(uint8_t *startp, uint8_t *endp);
+#endif
+#if CH_DBG_STACK_USAGE == TRUE
+  void __thd_stackpaint_init(thread_t *tp, void *topp);
+  size_t chThdGetStackUsage(thread_t *tp);
 #endif
   thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp);
   thread_t *chThdCreateSuspended(const thread_descriptor_t *tdp);
@@ -322,8 +326,19 @@ extern "C" {
   void chThdDequeueNextI(threads_queue_t *tqp, msg_t msg);
   void chThdDequeueAllI(threads_queue_t *tqp, msg_t msg);
   void chThdSleep(sysinterval_t time);
+  void chThdSleepWithSlack(sysinterval_t time, sysinterval_t slack);
   void chThdSleepUntil(systime_t time);
   systime_t chThdSleepUntilWindowed(systime_t prev, systime_t next);
+#if CH_CFG_USE_EDF == TRUE
+  void chThdSetDeadlineS(systime_t deadline);
+  void chThdSetDeadline(systime_t deadline);
+  void chThdEndJobS(void);
+  void chThdEndJob(void);
+  thread_t *chThdStartJobI(thread_t *tp, systime_t deadline);
+  systime_t chThdSleepUntilRelease(systime_t prev, systime_t next,
+                                   sysinterval_t deadline);
+  void chThdGetDeadlineStats(thread_t *tp, edf_stats_t *esp);
+#endif
   void chThdYield(void);
 #ifdef __cplusplus
 }
@@ -375,6 +390,21 @@ static inline systime_t chThdGetTicksX(thread_t *tp) {
 }
 #endif
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the absolute deadline of the specified thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The absolute deadline of the current job.
+ *
+ * @xclass
+ */
+static inline systime_t chThdGetDeadlineX(thread_t *tp) {
+
+  return tp->deadline;
+}
+#endif
+
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
     defined(__DOXYGEN__)
 /**
@@ -453,6 +483,31 @@ static inline void chThdSleepS(sysinterval_t ticks) {
   (void) chSchGoSleepTimeoutS(CH_STATE_SLEEPING, ticks);
 }
 
+/**
+ * @brief   Suspends the invoking thread for the specified number of ticks
+ *          allowing the wakeup to be delayed.
+ * @details The wakeup can be delayed up to @p slack ticks in order to be
+ *          coalesced with other virtual timers, this reduces the number
+ *          of alarms served by the system.
+ *
+ * @param[in] ticks     the delay in system ticks, the special values are
+ *                      handled as follow:
+ *                      - @a TIME_INFINITE the thread enters an infinite sleep
+ *                        state.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the acceptable additional delay in system ticks
+ *
+ * @sclass
+ */
+static inline void chThdSleepWithSlackS(sysinterval_t ticks,
+                                        sysinterval_t slack) {
+
+  chDbgCheck(ticks != TIME_IMMEDIATE);
+
+  (void) chSchGoSleepTimeoutWithSlackS(CH_STATE_SLEEPING, ticks, slack);
+}
+
 /**
  * @brief   Evaluates to @p true if the specified queue is empty.
  *
@@ -102,6 +102,8 @@ extern "C" {
   void chVTObjectDispose(virtual_timer_t *vtp);
   void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
                   vtfunc_t vtfunc, void *par);
+  void chVTDoSetWithSlackI(virtual_timer_t *vtp, sysinterval_t delay,
+                           sysinterval_t slack, vtfunc_t vtfunc, void *par);
   void chVTDoSetContinuousI(virtual_timer_t *vtp, sysinterval_t delay,
                             vtfunc_t vtfunc, void *par);
   void chVTDoResetI(virtual_timer_t *vtp);
@@ -149,6 +149,136 @@ thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
 
   thread_descriptor_t td = THD_DESCRIPTOR(name, wbase, wend, prio, pf, arg);
 
+#if CH_DBG_FILL_THREADS == TRUE
+  __thd_stackfill((uint8_t *)wbase, (uint8_t *)wend);
+#endif
+
+  chSysLock();
+  tp = chThdCreateSuspendedI(&td);
+  tp->flags = CH_FLAG_MODE_MPOOL;
+  tp->mpool = mp;
+  chSchWakeupS(tp, MSG_OK);
+  chSysUnlock();
+
+  return tp;
+}
+
+/**
+ * @brief   Initializes a working areas cache.
+ * @pre     The pools must be initialized to contain only objects with
+ *          alignment @p PORT_WORKING_AREA_ALIGN and must be ordered by
+ *          increasing objects size.
+ * @note    Pools having a memory provider allocate new working areas when
+ *          empty, pools without provider can only use the working areas
+ *          explicitly loaded into them.
+ *
+ * @param[out] tcp      pointer to a @p thread_cache_t structure
+ * @param[in] pools     array of memory pools, one for each size class
+ * @param[in] n         number of size classes
+ *
+ * @init
+ */
+void chThdCacheObjectInit(thread_cache_t *tcp,
+                          memory_pool_t *pools, unsigned n) {
+  unsigned i;
+
+  chDbgCheck((tcp != NULL) && (pools != NULL) && (n > 0U));
+
+  for (i = 0U; i < n; i++) {
+    chDbgAssert(MEM_IS_ALIGNED(pools[i].align, PORT_WORKING_AREA_ALIGN),
+                "invalid pool alignment");
+    chDbgAssert((i == 0U) ||
+                (pools[i].object_size > pools[i - 1U].object_size),
+                "size classes not ordered");
+  }
+
+  tcp->pools  = pools;
+  tcp->n      = n;
+  tcp->hits   = (ucnt_t)0;
+  tcp->misses = (ucnt_t)0;
+}
+
+/**
+ * @brief   Creates a new thread taking the working area from a cache.
+ * @details The smallest size class able to contain the requested working
+ *          area and having a cached working area is used, if none is
+ *          available then a new working area is allocated from the
+ *          provider of the smallest fitting size class.
+ * @pre     The configuration options @p CH_CFG_USE_DYNAMIC and
+ *          @p CH_CFG_USE_MEMPOOLS must be enabled in order to use this
+ *          function.
+ * @note    A thread can terminate by calling @p chThdExit() or by simply
+ *          returning from its main function.
+ * @note    The working area is returned to the cache when the last
+ *          reference to the thread is released, usually by @p chThdWait().
+ *
+ * @param[in] tcp       pointer to a @p thread_cache_t structure
+ * @param[in] size      size of the required working area
+ * @param[in] name      thread name
+ * @param[in] prio      the priority level for the new thread
+ * @param[in] pf        the thread function
+ * @param[in] arg       an argument passed to the thread function. It can be
+ *                      @p NULL.
+ * @return              The pointer to the @p thread_t structure allocated for
+ *                      the thread into the working space area.
+ * @retval  NULL        if a working area cannot be obtained.
+ *
+ * @api
+ */
+thread_t *chThdCreateFromCache(thread_cache_t *tcp, size_t size,
+                               const char *name, tprio_t prio,
+                               tfunc_t pf, void *arg) {
+  thread_t *tp;
+  memory_pool_t *mp;
+  void *wbase, *wend;
+  unsigned i, first;
+
+  chDbgCheck(tcp != NULL);
+
+  /* Smallest fitting size class.*/
+  first = 0U;
+  while ((first < tcp->n) && (tcp->pools[first].object_size < size)) {
+    first++;
+  }
+  if (first >= tcp->n) {
+    return NULL;
+  }
+
+  chSysLock();
+
+  /* Searching for a cached working area starting from the smallest fitting
+     size class.*/
+  mp = NULL;
+  for (i = first; i < tcp->n; i++) {
+    if (tcp->pools[i].next != NULL) {
+      mp = &tcp->pools[i];
+      break;
+    }
+  }
+
+  if (mp != NULL) {
+    /* A cached working area is always available.*/
+    wbase = chPoolAllocI(mp);
+    tcp->hits++;
+  }
+  else {
+    /* A new working area is requested to the provider of the pool, the
+       miss is only counted if the working area has been obtained.*/
+    mp = &tcp->pools[first];
+    wbase = chPoolAllocI(mp);
+    if (wbase != NULL) {
+      tcp->misses++;
+    }
+  }
+  chSysUnlock();
+
+  if (wbase == NULL) {
+    return NULL;
+  }
+  wend = (void *)((uint8_t *)wbase + mp->object_size);
+
+  thread_descriptor_t td = THD_DESCRIPTOR(name, wbase, wend, prio, pf, arg);
+
 #if CH_DBG_FILL_THREADS == TRUE
   __thd_stackfill((uint8_t *)wbase, (uint8_t *)wend);
 #endif
@@ -159,6 +159,14 @@ void chInstanceObjectInit(os_instance_t *oip,
   /* Setting up the caller as current thread.*/
   oip->rlist.current->state = CH_STATE_CURRENT;
 
+#if CH_DBG_STACK_USAGE == TRUE
+  /* Stack usage tracking of the main thread, only possible if the stack
+     boundaries are known.*/
+  if (oicp->mainthread_end != NULL) {
+    __thd_stackpaint_init(oip->rlist.current, oicp->mainthread_end);
+  }
+#endif
+
   /* User instance initialization hook.*/
   CH_CFG_OS_INSTANCE_INIT_HOOK(oip);
 
@@ -36,6 +36,9 @@
  *          Messages are usually processed in FIFO order but it is possible to
  *          process them in priority order by enabling the
  *          @p CH_CFG_USE_MESSAGES_PRIORITY option in @p chconf.h.<br>
+ *          Larger data can be exchanged by lending a buffer described by a
+ *          @p msg_buffer_t structure, the server accesses the buffer in
+ *          place while the client is suspended.<br>
  * @pre     In order to use the message APIs the @p CH_CFG_USE_MESSAGES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling messages requires 6-12 (depending on the architecture)
@@ -213,6 +216,52 @@ void chMsgRelease(thread_t *tp, msg_t msg) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Releases a sender thread and waits for the next message.
+ * @details Combined @p chMsgReleaseS() and @p chMsgWaitS() operation, the
+ *          released thread is made ready without rescheduling and the
+ *          server goes to sleep in the same critical zone. A higher
+ *          priority sender is never switched in just to let the server
+ *          enter the wait state afterward.
+ * @note    The saved context switch only happens when the released thread
+ *          has a higher priority than the server, otherwise this is
+ *          equivalent to @p chMsgRelease() followed by @p chMsgWait().
+ * @pre     Invoke this function only after a message has been received
+ *          using @p chMsgWait().
+ * @note    The reference counter of the sender thread is not increased, the
+ *          returned pointer is a temporary reference.
+ *
+ * @param[in] tp        pointer to the thread to be released
+ * @param[in] msg       message to be returned to the sender
+ * @return              A pointer to the thread carrying the next message.
+ *
+ * @sclass
+ */
+thread_t *chMsgReleaseAndWaitS(thread_t *tp, msg_t msg) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheckClassS();
+  chDbgAssert(tp->state == CH_STATE_SNDMSG, "invalid state");
+
+  tp->u.rdymsg = msg;
+  (void) chSchReadyI(tp);
+
+  if (!chMsgIsPendingI(currtp)) {
+    chSchGoSleepS(CH_STATE_WTMSG);
+    tp = threadref(ch_queue_fifo_remove(&currtp->msgqueue));
+    tp->state = CH_STATE_SNDMSG;
+  }
+  else {
+    tp = threadref(ch_queue_fifo_remove(&currtp->msgqueue));
+    tp->state = CH_STATE_SNDMSG;
+
+    /* The released thread could have an higher priority.*/
+    chSchRescheduleS();
+  }
+
+  return tp;
+}
+
 #endif /* CH_CFG_USE_MESSAGES == TRUE */
 
 /** @} */
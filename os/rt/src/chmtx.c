@@ -91,10 +91,140 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Re-enqueues a thread after a change of its priority.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The owner of the mutex the thread is waiting on, its
+ *                      priority could need to be updated too.
+ * @retval NULL         if the thread is not waiting on a mutex.
+ *
+ * @notapi
+ */
+static thread_t *mtx_requeue(thread_t *tp) {
+
+  /* The following states need priority queues reordering.*/
+  switch (tp->state) {
+  case CH_STATE_WTMTX:
+    /* Re-enqueues tp with its new priority on the mutex queue.*/
+    ch_sch_prio_insert(&tp->u.wtmtxp->queue,
+                       ch_queue_dequeue(&tp->hdr.queue));
+    return tp->u.wtmtxp->owner;
+#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
+    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
+     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
+    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
+     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
+#if CH_CFG_USE_CONDVARS == TRUE
+  case CH_STATE_WTCOND:
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+  case CH_STATE_WTSEM:
+#endif
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
+  case CH_STATE_SNDMSGQ:
+#endif
+    /* Re-enqueues tp with its new priority on the queue.*/
+    ch_sch_prio_insert(&tp->u.wtmtxp->queue,
+                       ch_queue_dequeue(&tp->hdr.queue));
+    break;
+#endif
+  case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+    /* Prevents an assertion in chSchReadyI().*/
+    tp->state = CH_STATE_CURRENT;
+#endif
+    /* Re-enqueues tp with its new priority on the ready list.*/
+    (void) chSchReadyI(threadref(ch_queue_dequeue(&tp->hdr.queue)));
+    break;
+  default:
+    /* Nothing to do for other states.*/
+    break;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Priority inheritance, boosts a mutex owner.
+ * @details Explores the thread-mutex dependencies boosting the priority of
+ *          all the affected threads to @p prio.
+ *
+ * @param[in] tp        pointer to the mutex owner
+ * @param[in] prio      priority of the thread requesting the mutex
+ *
+ * @notapi
+ */
+static void mtx_boost(thread_t *tp, tprio_t prio) {
+
+  while ((tp != NULL) && (tp->hdr.pqueue.prio < prio)) {
+    tp->hdr.pqueue.prio = prio;
+    tp = mtx_requeue(tp);
+  }
+}
+
+/**
+ * @brief   Returns the priority a thread inherits from its owned mutexes.
+ * @details The priority is the highest among the thread base priority and
+ *          the priorities of the threads waiting on its owned mutexes.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The inherited priority.
+ *
+ * @notapi
+ */
+static tprio_t mtx_inherited_prio(thread_t *tp) {
+  tprio_t prio = tp->realprio;
+  mutex_t *lmp = tp->mtxlist;
+
+  while (lmp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the thread base priority then the final
+       priority will have at least that priority.*/
+    if (ch_queue_notempty(&lmp->queue) &&
+        ((threadref(lmp->queue.next))->hdr.pqueue.prio > prio)) {
+      prio = threadref(lmp->queue.next)->hdr.pqueue.prio;
+    }
+    lmp = lmp->next;
+  }
+
+  return prio;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Handles the timeout of a thread waiting on a mutex.
+ * @details The thread is removed from the mutex queue and the priority of
+ *          the threads it boosted is recalculated.
+ * @note    Not a user function, it is invoked by the scheduler timeout
+ *          handler.
+ *
+ * @param[in] tp        pointer to the thread in @p CH_STATE_WTMTX state
+ *
+ * @notapi
+ */
+void __mtx_timeout(thread_t *tp) {
+  thread_t *otp = tp->u.wtmtxp->owner;
+
+  (void) ch_queue_dequeue(&tp->hdr.queue);
+
+  /* The priority can only decrease, the chain is followed while there are
+     changes.*/
+  while (otp != NULL) {
+    tprio_t prio = mtx_inherited_prio(otp);
+
+    if (prio == otp->hdr.pqueue.prio) {
+      break;
+    }
+    otp->hdr.pqueue.prio = prio;
+    otp = mtx_requeue(otp);
+  }
+}
+
 /**
  * @brief   Initializes s @p mutex_t structure.
  *
@@ -186,60 +316,9 @@ void chMtxLockS(mutex_t *mp) {
     }
     else {
 #endif
-      /* Priority inheritance protocol; explores the thread-mutex dependencies
-         boosting the priority of all the affected threads to equal the
-         priority of the running thread requesting the mutex.*/
-      thread_t *tp = mp->owner;
-
-      /* Does the running thread have higher priority than the mutex
-         owning thread? */
-      while (tp->hdr.pqueue.prio < currtp->hdr.pqueue.prio) {
-        /* Make priority of thread tp match the running thread's priority.*/
-        tp->hdr.pqueue.prio = currtp->hdr.pqueue.prio;
-
-        /* The following states need priority queues reordering.*/
-        switch (tp->state) {
-        case CH_STATE_WTMTX:
-          /* Re-enqueues the mutex owner with its new priority.*/
-          ch_sch_prio_insert(&tp->u.wtmtxp->queue,
-                             ch_queue_dequeue(&tp->hdr.queue));
-          tp = tp->u.wtmtxp->owner;
-          /*lint -e{9042} [16.1] Continues the while.*/
-          continue;
-#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
-    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
-     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
-    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
-     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
-#if CH_CFG_USE_CONDVARS == TRUE
-        case CH_STATE_WTCOND:
-#endif
-#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
-    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
-        case CH_STATE_WTSEM:
-#endif
-#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
-        case CH_STATE_SNDMSGQ:
-#endif
-          /* Re-enqueues tp with its new priority on the queue.*/
-          ch_sch_prio_insert(&tp->u.wtmtxp->queue,
-                             ch_queue_dequeue(&tp->hdr.queue));
-          break;
-#endif
-        case CH_STATE_READY:
-#if CH_DBG_ENABLE_ASSERTS == TRUE
-          /* Prevents an assertion in chSchReadyI().*/
-          tp->state = CH_STATE_CURRENT;
-#endif
-          /* Re-enqueues tp with its new priority on the ready list.*/
-          (void) chSchReadyI(threadref(ch_queue_dequeue(&tp->hdr.queue)));
-          break;
-        default:
-          /* Nothing to do for other states.*/
-          break;
-        }
-        break;
-      }
+      /* Priority inheritance protocol, the owner and the threads it is
+         waiting on are boosted to the running thread priority.*/
+      mtx_boost(mp->owner, currtp->hdr.pqueue.prio);
 
       /* Sleep on the mutex.*/
       ch_sch_prio_insert(&mp->queue, &currtp->hdr.queue);
@@ -268,6 +347,102 @@ void chMtxLockS(mutex_t *mp) {
   }
 }
 
+/**
+ * @brief   Locks the specified mutex with timeout.
+ * @details The priority inheritance protocol is applied while waiting, on
+ *          timeout the priority of the threads boosted by the invoking
+ *          thread is recalculated.
+ * @post    On success the mutex is locked and inserted in the per-thread
+ *          stack of owned mutexes.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the mutex has been locked.
+ * @retval MSG_TIMEOUT  if the mutex has not been locked within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chMtxLockTimeout(mutex_t *mp, sysinterval_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chMtxLockTimeoutS(mp, timeout);
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Locks the specified mutex with timeout.
+ * @details The priority inheritance protocol is applied while waiting, on
+ *          timeout the priority of the threads boosted by the invoking
+ *          thread is recalculated.
+ * @post    On success the mutex is locked and inserted in the per-thread
+ *          stack of owned mutexes.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the mutex has been locked.
+ * @retval MSG_TIMEOUT  if the mutex has not been locked within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chMtxLockTimeoutS(mutex_t *mp, sysinterval_t timeout) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheckClassS();
+  chDbgCheck(mp != NULL);
+
+  /* Cases not involving a timed wait.*/
+  if ((mp->owner == NULL) ||
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+      (mp->owner == currtp) ||
+#endif
+      (timeout == TIME_INFINITE)) {
+    chMtxLockS(mp);
+    return MSG_OK;
+  }
+
+  if (unlikely(timeout == TIME_IMMEDIATE)) {
+    return MSG_TIMEOUT;
+  }
+
+  /* Priority inheritance protocol, the owner and the threads it is waiting
+     on are boosted to the running thread priority.*/
+  mtx_boost(mp->owner, currtp->hdr.pqueue.prio);
+
+  /* Sleep on the mutex, on timeout the thread is removed from the queue
+     and the boosted priorities are recalculated by __mtx_timeout().*/
+  ch_sch_prio_insert(&mp->queue, &currtp->hdr.queue);
+  currtp->u.wtmtxp = mp;
+  (void) chSchGoSleepTimeoutS(CH_STATE_WTMTX, timeout);
+
+  /* The unlocking thread assigns the mutex to this thread, the wake-up
+     message is not set in that case so ownership is checked instead.*/
+  if (mp->owner != currtp) {
+    return MSG_TIMEOUT;
+  }
+
+  chDbgAssert(currtp->mtxlist == mp, "not owned");
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  chDbgAssert(mp->cnt == (cnt_t)1, "counter is not one");
+#endif
+
+  return MSG_OK;
+}
+
 /**
  * @brief   Tries to lock a mutex.
  * @details This function attempts to lock a mutex, if the mutex is already
@@ -356,7 +531,6 @@ bool chMtxTryLockS(mutex_t *mp) {
  */
 void chMtxUnlock(mutex_t *mp) {
   thread_t *currtp = chThdGetSelfX();
-  mutex_t *lmp;
 
   chDbgCheck(mp != NULL);
 
@@ -381,24 +555,9 @@ void chMtxUnlock(mutex_t *mp) {
     if (chMtxQueueNotEmptyS(mp)) {
       thread_t *tp;
 
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = currtp->realprio;
-      lmp = currtp->mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            ((threadref(lmp->queue.next))->hdr.pqueue.prio > newprio)) {
-          newprio = (threadref(lmp->queue.next))->hdr.pqueue.prio;
-        }
-        lmp = lmp->next;
-      }
-
       /* Assigns to the current thread the highest priority among all the
-         waiting threads.*/
-      currtp->hdr.pqueue.prio = newprio;
+         threads waiting on its owned mutexes.*/
+      currtp->hdr.pqueue.prio = mtx_inherited_prio(currtp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -443,7 +602,6 @@ void chMtxUnlock(mutex_t *mp) {
  */
 void chMtxUnlockS(mutex_t *mp) {
   thread_t *currtp = chThdGetSelfX();
-  mutex_t *lmp;
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
@@ -467,24 +625,9 @@ void chMtxUnlockS(mutex_t *mp) {
     if (chMtxQueueNotEmptyS(mp)) {
       thread_t *tp;
 
-      /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = currtp->realprio;
-      lmp = currtp->mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            ((threadref(lmp->queue.next))->hdr.pqueue.prio > newprio)) {
-          newprio = threadref(lmp->queue.next)->hdr.pqueue.prio;
-        }
-        lmp = lmp->next;
-      }
-
       /* Assigns to the current thread the highest priority among all the
-         waiting threads.*/
-      currtp->hdr.pqueue.prio = newprio;
+         threads waiting on its owned mutexes.*/
+      currtp->hdr.pqueue.prio = mtx_inherited_prio(currtp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -220,6 +220,9 @@ thread_t *chRegNextThread(thread_t *tp) {
  * @note    The reference counter of the found thread is increased by one so
  *          it cannot be disposed incidentally after the pointer has been
  *          returned.
+ * @note    The registry is scanned within a single critical zone without
+ *          taking references to the scanned threads, names are compared
+ *          by pointer before comparing the strings.
  *
  * @param[in] name      the thread name
  * @return              A pointer to the found thread.
@@ -228,18 +231,37 @@ thread_t *chRegNextThread(thread_t *tp) {
  * @api
  */
 thread_t *chRegFindThreadByName(const char *name) {
-  thread_t *ctp;
+  thread_t *tp = NULL;
+  ch_queue_t *qp;
+
+  chDbgCheck(name != NULL);
+
+  chSysLock();
 
   /* Scanning registry.*/
-  ctp = chRegFirstThread();
-  do {
-    if (strcmp(chRegGetThreadNameX(ctp), name) == 0) {
-      return ctp;
+  qp = REG_HEADER(currcore)->next;
+  while (qp != REG_HEADER(currcore)) {
+    /*lint -save -e413 [1.3] Safe to subtract a calculated offset.*/
+    thread_t *ctp = threadref(((uint8_t *)qp -
+                               __CH_OFFSETOF(thread_t, rqueue)));
+    /*lint -restore*/
+    const char *s = ctp->name;
+
+    if ((s == name) || ((s != NULL) && (strcmp(s, name) == 0))) {
+#if CH_CFG_USE_DYNAMIC == TRUE
+      chDbgAssert(ctp->refs < (trefs_t)255, "too many references");
+
+      ctp->refs++;
+#endif
+      tp = ctp;
+      break;
     }
-    ctp = chRegNextThread(ctp);
-  } while (ctp != NULL);
+    qp = qp->next;
+  }
 
-  return NULL;
+  chSysUnlock();
+
+  return tp;
 }
 
 /**
@@ -48,6 +48,110 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if a thread has a job with a deadline.
+ *
+ * @notapi
+ */
+#define __sch_is_job(tp)        (((tp)->flags & CH_FLAG_EDF_JOB) != (tmode_t)0)
+#endif
+
+/**
+ * @brief   Checks if a thread must be scheduled before another thread.
+ * @details A thread precedes another one if it has higher priority or, when
+ *          both threads belong to the EDF band, if it has an earlier
+ *          deadline. Threads in the band without a job are scheduled
+ *          behind all jobs.
+ * @note    The ready list header can be passed as @p tp1 because its
+ *          priority is lower than any thread priority.
+ *
+ * @param[in] tp1       pointer to the first thread
+ * @param[in] tp2       pointer to the second thread
+ * @return              The comparison result.
+ *
+ * @notapi
+ */
+static inline bool __sch_precedes(thread_t *tp1, thread_t *tp2) {
+
+#if CH_CFG_USE_EDF == TRUE
+  if ((tp1->hdr.pqueue.prio == (tprio_t)CH_CFG_EDF_PRIORITY) &&
+      (tp2->hdr.pqueue.prio == (tprio_t)CH_CFG_EDF_PRIORITY)) {
+    if (!__sch_is_job(tp2)) {
+      return __sch_is_job(tp1);
+    }
+    return __sch_is_job(tp1) &&
+           ch_sch_deadline_precedes(tp1->deadline, tp2->deadline);
+  }
+#endif
+
+  return tp1->hdr.pqueue.prio > tp2->hdr.pqueue.prio;
+}
+
+/**
+ * @brief   Returns the first thread in the ready list.
+ * @note    The ready list header is returned if the list is empty.
+ *
+ * @notapi
+ */
+#define __sch_first(oip)        threadref((oip)->rlist.pqueue.next)
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a thread in the EDF band of the ready list.
+ * @details The thread is positioned behind all threads with higher priority
+ *          and all threads in the band with earlier deadline. Threads with
+ *          the same deadline are handled as peers. Threads without a job
+ *          are positioned behind all jobs, in FIFO order.
+ *
+ * @param[in] pqp       pointer to the ready list header
+ * @param[in] tp        the thread to be made ready
+ * @param[in] behind    @p true if the thread must be placed behind its peers
+ * @return              The thread pointer.
+ *
+ * @notapi
+ */
+static thread_t *__sch_edf_insert(ch_priority_queue_t *pqp,
+                                  thread_t *tp,
+                                  bool behind) {
+  ch_priority_queue_t *p = &tp->hdr.pqueue;
+  ch_priority_queue_t *cp = pqp->next;
+
+  /* Skipping threads at higher priority levels, the header priority is
+     lower than the band so the scan always terminates.*/
+  while (cp->prio > p->prio) {
+    cp = cp->next;
+  }
+
+  /* Skipping threads in the band with an earlier deadline, or the same
+     deadline when going behind peers. Jobs go ahead of threads without a
+     job, those are peers.*/
+  while (cp->prio == p->prio) {
+    thread_t *ctp = threadref(cp);
+
+    if (__sch_is_job(tp)) {
+      if (!__sch_is_job(ctp) ||
+          ch_sch_deadline_precedes(tp->deadline, ctp->deadline) ||
+          (!behind && (ctp->deadline == tp->deadline))) {
+        break;
+      }
+    }
+    else if (!behind && !__sch_is_job(ctp)) {
+      break;
+    }
+    cp = cp->next;
+  }
+
+  /* Insertion on prev.*/
+  p->next       = cp;
+  p->prev       = cp->prev;
+  p->prev->next = p;
+  cp->prev      = p;
+
+  return tp;
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /**
  * @brief   Inserts a thread in the Ready List placing it behind its peers.
  * @details The thread is positioned behind all threads with higher or equal
@@ -76,6 +180,13 @@ static thread_t *__sch_ready_behind(thread_t *tp) {
   /* The thread is marked ready.*/
   tp->state = CH_STATE_READY;
 
+#if CH_CFG_USE_EDF == TRUE
+  /* Threads in the EDF band are ordered by deadline.*/
+  if (tp->hdr.pqueue.prio == (tprio_t)CH_CFG_EDF_PRIORITY) {
+    return __sch_edf_insert(&tp->owner->rlist.pqueue, tp, true);
+  }
+#endif
+
   /* Insertion in the priority queue.*/
   return threadref(ch_pqueue_insert_behind(&tp->owner->rlist.pqueue,
                                            &tp->hdr.pqueue));
@@ -109,6 +220,13 @@ static thread_t *__sch_ready_ahead(thread_t *tp) {
   /* The thread is marked ready.*/
   tp->state = CH_STATE_READY;
 
+#if CH_CFG_USE_EDF == TRUE
+  /* Threads in the EDF band are ordered by deadline.*/
+  if (tp->hdr.pqueue.prio == (tprio_t)CH_CFG_EDF_PRIORITY) {
+    return __sch_edf_insert(&tp->owner->rlist.pqueue, tp, false);
+  }
+#endif
+
   /* Insertion in the priority queue.*/
   return threadref(ch_pqueue_insert_ahead(&tp->owner->rlist.pqueue,
                                           &tp->hdr.pqueue));
@@ -217,6 +335,12 @@ static void __sch_wakeup(virtual_timer_t *vtp, void *p) {
     /* States requiring dequeuing.*/
     (void) ch_queue_dequeue(&tp->hdr.queue);
     break;
+#if CH_CFG_USE_MUTEXES == TRUE
+  case CH_STATE_WTMTX:
+    /* Dequeuing and undoing the priority inheritance.*/
+    __mtx_timeout(tp);
+    break;
+#endif
   default:
     /* Any other state, nothing to do.*/
     break;
@@ -377,6 +501,50 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
   return tp->u.rdymsg;
 }
 
+/**
+ * @brief   Puts the current thread to sleep into the specified state with
+ *          a tolerant timeout specification.
+ * @details Like @p chSchGoSleepTimeoutS() but the timeout is allowed to
+ *          expire up to @p slack ticks later in order to be coalesced with
+ *          other virtual timers.
+ *
+ * @param[in] newstate  the new thread state
+ * @param[in] timeout   the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE the thread enters an infinite sleep
+ *                        state, this is equivalent to invoking
+ *                        @p chSchGoSleepS() but, of course, less efficient.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the acceptable additional delay in ticks
+ * @return              The wakeup message.
+ * @retval MSG_TIMEOUT  if a timeout occurs.
+ *
+ * @sclass
+ */
+msg_t chSchGoSleepTimeoutWithSlackS(tstate_t newstate,
+                                    sysinterval_t timeout,
+                                    sysinterval_t slack) {
+  thread_t *tp = __instance_get_currthread(currcore);
+
+  chDbgCheckClassS();
+
+  if (TIME_INFINITE != timeout) {
+    virtual_timer_t vt;
+
+    chVTDoSetWithSlackI(&vt, timeout, slack, __sch_wakeup, (void *)tp);
+    chSchGoSleepS(newstate);
+    if (chVTIsArmedI(&vt)) {
+      chVTDoResetI(&vt);
+    }
+  }
+  else {
+    chSchGoSleepS(newstate);
+  }
+
+  return tp->u.rdymsg;
+}
+
 /**
  * @brief   Wakes up a thread.
  * @details The thread is inserted into the ready list or immediately made
@@ -424,7 +592,7 @@ void chSchWakeupS(thread_t *ntp, msg_t msg) {
      list instead.
      Note, we are favoring the path where the woken thread has higher
      priority.*/
-  if (unlikely(ntp->hdr.pqueue.prio <= otp->hdr.pqueue.prio)) {
+  if (unlikely(!__sch_precedes(ntp, otp))) {
     (void) __sch_ready_behind(ntp);
   }
   else {
@@ -463,7 +631,7 @@ void chSchRescheduleS(void) {
 
   /* Note, we are favoring the path where the reschedule is necessary
      because higher priority threads are ready.*/
-  if (likely(firstprio(&oip->rlist.pqueue) > tp->hdr.pqueue.prio)) {
+  if (likely(__sch_precedes(__sch_first(oip), tp))) {
     __sch_reschedule_ahead();
   }
 }
@@ -485,20 +653,19 @@ void chSchRescheduleS(void) {
 bool chSchIsPreemptionRequired(void) {
   os_instance_t *oip = currcore;
   thread_t *tp = __instance_get_currthread(oip);
-
-  tprio_t p1 = firstprio(&oip->rlist.pqueue);
-  tprio_t p2 = tp->hdr.pqueue.prio;
+  thread_t *ftp = __sch_first(oip);
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* If the running thread has not reached its time quantum, reschedule only
      if the first thread on the ready queue has a higher priority.
      Otherwise, if the running thread has used up its time quantum, reschedule
      if the first thread on the ready queue has equal or higher priority.*/
-  return (tp->ticks > (tslices_t)0) ? (p1 > p2) : (p1 >= p2);
+  return (tp->ticks > (tslices_t)0) ? __sch_precedes(ftp, tp) :
+                                      !__sch_precedes(tp, ftp);
 #else
   /* If the round robin preemption feature is not enabled then performs a
      simpler comparison.*/
-  return p1 > p2;
+  return __sch_precedes(ftp, tp);
 #endif
 }
 #endif /* !defined(CH_SCH_IS_PREEMPTION_REQUIRED_HOOKED) */
@@ -568,24 +735,23 @@ void chSchDoPreemption(void) {
 void chSchPreemption(void) {
   os_instance_t *oip = currcore;
   thread_t *tp = __instance_get_currthread(oip);
-  tprio_t p1 = firstprio(&oip->rlist.pqueue);
-  tprio_t p2 = tp->hdr.pqueue.prio;
+  thread_t *ftp = __sch_first(oip);
 
   /* Note, we are favoring the path where preemption is necessary
      because higher priority threads are ready.*/
 #if CH_CFG_TIME_QUANTUM > 0
   if (tp->ticks > (tslices_t)0) {
-    if (likely(p1 > p2)) {
+    if (likely(__sch_precedes(ftp, tp))) {
       __sch_reschedule_ahead();
     }
   }
   else {
-    if (likely(p1 >= p2)) {
+    if (likely(!__sch_precedes(tp, ftp))) {
       __sch_reschedule_behind();
     }
   }
 #else /* CH_CFG_TIME_QUANTUM == 0 */
-  if (likely(p1 > p2)) {
+  if (likely(__sch_precedes(ftp, tp))) {
     __sch_reschedule_ahead();
   }
 #endif /* CH_CFG_TIME_QUANTUM == 0 */
@@ -607,7 +773,7 @@ void chSchDoYieldS(void) {
 
   /* If this function has been called then it is likely there are threads
      at same priority level.*/
-  if (likely(firstprio(&oip->rlist.pqueue) >= tp->hdr.pqueue.prio)) {
+  if (likely(!__sch_precedes(tp, __sch_first(oip)))) {
     __sch_reschedule_behind();
   }
 }
@@ -108,6 +108,82 @@ void __stats_stop_measure_crit_isr(void) {
   chTMStopMeasurementX(&currcore->kernel_stats.m_crit_isr);
 }
 
+/**
+ * @brief   Increases the coalesced timers counter.
+ */
+void __stats_vt_coalesced(void) {
+
+  currcore->kernel_stats.n_vt_coalesced++;
+}
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Accounts a completed job with deadline.
+ *
+ * @param[in] missed    @p true if the job completed after its deadline
+ */
+void __stats_edf_job(bool missed) {
+
+  currcore->kernel_stats.n_edf_jobs++;
+  if (missed) {
+    currcore->kernel_stats.n_edf_misses++;
+  }
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_CFG_ST_TIMEDELTA > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Increases the served alarms counter.
+ */
+void __stats_vt_alarm(void) {
+
+  currcore->kernel_stats.n_vt_alarms++;
+}
+
+/**
+ * @brief   Accounts alarm setup retries.
+ *
+ * @param[in] n         number of retries
+ */
+void __stats_vt_retries(sysinterval_t n) {
+
+  currcore->kernel_stats.n_vt_retries += (ucnt_t)n;
+}
+
+/**
+ * @brief   Accounts a timer lateness into the histogram.
+ *
+ * @param[in] late      lateness of the timer in ticks
+ */
+void __stats_vt_lateness(sysinterval_t late) {
+  unsigned bin = 0U;
+
+  while ((late > (sysinterval_t)0) &&
+         (bin < ((unsigned)CH_DBG_STATISTICS_LATENESS_BINS - 1U))) {
+    late >>= 1;
+    bin++;
+  }
+  currcore->kernel_stats.vt_lateness[bin]++;
+}
+#endif /* CH_CFG_ST_TIMEDELTA > 0 */
+
+/**
+ * @brief   Returns a copy of the kernel statistics.
+ * @note    The statistics of the current OS instance are returned.
+ *
+ * @param[out] ksp      pointer to a @p kernel_stats_t structure
+ *
+ * @api
+ */
+void chStatsGetKernel(kernel_stats_t *ksp) {
+
+  chDbgCheck(ksp != NULL);
+
+  chSysLock();
+  *ksp = currcore->kernel_stats;
+  chSysUnlock();
+}
+
 #endif /* CH_DBG_STATISTICS == TRUE */
 
 /** @} */
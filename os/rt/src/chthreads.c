@@ -56,6 +56,31 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stack paint pattern, the fill value replicated in all bytes.
+ */
+#define STACK_PAINT_PATTERN     ((uint32_t)CH_DBG_STACK_FILL_VALUE * 0x01010101U)
+
+/**
+ * @brief   Size of a painting step in stack words.
+ */
+#define STACK_PAINT_WORDS                                                   \
+  ((CH_DBG_STACK_USAGE_CHUNK + sizeof (uint32_t) - 1U) / sizeof (uint32_t))
+
+/**
+ * @brief   Lowest stack word of a thread.
+ */
+#define STACK_PAINT_BASE(tp)                                                \
+  ((uint32_t *)MEM_ALIGN_NEXT((tp)->wabase, sizeof (uint32_t)))
+
+/**
+ * @brief   Stack word boundary at or below the specified address.
+ */
+#define STACK_PAINT_PREV(p)                                                 \
+  ((uint32_t *)MEM_ALIGN_PREV((p), sizeof (uint32_t)))
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -72,6 +97,117 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Paints the next stack area below the painted boundary.
+ * @details At most @p CH_DBG_STACK_USAGE_CHUNK bytes are painted starting
+ *          from the lower between the painted boundary and the saved stack
+ *          pointer of the thread.
+ * @note    The stack of a running thread cannot be painted because its
+ *          stack pointer is unknown, nothing is done in that case.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+static void stack_paint_step(thread_t *tp) {
+  uint32_t *basep, *startp, *endp;
+
+  basep = STACK_PAINT_BASE(tp);
+  if ((tp->stkmark == NULL) || (tp->stkmark <= basep) ||
+      (tp->state == CH_STATE_CURRENT) || (tp->state == CH_STATE_FINAL)) {
+    return;
+  }
+
+  /* The area below the saved stack pointer is not in use.*/
+  endp = STACK_PAINT_PREV(tp->ctx.sp);
+  if (endp > tp->stkmark) {
+    endp = tp->stkmark;
+  }
+  if ((size_t)(endp - basep) > STACK_PAINT_WORDS) {
+    startp = endp - STACK_PAINT_WORDS;
+  }
+  else {
+    startp = basep;
+  }
+
+  tp->stkmark = startp;
+  while (startp < endp) {
+    *startp++ = STACK_PAINT_PATTERN;
+  }
+}
+
+/**
+ * @brief   Checks if a stack position is still untouched.
+ *
+ * @param[in] p         stack position to be checked
+ * @param[in] endp      upper limit of the check
+ * @return              The check result.
+ * @retval true         if the probed words still contain the fill pattern.
+ * @retval false        if the probed words have been used.
+ *
+ * @notapi
+ */
+static bool stack_is_untouched(const uint32_t *p, const uint32_t *endp) {
+  unsigned i;
+
+  for (i = 0U; (i < CH_DBG_STACK_USAGE_PROBE) && (p < endp); i++) {
+    if (*p++ != STACK_PAINT_PATTERN) {
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif /* CH_DBG_STACK_USAGE == TRUE */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Completes the job in progress, if any.
+ * @details The completed job is accounted in the thread deadline
+ *          statistics, it is late if it completes after its deadline.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] now       current system time
+ *
+ * @notapi
+ */
+static void edf_end_job(thread_t *tp, systime_t now) {
+
+  if ((tp->flags & CH_FLAG_EDF_JOB) != (tmode_t)0) {
+    bool missed = ch_sch_deadline_precedes(tp->deadline, now);
+
+    tp->edfstats.jobs++;
+    if (missed) {
+      sysinterval_t lateness = chTimeDiffX(tp->deadline, now);
+
+      tp->edfstats.misses++;
+      if (lateness > tp->edfstats.lateness) {
+        tp->edfstats.lateness = lateness;
+      }
+    }
+    __stats_edf_job(missed);
+    tp->flags &= (tmode_t)~CH_FLAG_EDF_JOB;
+  }
+}
+
+/**
+ * @brief   Completes the job in progress, if any, and starts a new job.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] now       current system time
+ * @param[in] deadline  absolute deadline of the new job
+ *
+ * @notapi
+ */
+static void edf_new_job(thread_t *tp, systime_t now, systime_t deadline) {
+
+  edf_end_job(tp, now);
+  tp->deadline = deadline;
+  tp->flags   |= CH_FLAG_EDF_JOB;
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -125,6 +261,16 @@ thread_t *__thd_object_init(os_instance_t *oip,
 #endif
 #if CH_DBG_STATISTICS == TRUE
   chTMObjectInit(&tp->stats);
+#endif
+#if CH_DBG_STACK_USAGE == TRUE
+  tp->stkmark           = NULL;
+  tp->stktop            = NULL;
+#endif
+#if CH_CFG_USE_EDF == TRUE
+  tp->deadline          = (systime_t)0;
+  tp->edfstats.jobs     = (ucnt_t)0;
+  tp->edfstats.misses   = (ucnt_t)0;
+  tp->edfstats.lateness = (sysinterval_t)0;
 #endif
   CH_CFG_THREAD_INIT_HOOK(tp);
   return tp;
@@ -147,6 +293,85 @@ void __thd_stackfill(uint8_t *startp, uint8_t *endp) {
 }
 #endif /* CH_DBG_FILL_THREADS */
 
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the stack usage tracking of a thread.
+ * @details The first stack area below the initial stack pointer is painted,
+ *          the rest of the working area is painted in steps on subsequent
+ *          measurements.
+ * @pre     The thread context must have already been set up or the thread
+ *          must be the current one, in the latter case painting starts on
+ *          the first measurement performed while the thread is not running.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] topp      upper boundary of the thread stack, the thread
+ *                      structure itself for threads created in a working
+ *                      area
+ *
+ * @notapi
+ */
+void __thd_stackpaint_init(thread_t *tp, void *topp) {
+
+  tp->stktop  = STACK_PAINT_PREV(topp);
+  tp->stkmark = tp->stktop;
+  stack_paint_step(tp);
+}
+
+/**
+ * @brief   Returns the stack high-water mark of a thread.
+ * @details The painted stack area is probed using a binary search for the
+ *          boundary between the untouched and the used areas, then the
+ *          painted area is extended by a further step if possible.
+ * @note    The measured value only accounts for the stack usage since the
+ *          involved area has been painted, until the whole working area
+ *          is painted the returned value could be underestimated.
+ * @note    Untouched areas in stack frames larger than
+ *          @p CH_DBG_STACK_USAGE_PROBE words can lead to underestimation.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The maximum number of stack bytes used by the thread,
+ *                      the thread structure is not accounted.
+ * @retval 0            if the thread stack is not tracked.
+ *
+ * @api
+ */
+size_t chThdGetStackUsage(thread_t *tp) {
+  uint32_t *startp, *endp, *topp;
+
+  chDbgCheck(tp != NULL);
+
+  chSysLock();
+  startp = tp->stkmark;
+  chSysUnlock();
+
+  if (startp == NULL) {
+    return (size_t)0;
+  }
+
+  /* Binary search of the boundary, the untouched area is in the lower part
+     of the painted area.*/
+  topp = tp->stktop;
+  endp = topp;
+  while (startp < endp) {
+    uint32_t *p = startp + ((size_t)(endp - startp) / (size_t)2);
+
+    if (stack_is_untouched(p, topp)) {
+      startp = p + 1;
+    }
+    else {
+      endp = p;
+    }
+  }
+
+  /* Painting another area for the next measurement.*/
+  chSysLock();
+  stack_paint_step(tp);
+  chSysUnlock();
+
+  return (size_t)((uint8_t *)topp - (uint8_t *)startp);
+}
+#endif /* CH_DBG_STACK_USAGE == TRUE */
+
 /**
  * @brief   Creates a new thread into a static memory area.
  * @details The new thread is initialized but not inserted in the ready list,
@@ -198,11 +423,21 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
   /* The thread object is initialized but not started.*/
 #if CH_CFG_SMP_MODE != FALSE
   if (tdp->instance != NULL) {
-    return __thd_object_init(tdp->instance, tp, tdp->name, tdp->prio);
+    tp = __thd_object_init(tdp->instance, tp, tdp->name, tdp->prio);
   }
+  else {
+    tp = __thd_object_init(currcore, tp, tdp->name, tdp->prio);
+  }
+#else
+  tp = __thd_object_init(currcore, tp, tdp->name, tdp->prio);
+#endif
+
+#if CH_DBG_STACK_USAGE == TRUE
+  /* Stack usage tracking.*/
+  __thd_stackpaint_init(tp, tp);
 #endif
 
-  return __thd_object_init(currcore, tp, tdp->name, tdp->prio);
+  return tp;
 }
 
 /**
@@ -366,6 +601,11 @@ thread_t *chThdCreateStatic(void *wsp, size_t size,
 
   tp = __thd_object_init(currcore, tp, "noname", prio);
 
+#if CH_DBG_STACK_USAGE == TRUE
+  /* Stack usage tracking.*/
+  __thd_stackpaint_init(tp, tp);
+#endif
+
   /* Starting the thread immediately.*/
   chSchWakeupS(tp, MSG_OK);
   chSysUnlock();
@@ -663,6 +903,30 @@ void chThdSleep(sysinterval_t time) {
   chSysUnlock();
 }
 
+/**
+ * @brief   Suspends the invoking thread for the specified time allowing the
+ *          wakeup to be delayed.
+ * @details The wakeup can be delayed up to @p slack ticks in order to be
+ *          coalesced with other virtual timers, this reduces the number
+ *          of alarms served by the system.
+ *
+ * @param[in] time      the delay in system ticks, the special values are
+ *                      handled as follow:
+ *                      - @a TIME_INFINITE the thread enters an infinite sleep
+ *                        state.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the acceptable additional delay in system ticks
+ *
+ * @api
+ */
+void chThdSleepWithSlack(sysinterval_t time, sysinterval_t slack) {
+
+  chSysLock();
+  chThdSleepWithSlackS(time, slack);
+  chSysUnlock();
+}
+
 /**
  * @brief   Suspends the invoking thread until the system time arrives to the
  *          specified value.
@@ -714,6 +978,168 @@ systime_t chThdSleepUntilWindowed(systime_t prev, systime_t next) {
   return next;
 }
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a new job of the running thread with the specified
+ *          deadline.
+ * @details The job in progress, if any, is considered complete and
+ *          accounted in the thread deadline statistics. If the thread
+ *          belongs to the EDF band then a reschedule is performed because
+ *          the new deadline can be later than the deadline of other ready
+ *          threads in the band.
+ * @note    The deadline statistics are collected regardless of the thread
+ *          priority.
+ *
+ * @param[in] deadline  absolute deadline of the new job
+ *
+ * @sclass
+ */
+void chThdSetDeadlineS(systime_t deadline) {
+
+  chDbgCheckClassS();
+
+  edf_new_job(chThdGetSelfX(), chVTGetSystemTimeX(), deadline);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Starts a new job of the running thread with the specified
+ *          deadline.
+ * @details The job in progress, if any, is considered complete and
+ *          accounted in the thread deadline statistics. If the thread
+ *          belongs to the EDF band then a reschedule is performed because
+ *          the new deadline can be later than the deadline of other ready
+ *          threads in the band.
+ * @note    The deadline statistics are collected regardless of the thread
+ *          priority.
+ *
+ * @param[in] deadline  absolute deadline of the new job
+ *
+ * @api
+ */
+void chThdSetDeadline(systime_t deadline) {
+
+  chSysLock();
+  chThdSetDeadlineS(deadline);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Completes the job in progress of the running thread.
+ * @details The job, if any, is accounted in the thread deadline statistics
+ *          and no new job is started. Threads without a job are scheduled
+ *          behind all jobs in the EDF band so a reschedule is performed.
+ * @note    Event-driven threads should end their job before waiting for the
+ *          next event, an expired deadline would else rank them ahead of
+ *          all the jobs in the band when woken up.
+ *
+ * @sclass
+ */
+void chThdEndJobS(void) {
+
+  chDbgCheckClassS();
+
+  edf_end_job(chThdGetSelfX(), chVTGetSystemTimeX());
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Completes the job in progress of the running thread.
+ * @details The job, if any, is accounted in the thread deadline statistics
+ *          and no new job is started. Threads without a job are scheduled
+ *          behind all jobs in the EDF band so a reschedule is performed.
+ * @note    Event-driven threads should end their job before waiting for the
+ *          next event, an expired deadline would else rank them ahead of
+ *          all the jobs in the band when woken up.
+ *
+ * @api
+ */
+void chThdEndJob(void) {
+
+  chSysLock();
+  chThdEndJobS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Starts a thread created with @p chThdCreateI() with a job.
+ * @details The thread enters the ready list in deadline order, threads
+ *          created together in a critical zone run by deadline.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] deadline  absolute deadline of the first job
+ * @return              The pointer to the @p thread_t structure allocated for
+ *                      the thread into the working space area.
+ *
+ * @iclass
+ */
+thread_t *chThdStartJobI(thread_t *tp, systime_t deadline) {
+
+  chDbgCheckClassI();
+  chDbgCheck(tp != NULL);
+  chDbgAssert(tp->state == CH_STATE_WTSTART, "wrong state");
+
+  tp->deadline = deadline;
+  tp->flags   |= CH_FLAG_EDF_JOB;
+
+  return chSchReadyI(tp);
+}
+
+/**
+ * @brief   Completes the job in progress and waits for the next release.
+ * @details The job in progress, if any, is accounted in the thread deadline
+ *          statistics then the thread sleeps until @p next, the job
+ *          released at @p next has deadline @p next plus @p deadline. The
+ *          deadline is assigned before sleeping so the thread enters the
+ *          ready list in deadline order when the timer wakes it up.
+ * @note    The system time is assumed to be between @p prev and @p next
+ *          else the release is assumed to be already elapsed, in this case
+ *          no sleep is performed and the new job starts immediately.
+ * @see     chThdSleepUntilWindowed()
+ *
+ * @param[in] prev      absolute system time of the previous release
+ * @param[in] next      absolute system time of the next release
+ * @param[in] deadline  relative deadline of the next job
+ * @return              the @p next parameter
+ *
+ * @api
+ */
+systime_t chThdSleepUntilRelease(systime_t prev, systime_t next,
+                                 sysinterval_t deadline) {
+  systime_t time;
+
+  chSysLock();
+  time = chVTGetSystemTimeX();
+  edf_new_job(chThdGetSelfX(), time, chTimeAddX(next, deadline));
+  if (likely(chTimeIsInRangeX(time, prev, next))) {
+    chThdSleepS(chTimeDiffX(time, next));
+  }
+  else {
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+
+  return next;
+}
+
+/**
+ * @brief   Returns a copy of the deadline statistics of a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[out] esp      pointer to a @p edf_stats_t structure
+ *
+ * @api
+ */
+void chThdGetDeadlineStats(thread_t *tp, edf_stats_t *esp) {
+
+  chDbgCheck((tp != NULL) && (esp != NULL));
+
+  chSysLock();
+  *esp = tp->edfstats;
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /**
  * @brief   Yields the time slot.
  * @details Yields the CPU control to the next thread in the ready list with
@@ -107,12 +107,16 @@ static void vt_set_alarm(systime_t now, sysinterval_t delay) {
     delay = currdelta;
   }
 
-#if !defined(CH_VT_RFCU_DISABLED)
-  /* Checking if a skip occurred.*/
+  /* Checking if a skip occurred, retries are accounted in statistics
+     regardless of the RFCU setting.*/
   if (currdelta > CH_CFG_ST_TIMEDELTA) {
+    __stats_vt_retries(currdelta - (sysinterval_t)CH_CFG_ST_TIMEDELTA);
+#if !defined(CH_VT_RFCU_DISABLED)
     chRFCUCollectFaultsI(CH_RFCU_VT_INSUFFICIENT_DELTA);
+#endif
   }
-#else
+
+#if defined(CH_VT_RFCU_DISABLED)
   /* Assertions as fallback.*/
   chDbgAssert(currdelta <= CH_CFG_ST_TIMEDELTA, "insufficient delta");
 #endif
@@ -177,12 +181,16 @@ static void vt_insert_first(virtual_timers_list_t *vtlp,
     port_timer_set_alarm(chTimeAddX(now, currdelta));
   }
 
-#if !defined(CH_VT_RFCU_DISABLED)
-  /* Checking if a skip occurred.*/
+  /* Checking if a skip occurred, retries are accounted in statistics
+     regardless of the RFCU setting.*/
   if (currdelta > CH_CFG_ST_TIMEDELTA) {
+    __stats_vt_retries(currdelta - (sysinterval_t)CH_CFG_ST_TIMEDELTA);
+#if !defined(CH_VT_RFCU_DISABLED)
     chRFCUCollectFaultsI(CH_RFCU_VT_INSUFFICIENT_DELTA);
+#endif
   }
-#else
+
+#if defined(CH_VT_RFCU_DISABLED)
   /* Assertions as fallback.*/
   chDbgAssert(currdelta <= CH_CFG_ST_TIMEDELTA, "insufficient delta");
 #endif
@@ -238,6 +246,59 @@ static void vt_enqueue(virtual_timers_list_t *vtlp,
   ch_dlist_insert(&vtlp->dlist, &vtp->dlist, delta);
 }
 
+/**
+ * @brief   Aligns a timer deadline to the deadline of an armed timer.
+ * @details The delta list is scanned for a timer whose deadline falls
+ *          within the window [delay, delay + slack], if one is found then
+ *          the delay is extended to its deadline so that both timers are
+ *          served by the same alarm.
+ *
+ * @param[in] vtlp      pointer to the delta list to be scanned
+ * @param[in] delay     the requested delay
+ * @param[in] slack     the acceptable additional delay
+ * @return              The delay to be used for the timer.
+ */
+static sysinterval_t vt_coalesce(virtual_timers_list_t *vtlp,
+                                 sysinterval_t delay,
+                                 sysinterval_t slack) {
+  ch_delta_list_t *dlp;
+  sysinterval_t offset, deadline, limit, delta;
+
+#if CH_CFG_ST_TIMEDELTA > 0
+  /* In tick-less mode the deltas are relative to 'lasttime'.*/
+  offset = chTimeDiffX(vtlp->lasttime, chVTGetSystemTimeX());
+#else
+  offset = (sysinterval_t)0;
+#endif
+
+  /* Window of acceptable deadlines, the numeric range is saturated.*/
+  deadline = offset + delay;
+  if (deadline < offset) {
+    return delay;
+  }
+  limit = deadline + slack;
+  if (limit < deadline) {
+    limit = (sysinterval_t)-1;
+  }
+
+  /* Looking for the first timer expiring within the window.*/
+  delta = (sysinterval_t)0;
+  dlp = vtlp->dlist.next;
+  while (dlp != &vtlp->dlist) {
+    delta += dlp->delta;
+    if (delta > limit) {
+      break;
+    }
+    if (delta >= deadline) {
+      __stats_vt_coalesced();
+      return delay + (delta - deadline);
+    }
+    dlp = dlp->next;
+  }
+
+  return delay;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -321,6 +382,56 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
   vt_enqueue(vtlp, vtp, delay);
 }
 
+/**
+ * @brief   Enables a one-shot virtual timer with a tolerance on its deadline.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter. If an already armed timer is due within
+ *          @p slack ticks after the requested deadline then the new timer
+ *          is aligned to it, both timers are then served by the same alarm.
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from interrupt context.
+ * @note    The scan for a coalescing deadline has a cost proportional to
+ *          the number of armed timers, the same of the timer insertion.
+ *
+ * @param[out] vtp      pointer to a @p virtual_timer_t structure
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the number of ticks the timer is allowed to be
+ *                      delayed in order to be coalesced with another timer,
+ *                      zero is equivalent to @p chVTDoSetI()
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetWithSlackI(virtual_timer_t *vtp, sysinterval_t delay,
+                         sysinterval_t slack, vtfunc_t vtfunc, void *par) {
+  virtual_timers_list_t *vtlp = &currcore->vtlist;
+
+  chDbgCheckClassI();
+  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+
+  /* Timer initialization.*/
+  vtp->par     = par;
+  vtp->func    = vtfunc;
+  vtp->reload  = (sysinterval_t)0;
+
+  /* Aligning the deadline to an armed timer, if possible.*/
+  if (slack > (sysinterval_t)0) {
+    delay = vt_coalesce(vtlp, delay, slack);
+  }
+
+  /* Inserting the timer in the delta list.*/
+  vt_enqueue(vtlp, vtp, delay);
+}
+
 /**
  * @brief   Enables a continuous virtual timer.
  * @details The timer is enabled and programmed to trigger after the delay
@@ -528,6 +639,8 @@ void chVTDoTickI(void) {
   sysinterval_t delta, nowdelta;
   systime_t now;
 
+  __stats_vt_alarm();
+
   /* Looping through timers consuming all timers with deltas lower or equal
      than the interval between "now" and "lasttime".*/
   while (true) {
@@ -548,6 +661,9 @@ void chVTDoTickI(void) {
       break;
     }
 
+    /* Time elapsed since the timer deadline.*/
+    __stats_vt_lateness(nowdelta - vtp->dlist.delta);
+
     /* Last time deadline is updated to the next timer's time.*/
     lasttime = chTimeAddX(vtlp->lasttime, vtp->dlist.delta);
     vtlp->lasttime = lasttime;
@@ -128,6 +128,33 @@
 #define CH_CFG_TIME_QUANTUM                 0
 #endif
 
+/**
+ * @brief   Earliest deadline first scheduling band.
+ * @details If enabled then the ready threads at priority
+ *          @p CH_CFG_EDF_PRIORITY are ordered by absolute deadline, the
+ *          deadlines are assigned using @p chThdSetDeadline() or
+ *          @p chThdSleepUntilRelease(). Threads at other priority levels
+ *          keep the fixed priority scheduling.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_EDF)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
+/**
+ * @brief   Priority level of the EDF band.
+ * @details Threads at this level without a deadline, the main thread
+ *          included when the level is @p NORMALPRIO, are scheduled behind
+ *          all the jobs in FIFO order. A level not used by other threads
+ *          keeps them out of the band.
+ *
+ * @note    The default is @p NORMALPRIO.
+ */
+#if !defined(CH_CFG_EDF_PRIORITY)
+#define CH_CFG_EDF_PRIORITY                 NORMALPRIO
+#endif
+
 /**
  * @brief   Idle thread automatic spawn suppression.
  * @details When this option is activated the function @p chSysInit()
@@ -518,6 +545,17 @@
 #define CH_CFG_FACTORY_MAX_NAMES_LENGTH     8
 #endif
 
+/**
+ * @brief   Size of the names hash index of each objects list.
+ * @details If non-zero the objects lists are indexed by a hash of the
+ *          names, find and release operations only scan the objects
+ *          sharing the same slot. If zero the lists are scanned linearly.
+ * @note    Must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE)
+#define CH_CFG_FACTORY_HASH_SIZE            0
+#endif
+
 /**
  * @brief   Enables the registry of generic objects.
  */
@@ -657,6 +695,18 @@
 #define CH_DBG_FILL_THREADS                 TRUE
 #endif
 
+/**
+ * @brief   Debug option, stack usage tracking.
+ * @details If enabled then the threads working area is painted incrementally
+ *          starting from the stack top, the painting cost is bounded and
+ *          the stack high-water mark can be measured at runtime.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_STACK_USAGE)
+#define CH_DBG_STACK_USAGE                  FALSE
+#endif
+
 /**
  * @brief   Debug option, threads profiling.
  * @details If enabled then a field is added to the @p thread_t structure that
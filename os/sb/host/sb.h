@@ -173,6 +173,9 @@ extern "C" {
 #include "sbposix.h"
 #include "sbapi.h"
 #include "sbhost.h"
+#if defined(SIMULATOR)
+#include "sbsim.h"
+#endif
 
 #endif /* SBHOST_H */
 
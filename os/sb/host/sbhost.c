@@ -115,6 +115,7 @@ void sbObjectInit(sb_class_t *sbcp) {
 #endif
 }
 
+#if !defined(SIMULATOR) || defined(__DOXYGEN__)
 /**
  * @brief   Starts a sandboxed thread.
  *
@@ -175,6 +176,7 @@ thread_t *sbStartThread(sb_class_t *sbcp, const sb_config_t *config,
 
   return utp;
 }
+#endif /* !defined(SIMULATOR) */
 
 #if (CH_CFG_USE_MESSAGES == TRUE) || defined(__DOXYGEN__)
 /**
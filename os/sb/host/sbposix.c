@@ -48,6 +48,7 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (SB_CFG_ENABLE_VFS == TRUE) || defined(__DOXYGEN__)
 static msg_t create_descriptor(sb_ioblock_t *iop,
                                vfs_node_c *np,
                                uint8_t attributes) {
@@ -69,6 +70,7 @@ static bool is_valid_descriptor(sb_ioblock_t *iop, int fd) {
 
   return (fd >= 0) && (fd < SB_CFG_FD_NUM) && (iop->vfs_nodes[fd] != NULL);
 }
+#endif
 
 /*===========================================================================*/
 /* Module exported functions.                                                */
@@ -169,85 +171,76 @@ off_t sb_posix_lseek(int fd, off_t offset, int whence) {
 }
 
 #else /* Fallbacks for when there is no VFS.*/
-uint32_t sb_posix_open(const char *pathname, uint32_t flags) {
+int sb_posix_open(const char *path, int flags) {
 
-  (void)pathname;
+  (void)path;
   (void)flags;
 
-  return SB_ERR_ENOENT;
+  return CH_RET_ENOENT;
 }
 
-uint32_t sb_posix_close(uint32_t fd) {
+int sb_posix_close(int fd) {
 
-  if ((fd == 0U) || (fd == 1U) || (fd == 2U)) {
+  if ((fd == 0) || (fd == 1) || (fd == 2)) {
 
-    return SB_ERR_NOERROR;
+    return CH_RET_SUCCESS;
   }
 
-  return SB_ERR_EBADFD;
+  return CH_RET_EBADF;
 }
 
-uint32_t sb_posix_read(uint32_t fd, uint8_t *buf, size_t count) {
+ssize_t sb_posix_read(int fd, void *buf, size_t count) {
   sb_class_t *sbcp = (sb_class_t *)chThdGetSelfX()->ctx.syscall.p;
 
-  if (!sb_is_valid_write_range(sbcp, (void *)buf, count)) {
-    return SB_ERR_EFAULT;
+  if (!sb_is_valid_write_range(sbcp, buf, count)) {
+    return CH_RET_EFAULT;
   }
 
-  if (fd == 0U) {
+  if (fd == 0) {
     SandboxStream *ssp = sbcp->config->stdin_stream;
 
     if ((count == 0U) || (ssp == NULL)) {
-      return 0U;
+      return 0;
     }
 
-    return (uint32_t)ssp->vmt->read((void *)ssp, buf, count);
+    return (ssize_t)ssp->vmt->read((void *)ssp, (uint8_t *)buf, count);
   }
 
-  return SB_ERR_EBADFD;
+  return CH_RET_EBADF;
 }
 
-uint32_t sb_posix_write(uint32_t fd, const uint8_t *buf, size_t count) {
+ssize_t sb_posix_write(int fd, const void *buf, size_t count) {
   sb_class_t *sbcp = (sb_class_t *)chThdGetSelfX()->ctx.syscall.p;
 
-  if (!sb_is_valid_read_range(sbcp, (const void *)buf, count)) {
-    return SB_ERR_EFAULT;
-  }
-
-  if (fd == 1U) {
-    SandboxStream *ssp = sbcp->config->stdout_stream;
-
-    if ((count == 0U) || (ssp == NULL)) {
-      return 0U;
-    }
-
-    return (uint32_t)ssp->vmt->write((void *)ssp, buf, count);
+  if (!sb_is_valid_read_range(sbcp, buf, count)) {
+    return CH_RET_EFAULT;
   }
 
-  if (fd == 2U) {
-    SandboxStream *ssp = sbcp->config->stderr_stream;
+  if ((fd == 1) || (fd == 2)) {
+    SandboxStream *ssp = fd == 1 ? sbcp->config->stdout_stream :
+                                   sbcp->config->stderr_stream;
 
     if ((count == 0U) || (ssp == NULL)) {
-      return 0U;
+      return 0;
     }
 
-    return (uint32_t)ssp->vmt->write((void *)ssp, buf, count);
+    return (ssize_t)ssp->vmt->write((void *)ssp, (const uint8_t *)buf, count);
   }
 
-  return SB_ERR_EBADFD;
+  return CH_RET_EBADF;
 }
 
-uint32_t sb_posix_lseek(uint32_t fd, uint32_t offset, uint32_t whence) {
+off_t sb_posix_lseek(int fd, off_t offset, int whence) {
 
   (void)offset;
   (void)whence;
 
-  if ((fd == 0U) || (fd == 1U) || (fd == 2U)) {
+  if ((fd == 0) || (fd == 1) || (fd == 2)) {
 
-    return SB_ERR_ESPIPE;
+    return CH_RET_ESPIPE;
   }
 
-  return SB_ERR_EBADFD;
+  return CH_RET_EBADF;
 }
 #endif
 
@@ -0,0 +1,13 @@
+# List of the ChibiOS simulator sandbox host files.
+SBHOSTSRC = $(CHIBIOS)/os/sb/host/sbhost.c \
+			$(CHIBIOS)/os/sb/host/sbapi.c \
+			$(CHIBIOS)/os/sb/host/sbposix.c \
+			$(CHIBIOS)/os/sb/host/sim/sbsim.c
+
+SBHOSTINC = $(CHIBIOS)/os/sb/common \
+            $(CHIBIOS)/os/sb/host \
+            $(CHIBIOS)/os/sb/host/sim
+
+# Shared variables
+ALLCSRC    += $(SBHOSTSRC)
+ALLINC     += $(SBHOSTINC)
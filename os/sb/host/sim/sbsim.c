@@ -0,0 +1,394 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    sb/host/sim/sbsim.c
+ * @brief   Simulator SandBox host code.
+ * @details The simulator port has no preemption so a sandboxed thread can
+ *          only lose the CPU inside a syscall. Privileged code always sees
+ *          all regions as read-write, when the trampoline returns to
+ *          sandboxed code the regions of the running sandbox get their
+ *          configured permissions and the regions of the other sandboxes
+ *          become inaccessible. Faults are reported by the host as
+ *          @p SIGSEGV.
+ *
+ * @addtogroup SIM_SANDBOX
+ * @{
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "ch.h"
+#include "sb.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Privileged access to a region.
+ */
+#define SB_SIM_PROT_PRIVILEGED      (PROT_READ | PROT_WRITE)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a started sandbox slot.
+ */
+typedef struct {
+  /**
+   * @brief   Sandbox object or @p NULL if the slot is free.
+   */
+  sb_class_t                    *sbcp;
+  /**
+   * @brief   Current protection of the sandbox regions.
+   */
+  int                           prot[SB_CFG_NUM_REGIONS];
+} sb_sim_slot_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+extern const port_syscall_t sb_syscalls[256];
+
+/**
+ * @brief   Started sandboxes.
+ */
+static sb_sim_slot_t sb_sim_slots[SB_SIM_MAX_SANDBOXES];
+
+/**
+ * @brief   Host counters.
+ */
+static sb_sim_stats_t sb_sim_stats;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static size_t sb_sim_page_round(size_t size) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+  return (size + page - 1U) & ~(page - 1U);
+}
+
+static bool sb_sim_is_active(const sb_sim_slot_t *slp) {
+
+  return (slp->sbcp != NULL) && (slp->sbcp->tp != NULL) &&
+         (slp->sbcp->tp->state != CH_STATE_FINAL);
+}
+
+#if (SB_SIM_USE_MPROTECT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the protection of all regions of a sandbox slot.
+ * @note    Regions already having the required protection are skipped,
+ *          this keeps the cost of a transition proportional to the changes.
+ *
+ * @param[in] slp       pointer to the sandbox slot
+ * @param[in] self      @p true for the view of the running sandbox,
+ *                      @p false for the view of other sandboxes
+ * @param[in] privileged @p true for the privileged view
+ */
+static void sb_sim_protect(sb_sim_slot_t *slp, bool self, bool privileged) {
+  const sb_config_t *config = slp->sbcp->config;
+  unsigned i;
+
+  for (i = 0U; i < SB_CFG_NUM_REGIONS; i++) {
+    const sb_memory_region_t *rp = &config->regions[i];
+    int prot;
+
+    if (rp->area.size == 0U) {
+      continue;
+    }
+
+    if (privileged) {
+      prot = SB_SIM_PROT_PRIVILEGED;
+    }
+    else if (self) {
+      prot = rp->writeable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    }
+    else {
+      prot = PROT_NONE;
+    }
+
+    if (slp->prot[i] != prot) {
+      (void) mprotect(rp->area.base,
+                      sb_sim_page_round(rp->area.size), prot);
+      slp->prot[i] = prot;
+      sb_sim_stats.mprotects++;
+    }
+  }
+}
+
+/**
+ * @brief   Switches all regions to the view of a sandbox.
+ *
+ * @param[in] sbcp      pointer to the running sandbox object or @p NULL
+ *                      for the privileged view
+ */
+static void sb_sim_set_view(sb_class_t *sbcp) {
+  unsigned i;
+
+  for (i = 0U; i < SB_SIM_MAX_SANDBOXES; i++) {
+    sb_sim_slot_t *slp = &sb_sim_slots[i];
+
+    if (sb_sim_is_active(slp)) {
+      sb_sim_protect(slp, slp->sbcp == sbcp, sbcp == NULL);
+    }
+  }
+}
+#else
+#define sb_sim_set_view(sbcp) (void)(sbcp)
+#endif
+
+/**
+ * @brief   Sandbox thread function.
+ * @details Enters the sandbox, a return from the sandboxed function is
+ *          handled as an exit syscall with a zero exit code.
+ */
+static THD_FUNCTION(sb_sim_thread, arg) {
+  sb_class_t *sbcp = (sb_class_t *)arg;
+  const sb_sim_image_t *imgp;
+
+  imgp = (const sb_sim_image_t *)(void *)
+         sbcp->config->regions[sbcp->config->code_region].area.base;
+
+  sb_sim_set_view(sbcp);
+  imgp->entry();
+  (void) __sb_sim_syscall(SB_SYSC_EXIT, 0U, 0U, 0U, 0U);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Syscalls trampoline.
+ * @details Builds the registers frame and invokes the handler from the
+ *          @p sb_syscalls table in privileged view.
+ *
+ * @param[in] n         syscall number
+ * @param[in] r0        first argument
+ * @param[in] r1        second argument
+ * @param[in] r2        third argument
+ * @param[in] r3        fourth argument
+ * @return              The value of the @p r0 register on handler return.
+ */
+uint32_t __sb_sim_syscall(uint32_t n, uint32_t r0, uint32_t r1,
+                          uint32_t r2, uint32_t r3) {
+  struct port_extctx ectx = {r0, r1, r2, r3};
+  sb_class_t *sbcp = (sb_class_t *)chThdGetSelfX()->ctx.syscall.p;
+
+  chDbgAssert(sbcp != NULL, "not a sandbox");
+
+  sb_sim_stats.syscalls++;
+  sb_sim_set_view(NULL);
+  sb_syscalls[n & 255U](&ectx);
+  sb_sim_set_view(sbcp);
+
+  return ectx.r0;
+}
+
+/**
+ * @brief   Allocates a sandbox region.
+ * @details The region is a set of host pages mapped for privileged access,
+ *          it can be used in the @p regions field of a sandbox
+ *          configuration.
+ *
+ * @param[in] size      region size, rounded up to the host page size
+ * @return              The region base address.
+ * @retval NULL         if the mapping failed.
+ *
+ * @api
+ */
+void *sbSimAllocRegion(size_t size) {
+  void *p;
+
+  p = mmap(NULL, sb_sim_page_round(size), SB_SIM_PROT_PRIVILEGED,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Releases a sandbox region.
+ * @pre     The sandbox using the region must be terminated.
+ *
+ * @param[in] p         region base address
+ * @param[in] size      region size
+ *
+ * @api
+ */
+void sbSimFreeRegion(void *p, size_t size) {
+
+  (void) munmap(p, sb_sim_page_round(size));
+}
+
+/**
+ * @brief   Writes a sandbox image at the base of a code region.
+ *
+ * @param[out] code     code region base address
+ * @param[in] entry     sandboxed function
+ *
+ * @api
+ */
+void sbSimMakeImage(void *code, sb_sim_entry_t entry) {
+  sb_sim_image_t *imgp = (sb_sim_image_t *)code;
+
+  imgp->header.hdr_magic1 = SB_MAGIC1;
+  imgp->header.hdr_magic2 = SB_MAGIC2;
+  imgp->header.hdr_size   = sizeof (sb_header_t);
+  imgp->header.user       = 0U;
+  imgp->entry             = entry;
+}
+
+/**
+ * @brief   Starts a sandboxed thread.
+ * @note    Simulator implementation, the sandboxed function is executed
+ *          on the thread stack, the data region only holds data.
+ *
+ * @param[out] sbcp     pointer to the sandbox object
+ * @param[in] config    pointer to the sandbox configuration
+ * @param[in] name      thread name
+ * @param[in] wsp       pointer to the thread working area
+ * @param[in] size      size of the working area
+ * @param[in] prio      thread priority
+ * @return              The thread pointer.
+ * @retval NULL         if the sandbox thread creation failed.
+ *
+ * @api
+ */
+thread_t *sbStartThread(sb_class_t *sbcp, const sb_config_t *config,
+                        const char *name, void *wsp, size_t size,
+                        tprio_t prio) {
+  const sb_header_t *sbhp;
+  sb_sim_slot_t *slp = NULL;
+  thread_t *utp;
+  unsigned i;
+
+  chDbgAssert(sizeof (void *) == sizeof (uint32_t), "32 bits host required");
+
+  /* Header location.*/
+  sbhp = (const sb_header_t *)(void *)config->regions[config->code_region].area.base;
+
+  /* Checking header magic numbers.*/
+  if ((sbhp->hdr_magic1 != SB_MAGIC1) || (sbhp->hdr_magic2 != SB_MAGIC2)) {
+    return NULL;
+  }
+
+  /* Checking header size and alignment.*/
+  if (sbhp->hdr_size != sizeof (sb_header_t)) {
+    return NULL;
+  }
+
+#if SB_SIM_USE_MPROTECT == TRUE
+  /* Regions must be made of whole host pages.*/
+  for (i = 0U; i < SB_CFG_NUM_REGIONS; i++) {
+    if (((size_t)config->regions[i].area.base &
+         ((size_t)sysconf(_SC_PAGESIZE) - 1U)) != 0U) {
+      return NULL;
+    }
+  }
+#endif
+
+  /* Getting a slot, the one of a terminated sandbox can be reused.*/
+  for (i = 0U; i < SB_SIM_MAX_SANDBOXES; i++) {
+    if (sb_sim_slots[i].sbcp == sbcp) {
+      slp = &sb_sim_slots[i];
+      break;
+    }
+    if ((slp == NULL) && !sb_sim_is_active(&sb_sim_slots[i])) {
+      slp = &sb_sim_slots[i];
+    }
+  }
+  if ((slp == NULL) || sb_sim_is_active(slp)) {
+    return NULL;
+  }
+
+  /* Linking configuration information.*/
+  sbcp->config = config;
+
+  thread_descriptor_t td = {
+    .name       = name,
+    .wbase      = (stkalign_t *)wsp,
+    .wend       = (stkalign_t *)wsp + (size / sizeof (stkalign_t)),
+    .prio       = prio,
+    .funcp      = sb_sim_thread,
+    .arg        = (void *)sbcp
+  };
+
+  utp = chThdCreateSuspended(&td);
+  utp->ctx.syscall.p = (const void *)sbcp;
+
+  /* For messages exchange.*/
+  sbcp->tp      = utp;
+#if CH_CFG_USE_MESSAGES == TRUE
+  sbcp->msg_tp  = NULL;
+#endif
+#if CH_CFG_USE_EVENTS == TRUE
+  chEvtObjectInit(&sbcp->es);
+#endif
+
+  /* The regions are in privileged view while not running sandboxed code.*/
+  slp->sbcp = sbcp;
+  for (i = 0U; i < SB_CFG_NUM_REGIONS; i++) {
+    slp->prot[i] = SB_SIM_PROT_PRIVILEGED;
+  }
+
+  return chThdStart(utp);
+}
+
+/**
+ * @brief   Returns the host counters.
+ *
+ * @param[out] statsp   pointer to the counters copy
+ *
+ * @api
+ */
+void sbSimGetStats(sb_sim_stats_t *statsp) {
+
+  chSysLock();
+  *statsp = sb_sim_stats;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Clears the host counters.
+ *
+ * @api
+ */
+void sbSimResetStats(void) {
+
+  chSysLock();
+  sb_sim_stats.syscalls  = 0U;
+  sb_sim_stats.mprotects = 0U;
+  chSysUnlock();
+}
+
+/** @} */
@@ -0,0 +1,143 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    sb/host/sim/sbsim.h
+ * @brief   Simulator SandBox host macros and structures.
+ * @details The sandboxed code is a host function executed by the sandbox
+ *          thread, syscalls are calls to a trampoline building the same
+ *          registers frame of the SVC exception and dispatching it through
+ *          the @p sb_syscalls table. Sandbox regions are host pages, their
+ *          protection is switched using @p mprotect() on each transition
+ *          between sandboxed and privileged code.
+ *
+ * @addtogroup SIM_SANDBOX
+ * @{
+ */
+
+#ifndef SBSIM_H
+#define SBSIM_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Simulator sandbox host options
+ * @{
+ */
+/**
+ * @brief   Maximum number of sandboxes started at the same time.
+ */
+#if !defined(SB_SIM_MAX_SANDBOXES) || defined(__DOXYGEN__)
+#define SB_SIM_MAX_SANDBOXES                4
+#endif
+
+/**
+ * @brief   Regions protection switch.
+ * @details When enabled sandboxed code can only access its own regions
+ *          with the configured permissions, regions of the other sandboxes
+ *          are not accessible. Disabling it leaves only the syscalls
+ *          dispatch cost in the measurements.
+ */
+#if !defined(SB_SIM_USE_MPROTECT) || defined(__DOXYGEN__)
+#define SB_SIM_USE_MPROTECT                 TRUE
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if SB_SIM_MAX_SANDBOXES < 1
+#error "invalid SB_SIM_MAX_SANDBOXES value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a sandboxed function.
+ */
+typedef void (*sb_sim_entry_t)(void);
+
+/**
+ * @brief   Type of a simulated sandbox image.
+ * @details On target the code following the header is the sandbox entry
+ *          point, in the simulator it is a pointer to the host function.
+ */
+typedef struct {
+  /**
+   * @brief   Sandbox header.
+   */
+  sb_header_t                   header;
+  /**
+   * @brief   Sandbox entry function.
+   */
+  sb_sim_entry_t                entry;
+} sb_sim_image_t;
+
+/**
+ * @brief   Type of the simulator sandbox host counters.
+ */
+typedef struct {
+  /**
+   * @brief   Dispatched syscalls.
+   */
+  uint32_t                      syscalls;
+  /**
+   * @brief   Region protection changes.
+   */
+  uint32_t                      mprotects;
+} sb_sim_stats_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void *sbSimAllocRegion(size_t size);
+  void sbSimFreeRegion(void *p, size_t size);
+  void sbSimMakeImage(void *code, sb_sim_entry_t entry);
+  void sbSimGetStats(sb_sim_stats_t *statsp);
+  void sbSimResetStats(void);
+  uint32_t __sb_sim_syscall(uint32_t n, uint32_t r0, uint32_t r1,
+                            uint32_t r2, uint32_t r3);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* SBSIM_H */
+
+/** @} */
@@ -125,8 +125,37 @@ typedef uint32_t eventflags_t;
 
 /**
  * @name   SVC instruction wrappers.
+ * @note    In the simulator syscalls are calls to the sandbox host
+ *          trampoline, the same handlers are invoked.
  * @{
  */
+#if defined(SIMULATOR)
+#define __syscall0(x)                                                       \
+  (void)__sb_sim_syscall(x, 0U, 0U, 0U, 0U)
+
+#define __syscall0r(x)                                                      \
+  uint32_t r0 = __sb_sim_syscall(x, 0U, 0U, 0U, 0U);                        \
+  (void)r0
+
+#define __syscall1r(x, p1)                                                  \
+  uint32_t r0 = __sb_sim_syscall(x, (uint32_t)(p1), 0U, 0U, 0U);            \
+  (void)r0
+
+#define __syscall2r(x, p1, p2)                                              \
+  uint32_t r0 = __sb_sim_syscall(x, (uint32_t)(p1), (uint32_t)(p2),         \
+                                 0U, 0U);                                   \
+  (void)r0
+
+#define __syscall3r(x, p1, p2, p3)                                          \
+  uint32_t r0 = __sb_sim_syscall(x, (uint32_t)(p1), (uint32_t)(p2),         \
+                                 (uint32_t)(p3), 0U);                       \
+  (void)r0
+
+#define __syscall4r(x, p1, p2, p3, p4)                                      \
+  uint32_t r0 = __sb_sim_syscall(x, (uint32_t)(p1), (uint32_t)(p2),         \
+                                 (uint32_t)(p3), (uint32_t)(p4));           \
+  (void)r0
+#else
 #define __syscall0(x)                                                       \
   asm volatile ("svc " #x : : : "memory")
 
@@ -157,6 +186,7 @@ typedef uint32_t eventflags_t;
   register uint32_t r3 asm ("r3") = (uint32_t)(p4);                         \
   asm volatile ("svc " #x : "=r" (r0) : "r" (r0), "r" (r1),                 \
                                         "r" (r2), "r" (r3) : "memory")
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -166,7 +196,10 @@ typedef uint32_t eventflags_t;
 #ifdef __cplusplus
 extern "C" {
 #endif
-
+#if defined(SIMULATOR)
+  uint32_t __sb_sim_syscall(uint32_t n, uint32_t r0, uint32_t r1,
+                            uint32_t r2, uint32_t r3);
+#endif
 #ifdef __cplusplus
 }
 #endif
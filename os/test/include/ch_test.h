@@ -46,6 +46,15 @@
 #define TRUE                                (!FALSE)
 #endif
 
+/**
+ * @name    Machine-readable report formats
+ * @{
+ */
+#define TEST_REPORT_NONE                    0U
+#define TEST_REPORT_JSON                    1U
+#define TEST_REPORT_JUNIT                   2U
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -94,6 +103,45 @@
 #define TEST_CFG_SIZE_REPORT                TRUE
 #endif
 
+/**
+ * @brief   Warmup runs of benchmark cases.
+ * @details Test cases recording a score using @p test_record_score() are
+ *          benchmarks, they are executed again after the first run, the
+ *          first runs are not accounted.
+ */
+#if !defined(TEST_CFG_BENCHMARK_WARMUP) || defined(__DOXYGEN__)
+#define TEST_CFG_BENCHMARK_WARMUP           0
+#endif
+
+/**
+ * @brief   Measured runs of benchmark cases.
+ * @details If greater than one then minimum, median, 99th percentile and
+ *          maximum of each score are printed after the case output, only
+ *          the output of the first run is printed.
+ */
+#if !defined(TEST_CFG_BENCHMARK_RUNS) || defined(__DOXYGEN__)
+#define TEST_CFG_BENCHMARK_RUNS             1
+#endif
+
+/**
+ * @brief   Maximum number of scores recorded by a benchmark case.
+ * @note    Further scores are not recorded, suites recording more scores
+ *          check this setting at compile time.
+ */
+#if !defined(TEST_CFG_BENCHMARK_MAX_SCORES) || defined(__DOXYGEN__)
+#define TEST_CFG_BENCHMARK_MAX_SCORES       4
+#endif
+
+/**
+ * @brief   Maximum number of records in the machine-readable report.
+ * @details A record is kept for each benchmark case and for each failed
+ *          case, successful cases do not take space. Zero disables the
+ *          machine-readable report.
+ */
+#if !defined(TEST_CFG_REPORT_MAX_RECORDS) || defined(__DOXYGEN__)
+#define TEST_CFG_REPORT_MAX_RECORDS         0
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -114,6 +162,38 @@
 #error "TEST_CFG_DELAY_BETWEEN_TESTS requires TEST_CFG_CHIBIOS_SUPPORT"
 #endif
 
+#if TEST_CFG_BENCHMARK_WARMUP < 0
+#error "invalid TEST_CFG_BENCHMARK_WARMUP value"
+#endif
+
+#if TEST_CFG_BENCHMARK_RUNS < 1
+#error "invalid TEST_CFG_BENCHMARK_RUNS value"
+#endif
+
+#if TEST_CFG_BENCHMARK_MAX_SCORES < 1
+#error "invalid TEST_CFG_BENCHMARK_MAX_SCORES value"
+#endif
+
+/*
+ * Counters sampled around each run of benchmark cases, RT provides the
+ * realtime counter and, with statistics enabled, the context switches
+ * counter. Both can be redefined in the test configuration.
+ */
+#if (TEST_CFG_CHIBIOS_SUPPORT == TRUE) && defined(__CHIBIOS_RT__)
+#if !defined(TEST_BENCHMARK_GET_CYCLES) && (PORT_SUPPORTS_RT == TRUE)
+#define TEST_BENCHMARK_GET_CYCLES()         ((uint32_t)chSysGetRealtimeCounterX())
+#endif
+#if !defined(TEST_BENCHMARK_GET_CTXSWC) && (CH_DBG_STATISTICS == TRUE)
+#define TEST_BENCHMARK_GET_CTXSWC()         ((uint32_t)currcore->kernel_stats.n_ctxswc)
+#endif
+#endif
+
+/**
+ * @brief   Metrics slots of a benchmark case.
+ * @details Scores are followed by cycles and context switches per run.
+ */
+#define TEST_BENCHMARK_MAX_METRICS          (TEST_CFG_BENCHMARK_MAX_SCORES + 2)
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -124,6 +204,62 @@
  */
 typedef int (*test_putchar_t)(int c);
 
+/**
+ * @brief   Statistics of a benchmark metric.
+ */
+typedef struct {
+  /**
+   * @brief   Metric unit.
+   */
+  const char        *unit;
+  /**
+   * @brief   Minimum value.
+   */
+  uint32_t          min;
+  /**
+   * @brief   Median value.
+   */
+  uint32_t          median;
+  /**
+   * @brief   99th percentile.
+   */
+  uint32_t          p99;
+  /**
+   * @brief   Maximum value.
+   */
+  uint32_t          max;
+} test_metric_t;
+
+/**
+ * @brief   Report record of a test case.
+ */
+typedef struct {
+  /**
+   * @brief   Test sequence index.
+   */
+  unsigned          tseq;
+  /**
+   * @brief   Test case index.
+   */
+  unsigned          tcase;
+  /**
+   * @brief   Failure message or @p NULL.
+   */
+  const char        *failure_message;
+  /**
+   * @brief   Failed step.
+   */
+  unsigned          step;
+  /**
+   * @brief   Number of valid metrics.
+   */
+  unsigned          metrics_n;
+  /**
+   * @brief   Metrics of a benchmark case.
+   */
+  test_metric_t     metrics[TEST_BENCHMARK_MAX_METRICS];
+} test_record_t;
+
 /**
  * @brief   Type of a test engine context structure.
  */
@@ -161,6 +297,49 @@ typedef struct {
    * @brief   Current output stream.
    */
   BaseSequentialStream *stream;
+#endif
+  /**
+   * @brief   Output muted during benchmark repetitions.
+   */
+  bool              muted;
+  /**
+   * @brief   Current run of a benchmark case.
+   */
+  unsigned          bench_run;
+  /**
+   * @brief   Scores recorded in the current run.
+   */
+  unsigned          scores_n;
+  /**
+   * @brief   Units of the recorded scores.
+   */
+  const char        *score_units[TEST_CFG_BENCHMARK_MAX_SCORES];
+  /**
+   * @brief   Metrics samples of the measured runs.
+   */
+  uint32_t          samples[TEST_BENCHMARK_MAX_METRICS]
+                           [TEST_CFG_BENCHMARK_RUNS];
+#if (TEST_CFG_REPORT_MAX_RECORDS > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Machine-readable report format.
+   */
+  unsigned          report_format;
+  /**
+   * @brief   Report output function or @p NULL for the log output.
+   */
+  test_putchar_t    report_putchar;
+  /**
+   * @brief   Number of report records.
+   */
+  unsigned          records_n;
+  /**
+   * @brief   Records not stored because of lack of space.
+   */
+  unsigned          records_dropped;
+  /**
+   * @brief   Report records.
+   */
+  test_record_t     records[TEST_CFG_REPORT_MAX_RECORDS];
 #endif
 } ch_test_context_t;
 
@@ -312,6 +491,10 @@ extern "C" {
   int test_vprintf(const char *fmt, va_list ap);
   int test_printf(const char *fmt, ...);
   void test_emit_token(char token);
+  void test_record_score(uint32_t value, const char *unit);
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  void test_set_report(unsigned format, test_putchar_t putfunc);
+#endif
   bool test_execute_putchar(test_putchar_t putfunc,
                             const testsuite_t *tsp);
 #if TEST_CFG_CHIBIOS_SUPPORT == TRUE
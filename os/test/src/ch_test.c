@@ -25,6 +25,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "ch_test.h"
 
 /*===========================================================================*/
@@ -89,6 +91,356 @@ static void test_execute_case(const testcase_t *tcp) {
   }
 }
 
+/**
+ * @brief   Stores a sample of a benchmark metric.
+ *
+ * @param[in] metric    the metric index
+ * @param[in] value     the sample value
+ */
+static void test_store_sample(unsigned metric, uint32_t value) {
+
+#if TEST_CFG_BENCHMARK_WARMUP > 0
+  if (chtest.bench_run < (unsigned)TEST_CFG_BENCHMARK_WARMUP) {
+    return;
+  }
+#endif
+  chtest.samples[metric][chtest.bench_run -
+                         (unsigned)TEST_CFG_BENCHMARK_WARMUP] = value;
+}
+
+/**
+ * @brief   Computes the statistics of a metric.
+ * @note    The samples of the metric are sorted in place.
+ *
+ * @param[in] metric    the metric index
+ * @param[in] unit      the metric unit
+ * @param[out] mp       pointer to the @p test_metric_t to be filled
+ */
+static void test_compute_metric(unsigned metric, const char *unit,
+                                test_metric_t *mp) {
+  uint32_t *sp = chtest.samples[metric];
+  unsigned i, j, n = (unsigned)TEST_CFG_BENCHMARK_RUNS;
+
+  /* Insertion sort, runs are few.*/
+  for (i = 1U; i < n; i++) {
+    uint32_t s = sp[i];
+    for (j = i; (j > 0U) && (sp[j - 1U] > s); j--) {
+      sp[j] = sp[j - 1U];
+    }
+    sp[j] = s;
+  }
+
+  /* Lower median and nearest-rank percentile.*/
+  mp->unit   = unit;
+  mp->min    = sp[0];
+  mp->median = sp[(n - 1U) / 2U];
+  mp->p99    = sp[((99U * n) + 99U) / 100U - 1U];
+  mp->max    = sp[n - 1U];
+}
+
+/**
+ * @brief   Executes a test case.
+ * @details Cases recording scores are benchmarks, they are executed again
+ *          with muted output for the configured warmup and measured runs.
+ *
+ * @param[in] tcp       the test case
+ * @param[out] metrics  array of @p TEST_BENCHMARK_MAX_METRICS metrics
+ * @return              The number of metrics of a benchmark case.
+ * @retval 0            if the case is not a benchmark or failed.
+ */
+static unsigned test_run_case(const testcase_t *tcp, test_metric_t *metrics) {
+  unsigned run, i, n;
+#if defined(TEST_BENCHMARK_GET_CYCLES)
+  uint32_t cycles;
+#endif
+#if defined(TEST_BENCHMARK_GET_CTXSWC)
+  uint32_t ctxswc;
+#endif
+
+  for (run = 0U;
+       run < (unsigned)(TEST_CFG_BENCHMARK_WARMUP + TEST_CFG_BENCHMARK_RUNS);
+       run++) {
+    chtest.bench_run = run;
+    chtest.scores_n  = 0U;
+    chtest.muted     = run > 0U;
+#if defined(TEST_BENCHMARK_GET_CYCLES)
+    cycles = TEST_BENCHMARK_GET_CYCLES();
+#endif
+#if defined(TEST_BENCHMARK_GET_CTXSWC)
+    ctxswc = TEST_BENCHMARK_GET_CTXSWC();
+#endif
+    test_execute_case(tcp);
+#if defined(TEST_BENCHMARK_GET_CYCLES)
+    test_store_sample(TEST_CFG_BENCHMARK_MAX_SCORES,
+                      TEST_BENCHMARK_GET_CYCLES() - cycles);
+#endif
+#if defined(TEST_BENCHMARK_GET_CTXSWC)
+    test_store_sample(TEST_CFG_BENCHMARK_MAX_SCORES + 1,
+                      TEST_BENCHMARK_GET_CTXSWC() - ctxswc);
+#endif
+    if (chtest.local_fail || (chtest.scores_n == 0U)) {
+      break;
+    }
+  }
+  chtest.muted = false;
+
+  if (chtest.local_fail || (chtest.scores_n == 0U)) {
+    return 0U;
+  }
+
+  /* Statistics of scores and counters.*/
+  n = 0U;
+  for (i = 0U; i < chtest.scores_n; i++) {
+    test_compute_metric(i, chtest.score_units[i], &metrics[n++]);
+  }
+#if defined(TEST_BENCHMARK_GET_CYCLES)
+  test_compute_metric(TEST_CFG_BENCHMARK_MAX_SCORES, "cycles", &metrics[n++]);
+#endif
+#if defined(TEST_BENCHMARK_GET_CTXSWC)
+  test_compute_metric(TEST_CFG_BENCHMARK_MAX_SCORES + 1, "ctxswc",
+                      &metrics[n++]);
+#endif
+
+#if TEST_CFG_BENCHMARK_RUNS > 1
+  for (i = 0U; i < n; i++) {
+    test_printf("--- Stats : %s min %u, median %u, p99 %u, max %u (%u runs)"
+                TEST_CFG_EOL_STRING, metrics[i].unit,
+                metrics[i].min, metrics[i].median,
+                metrics[i].p99, metrics[i].max,
+                (unsigned)TEST_CFG_BENCHMARK_RUNS);
+  }
+#endif
+
+  return n;
+}
+
+#if (TEST_CFG_REPORT_MAX_RECORDS > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a new report record or @p NULL.
+ *
+ * @param[in] tseq      the test sequence index
+ * @param[in] tcase     the test case index
+ * @return              The record.
+ * @retval NULL         if there are no free records.
+ */
+static test_record_t *test_new_record(unsigned tseq, unsigned tcase) {
+  test_record_t *rp;
+
+  if (chtest.records_n >= (unsigned)TEST_CFG_REPORT_MAX_RECORDS) {
+    chtest.records_dropped++;
+    return NULL;
+  }
+  rp = &chtest.records[chtest.records_n++];
+  rp->tseq            = tseq;
+  rp->tcase           = tcase;
+  rp->failure_message = NULL;
+  rp->step            = 0U;
+  rp->metrics_n       = 0U;
+
+  return rp;
+}
+
+/**
+ * @brief   Returns the report record of a test case or @p NULL.
+ *
+ * @param[in] tseq      the test sequence index
+ * @param[in] tcase     the test case index
+ * @return              The record.
+ * @retval NULL         if the case has no record.
+ */
+static const test_record_t *test_find_record(unsigned tseq, unsigned tcase) {
+  unsigned i;
+
+  for (i = 0U; i < chtest.records_n; i++) {
+    if ((chtest.records[i].tseq == tseq) &&
+        (chtest.records[i].tcase == tcase)) {
+      return &chtest.records[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Prints a string escaped for the report format.
+ *
+ * @param[in] s         the string
+ */
+static void test_report_string(const char *s) {
+  char c;
+
+  while ((c = *s++) != '\0') {
+    if (chtest.report_format == TEST_REPORT_JSON) {
+      if ((c == '"') || (c == '\\')) {
+        test_putchar('\\');
+      }
+      test_putchar(c);
+    }
+    else if (c == '&') {
+      test_printf("&amp;");
+    }
+    else if (c == '<') {
+      test_printf("&lt;");
+    }
+    else if (c == '>') {
+      test_printf("&gt;");
+    }
+    else if (c == '"') {
+      test_printf("&quot;");
+    }
+    else {
+      test_putchar(c);
+    }
+  }
+}
+
+/**
+ * @brief   Prints the report in JSON format.
+ *
+ * @param[in] tsp       test suite
+ */
+static void test_report_json(const testsuite_t *tsp) {
+  const test_record_t *rp;
+  unsigned tseq, tcase, i;
+  bool first = true;
+
+  test_printf("{"TEST_CFG_EOL_STRING"  \"suite\": \"");
+  test_report_string(tsp->name != NULL ? tsp->name : "Test Suite");
+  test_printf("\","TEST_CFG_EOL_STRING);
+  test_printf("  \"result\": \"%s\","TEST_CFG_EOL_STRING,
+              chtest.global_fail ? "FAILURE" : "SUCCESS");
+  test_printf("  \"warmup\": %u,"TEST_CFG_EOL_STRING,
+              (unsigned)TEST_CFG_BENCHMARK_WARMUP);
+  test_printf("  \"runs\": %u,"TEST_CFG_EOL_STRING,
+              (unsigned)TEST_CFG_BENCHMARK_RUNS);
+  test_printf("  \"dropped\": %u,"TEST_CFG_EOL_STRING,
+              chtest.records_dropped);
+  test_printf("  \"cases\": [");
+  for (tseq = 0U; tsp->sequences[tseq] != NULL; tseq++) {
+    for (tcase = 0U; tsp->sequences[tseq]->cases[tcase] != NULL; tcase++) {
+      rp = test_find_record(tseq, tcase);
+      test_printf("%s"TEST_CFG_EOL_STRING"    {\"id\": \"%u.%u\", \"name\": \"",
+                  first ? "" : ",", tseq + 1U, tcase + 1U);
+      first = false;
+      test_report_string(tsp->sequences[tseq]->cases[tcase]->name);
+      if ((rp != NULL) && (rp->failure_message != NULL)) {
+        test_printf("\", \"result\": \"FAILURE\", \"step\": %u, "
+                    "\"message\": \"", rp->step);
+        test_report_string(rp->failure_message);
+        test_printf("\"}");
+        continue;
+      }
+      test_printf("\", \"result\": \"SUCCESS\"");
+      if (rp != NULL) {
+        test_printf(", \"metrics\": [");
+        for (i = 0U; i < rp->metrics_n; i++) {
+          test_printf("%s"TEST_CFG_EOL_STRING"      {\"unit\": \"",
+                      i == 0U ? "" : ",");
+          test_report_string(rp->metrics[i].unit);
+          test_printf("\", \"min\": %u, \"median\": %u, \"p99\": %u, "
+                      "\"max\": %u}",
+                      rp->metrics[i].min, rp->metrics[i].median,
+                      rp->metrics[i].p99, rp->metrics[i].max);
+        }
+        test_printf("]");
+      }
+      test_printf("}");
+    }
+  }
+  test_printf(TEST_CFG_EOL_STRING"  ]"TEST_CFG_EOL_STRING"}"TEST_CFG_EOL_STRING);
+}
+
+/**
+ * @brief   Prints the report in JUnit XML format.
+ * @note    Benchmark metrics are reported as test case properties.
+ *
+ * @param[in] tsp       test suite
+ */
+static void test_report_junit(const testsuite_t *tsp) {
+  const test_record_t *rp;
+  unsigned tseq, tcase, i, tests = 0U, failures = 0U;
+
+  for (tseq = 0U; tsp->sequences[tseq] != NULL; tseq++) {
+    for (tcase = 0U; tsp->sequences[tseq]->cases[tcase] != NULL; tcase++) {
+      rp = test_find_record(tseq, tcase);
+      if ((rp != NULL) && (rp->failure_message != NULL)) {
+        failures++;
+      }
+      tests++;
+    }
+  }
+
+  test_printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>"TEST_CFG_EOL_STRING);
+  test_printf("<testsuites>"TEST_CFG_EOL_STRING"  <testsuite name=\"");
+  test_report_string(tsp->name != NULL ? tsp->name : "Test Suite");
+  test_printf("\" tests=\"%u\" failures=\"%u\">"TEST_CFG_EOL_STRING,
+              tests, failures);
+  for (tseq = 0U; tsp->sequences[tseq] != NULL; tseq++) {
+    for (tcase = 0U; tsp->sequences[tseq]->cases[tcase] != NULL; tcase++) {
+      rp = test_find_record(tseq, tcase);
+      test_printf("    <testcase classname=\"");
+      test_report_string(tsp->sequences[tseq]->name);
+      test_printf("\" name=\"%u.%u ", tseq + 1U, tcase + 1U);
+      test_report_string(tsp->sequences[tseq]->cases[tcase]->name);
+      if (rp == NULL) {
+        test_printf("\"/>"TEST_CFG_EOL_STRING);
+        continue;
+      }
+      test_printf("\">"TEST_CFG_EOL_STRING);
+      if (rp->failure_message != NULL) {
+        test_printf("      <failure message=\"#%u ", rp->step);
+        test_report_string(rp->failure_message);
+        test_printf("\"/>"TEST_CFG_EOL_STRING);
+      }
+      else {
+        test_printf("      <properties>"TEST_CFG_EOL_STRING);
+        for (i = 0U; i < rp->metrics_n; i++) {
+          static const char * const stats[] = {"min", "median", "p99", "max"};
+          const uint32_t values[] = {rp->metrics[i].min, rp->metrics[i].median,
+                                     rp->metrics[i].p99, rp->metrics[i].max};
+          unsigned j;
+
+          for (j = 0U; j < 4U; j++) {
+            test_printf("        <property name=\"");
+            test_report_string(rp->metrics[i].unit);
+            test_printf(" %s\" value=\"%u\"/>"TEST_CFG_EOL_STRING,
+                        stats[j], values[j]);
+          }
+        }
+        test_printf("      </properties>"TEST_CFG_EOL_STRING);
+      }
+      test_printf("    </testcase>"TEST_CFG_EOL_STRING);
+    }
+  }
+  test_printf("  </testsuite>"TEST_CFG_EOL_STRING"</testsuites>"TEST_CFG_EOL_STRING);
+}
+
+/**
+ * @brief   Prints the machine-readable report.
+ *
+ * @param[in] tsp       test suite
+ */
+static void test_report(const testsuite_t *tsp) {
+  test_putchar_t putfunc = chtest.putchar;
+
+  if (chtest.report_putchar != NULL) {
+    chtest.putchar = chtest.report_putchar;
+  }
+  else {
+    test_printf(TEST_CFG_EOL_STRING);
+  }
+
+  if (chtest.report_format == TEST_REPORT_JSON) {
+    test_report_json(tsp);
+  }
+  else {
+    test_report_junit(tsp);
+  }
+
+  chtest.putchar = putfunc;
+}
+#endif /* TEST_CFG_REPORT_MAX_RECORDS > 0 */
+
 static void test_print_string(const char *s) {
   char c;
 
@@ -125,7 +477,8 @@ static void test_print_fat_line(void) {
  * @retval true         if one or more tests failed.
  */
 static bool test_execute_inner(const testsuite_t *tsp) {
-  unsigned tseq, tcase;
+  unsigned tseq, tcase, metrics_n;
+  test_metric_t metrics[TEST_BENCHMARK_MAX_METRICS];
 
   /* Test execution.*/
   test_printf(TEST_CFG_EOL_STRING);
@@ -162,6 +515,10 @@ static bool test_execute_inner(const testsuite_t *tsp) {
   test_printf(TEST_CFG_EOL_STRING);
 
   chtest.global_fail = false;
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  chtest.records_n       = 0U;
+  chtest.records_dropped = 0U;
+#endif
   tseq = 0U;
   while (tsp->sequences[tseq] != NULL) {
 #if defined(TEST_REPORT_HOOK_TESTSEQUENCE)
@@ -181,7 +538,7 @@ static bool test_execute_inner(const testsuite_t *tsp) {
 #if defined(TEST_REPORT_HOOK_TESTCASE)
       TEST_REPORT_HOOK_TESTCASE(tsp->sequences[tseq]->cases[tcase]);
 #endif
-      test_execute_case(tsp->sequences[tseq]->cases[tcase]);
+      metrics_n = test_run_case(tsp->sequences[tseq]->cases[tcase], metrics);
       if (chtest.local_fail) {
         test_printf("--- Result: FAILURE (#%u [", chtest.current_step, "", chtest.failure_message);
         test_print_tokens();
@@ -190,6 +547,23 @@ static bool test_execute_inner(const testsuite_t *tsp) {
       else {
         test_printf("--- Result: SUCCESS"TEST_CFG_EOL_STRING);
       }
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+      if (chtest.local_fail || (metrics_n > 0U)) {
+        test_record_t *rp = test_new_record(tseq, tcase);
+        if (rp != NULL) {
+          if (chtest.local_fail) {
+            rp->failure_message = chtest.failure_message;
+            rp->step            = chtest.current_step;
+          }
+          else {
+            rp->metrics_n = metrics_n;
+            memcpy(rp->metrics, metrics, metrics_n * sizeof (test_metric_t));
+          }
+        }
+      }
+#else
+      (void)metrics_n;
+#endif
       tcase++;
     }
     tseq++;
@@ -199,6 +573,12 @@ static bool test_execute_inner(const testsuite_t *tsp) {
   test_printf("Final result: %s"TEST_CFG_EOL_STRING,
               chtest.global_fail ? "FAILURE" : "SUCCESS");
 
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  if (chtest.report_format != TEST_REPORT_NONE) {
+    test_report(tsp);
+  }
+#endif
+
 #if defined(TEST_REPORT_HOOK_END)
   TEST_REPORT_HOOK_END();
 #endif
@@ -267,6 +647,47 @@ void test_emit_token(char token) {
   }
 }
 
+/**
+ * @brief   Records a score of a benchmark case.
+ * @details Cases recording scores are executed again for the configured
+ *          warmup and measured runs, statistics of the scores are printed
+ *          and reported.
+ * @note    This function can only be called from test_case execute context.
+ *
+ * @param[in] value     the score value
+ * @param[in] unit      the score unit as a string
+ *
+ * @api
+ */
+void test_record_score(uint32_t value, const char *unit) {
+  unsigned i = chtest.scores_n;
+
+  if (i < (unsigned)TEST_CFG_BENCHMARK_MAX_SCORES) {
+    chtest.score_units[i] = unit;
+    test_store_sample(i, value);
+    chtest.scores_n = i + 1U;
+  }
+}
+
+#if (TEST_CFG_REPORT_MAX_RECORDS > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the machine-readable report format and output.
+ * @details The report is printed at the end of the test suite execution.
+ *
+ * @param[in] format    the report format, @p TEST_REPORT_NONE disables the
+ *                      report
+ * @param[in] putfunc   character output function for the report or @p NULL
+ *                      for printing it after the text log
+ *
+ * @api
+ */
+void test_set_report(unsigned format, test_putchar_t putfunc) {
+
+  chtest.report_format  = format;
+  chtest.report_putchar = putfunc;
+}
+#endif /* TEST_CFG_REPORT_MAX_RECORDS > 0 */
+
 /**
  * @brief   Test execution with char output.
  *
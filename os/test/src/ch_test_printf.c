@@ -97,7 +97,7 @@ static char *test_ltoa(char *p, long num, int radix) {
  */
 void test_putchar(char c) {
 
-  if (chtest.putchar != NULL) {
+  if ((chtest.putchar != NULL) && !chtest.muted) {
     chtest.putchar(c);
   }
 }
@@ -0,0 +1,555 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adc_stream.c
+ * @brief   ADC streaming service code.
+ * @details The ADC runs in circular mode, each half buffer is handed by
+ *          the ADC callback to a worker thread without copying, the worker
+ *          decimates it using a CIC stage followed by a FIR stage and
+ *          publishes the resulting frame into a pipe or an objects FIFO.
+ *
+ * @addtogroup adc_stream
+ * @{
+ */
+
+#include <stddef.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "adc_stream.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Saturates a value to the 16 bits range.
+ *
+ * @param[in] x         value to be saturated
+ * @return              The saturated value.
+ */
+static inline int16_t adcs_sat16(int32_t x) {
+
+  if (x > 32767) {
+    return (int16_t)32767;
+  }
+  if (x < -32768) {
+    return (int16_t)-32768;
+  }
+  return (int16_t)x;
+}
+
+/**
+ * @brief   FIR dot product.
+ * @note    Contiguous operands, no conditionals and independent products,
+ *          the loop maps on dual 16 bits multiply-accumulate instructions
+ *          when available.
+ *
+ * @param[in] h         coefficients
+ * @param[in] x         window, newest sample first
+ * @param[in] n         number of taps
+ * @return              The accumulated value.
+ */
+static inline int64_t adcs_dot(const int16_t *h, const int16_t *x, size_t n) {
+  int64_t acc = 0;
+  size_t k;
+
+  for (k = 0U; k < n; k++) {
+    acc += (int32_t)h[k] * (int32_t)x[k];
+  }
+  return acc;
+}
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Publishes the output buffer content.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ * @param[in] n         number of samples in the output buffer
+ * @param[in] objp      FIFO object being filled or @p NULL
+ * @param[in] offset    offset of the output buffer within the frame
+ */
+static void adcs_write(adc_stream_t *asp, size_t n, int32_t *objp,
+                       size_t offset) {
+
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+  if (objp != NULL) {
+    size_t i;
+
+    for (i = 0U; i < n; i++) {
+      objp[offset + i] = asp->out[i];
+    }
+    return;
+  }
+#else
+  (void)objp;
+  (void)offset;
+#endif
+#if CH_CFG_USE_PIPES == TRUE
+  if (asp->config->pipe != NULL) {
+    (void) chPipeWriteTimeout(asp->config->pipe, (const uint8_t *)asp->out,
+                              n * sizeof (int32_t), TIME_IMMEDIATE);
+  }
+#endif
+}
+
+/**
+ * @brief   Checks if the half buffer being processed is being overwritten.
+ * @details The ADC starts overwriting the half buffer handed to the worker
+ *          as soon as it completes the other half.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ * @return              The overwrite status.
+ */
+static bool adcs_is_overwritten(adc_stream_t *asp) {
+  bool b;
+
+  chSysLock();
+  b = asp->stats.halves != asp->dispatched;
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Decimates and publishes an half buffer.
+ * @details The frame is dropped if the ADC starts overwriting the half
+ *          buffer before it has been entirely read, the check is performed
+ *          after each block. With pipes the blocks read before the
+ *          overwrite has been detected have already been written.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ * @param[in] in        pointer to the half buffer
+ */
+static void adcs_process_half(adc_stream_t *asp, const adcsample_t *in) {
+  const adcs_config_t *config = asp->config;
+  size_t channels = asp->decimator.channels;
+  size_t ratio = adcsDecimatorGetRatio(config->dcfg);
+  size_t remaining = config->depth / 2U;
+  size_t block = (ADCS_OUT_BUFFER_SIZE / channels) * ratio;
+  size_t offset = 0U;
+  int32_t *objp = NULL;
+  bool drop = false, overwritten = false;
+
+  /* Checking for space in the output, the frame is dropped if it does not
+     fit but the decimator state is kept updated anyway.*/
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+  if (config->fifo != NULL) {
+    objp = (int32_t *)chFifoTakeObjectTimeout(config->fifo, TIME_IMMEDIATE);
+    drop = objp == NULL;
+  }
+#endif
+#if CH_CFG_USE_PIPES == TRUE
+  if ((config->pipe != NULL) &&
+      (chPipeGetFreeCount(config->pipe) < asp->frame_size * sizeof (int32_t))) {
+    drop = true;
+  }
+#endif
+
+  while (remaining > 0U) {
+    size_t n = remaining < block ? remaining : block;
+    size_t m = adcsDecimatorProcess(&asp->decimator, in, n, asp->out);
+
+    /* The samples just read are valid only if the ADC did not complete
+       the other half meanwhile.*/
+    if (!overwritten) {
+      overwritten = adcs_is_overwritten(asp);
+    }
+    if (!drop && !overwritten) {
+      adcs_write(asp, m * channels, objp, offset);
+    }
+    offset    += m * channels;
+    in        += n * channels;
+    remaining -= n;
+  }
+
+  chSysLock();
+  if (drop) {
+    asp->stats.out_overruns++;
+  }
+  else if (overwritten) {
+    asp->stats.overwritten++;
+  }
+  else {
+    asp->stats.frames++;
+  }
+  chSysUnlock();
+
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+  if (objp != NULL) {
+    if (overwritten) {
+      chFifoReturnObject(config->fifo, (void *)objp);
+    }
+    else {
+      chFifoSendObject(config->fifo, (void *)objp);
+    }
+  }
+#endif
+}
+
+/**
+ * @brief   ADC callback.
+ * @details The half buffer just filled is handed to the worker thread, if
+ *          the worker is still busy with the previous one then the half
+ *          buffer is dropped and the ADC is overwriting the one being
+ *          processed, the worker detects it and drops that frame too.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ */
+static void adcs_end_cb(ADCDriver *adcp) {
+  adc_stream_t *asp = (adc_stream_t *)((uint8_t *)adcp->grpp -
+                                       offsetof(adc_stream_t, group));
+
+  chSysLockFromISR();
+  asp->stats.halves++;
+  if (asp->worker != NULL) {
+    asp->dispatched = asp->stats.halves;
+    chThdResumeI(&asp->worker, adcIsBufferComplete(adcp) ? (msg_t)1 :
+                                                           (msg_t)0);
+  }
+  else {
+    asp->stats.in_overruns++;
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Worker thread.
+ *
+ * @param[in] arg       pointer to the @p adc_stream_t object
+ */
+static THD_FUNCTION(adcs_worker, arg) {
+  adc_stream_t *asp = (adc_stream_t *)arg;
+
+  chRegSetThreadName("adcstream");
+
+  while (!chThdShouldTerminateX()) {
+    msg_t msg;
+
+    chSysLock();
+    msg = chThdSuspendTimeoutS(&asp->worker, TIME_INFINITE);
+    chSysUnlock();
+
+    if (msg < MSG_OK) {
+      break;
+    }
+
+    /* The half buffer is processed in place, the ADC is filling the other
+       half meanwhile.*/
+    adcs_process_half(asp, asp->config->buffer +
+                           ((size_t)msg * (asp->config->depth / 2U) *
+                            asp->decimator.channels));
+  }
+}
+#endif /* HAL_USE_ADC == TRUE */
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a decimator.
+ *
+ * @param[out] dp       pointer to the @p adcs_decimator_t object
+ * @param[in] dcfgp     pointer to the decimator configuration
+ * @param[in] channels  number of interleaved channels
+ *
+ * @init
+ */
+void adcsDecimatorObjectInit(adcs_decimator_t *dp,
+                             const adcs_decimator_config_t *dcfgp,
+                             size_t channels) {
+
+  chDbgCheck((dp != NULL) && (dcfgp != NULL) &&
+             (channels > 0U) && (channels <= (size_t)ADCS_MAX_CHANNELS));
+  chDbgCheck((dcfgp->cic_order <= (unsigned)ADCS_CIC_MAX_ORDER) &&
+             (dcfgp->cic_ratio > 0U) &&
+             ((dcfgp->cic_order > 0U) || (dcfgp->cic_ratio == 1U)));
+  chDbgCheck((dcfgp->fir_ratio > 0U) &&
+             ((dcfgp->fir_coeffs != NULL) || (dcfgp->fir_ratio == 1U)) &&
+             ((dcfgp->fir_coeffs == NULL) ||
+              ((dcfgp->fir_taps > 0U) &&
+               (dcfgp->fir_taps <= (size_t)ADCS_FIR_MAX_TAPS))));
+
+  dp->config   = dcfgp;
+  dp->channels = channels;
+  adcsDecimatorReset(dp);
+}
+
+/**
+ * @brief   Resets the decimator state.
+ *
+ * @param[in] dp        pointer to the @p adcs_decimator_t object
+ *
+ * @api
+ */
+void adcsDecimatorReset(adcs_decimator_t *dp) {
+  size_t c, k;
+
+  chDbgCheck(dp != NULL);
+
+  dp->cic_count = dp->config->cic_ratio;
+  dp->fir_count = dp->config->fir_ratio;
+  dp->fir_pos   = 0U;
+  for (c = 0U; c < dp->channels; c++) {
+    adcs_channel_state_t *sp = &dp->state[c];
+
+    for (k = 0U; k < (size_t)ADCS_CIC_MAX_ORDER; k++) {
+      sp->integ[k] = 0U;
+      sp->comb[k]  = 0U;
+    }
+    for (k = 0U; k < (size_t)ADCS_FIR_MAX_TAPS * 2U; k++) {
+      sp->line[k] = 0;
+    }
+  }
+}
+
+/**
+ * @brief   Decimates a block of samples.
+ * @details Input and output samples are interleaved frames of
+ *          @p channels samples each. The decimator state is kept between
+ *          calls so a continuous stream can be processed in blocks of any
+ *          size.
+ * @note    The output buffer must be able to contain
+ *          <tt>n / ratio + 1</tt> frames, exactly <tt>n / ratio</tt>
+ *          frames are produced if @p n is a multiple of the ratio.
+ *
+ * @param[in] dp        pointer to the @p adcs_decimator_t object
+ * @param[in] in        input frames
+ * @param[in] n         number of input frames
+ * @param[out] out      output frames
+ * @return              The number of output frames.
+ *
+ * @api
+ */
+size_t adcsDecimatorProcess(adcs_decimator_t *dp, const adcs_input_t *in,
+                            size_t n, int32_t *out) {
+  const adcs_decimator_config_t *dcfgp = dp->config;
+  const size_t channels = dp->channels;
+  const unsigned order = dcfgp->cic_order;
+  const size_t taps = dcfgp->fir_taps;
+  size_t i, c, k, m = 0U;
+
+  chDbgCheck((in != NULL) || (n == 0U));
+  chDbgCheck(out != NULL);
+
+  for (i = 0U; i < n; i++) {
+
+    /* CIC integrators, running at the input rate.*/
+    for (c = 0U; c < channels; c++) {
+      adcs_channel_state_t *sp = &dp->state[c];
+      uint32_t x = (uint32_t)((int32_t)in[c] - dcfgp->offset);
+
+      for (k = 0U; k < order; k++) {
+        sp->integ[k] += x;
+        x = sp->integ[k];
+      }
+      if (order == 0U) {
+        /* Bypassed CIC, the sample is just parked.*/
+        sp->integ[0] = x;
+      }
+    }
+    in += channels;
+
+    if (--dp->cic_count > 0U) {
+      continue;
+    }
+    dp->cic_count = dcfgp->cic_ratio;
+
+    /* CIC combs, running at the decimated rate.*/
+    if (dcfgp->fir_coeffs != NULL) {
+      dp->fir_pos = dp->fir_pos == 0U ? taps - 1U : dp->fir_pos - 1U;
+    }
+    for (c = 0U; c < channels; c++) {
+      adcs_channel_state_t *sp = &dp->state[c];
+      uint32_t x = sp->integ[order > 0U ? order - 1U : 0U];
+      int32_t y;
+
+      for (k = 0U; k < order; k++) {
+        uint32_t d = x - sp->comb[k];
+        sp->comb[k] = x;
+        x = d;
+      }
+      y = (int32_t)x >> dcfgp->cic_shift;
+
+      if (dcfgp->fir_coeffs == NULL) {
+        out[m * channels + c] = y;
+      }
+      else {
+        /* Newest sample written twice, the window is always contiguous.*/
+        sp->line[dp->fir_pos]        = adcs_sat16(y);
+        sp->line[dp->fir_pos + taps] = sp->line[dp->fir_pos];
+      }
+    }
+
+    if (dcfgp->fir_coeffs == NULL) {
+      m++;
+      continue;
+    }
+
+    if (--dp->fir_count > 0U) {
+      continue;
+    }
+    dp->fir_count = dcfgp->fir_ratio;
+
+    /* FIR, computed at the output rate only.*/
+    for (c = 0U; c < channels; c++) {
+      out[m * channels + c] =
+          (int32_t)(adcs_dot(dcfgp->fir_coeffs,
+                             &dp->state[c].line[dp->fir_pos],
+                             taps) >> dcfgp->fir_shift);
+    }
+    m++;
+  }
+
+  return m;
+}
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an ADC stream object.
+ *
+ * @param[out] asp      pointer to the @p adc_stream_t object
+ *
+ * @init
+ */
+void adcsObjectInit(adc_stream_t *asp) {
+
+  chDbgCheck(asp != NULL);
+
+  asp->config              = NULL;
+  asp->thread              = NULL;
+  asp->worker              = NULL;
+  asp->dispatched          = 0U;
+  asp->frame_size          = 0U;
+  asp->stats.halves        = 0U;
+  asp->stats.in_overruns   = 0U;
+  asp->stats.frames        = 0U;
+  asp->stats.out_overruns  = 0U;
+  asp->stats.overwritten   = 0U;
+}
+
+/**
+ * @brief   Starts an ADC stream.
+ * @details The worker thread is created then the ADC conversion is started
+ *          in circular mode.
+ * @pre     The ADC driver must have been started.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ * @param[in] config    pointer to the stream configuration
+ *
+ * @api
+ */
+void adcsStart(adc_stream_t *asp, const adcs_config_t *config) {
+  size_t ratio;
+
+  chDbgCheck((asp != NULL) && (config != NULL) &&
+             (config->adcp != NULL) && (config->grpp != NULL) &&
+             (config->buffer != NULL) && (config->dcfg != NULL));
+  chDbgAssert(asp->config == NULL, "already started");
+
+  ratio = adcsDecimatorGetRatio(config->dcfg);
+  chDbgCheck((config->depth >= 2U) &&
+             (((config->depth / 2U) % ratio) == 0U) &&
+             ((config->depth % 2U) == 0U));
+
+  asp->config     = config;
+  asp->frame_size = (config->depth / 2U / ratio) *
+                    (size_t)config->grpp->num_channels;
+#if CH_CFG_USE_OBJ_FIFOS == TRUE
+  chDbgCheck((config->fifo == NULL) ||
+             (config->fifo->free.pool.object_size >=
+              asp->frame_size * sizeof (int32_t)));
+#endif
+  adcsDecimatorObjectInit(&asp->decimator, config->dcfg,
+                          (size_t)config->grpp->num_channels);
+
+  /* Private circular copy of the conversion group, the callback locates
+     the stream from the group address.*/
+  asp->group          = *config->grpp;
+  asp->group.circular = true;
+  asp->group.end_cb   = adcs_end_cb;
+
+  asp->worker = NULL;
+  asp->thread = chThdCreateStatic(asp->wa, sizeof (asp->wa), config->prio,
+                                  adcs_worker, (void *)asp);
+
+  adcStartConversion(config->adcp, &asp->group,
+                     config->buffer, config->depth);
+}
+
+/**
+ * @brief   Stops an ADC stream.
+ * @details The ADC conversion is stopped and the worker thread terminated,
+ *          a frame being processed is completed.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ *
+ * @api
+ */
+void adcsStop(adc_stream_t *asp) {
+
+  chDbgCheck(asp != NULL);
+  chDbgAssert(asp->config != NULL, "not started");
+
+  adcStopConversion(asp->config->adcp);
+
+  chThdTerminate(asp->thread);
+  chSysLock();
+  chThdResumeS(&asp->worker, MSG_RESET);
+  chSysUnlock();
+  (void) chThdWait(asp->thread);
+
+  asp->thread = NULL;
+  asp->config = NULL;
+}
+
+/**
+ * @brief   Returns a copy of the stream statistics.
+ *
+ * @param[in] asp       pointer to the @p adc_stream_t object
+ * @param[out] sp       pointer to the statistics structure to be filled
+ *
+ * @api
+ */
+void adcsGetStats(adc_stream_t *asp, adcs_stats_t *sp) {
+
+  chDbgCheck((asp != NULL) && (sp != NULL));
+
+  chSysLock();
+  *sp = asp->stats;
+  chSysUnlock();
+}
+#endif /* HAL_USE_ADC == TRUE */
+
+/** @} */
@@ -0,0 +1,375 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adc_stream.h
+ * @brief   ADC streaming service structures and macros.
+ *
+ * @addtogroup adc_stream
+ * @{
+ */
+
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum number of interleaved channels.
+ */
+#if !defined(ADCS_MAX_CHANNELS) || defined(__DOXYGEN__)
+#define ADCS_MAX_CHANNELS                   4
+#endif
+
+/**
+ * @brief   Maximum CIC stage order.
+ */
+#if !defined(ADCS_CIC_MAX_ORDER) || defined(__DOXYGEN__)
+#define ADCS_CIC_MAX_ORDER                  5
+#endif
+
+/**
+ * @brief   Maximum number of FIR stage taps.
+ */
+#if !defined(ADCS_FIR_MAX_TAPS) || defined(__DOXYGEN__)
+#define ADCS_FIR_MAX_TAPS                   32
+#endif
+
+/**
+ * @brief   Size of the worker output buffer in samples.
+ * @details Output frames are written into pipes in blocks of this size.
+ */
+#if !defined(ADCS_OUT_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define ADCS_OUT_BUFFER_SIZE                64
+#endif
+
+/**
+ * @brief   Stack size of the worker thread.
+ */
+#if !defined(ADCS_WORKER_STACK_SIZE) || defined(__DOXYGEN__)
+#define ADCS_WORKER_STACK_SIZE              256
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (ADCS_MAX_CHANNELS < 1) || (ADCS_MAX_CHANNELS > 16)
+#error "invalid ADCS_MAX_CHANNELS value"
+#endif
+
+#if (ADCS_CIC_MAX_ORDER < 1) || (ADCS_CIC_MAX_ORDER > 8)
+#error "invalid ADCS_CIC_MAX_ORDER value"
+#endif
+
+#if ADCS_FIR_MAX_TAPS < 1
+#error "invalid ADCS_FIR_MAX_TAPS value"
+#endif
+
+#if ADCS_OUT_BUFFER_SIZE < ADCS_MAX_CHANNELS
+#error "ADCS_OUT_BUFFER_SIZE must be at least ADCS_MAX_CHANNELS"
+#endif
+
+/*
+ * Module dependencies check.
+ */
+#if (HAL_USE_ADC == TRUE) && !CH_CFG_USE_WAITEXIT
+#error "ADC streams require CH_CFG_USE_WAITEXIT"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a decimator input sample.
+ */
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+typedef adcsample_t adcs_input_t;
+#else
+typedef uint16_t adcs_input_t;
+#endif
+
+/**
+ * @brief   Type of a decimator configuration.
+ * @note    The CIC stage uses modular 32 bits arithmetic, the input
+ *          resolution plus <tt>cic_order * log2(cic_ratio)</tt> must not
+ *          exceed 32 bits.
+ */
+typedef struct {
+  /**
+   * @brief   Offset subtracted from each input sample.
+   * @note    Usually the ADC mid-scale value.
+   */
+  int32_t               offset;
+  /**
+   * @brief   CIC stage order, zero bypasses the stage.
+   */
+  unsigned              cic_order;
+  /**
+   * @brief   CIC stage decimation ratio, must be one if bypassed.
+   */
+  unsigned              cic_ratio;
+  /**
+   * @brief   Right shift applied to the CIC stage output.
+   * @note    The CIC gain is <tt>cic_ratio ^ cic_order</tt>.
+   */
+  unsigned              cic_shift;
+  /**
+   * @brief   FIR stage Q15 coefficients, @p NULL bypasses the stage.
+   */
+  const int16_t         *fir_coeffs;
+  /**
+   * @brief   Number of FIR stage taps.
+   */
+  size_t                fir_taps;
+  /**
+   * @brief   FIR stage decimation ratio, must be one if bypassed.
+   */
+  unsigned              fir_ratio;
+  /**
+   * @brief   Right shift applied to the FIR stage output.
+   */
+  unsigned              fir_shift;
+} adcs_decimator_config_t;
+
+/**
+ * @brief   Type of a decimator channel state.
+ */
+typedef struct {
+  /**
+   * @brief   CIC integrators.
+   */
+  uint32_t              integ[ADCS_CIC_MAX_ORDER];
+  /**
+   * @brief   CIC combs delay elements.
+   */
+  uint32_t              comb[ADCS_CIC_MAX_ORDER];
+  /**
+   * @brief   FIR delay line, duplicated in order to always have the
+   *          window in contiguous memory.
+   */
+  int16_t               line[ADCS_FIR_MAX_TAPS * 2];
+} adcs_channel_state_t;
+
+/**
+ * @brief   Type of a decimator.
+ */
+typedef struct {
+  /**
+   * @brief   Decimator configuration.
+   */
+  const adcs_decimator_config_t *config;
+  /**
+   * @brief   Number of interleaved channels.
+   */
+  size_t                channels;
+  /**
+   * @brief   Input samples until the next CIC output.
+   */
+  unsigned              cic_count;
+  /**
+   * @brief   CIC outputs until the next FIR output.
+   */
+  unsigned              fir_count;
+  /**
+   * @brief   Position of the newest sample in the FIR delay lines.
+   */
+  size_t                fir_pos;
+  /**
+   * @brief   Channels state.
+   */
+  adcs_channel_state_t  state[ADCS_MAX_CHANNELS];
+} adcs_decimator_t;
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an ADC stream configuration.
+ */
+typedef struct {
+  /**
+   * @brief   ADC driver.
+   */
+  ADCDriver             *adcp;
+  /**
+   * @brief   Conversion group, it is copied and forced to circular mode.
+   * @note    The group callback is replaced, the error callback is kept.
+   */
+  const ADCConversionGroup *grpp;
+  /**
+   * @brief   Circular samples buffer.
+   */
+  adcsample_t           *buffer;
+  /**
+   * @brief   Buffer depth in frames of @p num_channels samples.
+   * @note    Half the depth must be a multiple of the decimation ratio.
+   */
+  size_t                depth;
+  /**
+   * @brief   Decimator configuration.
+   */
+  const adcs_decimator_config_t *dcfg;
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Output pipe or @p NULL.
+   * @details Frames are written as arrays of @p int32_t samples, a frame
+   *          not fitting in the pipe is dropped.
+   */
+  pipe_t                *pipe;
+#endif
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Output objects FIFO or @p NULL.
+   * @details Each frame is written into an object taken from the FIFO, a
+   *          frame is dropped if no free objects are available.
+   */
+  objects_fifo_t        *fifo;
+#endif
+  /**
+   * @brief   Worker thread priority.
+   */
+  tprio_t               prio;
+} adcs_config_t;
+
+/**
+ * @brief   Type of ADC stream statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Half buffers filled by the ADC.
+   */
+  uint32_t              halves;
+  /**
+   * @brief   Half buffers dropped because the worker was busy.
+   */
+  uint32_t              in_overruns;
+  /**
+   * @brief   Frames published.
+   */
+  uint32_t              frames;
+  /**
+   * @brief   Frames dropped because of lack of space in the output.
+   */
+  uint32_t              out_overruns;
+  /**
+   * @brief   Frames dropped because the ADC overwrote the half buffer
+   *          while it was being processed.
+   */
+  uint32_t              overwritten;
+} adcs_stats_t;
+
+/**
+ * @brief   Type of an ADC stream.
+ */
+typedef struct {
+  /**
+   * @brief   Stream configuration or @p NULL if stopped.
+   */
+  const adcs_config_t   *config;
+  /**
+   * @brief   Circular copy of the conversion group.
+   */
+  ADCConversionGroup    group;
+  /**
+   * @brief   Decimator.
+   */
+  adcs_decimator_t      decimator;
+  /**
+   * @brief   Worker thread.
+   */
+  thread_t              *thread;
+  /**
+   * @brief   Worker thread waiting for a half buffer.
+   */
+  thread_reference_t    worker;
+  /**
+   * @brief   Value of the half buffers counter when the half buffer being
+   *          processed has been handed to the worker.
+   */
+  uint32_t              dispatched;
+  /**
+   * @brief   Output frame size in samples.
+   */
+  size_t                frame_size;
+  /**
+   * @brief   Statistics.
+   */
+  adcs_stats_t          stats;
+  /**
+   * @brief   Output buffer.
+   */
+  int32_t               out[ADCS_OUT_BUFFER_SIZE];
+  /**
+   * @brief   Worker thread working area.
+   */
+  THD_WORKING_AREA(wa, ADCS_WORKER_STACK_SIZE);
+} adc_stream_t;
+#endif /* HAL_USE_ADC == TRUE */
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Total decimation ratio of a decimator configuration.
+ *
+ * @param[in] dcfgp     pointer to a @p adcs_decimator_config_t structure
+ * @return              The decimation ratio.
+ */
+#define adcsDecimatorGetRatio(dcfgp)                                        \
+  ((dcfgp)->cic_ratio * (dcfgp)->fir_ratio)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void adcsDecimatorObjectInit(adcs_decimator_t *dp,
+                               const adcs_decimator_config_t *dcfgp,
+                               size_t channels);
+  void adcsDecimatorReset(adcs_decimator_t *dp);
+  size_t adcsDecimatorProcess(adcs_decimator_t *dp, const adcs_input_t *in,
+                              size_t n, int32_t *out);
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+  void adcsObjectInit(adc_stream_t *asp);
+  void adcsStart(adc_stream_t *asp, const adcs_config_t *config);
+  void adcsStop(adc_stream_t *asp);
+  void adcsGetStats(adc_stream_t *asp, adcs_stats_t *sp);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* ADC_STREAM_H */
+
+/** @} */
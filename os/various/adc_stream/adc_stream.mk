@@ -0,0 +1,8 @@
+# ADC streaming service files.
+ADCSTREAMSRC = $(CHIBIOS)/os/various/adc_stream/adc_stream.c
+
+ADCSTREAMINC = $(CHIBIOS)/os/various/adc_stream
+
+# Shared variables
+ALLCSRC += $(ADCSTREAMSRC)
+ALLINC  += $(ADCSTREAMINC)
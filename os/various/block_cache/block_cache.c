@@ -0,0 +1,579 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    block_cache.c
+ * @brief   Block cache code.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "block_cache.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Objects group of the cached blocks.
+ */
+#define BCACHE_GROUP                        0U
+
+/**
+ * @brief   Flags of a dirty block not in use.
+ */
+#define BCACHE_DIRTY_IDLE                   (OC_FLAG_INHASH |               \
+                                             OC_FLAG_INLRU |                \
+                                             OC_FLAG_LAZYWRITE)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static bool bc_is_inserted(void *ip) {
+
+  return blkIsInserted(((BlockCache *)ip)->blkp);
+}
+
+static bool bc_is_protected(void *ip) {
+
+  return blkIsWriteProtected(((BlockCache *)ip)->blkp);
+}
+
+static bool bc_get_info(void *ip, BlockDeviceInfo *bdip) {
+  BlockCache *bcp = (BlockCache *)ip;
+
+  if (bcp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+
+  bdip->blk_size = BCACHE_BLOCK_SIZE;
+  bdip->blk_num  = bcp->blk_num;
+
+  return HAL_SUCCESS;
+}
+
+static const struct BlockCacheVMT vmt = {
+  (size_t)0,
+  bc_is_inserted,
+  bc_is_protected,
+  (bool (*)(void *))bcacheConnect,
+  (bool (*)(void *))bcacheDisconnect,
+  (bool (*)(void *, uint32_t, uint8_t *, uint32_t))bcacheRead,
+  (bool (*)(void *, uint32_t, const uint8_t *, uint32_t))bcacheWrite,
+  (bool (*)(void *))bcacheSync,
+  bc_get_info
+};
+
+/**
+ * @brief   Returns the block cache owning an objects cache.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @return              The pointer to the @p BlockCache object.
+ */
+static BlockCache *bc_from_cache(objects_cache_t *ocp) {
+
+  return (BlockCache *)(void *)((uint8_t *)ocp - offsetof(BlockCache, cache));
+}
+
+/**
+ * @brief   Acquires a cached block if it is dirty and not in use.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] blk       block number
+ * @return              The pointer to the acquired block.
+ * @retval NULL         if the block is not cached, not dirty or in use.
+ */
+static bcache_block_t *bc_get_dirty(BlockCache *bcp, uint32_t blk) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)BCACHE_NUM_BLOCKS; i++) {
+    oc_object_t *objp = &bcp->blocks[i].header;
+
+    if ((objp->obj_key == blk) &&
+        ((objp->obj_flags & BCACHE_DIRTY_IDLE) == BCACHE_DIRTY_IDLE)) {
+      return (bcache_block_t *)chCacheGetObject(&bcp->cache,
+                                                BCACHE_GROUP, blk);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Single block reader, misses are normally served by
+ *          @p bcacheRead() with merged reads.
+ */
+static bool bc_readf(objects_cache_t *ocp, oc_object_t *objp, bool async) {
+  BlockCache *bcp = bc_from_cache(ocp);
+  bool err;
+
+  err = blkRead(bcp->blkp, objp->obj_key,
+                ((bcache_block_t *)objp)->data, 1U);
+  bcp->stats.dev_reads++;
+  if (err == HAL_SUCCESS) {
+    objp->obj_flags &= ~OC_FLAG_NOTSYNC;
+  }
+  else {
+    bcp->stats.errors++;
+  }
+
+  if (async) {
+    chCacheReleaseObject(ocp, objp);
+  }
+
+  return err;
+}
+
+/**
+ * @brief   Block writer.
+ * @details The write is extended over the following dirty blocks, the
+ *          whole run is written with a single device operation.
+ * @note    A failed asynchronous write, which happens on eviction, loses
+ *          the block data, it is accounted in the errors counter.
+ */
+static bool bc_writef(objects_cache_t *ocp, oc_object_t *objp, bool async) {
+  BlockCache *bcp = bc_from_cache(ocp);
+  bcache_block_t *run[BCACHE_MAX_BURST];
+  uint32_t blk = objp->obj_key;
+  const uint8_t *p;
+  unsigned i, n;
+  bool err;
+
+  run[0] = (bcache_block_t *)objp;
+  n = 1U;
+  while ((n < (unsigned)BCACHE_MAX_BURST) && (blk + n < bcp->blk_num)) {
+    run[n] = bc_get_dirty(bcp, blk + n);
+    if (run[n] == NULL) {
+      break;
+    }
+    run[n]->header.obj_flags &= ~OC_FLAG_LAZYWRITE;
+    n++;
+  }
+
+  if (n == 1U) {
+    p = run[0]->data;
+  }
+  else {
+    for (i = 0U; i < n; i++) {
+      memcpy(&bcp->staging[i * BCACHE_BLOCK_SIZE], run[i]->data,
+             BCACHE_BLOCK_SIZE);
+    }
+    p = bcp->staging;
+  }
+
+  err = blkWrite(bcp->blkp, blk, p, n);
+  bcp->stats.dev_writes++;
+  if (err == HAL_SUCCESS) {
+    bcp->stats.dev_blocks_written += n;
+  }
+  else {
+    /* The run is kept dirty for a later retry.*/
+    bcp->stats.errors++;
+    for (i = async ? 1U : 0U; i < n; i++) {
+      run[i]->header.obj_flags |= OC_FLAG_LAZYWRITE;
+    }
+  }
+
+  for (i = 1U; i < n; i++) {
+    chCacheReleaseObject(ocp, &run[i]->header);
+  }
+  if (async) {
+    chCacheReleaseObject(ocp, objp);
+  }
+
+  return err;
+}
+
+/**
+ * @brief   Writes back all the dirty blocks.
+ * @details Blocks are written in ascending order so that contiguous runs
+ *          are merged.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              The operation status.
+ */
+static bool bc_flush(BlockCache *bcp) {
+
+  while (true) {
+    oc_object_t *objp;
+    uint32_t blk = 0xFFFFFFFFU;
+    bool found = false;
+    unsigned i;
+    bool err;
+
+    for (i = 0U; i < (unsigned)BCACHE_NUM_BLOCKS; i++) {
+      objp = &bcp->blocks[i].header;
+      if (((objp->obj_flags & BCACHE_DIRTY_IDLE) == BCACHE_DIRTY_IDLE) &&
+          (objp->obj_key <= blk)) {
+        blk   = objp->obj_key;
+        found = true;
+      }
+    }
+    if (!found) {
+      return HAL_SUCCESS;
+    }
+
+    objp = chCacheGetObject(&bcp->cache, BCACHE_GROUP, blk);
+    err = chCacheWriteObject(&bcp->cache, objp, false);
+    chCacheReleaseObject(&bcp->cache, objp);
+    if (err) {
+      return HAL_FAILED;
+    }
+  }
+}
+
+/**
+ * @brief   Drops all the cached blocks.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ */
+static void bc_invalidate(BlockCache *bcp) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)BCACHE_NUM_BLOCKS; i++) {
+    oc_object_t *objp = &bcp->blocks[i].header;
+
+    if ((objp->obj_flags & OC_FLAG_INHASH) != 0U) {
+      objp = chCacheGetObject(&bcp->cache, BCACHE_GROUP, objp->obj_key);
+      objp->obj_flags |= OC_FLAG_NOTSYNC;
+      chCacheReleaseObject(&bcp->cache, objp);
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a block cache object.
+ *
+ * @param[out] bcp      pointer to the @p BlockCache object
+ * @param[in] blkp      pointer to the wrapped @p BaseBlockDevice
+ *
+ * @init
+ */
+void bcacheObjectInit(BlockCache *bcp, BaseBlockDevice *blkp) {
+
+  osalDbgCheck((bcp != NULL) && (blkp != NULL));
+
+  bcp->vmt      = &vmt;
+  bcp->state    = BLK_ACTIVE;
+  bcp->blkp     = blkp;
+  bcp->blk_num  = 0U;
+  bcp->next_blk = 0U;
+  memset(&bcp->stats, 0, sizeof bcp->stats);
+  chMtxObjectInit(&bcp->mtx);
+  chCacheObjectInit(&bcp->cache,
+                    (ucnt_t)BCACHE_HASH_SIZE, bcp->hash,
+                    (ucnt_t)BCACHE_NUM_BLOCKS, sizeof (bcache_block_t),
+                    bcp->blocks, bc_readf, bc_writef);
+}
+
+/**
+ * @brief   Connects the wrapped device, if not already connected, and
+ *          enables the cache.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed or block size mismatch.
+ *
+ * @api
+ */
+bool bcacheConnect(BlockCache *bcp) {
+  BlockDeviceInfo bdi;
+  bool err = HAL_SUCCESS;
+
+  osalDbgCheck(bcp != NULL);
+
+  chMtxLock(&bcp->mtx);
+  if (bcp->state != BLK_READY) {
+    /* The wrapped device could have been connected already.*/
+    if (((blkGetDriverState(bcp->blkp) == BLK_READY) ||
+         (blkConnect(bcp->blkp) == HAL_SUCCESS)) &&
+        (blkGetInfo(bcp->blkp, &bdi) == HAL_SUCCESS) &&
+        (bdi.blk_size == (uint32_t)BCACHE_BLOCK_SIZE)) {
+      bcp->blk_num  = bdi.blk_num;
+      bcp->next_blk = 0U;
+      bcp->state    = BLK_READY;
+    }
+    else {
+      err = HAL_FAILED;
+    }
+  }
+  chMtxUnlock(&bcp->mtx);
+
+  return err;
+}
+
+/**
+ * @brief   Writes back the dirty blocks, drops the cache content and
+ *          disconnects the wrapped device.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed, dirty blocks could have been lost.
+ *
+ * @api
+ */
+bool bcacheDisconnect(BlockCache *bcp) {
+  bool err = HAL_SUCCESS;
+
+  osalDbgCheck(bcp != NULL);
+
+  chMtxLock(&bcp->mtx);
+  if (bcp->state == BLK_READY) {
+    err = bc_flush(bcp);
+    bc_invalidate(bcp);
+    bcp->state = BLK_ACTIVE;
+    if (blkDisconnect(bcp->blkp) != HAL_SUCCESS) {
+      err = HAL_FAILED;
+    }
+  }
+  chMtxUnlock(&bcp->mtx);
+
+  return err;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ * @details Runs of missing blocks are read with a single device operation,
+ *          if the request continues the previous one the run is extended
+ *          by @p BCACHE_READ_AHEAD blocks.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcacheRead(BlockCache *bcp, uint32_t startblk,
+                uint8_t *buffer, uint32_t n) {
+  bcache_block_t *run[BCACHE_MAX_BURST];
+  bool err = HAL_SUCCESS;
+  uint32_t ahead;
+
+  osalDbgCheck((bcp != NULL) && (buffer != NULL));
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  if ((startblk >= bcp->blk_num) || (n > bcp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  chMtxLock(&bcp->mtx);
+
+  ahead = startblk == bcp->next_blk ? (uint32_t)BCACHE_READ_AHEAD : 0U;
+  bcp->next_blk = startblk + n;
+
+  while (n > 0U) {
+    bcache_block_t *bp;
+    uint32_t i, k, m, limit;
+    bool direct;
+
+    bp = (bcache_block_t *)chCacheGetObject(&bcp->cache,
+                                            BCACHE_GROUP, startblk);
+    if ((bp->header.obj_flags & OC_FLAG_NOTSYNC) == 0U) {
+      memcpy(buffer, bp->data, BCACHE_BLOCK_SIZE);
+      chCacheReleaseObject(&bcp->cache, &bp->header);
+      bcp->stats.hits++;
+      startblk++;
+      buffer += BCACHE_BLOCK_SIZE;
+      n--;
+      continue;
+    }
+
+    /* Miss, collecting the following missing blocks in order to read
+       them all at once.*/
+    limit = n + ahead;
+    if (limit > (uint32_t)BCACHE_MAX_BURST) {
+      limit = (uint32_t)BCACHE_MAX_BURST;
+    }
+    if (limit > bcp->blk_num - startblk) {
+      limit = bcp->blk_num - startblk;
+    }
+    run[0] = bp;
+    k = 1U;
+    while (k < limit) {
+      bp = (bcache_block_t *)chCacheGetObject(&bcp->cache,
+                                              BCACHE_GROUP, startblk + k);
+      if ((bp->header.obj_flags & OC_FLAG_NOTSYNC) == 0U) {
+        chCacheReleaseObject(&bcp->cache, &bp->header);
+        break;
+      }
+      run[k++] = bp;
+    }
+
+    /* Reading directly in the user buffer if the run does not extend
+       past the request.*/
+    direct = k <= n;
+    err = blkRead(bcp->blkp, startblk, direct ? buffer : bcp->staging, k);
+    bcp->stats.dev_reads++;
+    if (err != HAL_SUCCESS) {
+      /* Released blocks are still marked as not in sync, this drops
+         them.*/
+      for (i = 0U; i < k; i++) {
+        chCacheReleaseObject(&bcp->cache, &run[i]->header);
+      }
+      bcp->stats.errors++;
+      bcp->next_blk = 0xFFFFFFFFU;
+      break;
+    }
+
+    m = direct ? k : n;
+    for (i = 0U; i < k; i++) {
+      if (direct) {
+        memcpy(run[i]->data, &buffer[i * BCACHE_BLOCK_SIZE],
+               BCACHE_BLOCK_SIZE);
+      }
+      else {
+        memcpy(run[i]->data, &bcp->staging[i * BCACHE_BLOCK_SIZE],
+               BCACHE_BLOCK_SIZE);
+        if (i < m) {
+          memcpy(&buffer[i * BCACHE_BLOCK_SIZE], run[i]->data,
+                 BCACHE_BLOCK_SIZE);
+        }
+      }
+      run[i]->header.obj_flags &= ~OC_FLAG_NOTSYNC;
+      chCacheReleaseObject(&bcp->cache, &run[i]->header);
+    }
+
+    bcp->stats.misses     += m;
+    bcp->stats.prefetched += k - m;
+    startblk += m;
+    buffer   += m * BCACHE_BLOCK_SIZE;
+    n        -= m;
+  }
+
+  chMtxUnlock(&bcp->mtx);
+
+  return err;
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ * @details Blocks are only written into the cache, the device is updated
+ *          on eviction or on @p bcacheSync().
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcacheWrite(BlockCache *bcp, uint32_t startblk,
+                 const uint8_t *buffer, uint32_t n) {
+
+  osalDbgCheck((bcp != NULL) && (buffer != NULL));
+  osalDbgAssert(bcp->state == BLK_READY, "invalid state");
+
+  if ((startblk >= bcp->blk_num) || (n > bcp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  chMtxLock(&bcp->mtx);
+
+  while (n > 0U) {
+    bcache_block_t *bp;
+
+    bp = (bcache_block_t *)chCacheGetObject(&bcp->cache,
+                                            BCACHE_GROUP, startblk);
+    memcpy(bp->data, buffer, BCACHE_BLOCK_SIZE);
+    bp->header.obj_flags &= ~OC_FLAG_NOTSYNC;
+    bp->header.obj_flags |= OC_FLAG_LAZYWRITE;
+    chCacheReleaseObject(&bcp->cache, &bp->header);
+    startblk++;
+    buffer += BCACHE_BLOCK_SIZE;
+    n--;
+  }
+
+  chMtxUnlock(&bcp->mtx);
+
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes back the dirty blocks and synchronizes the wrapped
+ *          device.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bcacheSync(BlockCache *bcp) {
+  bool err;
+
+  osalDbgCheck(bcp != NULL);
+
+  chMtxLock(&bcp->mtx);
+  err = bc_flush(bcp);
+  if (err == HAL_SUCCESS) {
+    err = blkSync(bcp->blkp);
+  }
+  chMtxUnlock(&bcp->mtx);
+
+  return err;
+}
+
+/**
+ * @brief   Returns the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @param[out] statsp   pointer to the @p bcache_stats_t structure
+ *
+ * @api
+ */
+void bcacheGetStats(BlockCache *bcp, bcache_stats_t *statsp) {
+
+  osalDbgCheck((bcp != NULL) && (statsp != NULL));
+
+  chMtxLock(&bcp->mtx);
+  *statsp = bcp->stats;
+  chMtxUnlock(&bcp->mtx);
+}
+
+/** @} */
@@ -0,0 +1,256 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    block_cache.h
+ * @brief   Block cache structures and macros.
+ * @details The block cache is a @p BaseBlockDevice wrapping another
+ *          @p BaseBlockDevice, blocks are kept in an objects cache with
+ *          write-back policy. Misses are served with multi-block reads
+ *          extended ahead on sequential access, dirty blocks are written
+ *          back merging contiguous runs into multi-block writes.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Size of the cached blocks.
+ * @note    Must match the block size of the wrapped device.
+ */
+#if !defined(BCACHE_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define BCACHE_BLOCK_SIZE                   512
+#endif
+
+/**
+ * @brief   Number of cached blocks.
+ */
+#if !defined(BCACHE_NUM_BLOCKS) || defined(__DOXYGEN__)
+#define BCACHE_NUM_BLOCKS                   32
+#endif
+
+/**
+ * @brief   Number of hash table slots.
+ * @note    Must be a power of two not lower than @p BCACHE_NUM_BLOCKS.
+ */
+#if !defined(BCACHE_HASH_SIZE) || defined(__DOXYGEN__)
+#define BCACHE_HASH_SIZE                    64
+#endif
+
+/**
+ * @brief   Maximum number of blocks in a single device operation.
+ * @details Limits merged reads and writes, a staging buffer of this
+ *          number of blocks is part of the cache object.
+ */
+#if !defined(BCACHE_MAX_BURST) || defined(__DOXYGEN__)
+#define BCACHE_MAX_BURST                    8
+#endif
+
+/**
+ * @brief   Number of blocks read ahead on sequential access.
+ * @note    Zero disables read-ahead.
+ */
+#if !defined(BCACHE_READ_AHEAD) || defined(__DOXYGEN__)
+#define BCACHE_READ_AHEAD                   4
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_OBJ_CACHES == FALSE
+#error "BCACHE requires CH_CFG_USE_OBJ_CACHES"
+#endif
+
+#if CH_CFG_USE_MUTEXES == FALSE
+#error "BCACHE requires CH_CFG_USE_MUTEXES"
+#endif
+
+#if (BCACHE_BLOCK_SIZE < 16) || ((BCACHE_BLOCK_SIZE % 16) != 0)
+#error "invalid BCACHE_BLOCK_SIZE value"
+#endif
+
+#if (BCACHE_HASH_SIZE & (BCACHE_HASH_SIZE - 1)) != 0
+#error "BCACHE_HASH_SIZE must be a power of two"
+#endif
+
+#if BCACHE_HASH_SIZE < BCACHE_NUM_BLOCKS
+#error "BCACHE_HASH_SIZE lower than BCACHE_NUM_BLOCKS"
+#endif
+
+#if BCACHE_MAX_BURST < 1
+#error "invalid BCACHE_MAX_BURST value"
+#endif
+
+#if BCACHE_NUM_BLOCKS < (BCACHE_MAX_BURST * 2)
+#error "BCACHE_NUM_BLOCKS must be at least twice BCACHE_MAX_BURST"
+#endif
+
+#if (BCACHE_READ_AHEAD < 0) || (BCACHE_READ_AHEAD >= BCACHE_MAX_BURST)
+#error "invalid BCACHE_READ_AHEAD value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a cached block.
+ */
+typedef struct {
+  /**
+   * @brief   Cached object header, the block number is the key.
+   */
+  oc_object_t               header;
+  /**
+   * @brief   Block data.
+   */
+  uint8_t                   data[BCACHE_BLOCK_SIZE];
+} bcache_block_t;
+
+/**
+ * @brief   Block cache statistics.
+ * @note    The hit rate is <tt>hits / (hits + misses)</tt>, only blocks
+ *          requested by reads are accounted.
+ */
+typedef struct {
+  /**
+   * @brief   Blocks read from the cache.
+   */
+  uint32_t                  hits;
+  /**
+   * @brief   Blocks read from the device.
+   */
+  uint32_t                  misses;
+  /**
+   * @brief   Blocks read ahead of the requests.
+   */
+  uint32_t                  prefetched;
+  /**
+   * @brief   Device read operations.
+   */
+  uint32_t                  dev_reads;
+  /**
+   * @brief   Device write operations.
+   */
+  uint32_t                  dev_writes;
+  /**
+   * @brief   Blocks written to the device.
+   */
+  uint32_t                  dev_blocks_written;
+  /**
+   * @brief   Failed device operations.
+   */
+  uint32_t                  errors;
+} bcache_stats_t;
+
+/**
+ * @brief   @p BlockCache specific methods.
+ */
+#define _block_cache_methods                                                \
+  _base_block_device_methods
+
+/**
+ * @brief   @p BlockCache specific data.
+ */
+#define _block_cache_data                                                   \
+  _base_block_device_data                                                   \
+  /* Wrapped block device.*/                                                \
+  BaseBlockDevice           *blkp;                                          \
+  /* Operations serialization mutex.*/                                      \
+  mutex_t                   mtx;                                            \
+  /* Number of blocks of the wrapped device.*/                              \
+  uint32_t                  blk_num;                                        \
+  /* Block following the last read, used for sequential detection.*/       \
+  uint32_t                  next_blk;                                       \
+  /* Statistics.*/                                                          \
+  bcache_stats_t            stats;                                          \
+  /* Objects cache.*/                                                       \
+  objects_cache_t           cache;                                          \
+  /* Objects cache hash table.*/                                            \
+  oc_hash_header_t          hash[BCACHE_HASH_SIZE];                         \
+  /* Cached blocks.*/                                                       \
+  bcache_block_t            blocks[BCACHE_NUM_BLOCKS];                      \
+  /* Staging buffer for merged operations.*/                                \
+  uint8_t                   staging[BCACHE_MAX_BURST * BCACHE_BLOCK_SIZE];
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p BlockCache virtual methods table.
+ */
+struct BlockCacheVMT {
+  _block_cache_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block cache object.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BlockCacheVMT *vmt;
+  _block_cache_data
+} BlockCache;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bcacheObjectInit(BlockCache *bcp, BaseBlockDevice *blkp);
+  bool bcacheConnect(BlockCache *bcp);
+  bool bcacheDisconnect(BlockCache *bcp);
+  bool bcacheRead(BlockCache *bcp, uint32_t startblk,
+                  uint8_t *buffer, uint32_t n);
+  bool bcacheWrite(BlockCache *bcp, uint32_t startblk,
+                   const uint8_t *buffer, uint32_t n);
+  bool bcacheSync(BlockCache *bcp);
+  void bcacheGetStats(BlockCache *bcp, bcache_stats_t *statsp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* BLOCK_CACHE_H */
+
+/** @} */
@@ -0,0 +1,8 @@
+# Block cache files.
+BCACHESRC = $(CHIBIOS)/os/various/block_cache/block_cache.c
+
+BCACHEINC = $(CHIBIOS)/os/various/block_cache
+
+# Shared variables
+ALLCSRC += $(BCACHESRC)
+ALLINC  += $(BCACHEINC)
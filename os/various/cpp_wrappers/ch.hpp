@@ -1730,6 +1730,18 @@ namespace chibios_rt {
       chSemAddCounterI(&sem, n);
     }
 
+    /**
+     * @brief   Decreases the semaphore counter.
+     * @details This function can be used when the counter is known to be
+     *          positive.
+     *
+     * @iclass
+     */
+    void fastWaitI(void) {
+
+      chSemFastWaitI(&sem);
+    }
+
     /**
      * @brief   Returns the semaphore counter value.
      *
@@ -2911,6 +2923,26 @@ namespace chibios_rt {
 
       chPoolFreeI(&pool, objp);
     }
+
+    /**
+     * @brief   Returns the size of the pool objects.
+     *
+     * @xclass
+     */
+    size_t getObjectSizeX(void) const {
+
+      return pool.object_size;
+    }
+
+    /**
+     * @brief   Returns the alignment of the pool objects.
+     *
+     * @xclass
+     */
+    unsigned getAlignX(void) const {
+
+      return pool.align;
+    }
   };
 
   /*------------------------------------------------------------------------*
@@ -3031,6 +3063,22 @@ namespace chibios_rt {
       return chHeapAlloc(&heap, size);
     }
 
+    /**
+     * @brief   Allocates an aligned object from a heap.
+     * @pre     The heap must be already been initialized.
+     *
+     * @param[in] size      the size of the object to be allocated
+     * @param[in] align     desired memory alignment, must be a power of two
+     * @return              The pointer to the allocated object.
+     * @retval nullptr      if there is not enough free space.
+     *
+     * @api
+     */
+    void *allocAligned(const size_t size, unsigned align) {
+
+      return chHeapAllocAligned(&heap, size, align);
+    }
+
     /**
      * @brief   Releases an object into the heap.
      *
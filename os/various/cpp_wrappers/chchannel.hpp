@@ -0,0 +1,542 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chchannel.hpp
+ * @brief   Typed channels.
+ * @details Channels are bounded FIFO queues of objects of any type,
+ *          move-only types included. Messages are exchanged using atomic
+ *          operations, the kernel is entered only in order to block a
+ *          thread on a full or empty channel and to wake it up.
+ * @note    Channels require lock-free 32 bits atomic operations, the MPMC
+ *          variant also requires compare-and-swap which is not available
+ *          on ARMv6-M cores, use the SPSC variant there.
+ *
+ * @addtogroup cpp_channels
+ * @{
+ */
+
+#include "ch.hpp"
+
+#ifndef _CHCHANNEL_HPP_
+#define _CHCHANNEL_HPP_
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace chibios_rt {
+
+  /**
+   * @brief   Channel variants.
+   */
+  enum class ChannelMode {
+    /**
+     * @brief   Single producer and single consumer.
+     */
+    SPSC,
+    /**
+     * @brief   Multiple producers and multiple consumers.
+     */
+    MPMC
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::SpscRing                                                   *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Lock-free single producer single consumer ring.
+   *
+   * @param T               type of the objects
+   * @param N               number of slots, must be a power of two
+   */
+  template <typename T, unsigned N>
+  class SpscRing {
+    static_assert((N > 0U) && ((N & (N - 1U)) == 0U),
+                  "N must be a power of two");
+
+    struct Slot {
+      alignas(T) uint8_t    data[sizeof (T)];
+    };
+
+    /**
+     * @brief   Index of the next object to be read, written by the consumer.
+     */
+    std::atomic<unsigned>   head;
+    /**
+     * @brief   Index of the next slot to be written, written by the producer.
+     */
+    std::atomic<unsigned>   tail;
+    /**
+     * @brief   Objects slots.
+     */
+    Slot                    slots[N];
+
+    T *slot(unsigned i) {
+
+      return reinterpret_cast<T *>(slots[i & (N - 1U)].data);
+    }
+
+  public:
+    SpscRing(void) : head(0U), tail(0U) {
+
+    }
+
+    ~SpscRing() {
+
+      for (unsigned i = head.load(); i != tail.load(); i++) {
+        slot(i)->~T();
+      }
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * @brief   Moves an object into the ring.
+     *
+     * @param[in] item      the object, it is moved from only on success
+     * @return              The operation status.
+     * @retval false        if the ring is full.
+     */
+    bool tryPush(T &&item) {
+      unsigned t = tail.load(std::memory_order_relaxed);
+
+      if (t - head.load(std::memory_order_acquire) == N) {
+        return false;
+      }
+      new (slot(t)) T(std::move(item));
+      tail.store(t + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * @brief   Moves an object out of the ring.
+     *
+     * @param[out] item     the object
+     * @return              The operation status.
+     * @retval false        if the ring is empty.
+     */
+    bool tryPop(T &item) {
+      unsigned h = head.load(std::memory_order_relaxed);
+      T *p;
+
+      if (h == tail.load(std::memory_order_acquire)) {
+        return false;
+      }
+      p = slot(h);
+      item = std::move(*p);
+      p->~T();
+      head.store(h + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * @brief   Returns @p true if the ring is empty.
+     */
+    bool isEmpty(void) const {
+
+      return head.load() == tail.load();
+    }
+
+    /**
+     * @brief   Returns @p true if the ring is full.
+     */
+    bool isFull(void) const {
+
+      return tail.load() - head.load() == N;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MpmcRing                                                   *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Lock-free multiple producers multiple consumers ring.
+   * @details Each slot has a sequence number telling producers and
+   *          consumers if it is free or filled for the current lap, slots
+   *          are reserved by advancing the enqueue or dequeue index using
+   *          compare-and-swap.
+   *
+   * @param T               type of the objects
+   * @param N               number of slots, must be a power of two
+   */
+  template <typename T, unsigned N>
+  class MpmcRing {
+    static_assert((N > 0U) && ((N & (N - 1U)) == 0U),
+                  "N must be a power of two");
+
+    struct Slot {
+      std::atomic<unsigned> seq;
+      alignas(T) uint8_t    data[sizeof (T)];
+    };
+
+    /**
+     * @brief   Next slot to be reserved by producers.
+     */
+    std::atomic<unsigned>   enq;
+    /**
+     * @brief   Next slot to be reserved by consumers.
+     */
+    std::atomic<unsigned>   deq;
+    /**
+     * @brief   Objects slots.
+     */
+    Slot                    slots[N];
+
+  public:
+    MpmcRing(void) : enq(0U), deq(0U) {
+
+      for (unsigned i = 0U; i < N; i++) {
+        slots[i].seq.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ~MpmcRing() {
+
+      for (unsigned i = deq.load(); i != enq.load(); i++) {
+        reinterpret_cast<T *>(slots[i & (N - 1U)].data)->~T();
+      }
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    MpmcRing(const MpmcRing &) = delete;
+    MpmcRing &operator=(const MpmcRing &) = delete;
+
+    /**
+     * @brief   Moves an object into the ring.
+     *
+     * @param[in] item      the object, it is moved from only on success
+     * @return              The operation status.
+     * @retval false        if the ring is full.
+     */
+    bool tryPush(T &&item) {
+      unsigned pos = enq.load(std::memory_order_relaxed);
+      Slot *sp;
+
+      while (true) {
+        sp = &slots[pos & (N - 1U)];
+        int dif = (int)(sp->seq.load(std::memory_order_acquire) - pos);
+        if (dif == 0) {
+          if (enq.compare_exchange_weak(pos, pos + 1U,
+                                        std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if (dif < 0) {
+          return false;
+        }
+        else {
+          pos = enq.load(std::memory_order_relaxed);
+        }
+      }
+      new (sp->data) T(std::move(item));
+      sp->seq.store(pos + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * @brief   Moves an object out of the ring.
+     *
+     * @param[out] item     the object
+     * @return              The operation status.
+     * @retval false        if the ring is empty.
+     */
+    bool tryPop(T &item) {
+      unsigned pos = deq.load(std::memory_order_relaxed);
+      Slot *sp;
+      T *p;
+
+      while (true) {
+        sp = &slots[pos & (N - 1U)];
+        int dif = (int)(sp->seq.load(std::memory_order_acquire) - (pos + 1U));
+        if (dif == 0) {
+          if (deq.compare_exchange_weak(pos, pos + 1U,
+                                        std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if (dif < 0) {
+          return false;
+        }
+        else {
+          pos = deq.load(std::memory_order_relaxed);
+        }
+      }
+      p = reinterpret_cast<T *>(sp->data);
+      item = std::move(*p);
+      p->~T();
+      sp->seq.store(pos + N, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * @brief   Returns @p true if the ring is empty.
+     * @note    Objects being written by a producer are not counted.
+     */
+    bool isEmpty(void) const {
+      unsigned pos = deq.load();
+
+      return (int)(slots[pos & (N - 1U)].seq.load() - (pos + 1U)) < 0;
+    }
+
+    /**
+     * @brief   Returns @p true if the ring is full.
+     * @note    Objects being read by a consumer are counted.
+     */
+    bool isFull(void) const {
+      unsigned pos = enq.load();
+
+      return (int)(slots[pos & (N - 1U)].seq.load() - pos) < 0;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Channel                                                    *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Typed channel.
+   * @details Threads block on a full or empty channel using a threads
+   *          queue, the waiting threads are counted so that the other side
+   *          enters the kernel only when there is somebody to wake up.
+   *
+   * @param T               type of the objects, it must be move-constructible
+   *                        and move-assignable
+   * @param N               number of slots, must be a power of two
+   * @param M               channel variant
+   */
+  template <typename T, unsigned N, ChannelMode M = ChannelMode::MPMC>
+  class Channel {
+    /**
+     * @brief   Objects ring.
+     */
+    typename std::conditional<M == ChannelMode::SPSC,
+                              SpscRing<T, N>, MpmcRing<T, N>>::type ring;
+    /**
+     * @brief   Threads waiting for objects.
+     */
+    threads_queue_t         rx_queue;
+    /**
+     * @brief   Threads waiting for free slots.
+     */
+    threads_queue_t         tx_queue;
+    /**
+     * @brief   Number of threads waiting for objects.
+     */
+    std::atomic<unsigned>   rx_waiting;
+    /**
+     * @brief   Number of threads waiting for free slots.
+     */
+    std::atomic<unsigned>   tx_waiting;
+
+    /*
+     * The waiter increments its counter then checks the ring again, the
+     * other side updates the ring then checks the counter, the fences
+     * guarantee that at least one of them sees the update of the other.
+     */
+    static void wakeup(threads_queue_t *tqp, std::atomic<unsigned> &waiting) {
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting.load(std::memory_order_relaxed) > 0U) {
+        chSysLock();
+        chThdDequeueNextI(tqp, MSG_OK);
+        chSchRescheduleS();
+        chSysUnlock();
+      }
+    }
+
+    template <typename C>
+    static msg_t wait(threads_queue_t *tqp, std::atomic<unsigned> &waiting,
+                      C blocked, systime_t start, sysinterval_t timeout) {
+      msg_t msg = MSG_OK;
+
+      if ((timeout != TIME_INFINITE) && (timeout != TIME_IMMEDIATE)) {
+        sysinterval_t elapsed = chVTTimeElapsedSinceX(start);
+        if (elapsed >= timeout) {
+          return MSG_TIMEOUT;
+        }
+        timeout -= elapsed;
+      }
+
+      chSysLock();
+      waiting.fetch_add(1U, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (blocked()) {
+        msg = chThdEnqueueTimeoutS(tqp, timeout);
+      }
+      waiting.fetch_sub(1U, std::memory_order_relaxed);
+      chSysUnlock();
+
+      return msg;
+    }
+
+  public:
+    /**
+     * @brief   Channel constructor.
+     *
+     * @init
+     */
+    Channel(void) : rx_waiting(0U), tx_waiting(0U) {
+
+      chThdQueueObjectInit(&rx_queue);
+      chThdQueueObjectInit(&tx_queue);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    /**
+     * @brief   Sends an object without waiting.
+     *
+     * @param[in] item      the object, it is moved from only on success
+     * @return              The operation status.
+     * @retval false        if the channel is full.
+     *
+     * @api
+     */
+    bool trySend(T &&item) {
+
+      if (!ring.tryPush(std::move(item))) {
+        return false;
+      }
+      wakeup(&rx_queue, rx_waiting);
+
+      return true;
+    }
+
+    /**
+     * @brief   Receives an object without waiting.
+     *
+     * @param[out] item     the object
+     * @return              The operation status.
+     * @retval false        if the channel is empty.
+     *
+     * @api
+     */
+    bool tryReceive(T &item) {
+
+      if (!ring.tryPop(item)) {
+        return false;
+      }
+      wakeup(&tx_queue, tx_waiting);
+
+      return true;
+    }
+
+    /**
+     * @brief   Sends an object.
+     * @details The calling thread waits for a free slot if the channel
+     *          is full.
+     *
+     * @param[in] item      the object, it is moved from only on success
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been sent.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t send(T &&item, sysinterval_t timeout) {
+      systime_t start = chVTGetSystemTimeX();
+
+      while (!ring.tryPush(std::move(item))) {
+        msg_t msg = wait(&tx_queue, tx_waiting,
+                         [this](void) {return ring.isFull();},
+                         start, timeout);
+        if (msg != MSG_OK) {
+          return msg;
+        }
+      }
+      wakeup(&rx_queue, rx_waiting);
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Receives an object.
+     * @details The calling thread waits for an object if the channel
+     *          is empty.
+     *
+     * @param[out] item     the object
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an object has been received.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t receive(T &item, sysinterval_t timeout) {
+      systime_t start = chVTGetSystemTimeX();
+
+      while (!ring.tryPop(item)) {
+        msg_t msg = wait(&rx_queue, rx_waiting,
+                         [this](void) {return ring.isEmpty();},
+                         start, timeout);
+        if (msg != MSG_OK) {
+          return msg;
+        }
+      }
+      wakeup(&tx_queue, tx_waiting);
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Returns @p true if the channel is empty.
+     *
+     * @xclass
+     */
+    bool isEmptyX(void) const {
+
+      return ring.isEmpty();
+    }
+
+    /**
+     * @brief   Returns @p true if the channel is full.
+     *
+     * @xclass
+     */
+    bool isFullX(void) const {
+
+      return ring.isFull();
+    }
+  };
+
+  /**
+   * @brief   Single producer single consumer channel.
+   */
+  template <typename T, unsigned N>
+  using SpscChannel = Channel<T, N, ChannelMode::SPSC>;
+}
+
+#endif /* _CHCHANNEL_HPP_ */
+
+/** @} */
@@ -0,0 +1,161 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+/**
+ * @file    chcoro.cpp
+ * @brief   C++20 coroutines support code.
+ *
+ * @addtogroup cpp_coroutines
+ * @{
+ */
+
+#include "chcoro.hpp"
+
+#if defined(__cpp_impl_coroutine) || defined(__DOXYGEN__)
+
+namespace chibios_rt {
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Task                                                       *
+   *------------------------------------------------------------------------*/
+
+  MemoryPool *Task::frames_pool = nullptr;
+  size_t Task::frames_size = (size_t)0;
+  Task::FrameStats Task::frames_stats = {0U, 0U, 0U, 0U};
+
+  void *Task::promise_type::operator new(size_t size) noexcept {
+    void *p = nullptr;
+    bool from_pool;
+
+    chSysLock();
+    if (size > frames_stats.max_size) {
+      frames_stats.max_size = size;
+    }
+    from_pool = (frames_pool != nullptr) && (size <= frames_size);
+    if (from_pool) {
+      p = frames_pool->allocI();
+    }
+    chSysUnlock();
+
+#if CH_CFG_USE_HEAP == TRUE
+    if (!from_pool) {
+      p = chHeapAlloc(NULL, size);
+    }
+#endif
+
+    chSysLock();
+    if (p == nullptr) {
+      frames_stats.failed++;
+    }
+    else if (from_pool) {
+      frames_stats.pool++;
+    }
+    else {
+      frames_stats.heap++;
+    }
+    chSysUnlock();
+
+    return p;
+  }
+
+  void Task::promise_type::operator delete(void *p, size_t size) noexcept {
+
+    if ((frames_pool != nullptr) && (size <= frames_size)) {
+      frames_pool->free(p);
+    }
+#if CH_CFG_USE_HEAP == TRUE
+    else {
+      chHeapFree(p);
+    }
+#endif
+  }
+
+  void Task::setFramesPool(MemoryPool *mp, size_t size) {
+
+    chSysLock();
+    frames_pool = mp;
+    frames_size = mp != nullptr ? size : (size_t)0;
+    chSysUnlock();
+  }
+
+  void Task::getFrameStats(FrameStats *fsp) {
+
+    chSysLock();
+    *fsp = frames_stats;
+    chSysUnlock();
+  }
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Executor                                                   *
+   *------------------------------------------------------------------------*/
+
+  void Executor::dispatchEvents(eventmask_t events) {
+
+    events |= ev_pending;
+
+    chSysLock();
+    ev_waiters.removeIf([&events](EventsAwaiter *wp) {
+                          return (wp->mask & events) != (eventmask_t)0;
+                        },
+                        [&events](EventsAwaiter *wp) {
+                          wp->events = wp->mask & events;
+                          events &= ~wp->events;
+                          wp->readyI();
+                        });
+    chSysUnlock();
+
+    ev_pending = events;
+  }
+
+  void Executor::run(void) {
+
+    chSysLock();
+    thread = chThdGetSelfX();
+    while (!terminate_req) {
+      Task::promise_type *pp = ready_head;
+
+      if (pp != nullptr) {
+        ready_head = pp->next;
+        if (ready_head == nullptr) {
+          ready_tail = nullptr;
+        }
+        resumes++;
+        chSysUnlock();
+
+        Task::handle_t::from_promise(*pp).resume();
+      }
+      else {
+        eventmask_t events;
+
+        chSysUnlock();
+
+        /* Coroutines wake-ups are only used to exit the wait, the other
+           events are for the coroutines awaiting them.*/
+        events = chEvtWaitAny(ALL_EVENTS) & ~CH_CORO_READY_EVENT;
+        if (events != (eventmask_t)0) {
+          dispatchEvents(events);
+        }
+      }
+      chSysLock();
+    }
+    terminate_req = false;
+    thread = nullptr;
+    chSysUnlock();
+  }
+}
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+/** @} */
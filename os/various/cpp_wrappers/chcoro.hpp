@@ -0,0 +1,1128 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chcoro.hpp
+ * @brief   C++20 coroutines support classes.
+ * @details Coroutines returning @p Task are run by an @p Executor, many
+ *          coroutines share the stack of the thread running the executor.
+ *          Suspended coroutines only use their frame, frames can be
+ *          allocated from a @p MemoryPool.
+ *          Coroutines are made ready again by awaitable objects, the
+ *          wake-up side is I-class and can be used from threads, ISRs,
+ *          virtual timer and HAL callbacks.
+ * @note    Requires a C++20 compiler, the content of this file is ignored
+ *          if coroutines are not supported.
+ *
+ * @addtogroup cpp_coroutines
+ * @{
+ */
+
+#include "ch.hpp"
+
+#ifndef _CHCORO_HPP_
+#define _CHCORO_HPP_
+
+#if defined(__cpp_impl_coroutine) || defined(__DOXYGEN__)
+
+#include <coroutine>
+
+#if CH_CFG_USE_EVENTS == FALSE
+#error "coroutines require CH_CFG_USE_EVENTS"
+#endif
+
+/**
+ * @brief   Event flag reserved by executors for coroutines wake-ups.
+ * @note    The executor thread cannot use this flag for other purposes.
+ */
+#if !defined(CH_CORO_READY_EVENT) || defined(__DOXYGEN__)
+#define CH_CORO_READY_EVENT                 EVENT_MASK(31)
+#endif
+
+namespace chibios_rt {
+
+  /* Forward declaration of some classes.*/
+  class Executor;
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Task                                                       *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Return type of coroutines run by an @p Executor.
+   * @details A task is a reference to a coroutine not yet started, the
+   *          coroutine runs when the task is spawned on an executor and
+   *          its frame is released when the coroutine returns.
+   */
+  class Task {
+  public:
+    /**
+     * @brief   Frames allocation statistics.
+     */
+    struct FrameStats {
+      /**
+       * @brief   Frames allocated from the frames pool.
+       */
+      size_t                pool;
+      /**
+       * @brief   Frames allocated from the heap.
+       */
+      size_t                heap;
+      /**
+       * @brief   Failed allocations.
+       */
+      size_t                failed;
+      /**
+       * @brief   Size of the largest requested frame.
+       */
+      size_t                max_size;
+    };
+
+    /**
+     * @brief   Coroutine promise.
+     */
+    struct promise_type {
+      /**
+       * @brief   Executor running the coroutine.
+       */
+      Executor              *executor = nullptr;
+      /**
+       * @brief   Next coroutine in the executor ready list.
+       */
+      promise_type          *next = nullptr;
+
+      Task get_return_object(void) noexcept {
+
+        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+
+      static Task get_return_object_on_allocation_failure(void) noexcept {
+
+        return Task();
+      }
+
+      std::suspend_always initial_suspend(void) noexcept {
+
+        return {};
+      }
+
+      std::suspend_never final_suspend(void) noexcept;
+
+      void return_void(void) noexcept {
+
+      }
+
+      void unhandled_exception(void) noexcept {
+
+        chSysHalt("coroutine exception");
+      }
+
+      static void *operator new(size_t size) noexcept;
+      static void operator delete(void *p, size_t size) noexcept;
+    };
+
+    /**
+     * @brief   Type of a coroutine handle.
+     */
+    typedef std::coroutine_handle<promise_type> handle_t;
+
+  private:
+    friend class Executor;
+
+    /**
+     * @brief   Handle of the coroutine not yet spawned.
+     */
+    handle_t                handle;
+
+    static MemoryPool       *frames_pool;
+    static size_t           frames_size;
+    static FrameStats       frames_stats;
+
+    explicit Task(handle_t h) : handle(h) {
+
+    }
+
+  public:
+    /**
+     * @brief   Task constructor.
+     * @details An invalid task, coroutines return it when the frame
+     *          allocation fails.
+     */
+    Task(void) : handle(nullptr) {
+
+    }
+
+    /* Prohibit copy construction and assignment, but allow move.*/
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    Task(Task &&other) noexcept : handle(other.handle) {
+
+      other.handle = nullptr;
+    }
+
+    /**
+     * @brief   Task destructor.
+     * @details Coroutines never spawned are destroyed.
+     */
+    ~Task() {
+
+      if (handle) {
+        handle.destroy();
+      }
+    }
+
+    /**
+     * @brief   Returns @p true if the coroutine has been created.
+     *
+     * @xclass
+     */
+    bool isValidX(void) const {
+
+      return (bool)handle;
+    }
+
+    /**
+     * @brief   Sets the memory pool used for coroutine frames.
+     * @details Frames up to @p size bytes are taken from the pool, larger
+     *          frames are taken from the default heap, if enabled. If the
+     *          pool is exhausted the coroutine call returns an invalid task.
+     * @note    Frames are allocated when coroutines are called, the pool
+     *          must be set before calling any coroutine and not changed
+     *          while frames are allocated.
+     *
+     * @param[in] mp        the memory pool or @p nullptr
+     * @param[in] size      size of the pool objects
+     *
+     * @api
+     */
+    static void setFramesPool(MemoryPool *mp, size_t size);
+
+    /**
+     * @brief   Returns the frames allocation statistics.
+     *
+     * @param[out] fsp      pointer to a @p FrameStats structure
+     *
+     * @api
+     */
+    static void getFrameStats(FrameStats *fsp);
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineWaiter                                            *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Base class of awaiters queued on synchronization objects.
+   */
+  class CoroutineWaiter {
+    template <typename W> friend class CoroutinesQueue;
+
+    /**
+     * @brief   Next waiter in the queue.
+     */
+    CoroutineWaiter         *next = nullptr;
+
+  protected:
+    /**
+     * @brief   Promise of the waiting coroutine.
+     */
+    Task::promise_type      *waiter = nullptr;
+
+  public:
+    /**
+     * @brief   Makes the waiting coroutine ready.
+     *
+     * @iclass
+     */
+    inline void readyI(void);
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutinesQueue                                            *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   FIFO queue of awaiters.
+   *
+   * @param W               type of the awaiters
+   */
+  template <typename W>
+  class CoroutinesQueue {
+    CoroutineWaiter         *head = nullptr;
+    CoroutineWaiter         *tail = nullptr;
+
+  public:
+    /**
+     * @brief   Returns @p true if there are no waiters.
+     */
+    bool isEmpty(void) const {
+
+      return head == nullptr;
+    }
+
+    /**
+     * @brief   Inserts a waiter at the end of the queue.
+     */
+    void insert(W *wp) {
+
+      wp->next = nullptr;
+      if (tail == nullptr) {
+        head = wp;
+      }
+      else {
+        tail->next = wp;
+      }
+      tail = wp;
+    }
+
+    /**
+     * @brief   Removes the first waiter of the queue.
+     *
+     * @return              The waiter or @p nullptr if the queue is empty.
+     */
+    W *remove(void) {
+      CoroutineWaiter *wp = head;
+
+      if (wp != nullptr) {
+        head = wp->next;
+        if (head == nullptr) {
+          tail = nullptr;
+        }
+      }
+
+      return static_cast<W *>(wp);
+    }
+
+    /**
+     * @brief   Removes the waiters matching a predicate.
+     *
+     * @param[in] match     predicate, called with each waiter
+     * @param[in] action    function called with each removed waiter
+     */
+    template <typename P, typename A>
+    void removeIf(P match, A action) {
+      CoroutineWaiter **wpp = &head;
+      CoroutineWaiter *prev = nullptr;
+
+      while (*wpp != nullptr) {
+        W *wp = static_cast<W *>(*wpp);
+        if (match(wp)) {
+          *wpp = wp->next;
+          if (tail == wp) {
+            tail = prev;
+          }
+          action(wp);
+        }
+        else {
+          prev = wp;
+          wpp = &wp->next;
+        }
+      }
+    }
+  };
+
+  class EventsAwaiter;
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Executor                                                   *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutines executor.
+   * @details Ready coroutines are resumed in FIFO order by the thread
+   *          invoking @p run(), when there are no ready coroutines the
+   *          thread waits for events.
+   */
+  class Executor {
+    friend class EventsAwaiter;
+    friend struct Task::promise_type;
+
+    /**
+     * @brief   Thread running the executor.
+     */
+    thread_t                *thread = nullptr;
+    /**
+     * @brief   First ready coroutine.
+     */
+    Task::promise_type      *ready_head = nullptr;
+    /**
+     * @brief   Last ready coroutine.
+     */
+    Task::promise_type      *ready_tail = nullptr;
+    /**
+     * @brief   Coroutines waiting for events.
+     */
+    CoroutinesQueue<EventsAwaiter> ev_waiters;
+    /**
+     * @brief   Events received and not yet consumed by coroutines.
+     */
+    eventmask_t             ev_pending = (eventmask_t)0;
+    /**
+     * @brief   Number of spawned coroutines not yet returned.
+     */
+    ucnt_t                  tasks = (ucnt_t)0;
+    /**
+     * @brief   Number of coroutines resumptions.
+     */
+    ucnt_t                  resumes = (ucnt_t)0;
+    /**
+     * @brief   Termination request.
+     */
+    bool                    terminate_req = false;
+
+    void dispatchEvents(eventmask_t events);
+
+  public:
+    /**
+     * @brief   Executor constructor.
+     *
+     * @init
+     */
+    Executor(void) {
+
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    /**
+     * @brief   Makes a coroutine ready.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel. Note
+     *          that interrupt handlers always reschedule on exit so an
+     *          explicit reschedule must not be performed in ISRs.
+     *
+     * @param[in] pp        promise of the coroutine
+     *
+     * @iclass
+     */
+    void readyI(Task::promise_type *pp) {
+
+      chDbgCheckClassI();
+
+      pp->next = nullptr;
+      if (ready_tail == nullptr) {
+        ready_head = pp;
+        if (thread != nullptr) {
+          chEvtSignalI(thread, CH_CORO_READY_EVENT);
+        }
+      }
+      else {
+        ready_tail->next = pp;
+      }
+      ready_tail = pp;
+    }
+
+    /**
+     * @brief   Spawns a task on this executor.
+     * @details The coroutine is started by the executor thread.
+     *
+     * @param[in] task      the task to be spawned, it is invalidated
+     * @return              The operation status.
+     * @retval false        if the task is not valid.
+     *
+     * @api
+     */
+    bool spawn(Task &&task) {
+
+      if (!task.handle) {
+        return false;
+      }
+
+      Task::promise_type *pp = &task.handle.promise();
+      task.handle = nullptr;
+      pp->executor = this;
+
+      chSysLock();
+      tasks++;
+      readyI(pp);
+      chSchRescheduleS();
+      chSysUnlock();
+
+      return true;
+    }
+
+    /**
+     * @brief   Runs the executor.
+     * @details Ready coroutines are resumed by the calling thread until
+     *          @p terminate() is invoked.
+     *
+     * @api
+     */
+    void run(void);
+
+    /**
+     * @brief   Requests the executor termination.
+     * @note    Suspended coroutines are not destroyed.
+     *
+     * @api
+     */
+    void terminate(void) {
+
+      chSysLock();
+      terminate_req = true;
+      if (thread != nullptr) {
+        chEvtSignalI(thread, CH_CORO_READY_EVENT);
+      }
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the number of coroutines not yet returned.
+     *
+     * @xclass
+     */
+    ucnt_t getTasksX(void) const {
+
+      return tasks;
+    }
+
+    /**
+     * @brief   Returns the number of coroutines resumptions.
+     *
+     * @xclass
+     */
+    ucnt_t getResumesX(void) const {
+
+      return resumes;
+    }
+  };
+
+  inline std::suspend_never Task::promise_type::final_suspend(void) noexcept {
+
+    chSysLock();
+    executor->tasks--;
+    chSysUnlock();
+
+    return {};
+  }
+
+  inline void CoroutineWaiter::readyI(void) {
+
+    waiter->executor->readyI(waiter);
+  }
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ExecutorThread                                             *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Static thread running an executor.
+   *
+   * @param N               the working area size for the thread class
+   */
+  template <int N>
+  class ExecutorThread : public BaseStaticThread<N>, public Executor {
+  protected:
+    void main(void) override {
+
+      run();
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * Awaitables                                                             *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Awaiter yielding to the other ready coroutines.
+   */
+  class YieldAwaiter {
+  public:
+    bool await_ready(void) noexcept {
+
+      return false;
+    }
+
+    void await_suspend(Task::handle_t h) noexcept {
+
+      chSysLock();
+      h.promise().executor->readyI(&h.promise());
+      chSysUnlock();
+    }
+
+    void await_resume(void) noexcept {
+
+    }
+  };
+
+  /**
+   * @brief   Awaiter sleeping for a time interval.
+   * @details The virtual timer is part of the coroutine frame.
+   */
+  class SleepAwaiter {
+    sysinterval_t           interval;
+    virtual_timer_t         vt;
+
+    static void wakeup(virtual_timer_t *vtp, void *p) {
+      Task::promise_type *pp = (Task::promise_type *)p;
+
+      (void)vtp;
+
+      chSysLockFromISR();
+      pp->executor->readyI(pp);
+      chSysUnlockFromISR();
+    }
+
+  public:
+    SleepAwaiter(sysinterval_t timeout) : interval(timeout) {
+
+      chVTObjectInit(&vt);
+    }
+
+    bool await_ready(void) noexcept {
+
+      return interval == TIME_IMMEDIATE;
+    }
+
+    void await_suspend(Task::handle_t h) noexcept {
+
+      chVTSet(&vt, interval, wakeup, (void *)&h.promise());
+    }
+
+    void await_resume(void) noexcept {
+
+    }
+  };
+
+  /**
+   * @brief   Awaiter waiting for executor events.
+   * @details Events are delivered to the executor thread, the coroutine
+   *          resumes when any of the awaited events is pending. Events
+   *          received while no coroutine awaits them remain pending.
+   */
+  class EventsAwaiter : public CoroutineWaiter {
+    friend class Executor;
+
+    eventmask_t             mask;
+    eventmask_t             events = (eventmask_t)0;
+
+  public:
+    EventsAwaiter(eventmask_t emask) : mask(emask) {
+
+    }
+
+    bool await_ready(void) noexcept {
+
+      return false;
+    }
+
+    bool await_suspend(Task::handle_t h) noexcept {
+      Executor *ep = h.promise().executor;
+
+      /* Executor data, only accessed by the executor thread.*/
+      events = ep->ev_pending & mask;
+      if (events != (eventmask_t)0) {
+        ep->ev_pending &= ~events;
+        return false;
+      }
+      waiter = &h.promise();
+      ep->ev_waiters.insert(this);
+
+      return true;
+    }
+
+    eventmask_t await_resume(void) noexcept {
+
+      return events;
+    }
+  };
+
+  /**
+   * @brief   Awaiter waiting for an event listener.
+   * @pre     The listener must have been registered by a coroutine of the
+   *          same executor, the registering thread is the listener.
+   */
+  class ListenerAwaiter : public EventsAwaiter {
+    EventListener           &listener;
+
+  public:
+    ListenerAwaiter(EventListener &el) :
+      EventsAwaiter(el.ev_listener.events), listener(el) {
+
+    }
+
+    eventflags_t await_resume(void) noexcept {
+
+      return listener.getAndClearFlags();
+    }
+  };
+
+  /**
+   * @brief   Yields to the other ready coroutines.
+   *
+   * @return                The awaiter.
+   */
+  static inline YieldAwaiter asyncYield(void) {
+
+    return YieldAwaiter();
+  }
+
+  /**
+   * @brief   Suspends the coroutine for a time interval.
+   *
+   * @param[in] interval    the time interval
+   * @return                The awaiter.
+   */
+  static inline SleepAwaiter asyncSleep(sysinterval_t interval) {
+
+    return SleepAwaiter(interval);
+  }
+
+  /**
+   * @brief   Waits for any of the specified events.
+   * @note    The awaiter returns the received events.
+   *
+   * @param[in] events      mask of the awaited events
+   * @return                The awaiter.
+   */
+  static inline EventsAwaiter asyncWaitAnyEvent(eventmask_t events) {
+
+    return EventsAwaiter(events);
+  }
+
+  /**
+   * @brief   Waits for the events of an event listener.
+   * @note    The awaiter returns the flags of the listener.
+   *
+   * @param[in] el          the event listener
+   * @return                The awaiter.
+   */
+  static inline ListenerAwaiter asyncWaitListener(EventListener &el) {
+
+    return ListenerAwaiter(el);
+  }
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Completion                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   One-shot completion awaited by a coroutine.
+   * @details It is meant to be signaled from HAL completion callbacks,
+   *          a completion signaled before being awaited is not lost.
+   */
+  class Completion {
+    Task::promise_type      *waiter = nullptr;
+    bool                    done = false;
+    msg_t                   msg = MSG_OK;
+
+  public:
+    /**
+     * @brief   Completion awaiter.
+     */
+    class Awaiter {
+      Completion            &completion;
+
+    public:
+      Awaiter(Completion &c) : completion(c) {
+
+      }
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(Task::handle_t h) noexcept {
+
+        chSysLock();
+        if (completion.done) {
+          completion.done = false;
+          chSysUnlock();
+          return false;
+        }
+        completion.waiter = &h.promise();
+        chSysUnlock();
+
+        return true;
+      }
+
+      msg_t await_resume(void) noexcept {
+
+        return completion.msg;
+      }
+    };
+
+    /**
+     * @brief   Signals the completion.
+     *
+     * @param[in] m         message returned to the waiting coroutine
+     *
+     * @iclass
+     */
+    void signalI(msg_t m) {
+      Task::promise_type *pp = waiter;
+
+      msg = m;
+      if (pp != nullptr) {
+        waiter = nullptr;
+        pp->executor->readyI(pp);
+      }
+      else {
+        done = true;
+      }
+    }
+
+    /**
+     * @brief   Signals the completion from an ISR or a HAL callback.
+     *
+     * @param[in] m         message returned to the waiting coroutine
+     *
+     * @isr
+     */
+    void signalFromISR(msg_t m) {
+
+      chSysLockFromISR();
+      signalI(m);
+      chSysUnlockFromISR();
+    }
+
+    /**
+     * @brief   Signals the completion.
+     *
+     * @param[in] m         message returned to the waiting coroutine
+     *
+     * @api
+     */
+    void signal(msg_t m) {
+
+      chSysLock();
+      signalI(m);
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Waits for the completion.
+     * @note    The awaiter returns the signaled message.
+     *
+     * @return              The awaiter.
+     */
+    Awaiter asyncWait(void) {
+
+      return Awaiter(*this);
+    }
+  };
+
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::AwaitableSemaphore                                         *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Counter semaphore that can be awaited by coroutines.
+   * @details Coroutines are woken by the @p signal() and @p signalI()
+   *          methods of this class before the waiting threads.
+   * @note    The semaphore is privately inherited so that it cannot be
+   *          signaled bypassing the waiting coroutines.
+   */
+  class AwaitableSemaphore : private CounterSemaphore {
+  public:
+    /**
+     * @brief   Semaphore awaiter.
+     */
+    class Awaiter : public CoroutineWaiter {
+      AwaitableSemaphore    &sem;
+
+    public:
+      Awaiter(AwaitableSemaphore &s) : sem(s) {
+
+      }
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(Task::handle_t h) noexcept {
+
+        chSysLock();
+        if (sem.getCounterI() > (cnt_t)0) {
+          sem.fastWaitI();
+          chSysUnlock();
+          return false;
+        }
+        waiter = &h.promise();
+        sem.waiters.insert(this);
+        chSysUnlock();
+
+        return true;
+      }
+
+      void await_resume(void) noexcept {
+
+      }
+    };
+
+  private:
+    CoroutinesQueue<Awaiter> waiters;
+
+  public:
+    using CounterSemaphore::wait;
+    using CounterSemaphore::waitS;
+    using CounterSemaphore::getCounterI;
+
+    /**
+     * @brief   AwaitableSemaphore constructor.
+     *
+     * @param[in] n             the semaphore counter value, must be greater
+     *                          or equal to zero
+     *
+     * @init
+     */
+    AwaitableSemaphore(cnt_t n) : CounterSemaphore(n) {
+
+    }
+
+    /**
+     * @brief   Waits on the semaphore from a coroutine.
+     *
+     * @return                  The awaiter.
+     */
+    Awaiter asyncWait(void) {
+
+      return Awaiter(*this);
+    }
+
+    /**
+     * @brief   Performs a signal operation on the semaphore.
+     *
+     * @iclass
+     */
+    void signalI(void) {
+      Awaiter *wp = waiters.remove();
+
+      if (wp != nullptr) {
+        wp->readyI();
+      }
+      else {
+        CounterSemaphore::signalI();
+      }
+    }
+
+    /**
+     * @brief   Performs a signal operation on the semaphore.
+     *
+     * @api
+     */
+    void signal(void) {
+
+      chSysLock();
+      signalI();
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+  };
+#endif /* CH_CFG_USE_SEMAPHORES == TRUE */
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::AwaitableMailbox                                           *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Mailbox that can be fetched by coroutines.
+   * @details Messages posted using the methods of this class are handed
+   *          directly to waiting coroutines, if any.
+   *
+   * @param T               type of objects that mailbox able to handle
+   * @param N               length of the mailbox buffer
+   */
+  template <typename T, int N>
+  class AwaitableMailbox : public Mailbox<T, N> {
+  public:
+    /**
+     * @brief   Mailbox awaiter.
+     */
+    class Awaiter : public CoroutineWaiter {
+      friend class AwaitableMailbox;
+
+      AwaitableMailbox      &mbx;
+      T                     msg;
+
+    public:
+      Awaiter(AwaitableMailbox &m) : mbx(m) {
+
+      }
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(Task::handle_t h) noexcept {
+
+        chSysLock();
+        if (mbx.fetchI(&msg) == MSG_OK) {
+          chSysUnlock();
+          return false;
+        }
+        waiter = &h.promise();
+        mbx.waiters.insert(this);
+        chSysUnlock();
+
+        return true;
+      }
+
+      T await_resume(void) noexcept {
+
+        return msg;
+      }
+    };
+
+  private:
+    CoroutinesQueue<Awaiter> waiters;
+
+  public:
+    /**
+     * @brief   Fetches a message from a coroutine.
+     * @note    The awaiter returns the message.
+     *
+     * @return              The awaiter.
+     */
+    Awaiter asyncFetch(void) {
+
+      return Awaiter(*this);
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @return              The operation status.
+     * @retval MSG_OK       if a message has been correctly posted.
+     * @retval MSG_TIMEOUT  if the mailbox is full.
+     *
+     * @iclass
+     */
+    msg_t postI(T msg) {
+      Awaiter *wp = waiters.remove();
+
+      if (wp != nullptr) {
+        wp->msg = msg;
+        wp->readyI();
+        return MSG_OK;
+      }
+
+      return Mailbox<T, N>::postI(msg);
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @sclass
+     */
+    msg_t postS(T msg, sysinterval_t timeout) {
+      Awaiter *wp = waiters.remove();
+
+      if (wp != nullptr) {
+        wp->msg = msg;
+        wp->readyI();
+        chSchRescheduleS();
+        return MSG_OK;
+      }
+
+      return Mailbox<T, N>::postS(msg, timeout);
+    }
+
+    /**
+     * @brief   Posts an high priority message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @return              The operation status.
+     * @retval MSG_OK       if a message has been correctly posted.
+     * @retval MSG_TIMEOUT  if the mailbox is full.
+     *
+     * @iclass
+     */
+    msg_t postAheadI(T msg) {
+      Awaiter *wp = waiters.remove();
+
+      if (wp != nullptr) {
+        wp->msg = msg;
+        wp->readyI();
+        return MSG_OK;
+      }
+
+      return Mailbox<T, N>::postAheadI(msg);
+    }
+
+    /**
+     * @brief   Posts an high priority message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @sclass
+     */
+    msg_t postAheadS(T msg, sysinterval_t timeout) {
+      Awaiter *wp = waiters.remove();
+
+      if (wp != nullptr) {
+        wp->msg = msg;
+        wp->readyI();
+        chSchRescheduleS();
+        return MSG_OK;
+      }
+
+      return Mailbox<T, N>::postAheadS(msg, timeout);
+    }
+
+    /**
+     * @brief   Posts an high priority message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @api
+     */
+    msg_t postAhead(T msg, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      chSysLock();
+      rdymsg = postAheadS(msg, timeout);
+      chSysUnlock();
+
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     *
+     * @api
+     */
+    msg_t post(T msg, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      chSysLock();
+      rdymsg = postS(msg, timeout);
+      chSysUnlock();
+
+      return rdymsg;
+    }
+  };
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+}
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+#endif /* _CHCORO_HPP_ */
+
+/** @} */
@@ -1,7 +1,8 @@
 # C++ wrapper files.
 CHCPPSRC   = $(CHIBIOS)/os/various/syscalls.c
 
-CHCPPSRCPP = $(CHIBIOS)/os/various/cpp_wrappers/ch.cpp
+CHCPPSRCPP = $(CHIBIOS)/os/various/cpp_wrappers/ch.cpp \
+             $(CHIBIOS)/os/various/cpp_wrappers/chcoro.cpp
 
 CHCPPINC   = $(CHIBIOS)/os/various/cpp_wrappers
 
@@ -0,0 +1,347 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chmemres.hpp
+ * @brief   C++17 polymorphic memory resources.
+ * @details Adapters allowing the heap and memory pools to be used as
+ *          allocators by the standard containers of the @p std::pmr
+ *          namespace, plus a monotonic arena.
+ * @note    Allocation failures throw @p std::bad_alloc if exceptions are
+ *          enabled, else the system is halted. Resources can be chained
+ *          to an upstream resource in order to handle exhaustion.
+ *
+ * @addtogroup cpp_memory_resources
+ * @{
+ */
+
+#include "ch.hpp"
+
+#ifndef _CHMEMRES_HPP_
+#define _CHMEMRES_HPP_
+
+#if (__cplusplus >= 201703L) || defined(__DOXYGEN__)
+
+#include <memory_resource>
+#if defined(__cpp_exceptions)
+#include <new>
+#endif
+
+namespace chibios_rt {
+
+  /**
+   * @brief   Handles the result of an allocation.
+   *
+   * @param[in] p           the allocated block or @p nullptr
+   * @return                The allocated block.
+   */
+  static inline void *checkResourceAllocation(void *p) {
+
+    if (p == nullptr) {
+#if defined(__cpp_exceptions)
+      throw std::bad_alloc();
+#else
+      chSysHalt("memory resource exhausted");
+#endif
+    }
+
+    return p;
+  }
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::HeapResource                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Memory resource allocating from a heap.
+   */
+  class HeapResource : public std::pmr::memory_resource {
+    /**
+     * @brief   The heap or @p nullptr for the default heap.
+     */
+    Heap                    *heap;
+
+  public:
+    /**
+     * @brief   HeapResource constructor.
+     * @details Blocks are allocated from the default heap.
+     *
+     * @init
+     */
+    HeapResource(void) : heap(nullptr) {
+
+    }
+
+    /**
+     * @brief   HeapResource constructor.
+     *
+     * @param[in] h         the heap
+     *
+     * @init
+     */
+    HeapResource(Heap &h) : heap(&h) {
+
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+      void *p;
+
+      if (bytes == (size_t)0) {
+        bytes = (size_t)1;
+      }
+      if (heap != nullptr) {
+        p = heap->allocAligned(bytes, (unsigned)alignment);
+      }
+      else {
+        p = chHeapAllocAligned(NULL, bytes, (unsigned)alignment);
+      }
+
+      return checkResourceAllocation(p);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+
+      (void)bytes;
+      (void)alignment;
+
+      chHeapFree(p);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+  };
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PoolResource                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Memory resource allocating from a memory pool.
+   * @details Blocks fitting the pool objects size and alignment are taken
+   *          from the pool, the other requests are forwarded to the
+   *          upstream resource, if any.
+   * @note    Node-based containers are the natural users of this resource,
+   *          an @p ObjectsPool can be used as well.
+   */
+  class PoolResource : public std::pmr::memory_resource {
+    /**
+     * @brief   The memory pool.
+     */
+    MemoryPool              &pool;
+    /**
+     * @brief   Upstream resource or @p nullptr.
+     */
+    std::pmr::memory_resource *upstream;
+
+    bool fits(size_t bytes, size_t alignment) const {
+
+      return (bytes <= pool.getObjectSizeX()) &&
+             (alignment <= (size_t)pool.getAlignX());
+    }
+
+  public:
+    /**
+     * @brief   PoolResource constructor.
+     *
+     * @param[in] mp        the memory pool
+     * @param[in] up        upstream resource for requests not fitting the
+     *                      pool objects or @p nullptr
+     *
+     * @init
+     */
+    PoolResource(MemoryPool &mp, std::pmr::memory_resource *up = nullptr) :
+      pool(mp), upstream(up) {
+
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+
+      if (fits(bytes, alignment)) {
+        return checkResourceAllocation(pool.alloc());
+      }
+      if (upstream != nullptr) {
+        return upstream->allocate(bytes, alignment);
+      }
+
+      return checkResourceAllocation(nullptr);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+
+      if (fits(bytes, alignment)) {
+        pool.free(p);
+      }
+      else {
+        upstream->deallocate(p, bytes, alignment);
+      }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+  };
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ArenaResource                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Monotonic memory resource over a memory area.
+   * @details Allocations advance a pointer inside the area, deallocations
+   *          do nothing, the whole area is reclaimed using @p release().
+   *          Allocations are performed in a critical zone and are fast and
+   *          deterministic.
+   */
+  class ArenaResource : public std::pmr::memory_resource {
+    /**
+     * @brief   Arena base.
+     */
+    uint8_t                 *base;
+    /**
+     * @brief   Arena size.
+     */
+    size_t                  size;
+    /**
+     * @brief   Used space.
+     */
+    size_t                  used;
+    /**
+     * @brief   Maximum used space.
+     */
+    size_t                  peak;
+
+  public:
+    /**
+     * @brief   ArenaResource constructor.
+     *
+     * @param[in] buffer    arena base
+     * @param[in] n         arena size
+     *
+     * @init
+     */
+    ArenaResource(void *buffer, size_t n) :
+      base((uint8_t *)buffer), size(n), used((size_t)0), peak((size_t)0) {
+
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    ArenaResource(const ArenaResource &) = delete;
+    ArenaResource &operator=(const ArenaResource &) = delete;
+
+    /**
+     * @brief   Releases all the allocated blocks.
+     * @note    The objects allocated from the arena must not be used
+     *          anymore, their destructors are not invoked.
+     *
+     * @api
+     */
+    void release(void) {
+
+      chSysLock();
+      used = (size_t)0;
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the used space.
+     *
+     * @xclass
+     */
+    size_t getUsedX(void) const {
+
+      return used;
+    }
+
+    /**
+     * @brief   Returns the maximum used space since initialization.
+     *
+     * @xclass
+     */
+    size_t getPeakX(void) const {
+
+      return peak;
+    }
+
+  protected:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+      uint8_t *p;
+
+      chSysLock();
+      p = (uint8_t *)MEM_ALIGN_NEXT(base + used, alignment);
+      if ((size_t)(p - base) + bytes > size) {
+        chSysUnlock();
+        return checkResourceAllocation(nullptr);
+      }
+      used = (size_t)(p - base) + bytes;
+      if (used > peak) {
+        peak = used;
+      }
+      chSysUnlock();
+
+      return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+
+      (void)p;
+      (void)bytes;
+      (void)alignment;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+
+      return this == &other;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticArenaResource                                        *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Monotonic memory resource and its memory area.
+   *
+   * @param N               size of the arena
+   */
+  template <size_t N>
+  class StaticArenaResource : public ArenaResource {
+    alignas(PORT_NATURAL_ALIGN) uint8_t arena_buf[N];
+
+  public:
+    /**
+     * @brief   StaticArenaResource constructor.
+     *
+     * @init
+     */
+    StaticArenaResource(void) : ArenaResource(arena_buf, N) {
+
+    }
+  };
+}
+
+#endif /* __cplusplus >= 201703L */
+
+#endif /* _CHMEMRES_HPP_ */
+
+/** @} */
@@ -34,6 +34,31 @@ extern SDCDriver FATFS_HAL_DEVICE;
 extern RTCDriver RTCD1;
 #endif
 
+/* When enabled, sectors go through a write-back block cache wrapping the
+   HAL device. The cache is connected by disk_initialize(), dirty sectors
+   are written by CTRL_SYNC, bcacheDisconnect() must be used in place of
+   the HAL device disconnect.*/
+#if !defined(FATFS_USE_BLOCK_CACHE)
+#define FATFS_USE_BLOCK_CACHE FALSE
+#endif
+
+#if FATFS_USE_BLOCK_CACHE
+#include "block_cache.h"
+
+BlockCache fatfs_block_cache;
+static bool fatfs_block_cache_init = false;
+
+static bool fatfs_block_cache_connect(void) {
+
+  if (!fatfs_block_cache_init) {
+    bcacheObjectInit(&fatfs_block_cache,
+                     (BaseBlockDevice *)&FATFS_HAL_DEVICE);
+    fatfs_block_cache_init = true;
+  }
+  return bcacheConnect(&fatfs_block_cache);
+}
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Correspondence between physical drive number and physical drive.      */
 
@@ -58,6 +83,10 @@ DSTATUS disk_initialize (
     /* It is initialized externally, just reads the status.*/
     if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
       stat |= STA_NOINIT;
+#if FATFS_USE_BLOCK_CACHE
+    else if (fatfs_block_cache_connect())
+      stat |= STA_NOINIT;
+#endif
     if (mmcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |=  STA_PROTECT;
     return stat;
@@ -67,6 +96,10 @@ DSTATUS disk_initialize (
     /* It is initialized externally, just reads the status.*/
     if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
       stat |= STA_NOINIT;
+#if FATFS_USE_BLOCK_CACHE
+    else if (fatfs_block_cache_connect())
+      stat |= STA_NOINIT;
+#endif
     if (sdcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |=  STA_PROTECT;
     return stat;
@@ -122,6 +155,15 @@ DRESULT disk_read (
     UINT count        /* Number of sectors to read (1..255) */
 )
 {
+#if FATFS_USE_BLOCK_CACHE
+  if (pdrv == 0) {
+    if (blkGetDriverState(&fatfs_block_cache) != BLK_READY)
+      return RES_NOTRDY;
+    if (bcacheRead(&fatfs_block_cache, sector, buff, count))
+      return RES_ERROR;
+    return RES_OK;
+  }
+#endif
   switch (pdrv) {
 #if HAL_USE_MMC_SPI
   case MMC:
@@ -163,6 +205,17 @@ DRESULT disk_write (
     UINT count        /* Number of sectors to write (1..255) */
 )
 {
+#if FATFS_USE_BLOCK_CACHE
+  if (pdrv == 0) {
+    if (blkGetDriverState(&fatfs_block_cache) != BLK_READY)
+      return RES_NOTRDY;
+    if (blkIsWriteProtected(&fatfs_block_cache))
+      return RES_WRPRT;
+    if (bcacheWrite(&fatfs_block_cache, sector, buff, count))
+      return RES_ERROR;
+    return RES_OK;
+  }
+#endif
   switch (pdrv) {
 #if HAL_USE_MMC_SPI
   case MMC:
@@ -212,6 +265,10 @@ DRESULT disk_ioctl (
   case MMC:
     switch (cmd) {
     case CTRL_SYNC:
+#if FATFS_USE_BLOCK_CACHE
+        if (bcacheSync(&fatfs_block_cache))
+            return RES_ERROR;
+#endif
         return RES_OK;
 #if FF_MAX_SS > FF_MIN_SS
     case GET_SECTOR_SIZE:
@@ -230,6 +287,10 @@ DRESULT disk_ioctl (
   case SDC:
     switch (cmd) {
     case CTRL_SYNC:
+#if FATFS_USE_BLOCK_CACHE
+        if (bcacheSync(&fatfs_block_cache))
+            return RES_ERROR;
+#endif
         return RES_OK;
     case GET_SECTOR_COUNT:
         *((DWORD *)buff) = mmcsdGetCardCapacity(&FATFS_HAL_DEVICE);
@@ -79,6 +79,22 @@
 #include <lwip/autoip.h>
 #endif
 
+#if LWIP_USE_MAC_ZERO_COPY == TRUE
+#include <lwip/memp.h>
+
+#if MAC_USE_ZERO_COPY != TRUE
+#error "LWIP_USE_MAC_ZERO_COPY requires MAC_USE_ZERO_COPY"
+#endif
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "LWIP_USE_MAC_ZERO_COPY requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+#if ETH_PAD_SIZE
+#error "LWIP_USE_MAC_ZERO_COPY is not compatible with ETH_PAD_SIZE"
+#endif
+#endif
+
 #define PERIODIC_TIMER_ID       1
 #define FRAME_RECEIVED_ID       2
 
@@ -92,6 +108,93 @@ thread_reference_t lwip_trp = NULL;
  */
 static THD_WORKING_AREA(wa_lwip_thread, LWIP_THREAD_STACK_SIZE);
 
+#if LWIP_USE_MAC_ZERO_COPY == TRUE
+/*
+ * Custom pbuf referencing a MAC receive buffer.
+ */
+typedef struct {
+  struct pbuf_custom    pc;
+  MACReceiveDescriptor  rd;
+} rx_pbuf_t;
+
+LWIP_MEMPOOL_DECLARE(RX_PBUF, LWIP_ZERO_COPY_RX_PBUFS, sizeof (rx_pbuf_t),
+                     "Zero-copy RX PBUF");
+
+/*
+ * Returns the buffer to the MAC when the stack frees the pbuf.
+ */
+static void rx_pbuf_free(struct pbuf *p) {
+  rx_pbuf_t *rxp = (rx_pbuf_t *)p;
+
+  macReleaseReceiveDescriptor(&rxp->rd);
+  LWIP_MEMPOOL_FREE(RX_PBUF, rxp);
+}
+
+/*
+ * Wraps a received frame into a custom pbuf without copying it, the
+ * descriptor is released when the pbuf is freed.
+ * Returns NULL if no wrappers are available or if the frame is not
+ * contained in a single buffer, the descriptor is left untouched.
+ */
+static struct pbuf *low_level_lend(MACReceiveDescriptor *rdp) {
+  rx_pbuf_t *rxp;
+  const uint8_t *buf;
+  size_t size;
+
+  rxp = (rx_pbuf_t *)LWIP_MEMPOOL_ALLOC(RX_PBUF);
+  if (rxp == NULL)
+    return NULL;
+
+  rxp->rd = *rdp;
+  buf = macGetNextReceiveBuffer(&rxp->rd, &size);
+  if ((buf == NULL) || (size < rdp->size)) {
+    LWIP_MEMPOOL_FREE(RX_PBUF, rxp);
+    return NULL;
+  }
+
+  rxp->pc.custom_free_function = rx_pbuf_free;
+  return pbuf_alloced_custom(PBUF_RAW, (u16_t)rdp->size, PBUF_REF, &rxp->pc,
+                             (void *)buf, (u16_t)rdp->size);
+}
+#endif /* LWIP_USE_MAC_ZERO_COPY == TRUE */
+
+/*
+ * Copies a received frame into a chain of pool pbufs, the descriptor is
+ * released.
+ * Returns NULL if the pool is exhausted, the frame is dropped.
+ */
+static struct pbuf *low_level_copy(MACReceiveDescriptor *rdp) {
+  struct pbuf *p, *q;
+  u16_t len;
+
+  len = (u16_t)rdp->size;
+
+#if ETH_PAD_SIZE
+  len += ETH_PAD_SIZE;        /* allow room for Ethernet padding */
+#endif
+
+  /* We allocate a pbuf chain of pbufs from the pool. */
+  p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+
+  if (p != NULL) {
+#if ETH_PAD_SIZE
+    pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
+#endif
+
+    /* Iterates through the pbuf chain. */
+    for(q = p; q != NULL; q = q->next)
+      macReadReceiveDescriptor(rdp, (uint8_t *)q->payload, (size_t)q->len);
+
+#if ETH_PAD_SIZE
+    pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
+#endif
+  }
+
+  macReleaseReceiveDescriptor(rdp);
+
+  return p;
+}
+
 /*
  * Initialization.
  */
@@ -172,8 +275,6 @@ static err_t low_level_output(struct netif *netif, struct pbuf *p) {
  */
 static bool low_level_input(struct netif *netif, struct pbuf **pbuf) {
   MACReceiveDescriptor rd;
-  struct pbuf *q;
-  u16_t len;
 
   (void)netif;
 
@@ -182,25 +283,19 @@ static bool low_level_input(struct netif *netif, struct pbuf **pbuf) {
   if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) != MSG_OK)
     return false;
 
-  len = (u16_t)rd.size;
-
-#if ETH_PAD_SIZE
-  len += ETH_PAD_SIZE;        /* allow room for Ethernet padding */
+#if LWIP_USE_MAC_ZERO_COPY == TRUE
+  *pbuf = low_level_lend(&rd);
+  if (*pbuf == NULL)
+    *pbuf = low_level_copy(&rd);
+#else
+  *pbuf = low_level_copy(&rd);
 #endif
 
-  /* We allocate a pbuf chain of pbufs from the pool. */
-  *pbuf = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
-
   if (*pbuf != NULL) {
 #if ETH_PAD_SIZE
     pbuf_header(*pbuf, -ETH_PAD_SIZE); /* drop the padding word */
 #endif
 
-    /* Iterates through the pbuf chain. */
-    for(q = *pbuf; q != NULL; q = q->next)
-      macReadReceiveDescriptor(&rd, (uint8_t *)q->payload, (size_t)q->len);
-    macReleaseReceiveDescriptor(&rd);
-
     MIB2_STATS_NETIF_ADD(netif, ifinoctets, (*pbuf)->tot_len);
 
     if (*(uint8_t *)((*pbuf)->payload) & 1) {
@@ -219,7 +314,6 @@ static bool low_level_input(struct netif *netif, struct pbuf **pbuf) {
     LINK_STATS_INC(link.recv);
   }
   else {
-    macReleaseReceiveDescriptor(&rd);     // Drop packet
     LINK_STATS_INC(link.memerr);
     LINK_STATS_INC(link.drop);
     MIB2_STATS_NETIF_INC(netif, ifindiscards);
@@ -250,6 +344,10 @@ static err_t ethernetif_init(struct netif *netif) {
    */
   MIB2_INIT_NETIF(netif, snmp_ifType_ethernet_csmacd, LWIP_LINK_SPEED);
 
+#if LWIP_USE_MAC_ZERO_COPY == TRUE
+  LWIP_MEMPOOL_INIT(RX_PBUF);
+#endif
+
   netif->state = NULL;
   netif->name[0] = LWIP_IFNAME0;
   netif->name[1] = LWIP_IFNAME1;
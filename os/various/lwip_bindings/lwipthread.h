@@ -96,6 +96,29 @@
 #define LWIP_SEND_TIMEOUT                   50
 #endif
 
+/**
+ * @brief   Zero-copy reception.
+ * @details If enabled the received frames are passed to the stack as
+ *          custom pbufs referencing the MAC receive buffers, buffers are
+ *          returned to the MAC when the pbufs are freed. Frames spanning
+ *          multiple buffers or received when all the wrappers are in use
+ *          are copied into pool pbufs as usual.
+ * @note    Requires @p MAC_USE_ZERO_COPY and @p LWIP_SUPPORT_CUSTOM_PBUF.
+ * @note    A buffer held by the stack stalls the MAC receive ring when
+ *          the DMA wraps around to it, the MAC should have more receive
+ *          buffers than @p LWIP_ZERO_COPY_RX_PBUFS.
+ */
+#if !defined(LWIP_USE_MAC_ZERO_COPY) || defined(__DOXYGEN__)
+#define LWIP_USE_MAC_ZERO_COPY              FALSE
+#endif
+
+/**
+ * @brief   Maximum number of MAC receive buffers lent to the stack.
+ */
+#if !defined(LWIP_ZERO_COPY_RX_PBUFS) || defined(__DOXYGEN__)
+#define LWIP_ZERO_COPY_RX_PBUFS             2
+#endif
+
 /**
  * @brief   Link speed.
  */
@@ -0,0 +1,397 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    periodic_tasks.c
+ * @brief   Periodic tasks code.
+ *
+ * @addtogroup periodic_tasks
+ * @{
+ */
+
+#include "ch.h"
+#include "periodic_tasks.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   List of the started tasks.
+ */
+static periodic_task_t *ptask_list = NULL;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the current time for measurements.
+ */
+static inline rtcnt_t ptask_now(void) {
+
+#if PORT_SUPPORTS_RT == TRUE
+  return chSysGetRealtimeCounterX();
+#else
+  return (rtcnt_t)chVTGetSystemTimeX();
+#endif
+}
+
+static void ptask_times_reset(ptask_times_t *ptp) {
+
+  ptp->best       = (rtcnt_t)-1;
+  ptp->worst      = (rtcnt_t)0;
+  ptp->last       = (rtcnt_t)0;
+  ptp->n          = (ucnt_t)0;
+  ptp->cumulative = (rttime_t)0;
+}
+
+static void ptask_times_update(ptask_times_t *ptp, rtcnt_t t) {
+
+  ptp->last = t;
+  if (t < ptp->best) {
+    ptp->best = t;
+  }
+  if (t > ptp->worst) {
+    ptp->worst = t;
+  }
+  ptp->n++;
+  ptp->cumulative += (rttime_t)t;
+}
+
+static void ptask_stats_reset(ptask_stats_t *sp) {
+
+  sp->releases    = (ucnt_t)0;
+  sp->completions = (ucnt_t)0;
+  sp->misses      = (ucnt_t)0;
+  sp->overruns    = (ucnt_t)0;
+  ptask_times_reset(&sp->exec);
+  ptask_times_reset(&sp->response);
+}
+
+/**
+ * @brief   Accounts a deadline miss of the job in progress.
+ * @note    Multiple misses of the same job are counted once.
+ */
+static void ptask_miss_i(periodic_task_t *ptp) {
+
+  if (!ptp->missed) {
+    ptp->missed = true;
+    ptp->stats.misses++;
+    if (ptp->config->miss_cb != NULL) {
+      ptp->config->miss_cb(ptp);
+    }
+  }
+}
+
+static void ptask_deadline_cb(virtual_timer_t *vtp, void *p) {
+  periodic_task_t *ptp = (periodic_task_t *)p;
+
+  (void)vtp;
+
+  chSysLockFromISR();
+  if (ptp->busy) {
+    ptask_miss_i(ptp);
+  }
+  chSysUnlockFromISR();
+}
+
+static void ptask_release_cb(virtual_timer_t *vtp, void *p) {
+  periodic_task_t *ptp = (periodic_task_t *)p;
+
+  (void)vtp;
+
+  chSysLockFromISR();
+  ptp->stats.releases++;
+  if (!ptp->busy) {
+    ptp->busy         = true;
+    ptp->missed       = false;
+    ptp->release_time = ptask_now();
+    if (ptp->deadline < ptp->config->period) {
+      chVTSetI(&ptp->deadline_vt, ptp->deadline, ptask_deadline_cb, ptp);
+    }
+    chThdResumeI(&ptp->trp, MSG_OK);
+  }
+  else {
+    /* The previous job is still running, the release is skipped and,
+       the deadline being not greater than the period, it is also late.*/
+    ptp->stats.overruns++;
+    ptask_miss_i(ptp);
+  }
+  chSysUnlockFromISR();
+}
+
+static THD_FUNCTION(ptask_thread, arg) {
+  periodic_task_t *ptp = (periodic_task_t *)arg;
+  const ptask_config_t *cfgp = ptp->config;
+  systime_t now, first;
+  sysinterval_t delay;
+
+  chSysLock();
+
+  /* The releases timer is started by the thread itself so that it is
+     already waiting when the first release happens. If the first release
+     time has already passed then it happens as soon as possible.*/
+  now   = chVTGetSystemTimeX();
+  first = chTimeAddX(ptp->origin, cfgp->phase);
+  if (chTimeIsInRangeX(now, ptp->origin, first)) {
+    delay = chTimeDiffX(now, first);
+  }
+  else {
+    delay = (sysinterval_t)1;
+  }
+  chVTSetI(&ptp->release_vt, delay, ptask_release_cb, ptp);
+  chVTSetReloadIntervalX(&ptp->release_vt, cfgp->period);
+
+  while (!ptp->stop) {
+    rtcnt_t start, end;
+
+    if (chThdSuspendS(&ptp->trp) != MSG_OK) {
+      break;
+    }
+    chSysUnlock();
+
+    start = ptask_now();
+    cfgp->job(cfgp->arg);
+    end = ptask_now();
+
+    chSysLock();
+    chVTResetI(&ptp->deadline_vt);
+    ptp->busy = false;
+    ptp->stats.completions++;
+    ptask_times_update(&ptp->stats.exec, end - start);
+    ptask_times_update(&ptp->stats.response, end - ptp->release_time);
+  }
+
+  /* The task could have been stopped before reaching the loop.*/
+  chVTResetI(&ptp->release_vt);
+  chSysUnlock();
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a periodic task object.
+ *
+ * @param[out] ptp      pointer to a @p periodic_task_t structure
+ * @param[in] cfgp      pointer to the task configuration
+ *
+ * @init
+ */
+void ptaskObjectInit(periodic_task_t *ptp, const ptask_config_t *cfgp) {
+
+  chDbgCheck((ptp != NULL) && (cfgp != NULL) && (cfgp->job != NULL) &&
+             (cfgp->period > (sysinterval_t)0) &&
+             (cfgp->deadline <= cfgp->period));
+
+  ptp->next         = NULL;
+  ptp->config       = cfgp;
+  ptp->prio         = cfgp->prio;
+  ptp->deadline     = cfgp->deadline > (sysinterval_t)0 ? cfgp->deadline :
+                                                          cfgp->period;
+  ptp->origin       = (systime_t)0;
+  ptp->thread       = NULL;
+  ptp->trp          = NULL;
+  ptp->release_time = (rtcnt_t)0;
+  ptp->busy         = false;
+  ptp->missed       = false;
+  ptp->stop         = false;
+  chVTObjectInit(&ptp->release_vt);
+  chVTObjectInit(&ptp->deadline_vt);
+  ptask_stats_reset(&ptp->stats);
+}
+
+/**
+ * @brief   Assigns priorities to a set of tasks using the rate-monotonic
+ *          policy.
+ * @details Shorter periods get higher priorities, the task with the longest
+ *          period gets the base priority. Tasks with the same period get
+ *          the same priority.
+ * @note    The tasks must not be started.
+ *
+ * @param[in] ptps      array of pointers to the tasks
+ * @param[in] n         number of tasks in the array
+ * @param[in] base      lowest priority to be assigned
+ *
+ * @api
+ */
+void ptaskAssignRateMonotonic(periodic_task_t *ptps[], unsigned n,
+                              tprio_t base) {
+  unsigned i, j, k;
+
+  chDbgCheck((ptps != NULL) && (n > 0U));
+
+  for (i = 0U; i < n; i++) {
+    sysinterval_t period = ptps[i]->config->period;
+    tprio_t prio = base;
+
+    chDbgAssert(ptps[i]->thread == NULL, "task started");
+
+    /* Counting the distinct periods longer than this one.*/
+    for (j = 0U; j < n; j++) {
+      sysinterval_t pj = ptps[j]->config->period;
+
+      if (pj > period) {
+        for (k = 0U; k < j; k++) {
+          if (ptps[k]->config->period == pj) {
+            break;
+          }
+        }
+        if (k == j) {
+          prio++;
+        }
+      }
+    }
+
+    chDbgAssert((prio >= base) && (prio <= HIGHPRIO), "priority overflow");
+
+    ptps[i]->prio = prio;
+  }
+}
+
+/**
+ * @brief   Starts a periodic task.
+ * @details The first release happens at @p origin plus the task phase,
+ *          tasks of a set should be started using the same origin.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @param[in] origin    releases time origin, usually the current time
+ *
+ * @api
+ */
+void ptaskStart(periodic_task_t *ptp, systime_t origin) {
+  thread_descriptor_t td;
+
+  chDbgCheck(ptp != NULL);
+  chDbgAssert(ptp->thread == NULL, "already started");
+
+  td.name  = ptp->config->name;
+  td.wbase = THD_WORKING_AREA_BASE(ptp->config->wsp);
+  td.wend  = (stkalign_t *)((uint8_t *)ptp->config->wsp + ptp->config->size);
+  td.prio  = ptp->prio;
+  td.funcp = ptask_thread;
+  td.arg   = (void *)ptp;
+#if CH_CFG_SMP_MODE != FALSE
+  td.instance = NULL;
+#endif
+
+  chSysLock();
+  ptp->origin = origin;
+  ptp->busy   = false;
+  ptp->missed = false;
+  ptp->stop   = false;
+  ptp->next   = ptask_list;
+  ptask_list  = ptp;
+  chSysUnlock();
+
+  ptp->thread = chThdCreate(&td);
+}
+
+/**
+ * @brief   Stops a periodic task.
+ * @details No more jobs are released, the function waits for the job in
+ *          progress, if any, to complete.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ *
+ * @api
+ */
+void ptaskStop(periodic_task_t *ptp) {
+  periodic_task_t **pp;
+
+  chDbgCheck(ptp != NULL);
+  chDbgAssert(ptp->thread != NULL, "not started");
+
+  chSysLock();
+  chVTResetI(&ptp->release_vt);
+  chVTResetI(&ptp->deadline_vt);
+  ptp->stop = true;
+  chThdResumeI(&ptp->trp, MSG_RESET);
+
+  pp = &ptask_list;
+  while (*pp != ptp) {
+    pp = &(*pp)->next;
+  }
+  *pp = ptp->next;
+  ptp->next = NULL;
+  chSchRescheduleS();
+  chSysUnlock();
+
+  (void) chThdWait(ptp->thread);
+  ptp->thread = NULL;
+}
+
+/**
+ * @brief   Returns the task statistics.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @param[out] statsp   pointer to the @p ptask_stats_t structure
+ *
+ * @api
+ */
+void ptaskGetStats(periodic_task_t *ptp, ptask_stats_t *statsp) {
+
+  chDbgCheck((ptp != NULL) && (statsp != NULL));
+
+  chSysLock();
+  *statsp = ptp->stats;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Resets the task statistics.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ *
+ * @api
+ */
+void ptaskResetStats(periodic_task_t *ptp) {
+
+  chDbgCheck(ptp != NULL);
+
+  chSysLock();
+  ptask_stats_reset(&ptp->stats);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the first task in the list of the started tasks.
+ * @note    The list must not be modified while being scanned.
+ *
+ * @return              The first task or @p NULL.
+ *
+ * @xclass
+ */
+periodic_task_t *ptaskGetFirstX(void) {
+
+  return ptask_list;
+}
+
+/** @} */
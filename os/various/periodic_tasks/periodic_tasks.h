@@ -0,0 +1,312 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    periodic_tasks.h
+ * @brief   Periodic tasks structures and macros.
+ * @details A periodic task is a thread executing a job function at each
+ *          release. Releases are generated by a continuous virtual timer
+ *          so they do not drift and do not depend on the job execution
+ *          time. Each job must complete within a relative deadline,
+ *          misses are counted and notified through a callback.
+ *
+ * @addtogroup periodic_tasks
+ * @{
+ */
+
+#ifndef PERIODIC_TASKS_H
+#define PERIODIC_TASKS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_WAITEXIT == FALSE
+#error "PTASK requires CH_CFG_USE_WAITEXIT"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a periodic task.
+ */
+typedef struct periodic_task periodic_task_t;
+
+/**
+ * @brief   Type of a job function.
+ *
+ * @param[in] arg       the argument specified in the task configuration
+ */
+typedef void (*ptask_job_t)(void *arg);
+
+/**
+ * @brief   Type of a deadline-miss callback.
+ * @note    The callback is invoked from ISR context within a critical
+ *          zone, only I-class functions can be used.
+ *
+ * @param[in] ptp       pointer to the periodic task missing its deadline
+ */
+typedef void (*ptask_miss_cb_t)(periodic_task_t *ptp);
+
+/**
+ * @brief   Type of a periodic task configuration.
+ */
+typedef struct {
+  /**
+   * @brief   Task name.
+   */
+  const char                *name;
+  /**
+   * @brief   Pointer to the working area.
+   */
+  void                      *wsp;
+  /**
+   * @brief   Size of the working area.
+   */
+  size_t                    size;
+  /**
+   * @brief   Task priority.
+   * @note    Overridden by @p ptaskAssignRateMonotonic().
+   */
+  tprio_t                   prio;
+  /**
+   * @brief   Release period.
+   */
+  sysinterval_t             period;
+  /**
+   * @brief   Offset of the first release from the start origin.
+   */
+  sysinterval_t             phase;
+  /**
+   * @brief   Relative deadline.
+   * @note    Zero means a deadline equal to the period, the deadline
+   *          cannot exceed the period.
+   */
+  sysinterval_t             deadline;
+  /**
+   * @brief   Job function.
+   */
+  ptask_job_t               job;
+  /**
+   * @brief   Job function argument.
+   */
+  void                      *arg;
+  /**
+   * @brief   Deadline-miss callback or @p NULL.
+   */
+  ptask_miss_cb_t           miss_cb;
+} ptask_config_t;
+
+/**
+ * @brief   Type of a times statistic.
+ * @note    Times are expressed in realtime counter ticks, or in system
+ *          ticks on ports without a realtime counter.
+ */
+typedef struct {
+  rtcnt_t                   best;           /**< @brief Best measurement.   */
+  rtcnt_t                   worst;          /**< @brief Worst measurement.  */
+  rtcnt_t                   last;           /**< @brief Last measurement.   */
+  ucnt_t                    n;              /**< @brief Measurements.       */
+  rttime_t                  cumulative;     /**< @brief Cumulative time.    */
+} ptask_times_t;
+
+/**
+ * @brief   Type of the periodic task statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Released jobs.
+   */
+  ucnt_t                    releases;
+  /**
+   * @brief   Completed jobs.
+   */
+  ucnt_t                    completions;
+  /**
+   * @brief   Jobs missing their deadline.
+   */
+  ucnt_t                    misses;
+  /**
+   * @brief   Releases skipped because the previous job was still running.
+   */
+  ucnt_t                    overruns;
+  /**
+   * @brief   Execution time, from job start to job end.
+   * @note    Preemptions by higher priority threads are included.
+   */
+  ptask_times_t             exec;
+  /**
+   * @brief   Response time, from release to job end.
+   */
+  ptask_times_t             response;
+} ptask_stats_t;
+
+/**
+ * @brief   Structure representing a periodic task.
+ */
+struct periodic_task {
+  /**
+   * @brief   Next task in the list of the started tasks.
+   */
+  periodic_task_t           *next;
+  /**
+   * @brief   Task configuration.
+   */
+  const ptask_config_t      *config;
+  /**
+   * @brief   Effective priority.
+   */
+  tprio_t                   prio;
+  /**
+   * @brief   Effective relative deadline.
+   */
+  sysinterval_t             deadline;
+  /**
+   * @brief   Start origin.
+   */
+  systime_t                 origin;
+  /**
+   * @brief   Task thread or @p NULL if not started.
+   */
+  thread_t                  *thread;
+  /**
+   * @brief   Reference to the thread waiting for a release.
+   */
+  thread_reference_t        trp;
+  /**
+   * @brief   Releases timer.
+   */
+  virtual_timer_t           release_vt;
+  /**
+   * @brief   Deadline timer.
+   */
+  virtual_timer_t           deadline_vt;
+  /**
+   * @brief   Time of the last release.
+   */
+  rtcnt_t                   release_time;
+  /**
+   * @brief   A job is in progress.
+   */
+  bool                      busy;
+  /**
+   * @brief   The job in progress missed its deadline.
+   */
+  bool                      missed;
+  /**
+   * @brief   Stop requested.
+   */
+  bool                      stop;
+  /**
+   * @brief   Statistics.
+   */
+  ptask_stats_t             stats;
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void ptaskObjectInit(periodic_task_t *ptp, const ptask_config_t *cfgp);
+  void ptaskAssignRateMonotonic(periodic_task_t *ptps[], unsigned n,
+                                tprio_t base);
+  void ptaskStart(periodic_task_t *ptp, systime_t origin);
+  void ptaskStop(periodic_task_t *ptp);
+  void ptaskGetStats(periodic_task_t *ptp, ptask_stats_t *statsp);
+  void ptaskResetStats(periodic_task_t *ptp);
+  periodic_task_t *ptaskGetFirstX(void);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the task following the specified one in the list of
+ *          the started tasks.
+ * @note    The list must not be modified while being scanned.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @return              The next task or @p NULL.
+ *
+ * @xclass
+ */
+static inline periodic_task_t *ptaskGetNextX(periodic_task_t *ptp) {
+
+  return ptp->next;
+}
+
+/**
+ * @brief   Returns the task name.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @return              The task name.
+ *
+ * @xclass
+ */
+static inline const char *ptaskGetNameX(periodic_task_t *ptp) {
+
+  return ptp->config->name;
+}
+
+/**
+ * @brief   Returns the task effective priority.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @return              The task priority.
+ *
+ * @xclass
+ */
+static inline tprio_t ptaskGetPriorityX(periodic_task_t *ptp) {
+
+  return ptp->prio;
+}
+
+/**
+ * @brief   Returns the task effective relative deadline.
+ *
+ * @param[in] ptp       pointer to a @p periodic_task_t structure
+ * @return              The relative deadline.
+ *
+ * @xclass
+ */
+static inline sysinterval_t ptaskGetDeadlineX(periodic_task_t *ptp) {
+
+  return ptp->deadline;
+}
+
+#endif /* PERIODIC_TASKS_H */
+
+/** @} */
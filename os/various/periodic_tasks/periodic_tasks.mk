@@ -0,0 +1,8 @@
+# Periodic tasks files.
+PTASKSRC = $(CHIBIOS)/os/various/periodic_tasks/periodic_tasks.c
+
+PTASKINC = $(CHIBIOS)/os/various/periodic_tasks
+
+# Shared variables
+ALLCSRC += $(PTASKSRC)
+ALLINC  += $(PTASKINC)
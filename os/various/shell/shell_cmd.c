@@ -35,6 +35,10 @@
 #include "vfs.h"
 #endif
 
+#if (SHELL_CMD_PTASKS_ENABLED == TRUE) || defined(__DOXYGEN__)
+#include "periodic_tasks.h"
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 #include "rt_test_root.h"
 #include "oslib_test_root.h"
@@ -161,7 +165,11 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
     shellUsage(chp, "threads");
     return;
   }
+#if !defined(__CHIBIOS_NIL__) && (CH_DBG_STACK_USAGE == TRUE)
+  chprintf(chp, "core stklimit    stack     addr refs prio     state  stkused         name" SHELL_NEWLINE_STR);
+#else
   chprintf(chp, "core stklimit    stack     addr refs prio     state         name" SHELL_NEWLINE_STR);
+#endif
   tp = chRegFirstThread();
   do {
     core_id_t core_id;
@@ -176,6 +184,18 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
 #else
     uint32_t stklimit = 0U;
 #endif
+#if !defined(__CHIBIOS_NIL__) && (CH_DBG_STACK_USAGE == TRUE)
+    chprintf(chp, "%4lu %08lx %08lx %08lx %4lu %4lu %9s %8lu %12s" SHELL_NEWLINE_STR,
+             core_id,
+             stklimit,
+             (uint32_t)tp->ctx.sp,
+             (uint32_t)tp,
+             (uint32_t)tp->refs - 1,
+             (uint32_t)tp->hdr.pqueue.prio,
+             states[tp->state],
+             (uint32_t)chRegGetThreadStackUsage(tp),
+             tp->name == NULL ? "" : tp->name);
+#else
     chprintf(chp, "%4lu %08lx %08lx %08lx %4lu %4lu %9s %12s" SHELL_NEWLINE_STR,
              core_id,
              stklimit,
@@ -185,11 +205,90 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
              (uint32_t)tp->hdr.pqueue.prio,
              states[tp->state],
              tp->name == NULL ? "" : tp->name);
+#endif
     tp = chRegNextThread(tp);
   } while (tp != NULL);
 }
 #endif
 
+#if ((SHELL_CMD_STATS_ENABLED == TRUE) && !defined(__CHIBIOS_NIL__) &&       \
+     (CH_DBG_STATISTICS == TRUE)) || defined(__DOXYGEN__)
+static void cmd_stats(BaseSequentialStream *chp, int argc, char *argv[]) {
+  kernel_stats_t ks;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "stats");
+    return;
+  }
+
+#if CH_CFG_NO_IDLE_THREAD == FALSE
+  {
+    thread_t *itp = chSysGetIdleThreadX();
+    rtcnt_t start;
+    rttime_t idle, wakeups, elapsed;
+
+    /* Sampling the idle thread accounting over a one second window, the
+       idle thread is not running while this thread is so its measurement
+       is stable when read.*/
+    chSysLock();
+    idle    = itp->stats.cumulative;
+    wakeups = (rttime_t)itp->stats.n;
+    start   = chSysGetRealtimeCounterX();
+    chSysUnlock();
+    chThdSleepMilliseconds(1000);
+    chSysLock();
+    elapsed = (rttime_t)(rtcnt_t)(chSysGetRealtimeCounterX() - start);
+    idle    = itp->stats.cumulative - idle;
+    wakeups = (rttime_t)itp->stats.n - wakeups;
+    chSysUnlock();
+
+    if (elapsed > (rttime_t)0) {
+      chprintf(chp, "idle residency:   %lu.%lu%%" SHELL_NEWLINE_STR,
+               (uint32_t)((idle * 100U) / elapsed),
+               (uint32_t)(((idle * 1000U) / elapsed) % 10U));
+    }
+    chprintf(chp, "idle wakeups/s:   %lu" SHELL_NEWLINE_STR,
+             (uint32_t)wakeups);
+  }
+#endif
+
+  chStatsGetKernel(&ks);
+  chprintf(chp, "interrupts:       %lu" SHELL_NEWLINE_STR, (uint32_t)ks.n_irq);
+  chprintf(chp, "context switches: %lu" SHELL_NEWLINE_STR, (uint32_t)ks.n_ctxswc);
+  chprintf(chp, "coalesced timers: %lu" SHELL_NEWLINE_STR,
+           (uint32_t)ks.n_vt_coalesced);
+#if CH_CFG_USE_EDF == TRUE
+  chprintf(chp, "deadline jobs:    %lu" SHELL_NEWLINE_STR,
+           (uint32_t)ks.n_edf_jobs);
+  chprintf(chp, "deadline misses:  %lu" SHELL_NEWLINE_STR,
+           (uint32_t)ks.n_edf_misses);
+#endif
+#if CH_CFG_ST_TIMEDELTA > 0
+  {
+    unsigned i;
+
+    chprintf(chp, "timer alarms:     %lu" SHELL_NEWLINE_STR,
+             (uint32_t)ks.n_vt_alarms);
+    chprintf(chp, "alarm retries:    %lu" SHELL_NEWLINE_STR,
+             (uint32_t)ks.n_vt_retries);
+    chprintf(chp, "timers lateness (ticks):" SHELL_NEWLINE_STR);
+    chprintf(chp, "  %8s %lu" SHELL_NEWLINE_STR, "0", (uint32_t)ks.vt_lateness[0]);
+    for (i = 1U; i < (unsigned)CH_DBG_STATISTICS_LATENESS_BINS; i++) {
+      if (i < (unsigned)CH_DBG_STATISTICS_LATENESS_BINS - 1U) {
+        chprintf(chp, "  <%7lu %lu" SHELL_NEWLINE_STR,
+                 (uint32_t)1U << i, (uint32_t)ks.vt_lateness[i]);
+      }
+      else {
+        chprintf(chp, "  >=%6lu %lu" SHELL_NEWLINE_STR,
+                 (uint32_t)1U << (i - 1U), (uint32_t)ks.vt_lateness[i]);
+      }
+    }
+  }
+#endif
+}
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 static THD_FUNCTION(test_rt, arg) {
   BaseSequentialStream *chp = (BaseSequentialStream *)arg;
@@ -201,13 +300,36 @@ static THD_FUNCTION(test_oslib, arg) {
   test_execute(chp, &oslib_test_suite);
 }
 
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+#define TEST_USAGE      "test rt|oslib [json|junit]"
+#else
+#define TEST_USAGE      "test rt|oslib"
+#endif
+
 static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
   thread_t *tp;
   tfunc_t tfp;
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  unsigned format = TEST_REPORT_NONE;
+
+  if (argc == 2) {
+    if (!strcmp(argv[1], "json")) {
+      format = TEST_REPORT_JSON;
+    }
+    else if (!strcmp(argv[1], "junit")) {
+      format = TEST_REPORT_JUNIT;
+    }
+    else {
+      shellUsage(chp, TEST_USAGE);
+      return;
+    }
+    argc--;
+  }
+#endif
 
   (void)argv;
   if (argc != 1) {
-    shellUsage(chp, "test rt|oslib");
+    shellUsage(chp, TEST_USAGE);
     return;
   }
   if (!strcmp(argv[0], "rt")) {
@@ -217,9 +339,12 @@ static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
     tfp = test_oslib;
   }
   else {
-    shellUsage(chp, "test rt|oslib");
+    shellUsage(chp, TEST_USAGE);
     return;
   }
+#if TEST_CFG_REPORT_MAX_RECORDS > 0
+  test_set_report(format, NULL);
+#endif
   tp = chThdCreateFromHeap(NULL, SHELL_CMD_TEST_WA_SIZE,
                            "test", chThdGetPriorityX(),
                            tfp, chp);
@@ -231,6 +356,48 @@ static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
 }
 #endif
 
+#if (SHELL_CMD_PTASKS_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_ptasks(BaseSequentialStream *chp, int argc, char *argv[]) {
+  periodic_task_t *ptp;
+  bool reset = false;
+
+  if (argc == 1) {
+    reset = strcmp(argv[0], "reset") == 0;
+  }
+  if ((argc > 1) || ((argc == 1) && !reset)) {
+    shellUsage(chp, "ptasks [reset]");
+    return;
+  }
+
+  chprintf(chp, "        name   period deadline prio releases   misses overruns "
+                "exec.avg exec.max resp.avg resp.max" SHELL_NEWLINE_STR);
+  ptp = ptaskGetFirstX();
+  while (ptp != NULL) {
+    ptask_stats_t s;
+
+    ptaskGetStats(ptp, &s);
+    chprintf(chp, "%12s %8lu %8lu %4lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu"
+                  SHELL_NEWLINE_STR,
+             ptaskGetNameX(ptp) == NULL ? "" : ptaskGetNameX(ptp),
+             (uint32_t)TIME_I2MS(ptp->config->period),
+             (uint32_t)TIME_I2MS(ptaskGetDeadlineX(ptp)),
+             (uint32_t)ptaskGetPriorityX(ptp),
+             (uint32_t)s.releases,
+             (uint32_t)s.misses,
+             (uint32_t)s.overruns,
+             s.exec.n > 0U ? (uint32_t)(s.exec.cumulative / s.exec.n) : 0U,
+             (uint32_t)s.exec.worst,
+             s.response.n > 0U ?
+               (uint32_t)(s.response.cumulative / s.response.n) : 0U,
+             (uint32_t)s.response.worst);
+    if (reset) {
+      ptaskResetStats(ptp);
+    }
+    ptp = ptaskGetNextX(ptp);
+  }
+}
+#endif
+
 #if (SHELL_CMD_FILES_ENABLED == TRUE) || defined(__DOXYGEN__)
 static void scan_nodes(BaseSequentialStream *chp,
                        char *path,
@@ -454,6 +621,13 @@ const ShellCommand shell_local_commands[] = {
 #if SHELL_CMD_THREADS_ENABLED == TRUE
   {"threads", cmd_threads},
 #endif
+#if (SHELL_CMD_STATS_ENABLED == TRUE) && !defined(__CHIBIOS_NIL__) &&         \
+    (CH_DBG_STATISTICS == TRUE)
+  {"stats", cmd_stats},
+#endif
+#if SHELL_CMD_PTASKS_ENABLED == TRUE
+  {"ptasks", cmd_ptasks},
+#endif
 #if SHELL_CMD_FILES_ENABLED == TRUE
   {"cat", cmd_cat},
   {"cd", cmd_cd},
@@ -57,6 +57,10 @@
 #define SHELL_CMD_THREADS_ENABLED           TRUE
 #endif
 
+#if !defined(SHELL_CMD_STATS_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_STATS_ENABLED             TRUE
+#endif
+
 #if !defined(SHELL_CMD_TEST_ENABLED) || defined(__DOXYGEN__)
 #define SHELL_CMD_TEST_ENABLED              TRUE
 #endif
@@ -65,6 +69,10 @@
 #define SHELL_CMD_FILES_ENABLED             FALSE
 #endif
 
+#if !defined(SHELL_CMD_PTASKS_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_PTASKS_ENABLED            FALSE
+#endif
+
 #if !defined(SHELL_CMD_TEST_WA_SIZE) || defined(__DOXYGEN__)
 #define SHELL_CMD_TEST_WA_SIZE              THD_WORKING_AREA_SIZE(512)
 #endif
@@ -0,0 +1,10 @@
+# List of all the CMSIS RTOS2 test files.
+TESTSRC += ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_root.c \
+           ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_sequence_001.c \
+           ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_sequence_002.c \
+           ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_sequence_003.c \
+           ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_sequence_004.c \
+           ${CHIBIOS}/test/cmsis_os2/source/test/cmsis_os2_test_sequence_005.c
+
+# Required include directories
+TESTINC += ${CHIBIOS}/test/cmsis_os2/source/test
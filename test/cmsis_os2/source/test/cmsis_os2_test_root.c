@@ -0,0 +1,135 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @mainpage Test Suite Specification
+ * Test suite for the CMSIS RTOS2 wrapper over ChibiOS/RT. The purpose
+ * of this suite is to check threads, mutexes, semaphores and message
+ * queues with arbitrary size messages through the CMSIS API and to
+ * measure the wrapper overhead against the native calls.
+ *
+ * <h2>Test Sequences</h2>
+ * - @subpage cmsis_os2_test_sequence_001
+ * - @subpage cmsis_os2_test_sequence_002
+ * - @subpage cmsis_os2_test_sequence_003
+ * - @subpage cmsis_os2_test_sequence_004
+ * - @subpage cmsis_os2_test_sequence_005
+ * .
+ */
+
+/**
+ * @file    cmsis_os2_test_root.c
+ * @brief   Test Suite root structures code.
+ */
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Array of test sequences.
+ */
+const testsequence_t * const cmsis_os2_test_suite_array[] = {
+  &cmsis_os2_test_sequence_001,
+  &cmsis_os2_test_sequence_002,
+  &cmsis_os2_test_sequence_003,
+  &cmsis_os2_test_sequence_004,
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  &cmsis_os2_test_sequence_005,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Test suite root structure.
+ */
+const testsuite_t cmsis_os2_test_suite = {
+  "CMSIS RTOS2 Test Suite",
+  cmsis_os2_test_suite_array
+};
+
+/*===========================================================================*/
+/* Shared code.                                                              */
+/*===========================================================================*/
+
+/*
+ * Working areas of the test threads.
+ */
+ALIGNED_VAR(PORT_WORKING_AREA_ALIGN)
+uint8_t cmsis_os2_wa[CMSIS_OS2_MAX_THREADS][CMSIS_OS2_WA_SIZE];
+
+/*
+ * Test threads.
+ */
+static osThreadId_t cmsis_os2_threads[CMSIS_OS2_MAX_THREADS];
+
+/*
+ * Returns the priority of the invoking thread.
+ */
+osPriority_t cmsis_os2_self_prio(void) {
+
+  return osThreadGetPriority(osThreadGetId());
+}
+
+/*
+ * Creates a test thread using a static working area.
+ */
+osThreadId_t cmsis_os2_thread_new(unsigned i, osThreadFunc_t func,
+                                  void *argument, osPriority_t priority) {
+  osThreadAttr_t attr;
+
+  memset(&attr, 0, sizeof attr);
+  attr.name       = "cmsis";
+  attr.stack_mem  = cmsis_os2_wa[i];
+  attr.stack_size = CMSIS_OS2_WA_SIZE;
+  attr.priority   = priority;
+  cmsis_os2_threads[i] = osThreadNew(func, argument, &attr);
+
+  return cmsis_os2_threads[i];
+}
+
+/*
+ * Waits for the termination of all the test threads.
+ */
+void cmsis_os2_wait_threads(void) {
+  unsigned i;
+
+  for (i = 0U; i < CMSIS_OS2_MAX_THREADS; i++) {
+    if (cmsis_os2_threads[i] != NULL) {
+      (void) chThdWait((thread_t *)cmsis_os2_threads[i]);
+      cmsis_os2_threads[i] = NULL;
+    }
+  }
+}
+
+/*
+ * Delays execution until next system time tick.
+ */
+systime_t cmsis_os2_wait_tick(void) {
+
+  chThdSleep(1);
+#if defined(SIMULATOR)
+  _sim_check_for_interrupts();
+#endif
+  return chVTGetSystemTimeX();
+}
+
+#endif /* !defined(__DOXYGEN__) */
@@ -0,0 +1,97 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    cmsis_os2_test_root.h
+ * @brief   Test Suite root structures header.
+ */
+
+#ifndef CMSIS_OS2_TEST_ROOT_H
+#define CMSIS_OS2_TEST_ROOT_H
+
+#include "ch_test.h"
+
+#include "cmsis_os2_test_sequence_001.h"
+#include "cmsis_os2_test_sequence_002.h"
+#include "cmsis_os2_test_sequence_003.h"
+#include "cmsis_os2_test_sequence_004.h"
+#include "cmsis_os2_test_sequence_005.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testsuite_t cmsis_os2_test_suite;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#include <string.h>
+
+#include "cmsis_os2.h"
+
+/*
+ * Maximum number of test threads.
+ */
+#define CMSIS_OS2_MAX_THREADS       2
+
+/*
+ * Stack size of test threads.
+ */
+#if !defined(CMSIS_OS2_STACK_SIZE)
+  #if defined(PORT_ARCHITECTURE_SIMIA32)
+    #define CMSIS_OS2_STACK_SIZE    1024
+  #else
+    #define CMSIS_OS2_STACK_SIZE    256
+  #endif
+#endif
+
+/*
+ * Working Area size of test threads.
+ */
+#define CMSIS_OS2_WA_SIZE MEM_ALIGN_NEXT(THD_WORKING_AREA_SIZE(CMSIS_OS2_STACK_SIZE), \
+                                         PORT_WORKING_AREA_ALIGN)
+
+/*
+ * Message used by the queue tests, its size is not a multiple of the
+ * port alignment.
+ */
+typedef struct {
+  uint8_t                   seq;
+  char                      text[10];
+} cmsis_os2_msg_t;
+
+extern uint8_t cmsis_os2_wa[CMSIS_OS2_MAX_THREADS][CMSIS_OS2_WA_SIZE];
+
+osPriority_t cmsis_os2_self_prio(void);
+osThreadId_t cmsis_os2_thread_new(unsigned i, osThreadFunc_t func,
+                                  void *argument, osPriority_t priority);
+void cmsis_os2_wait_threads(void);
+systime_t cmsis_os2_wait_tick(void);
+
+#endif /* !defined(__DOXYGEN__) */
+
+#endif /* CMSIS_OS2_TEST_ROOT_H */
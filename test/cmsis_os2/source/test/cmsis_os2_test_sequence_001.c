@@ -0,0 +1,212 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+/**
+ * @file    cmsis_os2_test_sequence_001.c
+ * @brief   Test Sequence 001 code.
+ *
+ * @page cmsis_os2_test_sequence_001 [1] Threads
+ *
+ * File: @ref cmsis_os2_test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the CMSIS RTOS2 threads functionality.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage cmsis_os2_test_001_001
+ * - @subpage cmsis_os2_test_001_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static void thread(void *argument) {
+
+  test_emit_token(*(const char *)argument);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page cmsis_os2_test_001_001 [1.1] Threads creation
+ *
+ * <h2>Description</h2>
+ * Threads are created using static and heap-allocated working areas,
+ * priorities and execution order are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.1.1] Two threads are created with static working areas at
+ *   priorities lower than the test thread, the priorities and the
+ *   execution sequence are checked.
+ * - [1.1.2] Invalid parameters are passed to osThreadNew().
+ * - [1.1.3] A thread is created with a working area allocated from the
+ *   heap.
+ * .
+ */
+
+static void cmsis_os2_test_001_001_execute(void) {
+  osPriority_t prio = cmsis_os2_self_prio();
+
+  /* [1.1.1] Two threads are created with static working areas at
+     priorities lower than the test thread, the priorities and the
+     execution sequence are checked.*/
+  test_set_step(1);
+  {
+    osThreadId_t tid;
+
+    tid = cmsis_os2_thread_new(0, thread, "B", (osPriority_t)(prio - 2));
+    test_assert(tid != NULL, "thread not created");
+    test_assert(osThreadGetPriority(tid) == (osPriority_t)(prio - 2),
+                "wrong priority");
+    tid = cmsis_os2_thread_new(1, thread, "A", (osPriority_t)(prio - 1));
+    test_assert(tid != NULL, "thread not created");
+    cmsis_os2_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(1);
+
+  /* [1.1.2] Invalid parameters are passed to osThreadNew().*/
+  test_set_step(2);
+  {
+    osThreadAttr_t attr;
+
+    test_assert(osThreadNew(NULL, NULL, NULL) == NULL, "created");
+    memset(&attr, 0, sizeof attr);
+    attr.stack_mem = cmsis_os2_wa[0];
+    test_assert(osThreadNew(thread, "A", &attr) == NULL, "created without size");
+    attr.stack_size = CMSIS_OS2_WA_SIZE;
+    attr.priority   = osPriorityISR;
+    test_assert(osThreadNew(thread, "A", &attr) == NULL, "created at ISR priority");
+  }
+  test_end_step(2);
+
+  /* [1.1.3] A thread is created with a working area allocated from the
+     heap.*/
+  test_set_step(3);
+  {
+#if (CH_CFG_USE_DYNAMIC == TRUE) && (CH_CFG_USE_HEAP == TRUE)
+    osThreadAttr_t attr;
+    osThreadId_t tid;
+
+    memset(&attr, 0, sizeof attr);
+    attr.stack_size = CMSIS_OS2_STACK_SIZE;
+    attr.priority   = (osPriority_t)(prio - 1);
+    tid = osThreadNew(thread, "C", &attr);
+    test_assert(tid != NULL, "thread not created");
+    (void) chThdWait((thread_t *)tid);
+    test_assert_sequence("C", "invalid sequence");
+#endif
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_001_001 = {
+  "Threads creation",
+  NULL,
+  NULL,
+  cmsis_os2_test_001_001_execute
+};
+
+/**
+ * @page cmsis_os2_test_001_002 [1.2] Delays
+ *
+ * <h2>Description</h2>
+ * The relative and absolute delays are tested, absolute times not in
+ * the future are rejected.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.2.1] Sleeping for 10 ticks, the elapsed time is checked.
+ * - [1.2.2] Sleeping until an absolute time 10 ticks ahead, the
+ *   wake-up time is checked.
+ * - [1.2.3] Delaying until the current time and a past time, the
+ *   function must return immediately with an error.
+ * .
+ */
+
+static void cmsis_os2_test_001_002_execute(void) {
+  systime_t time;
+
+  /* [1.2.1] Sleeping for 10 ticks, the elapsed time is checked.*/
+  test_set_step(1);
+  {
+    time = cmsis_os2_wait_tick();
+    test_assert(osDelay(0U) == osErrorParameter, "zero delay accepted");
+    test_assert(osDelay(10U) == osOK, "delay failed");
+    test_assert(chVTTimeElapsedSinceX(time) >= (sysinterval_t)10,
+                "too short");
+  }
+  test_end_step(1);
+
+  /* [1.2.2] Sleeping until an absolute time 10 ticks ahead, the
+     wake-up time is checked.*/
+  test_set_step(2);
+  {
+    time = cmsis_os2_wait_tick();
+    test_assert(osDelayUntil((uint32_t)chTimeAddX(time, (sysinterval_t)10)) == osOK,
+                "delay failed");
+    test_assert(chVTTimeElapsedSinceX(time) >= (sysinterval_t)10,
+                "woken early");
+  }
+  test_end_step(2);
+
+  /* [1.2.3] Delaying until the current time and a past time, the
+     function must return immediately with an error.*/
+  test_set_step(3);
+  {
+    time = cmsis_os2_wait_tick();
+    test_assert(osDelayUntil((uint32_t)time) == osErrorParameter,
+                "current time accepted");
+    test_assert(osDelayUntil((uint32_t)(time - (systime_t)5)) == osErrorParameter,
+                "past time accepted");
+    test_assert(chVTTimeElapsedSinceX(time) < (sysinterval_t)5, "slept");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_001_002 = {
+  "Delays",
+  NULL,
+  NULL,
+  cmsis_os2_test_001_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const cmsis_os2_test_sequence_001_array[] = {
+  &cmsis_os2_test_001_001,
+  &cmsis_os2_test_001_002,
+  NULL
+};
+
+/**
+ * @brief   Threads.
+ */
+const testsequence_t cmsis_os2_test_sequence_001 = {
+  "Threads",
+  cmsis_os2_test_sequence_001_array
+};
@@ -0,0 +1,256 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+/**
+ * @file    cmsis_os2_test_sequence_002.c
+ * @brief   Test Sequence 002 code.
+ *
+ * @page cmsis_os2_test_sequence_002 [2] Mutexes
+ *
+ * File: @ref cmsis_os2_test_sequence_002.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the CMSIS RTOS2 mutexes functionality.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage cmsis_os2_test_002_001
+ * - @subpage cmsis_os2_test_002_002
+ * - @subpage cmsis_os2_test_002_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static void try_thread(void *argument) {
+  osMutexId_t mid = (osMutexId_t)argument;
+
+  if (osMutexAcquire(mid, 0U) == osErrorResource) {
+    test_emit_token('R');
+  }
+  if (osMutexAcquire(mid, 2U) == osErrorTimeout) {
+    test_emit_token('T');
+  }
+}
+
+static void lock_thread(void *argument) {
+  osMutexId_t mid = (osMutexId_t)argument;
+
+  if (osMutexAcquire(mid, osWaitForever) == osOK) {
+    test_emit_token('L');
+    (void) osMutexRelease(mid);
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page cmsis_os2_test_002_001 [2.1] Mutex ownership
+ *
+ * <h2>Description</h2>
+ * A mutex is acquired and released, ownership and errors are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.1.1] Acquiring the mutex, the owner is checked.
+ * - [2.1.2] A thread tries to acquire the mutex without waiting and
+ *   with a timeout.
+ * - [2.1.3] Releasing the mutex, a second release is an error.
+ * .
+ */
+
+static void cmsis_os2_test_002_001_execute(void) {
+  osPriority_t prio = cmsis_os2_self_prio();
+  osMutexId_t mid;
+
+  /* [2.1.1] Acquiring the mutex, the owner is checked.*/
+  test_set_step(1);
+  {
+    mid = osMutexNew(NULL);
+    test_assert(mid != NULL, "mutex not created");
+    test_assert(osMutexGetOwner(mid) == NULL, "owned");
+    test_assert(osMutexAcquire(mid, osWaitForever) == osOK, "not acquired");
+    test_assert(osMutexGetOwner(mid) == osThreadGetId(), "wrong owner");
+    test_assert(osMutexDelete(mid) == osErrorResource, "deleted while owned");
+  }
+  test_end_step(1);
+
+  /* [2.1.2] A thread tries to acquire the mutex without waiting and
+     with a timeout.*/
+  test_set_step(2);
+  {
+    (void) cmsis_os2_thread_new(0, try_thread, (void *)mid,
+                                (osPriority_t)(prio + 1));
+    cmsis_os2_wait_threads();
+    test_assert_sequence("RT", "invalid sequence");
+  }
+  test_end_step(2);
+
+  /* [2.1.3] Releasing the mutex, a second release is an error.*/
+  test_set_step(3);
+  {
+    test_assert(osMutexRelease(mid) == osOK, "not released");
+    test_assert(osMutexGetOwner(mid) == NULL, "still owned");
+    test_assert(osMutexRelease(mid) == osErrorResource, "released twice");
+    test_assert(osMutexDelete(mid) == osOK, "not deleted");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_002_001 = {
+  "Mutex ownership",
+  NULL,
+  NULL,
+  cmsis_os2_test_002_001_execute
+};
+
+/**
+ * @page cmsis_os2_test_002_002 [2.2] Priority inheritance
+ *
+ * <h2>Description</h2>
+ * A thread with higher priority waits on a mutex owned by the test
+ * thread, the test thread priority must be raised until the mutex is
+ * released.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.2.1] Acquiring the mutex then starting a thread waiting on it.
+ * - [2.2.2] Releasing the mutex, the priority must be restored and the
+ *   thread must run.
+ * .
+ */
+
+static void cmsis_os2_test_002_002_execute(void) {
+  osPriority_t prio = cmsis_os2_self_prio();
+  osMutexId_t mid;
+
+  /* [2.2.1] Acquiring the mutex then starting a thread waiting on
+     it.*/
+  test_set_step(1);
+  {
+    mid = osMutexNew(NULL);
+    test_assert(mid != NULL, "mutex not created");
+    test_assert(osMutexAcquire(mid, osWaitForever) == osOK, "not acquired");
+    (void) cmsis_os2_thread_new(0, lock_thread, (void *)mid,
+                                (osPriority_t)(prio + 2));
+    test_assert(cmsis_os2_self_prio() == (osPriority_t)(prio + 2),
+                "priority not raised");
+  }
+  test_end_step(1);
+
+  /* [2.2.2] Releasing the mutex, the priority must be restored and the
+     thread must run.*/
+  test_set_step(2);
+  {
+    test_assert(osMutexRelease(mid) == osOK, "not released");
+    test_assert(cmsis_os2_self_prio() == prio, "priority not restored");
+    test_assert_sequence("L", "invalid sequence");
+    cmsis_os2_wait_threads();
+    test_assert(osMutexDelete(mid) == osOK, "not deleted");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t cmsis_os2_test_002_002 = {
+  "Priority inheritance",
+  NULL,
+  NULL,
+  cmsis_os2_test_002_002_execute
+};
+
+/**
+ * @page cmsis_os2_test_002_003 [2.3] Release order
+ *
+ * <h2>Description</h2>
+ * Two mutexes are acquired, releasing them out of order must be
+ * rejected without altering the ownership.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.3.1] Acquiring two mutexes.
+ * - [2.3.2] Releasing the first mutex before the second one, the
+ *   release must fail.
+ * - [2.3.3] Releasing the mutexes in reverse order.
+ * .
+ */
+
+static void cmsis_os2_test_002_003_execute(void) {
+  osMutexId_t mid1, mid2;
+
+  /* [2.3.1] Acquiring two mutexes.*/
+  test_set_step(1);
+  {
+    mid1 = osMutexNew(NULL);
+    mid2 = osMutexNew(NULL);
+    test_assert((mid1 != NULL) && (mid2 != NULL), "mutex not created");
+    test_assert(osMutexAcquire(mid1, osWaitForever) == osOK, "not acquired");
+    test_assert(osMutexAcquire(mid2, osWaitForever) == osOK, "not acquired");
+  }
+  test_end_step(1);
+
+  /* [2.3.2] Releasing the first mutex before the second one, the
+     release must fail.*/
+  test_set_step(2);
+  {
+    test_assert(osMutexRelease(mid1) == osErrorResource, "released");
+    test_assert(osMutexGetOwner(mid1) == osThreadGetId(), "ownership lost");
+    test_assert(chMtxGetNextMutexX() == &((os_mutex_cb_t *)mid2)->mtx,
+                "owned list corrupted");
+  }
+  test_end_step(2);
+
+  /* [2.3.3] Releasing the mutexes in reverse order.*/
+  test_set_step(3);
+  {
+    test_assert(osMutexRelease(mid2) == osOK, "not released");
+    test_assert(osMutexRelease(mid1) == osOK, "not released");
+    test_assert(osMutexDelete(mid1) == osOK, "not deleted");
+    test_assert(osMutexDelete(mid2) == osOK, "not deleted");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_002_003 = {
+  "Release order",
+  NULL,
+  NULL,
+  cmsis_os2_test_002_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const cmsis_os2_test_sequence_002_array[] = {
+  &cmsis_os2_test_002_001,
+  &cmsis_os2_test_002_002,
+  &cmsis_os2_test_002_003,
+  NULL
+};
+
+/**
+ * @brief   Mutexes.
+ */
+const testsequence_t cmsis_os2_test_sequence_002 = {
+  "Mutexes",
+  cmsis_os2_test_sequence_002_array
+};
@@ -0,0 +1,170 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+/**
+ * @file    cmsis_os2_test_sequence_003.c
+ * @brief   Test Sequence 003 code.
+ *
+ * @page cmsis_os2_test_sequence_003 [3] Semaphores
+ *
+ * File: @ref cmsis_os2_test_sequence_003.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the CMSIS RTOS2 semaphores functionality.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage cmsis_os2_test_003_001
+ * - @subpage cmsis_os2_test_003_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static osSemaphoreId_t sid;
+
+static void wait_thread(void *argument) {
+
+  if (osSemaphoreAcquire(sid, osWaitForever) == osOK) {
+    test_emit_token(*(const char *)argument);
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page cmsis_os2_test_003_001 [3.1] Counting and limits
+ *
+ * <h2>Description</h2>
+ * Tokens are acquired and released within the limits of a semaphore.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.1.1] Creating a semaphore with two tokens at most and one
+ *   available.
+ * - [3.1.2] Acquiring tokens until the semaphore is empty.
+ * - [3.1.3] Releasing tokens up to the maximum count.
+ * .
+ */
+
+static void cmsis_os2_test_003_001_execute(void) {
+  osSemaphoreId_t sid;
+
+  /* [3.1.1] Creating a semaphore with two tokens at most and one
+     available.*/
+  test_set_step(1);
+  {
+    test_assert(osSemaphoreNew(0U, 0U, NULL) == NULL, "created");
+    test_assert(osSemaphoreNew(1U, 2U, NULL) == NULL, "created");
+    sid = osSemaphoreNew(2U, 1U, NULL);
+    test_assert(sid != NULL, "semaphore not created");
+    test_assert(osSemaphoreGetCount(sid) == 1U, "wrong count");
+  }
+  test_end_step(1);
+
+  /* [3.1.2] Acquiring tokens until the semaphore is empty.*/
+  test_set_step(2);
+  {
+    test_assert(osSemaphoreAcquire(sid, 0U) == osOK, "not acquired");
+    test_assert(osSemaphoreAcquire(sid, 0U) == osErrorResource, "acquired");
+    test_assert(osSemaphoreAcquire(sid, 2U) == osErrorTimeout, "acquired");
+  }
+  test_end_step(2);
+
+  /* [3.1.3] Releasing tokens up to the maximum count.*/
+  test_set_step(3);
+  {
+    test_assert(osSemaphoreRelease(sid) == osOK, "not released");
+    test_assert(osSemaphoreRelease(sid) == osOK, "not released");
+    test_assert(osSemaphoreRelease(sid) == osErrorResource, "released");
+    test_assert(osSemaphoreGetCount(sid) == 2U, "wrong count");
+    test_assert(osSemaphoreDelete(sid) == osOK, "not deleted");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_003_001 = {
+  "Counting and limits",
+  NULL,
+  NULL,
+  cmsis_os2_test_003_001_execute
+};
+
+/**
+ * @page cmsis_os2_test_003_002 [3.2] Waiting threads
+ *
+ * <h2>Description</h2>
+ * Two threads wait on an empty semaphore, each release must wake one
+ * of them.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.2.1] Starting the threads then releasing two tokens.
+ * .
+ */
+
+static void cmsis_os2_test_003_002_execute(void) {
+  osPriority_t prio = cmsis_os2_self_prio();
+
+  /* [3.2.1] Starting the threads then releasing two tokens.*/
+  test_set_step(1);
+  {
+    sid = osSemaphoreNew(2U, 0U, NULL);
+    test_assert(sid != NULL, "semaphore not created");
+    (void) cmsis_os2_thread_new(0, wait_thread, (void *)"A",
+                                (osPriority_t)(prio + 2));
+    (void) cmsis_os2_thread_new(1, wait_thread, (void *)"B",
+                                (osPriority_t)(prio + 1));
+    test_assert(osSemaphoreRelease(sid) == osOK, "not released");
+    test_assert(osSemaphoreRelease(sid) == osOK, "not released");
+    cmsis_os2_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+    test_assert(osSemaphoreDelete(sid) == osOK, "not deleted");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t cmsis_os2_test_003_002 = {
+  "Waiting threads",
+  NULL,
+  NULL,
+  cmsis_os2_test_003_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const cmsis_os2_test_sequence_003_array[] = {
+  &cmsis_os2_test_003_001,
+  &cmsis_os2_test_003_002,
+  NULL
+};
+
+/**
+ * @brief   Semaphores.
+ */
+const testsequence_t cmsis_os2_test_sequence_003 = {
+  "Semaphores",
+  cmsis_os2_test_sequence_003_array
+};
@@ -0,0 +1,286 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+/**
+ * @file    cmsis_os2_test_sequence_004.c
+ * @brief   Test Sequence 004 code.
+ *
+ * @page cmsis_os2_test_sequence_004 [4] Message queues
+ *
+ * File: @ref cmsis_os2_test_sequence_004.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the CMSIS RTOS2 message queues functionality,
+ * messages have an arbitrary size.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage cmsis_os2_test_004_001
+ * - @subpage cmsis_os2_test_004_002
+ * - @subpage cmsis_os2_test_004_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define QUEUE_LEN                   3U
+
+static os_message_queue_cb_t qcb;
+static ALIGNED_VAR(PORT_NATURAL_ALIGN)
+uint8_t qbuf[osMessageQueueMemSize(QUEUE_LEN, sizeof (cmsis_os2_msg_t))];
+static osMessageQueueId_t qid;
+
+static void msg_fill(cmsis_os2_msg_t *mp, unsigned seq) {
+
+  memset(mp, 0, sizeof *mp);
+  mp->seq = (uint8_t)seq;
+  memcpy(mp->text, "message", 7U);
+  mp->text[7] = (char)('0' + seq);
+}
+
+static void get_thread(void *argument) {
+  cmsis_os2_msg_t msg, expected;
+
+  (void)argument;
+  if (osMessageQueueGet(qid, &msg, NULL, osWaitForever) == osOK) {
+    msg_fill(&expected, 7U);
+    if (memcmp(&msg, &expected, sizeof msg) == 0) {
+      test_emit_token('G');
+    }
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page cmsis_os2_test_004_001 [4.1] Static buffers
+ *
+ * <h2>Description</h2>
+ * A queue is created over a statically allocated control block and
+ * buffer, messages are put until the queue is full then retrieved and
+ * compared.
+ *
+ * <h2>Test Steps</h2>
+ * - [4.1.1] Creating the queue, a buffer too small is rejected.
+ * - [4.1.2] Filling the queue.
+ * - [4.1.3] Emptying the queue, messages must be retrieved in order
+ *   and intact.
+ * .
+ */
+
+static void cmsis_os2_test_004_001_execute(void) {
+  osMessageQueueAttr_t attr;
+  osMessageQueueId_t qid;
+  cmsis_os2_msg_t msg;
+  uint8_t prio;
+  unsigned i;
+
+  /* [4.1.1] Creating the queue, a buffer too small is rejected.*/
+  test_set_step(1);
+  {
+    memset(&attr, 0, sizeof attr);
+    attr.cb_mem  = &qcb;
+    attr.cb_size = sizeof qcb;
+    attr.mq_mem  = qbuf;
+    attr.mq_size = sizeof qbuf - 1U;
+    test_assert(osMessageQueueNew(QUEUE_LEN, sizeof (cmsis_os2_msg_t), &attr) == NULL,
+                "created");
+    attr.mq_size = sizeof qbuf;
+    qid = osMessageQueueNew(QUEUE_LEN, sizeof (cmsis_os2_msg_t), &attr);
+    test_assert(qid != NULL, "queue not created");
+    test_assert(osMessageQueueGetCapacity(qid) == QUEUE_LEN, "wrong capacity");
+    test_assert(osMessageQueueGetMsgSize(qid) == sizeof (cmsis_os2_msg_t),
+                "wrong size");
+  }
+  test_end_step(1);
+
+  /* [4.1.2] Filling the queue.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < QUEUE_LEN; i++) {
+      msg_fill(&msg, i);
+      test_assert(osMessageQueuePut(qid, &msg, 0U, 0U) == osOK, "not queued");
+    }
+    test_assert(osMessageQueuePut(qid, &msg, 0U, 0U) == osErrorResource,
+                "queued");
+    test_assert(osMessageQueuePut(qid, &msg, 0U, 2U) == osErrorTimeout,
+                "queued");
+    test_assert(osMessageQueueGetCount(qid) == QUEUE_LEN, "wrong count");
+    test_assert(osMessageQueueGetSpace(qid) == 0U, "wrong space");
+  }
+  test_end_step(2);
+
+  /* [4.1.3] Emptying the queue, messages must be retrieved in order
+     and intact.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < QUEUE_LEN; i++) {
+      cmsis_os2_msg_t expected;
+
+      prio = 0xFFU;
+      test_assert(osMessageQueueGet(qid, &msg, &prio, 0U) == osOK, "no message");
+      msg_fill(&expected, i);
+      test_assert(memcmp(&msg, &expected, sizeof msg) == 0, "wrong message");
+      test_assert(prio == 0U, "wrong priority");
+    }
+    test_assert(osMessageQueueGet(qid, &msg, NULL, 0U) == osErrorResource,
+                "not empty");
+    test_assert(osMessageQueueGetSpace(qid) == QUEUE_LEN, "wrong space");
+    test_assert(osMessageQueueDelete(qid) == osOK, "not deleted");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_004_001 = {
+  "Static buffers",
+  NULL,
+  NULL,
+  cmsis_os2_test_004_001_execute
+};
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page cmsis_os2_test_004_002 [4.2] Priority messages
+ *
+ * <h2>Description</h2>
+ * Messages with non-zero priority are queued ahead of all the queued
+ * messages.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_HEAP == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.2.1] Queuing a normal message and two priority messages, the
+ *   retrieval order is checked.
+ * .
+ */
+
+static void cmsis_os2_test_004_002_execute(void) {
+  osMessageQueueId_t qid;
+  cmsis_os2_msg_t msg;
+
+  /* [4.2.1] Queuing a normal message and two priority messages, the
+     retrieval order is checked.*/
+  test_set_step(1);
+  {
+    qid = osMessageQueueNew(QUEUE_LEN, sizeof (cmsis_os2_msg_t), NULL);
+    test_assert(qid != NULL, "queue not created");
+    msg_fill(&msg, 0U);
+    (void) osMessageQueuePut(qid, &msg, 0U, 0U);
+    msg_fill(&msg, 1U);
+    (void) osMessageQueuePut(qid, &msg, 1U, 0U);
+    msg_fill(&msg, 2U);
+    (void) osMessageQueuePut(qid, &msg, 2U, 0U);
+    (void) osMessageQueueGet(qid, &msg, NULL, 0U);
+    test_assert(msg.seq == 2U, "wrong order");
+    (void) osMessageQueueGet(qid, &msg, NULL, 0U);
+    test_assert(msg.seq == 1U, "wrong order");
+    (void) osMessageQueueGet(qid, &msg, NULL, 0U);
+    test_assert(msg.seq == 0U, "wrong order");
+    test_assert(osMessageQueueDelete(qid) == osOK, "not deleted");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t cmsis_os2_test_004_002 = {
+  "Priority messages",
+  NULL,
+  NULL,
+  cmsis_os2_test_004_002_execute
+};
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page cmsis_os2_test_004_003 [4.3] Waiting threads
+ *
+ * <h2>Description</h2>
+ * A thread waits for a message on an empty queue, the message put by
+ * the test thread must be received intact.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_HEAP == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.3.1] Starting the thread then putting a message.
+ * .
+ */
+
+static void cmsis_os2_test_004_003_execute(void) {
+  osPriority_t prio = cmsis_os2_self_prio();
+  cmsis_os2_msg_t msg;
+
+  /* [4.3.1] Starting the thread then putting a message.*/
+  test_set_step(1);
+  {
+    qid = osMessageQueueNew(1U, sizeof (cmsis_os2_msg_t), NULL);
+    test_assert(qid != NULL, "queue not created");
+    (void) cmsis_os2_thread_new(0, get_thread, NULL, (osPriority_t)(prio + 1));
+    msg_fill(&msg, 7U);
+    test_assert(osMessageQueuePut(qid, &msg, 0U, osWaitForever) == osOK,
+                "not queued");
+    cmsis_os2_wait_threads();
+    test_assert_sequence("G", "invalid sequence");
+    test_assert(osMessageQueueDelete(qid) == osOK, "not deleted");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t cmsis_os2_test_004_003 = {
+  "Waiting threads",
+  NULL,
+  NULL,
+  cmsis_os2_test_004_003_execute
+};
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const cmsis_os2_test_sequence_004_array[] = {
+  &cmsis_os2_test_004_001,
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  &cmsis_os2_test_004_002,
+#endif
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  &cmsis_os2_test_004_003,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Message queues.
+ */
+const testsequence_t cmsis_os2_test_sequence_004 = {
+  "Message queues",
+  cmsis_os2_test_sequence_004_array
+};
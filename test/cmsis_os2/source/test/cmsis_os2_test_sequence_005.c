@@ -0,0 +1,333 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "cmsis_os2_test_root.h"
+
+/**
+ * @file    cmsis_os2_test_sequence_005.c
+ * @brief   Test Sequence 005 code.
+ *
+ * @page cmsis_os2_test_sequence_005 [5] Benchmarks
+ *
+ * File: @ref cmsis_os2_test_sequence_005.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the overhead of the CMSIS RTOS2 wrapper
+ * against the native RT calls, the scores are the operations performed
+ * in one second.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_HEAP == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage cmsis_os2_test_005_001
+ * - @subpage cmsis_os2_test_005_002
+ * - @subpage cmsis_os2_test_005_003
+ * .
+ */
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define BENCH_MSG_SIZE              32U
+
+static mutex_t mtx;
+static semaphore_t sem;
+static objects_fifo_t fifo;
+static ALIGNED_VAR(PORT_NATURAL_ALIGN) uint8_t fifo_objs[BENCH_MSG_SIZE];
+static msg_t fifo_msgs[1];
+static osMutexId_t mid;
+static osSemaphoreId_t sid;
+static osMessageQueueId_t qid;
+static uint8_t bench_msg[BENCH_MSG_SIZE];
+
+static void native_mutex(void) {
+
+  chMtxLock(&mtx);
+  chMtxUnlock(&mtx);
+}
+
+static void cmsis_mutex(void) {
+
+  (void) osMutexAcquire(mid, osWaitForever);
+  (void) osMutexRelease(mid);
+}
+
+static void native_semaphore(void) {
+
+  chSemSignal(&sem);
+  (void) chSemWait(&sem);
+}
+
+static void cmsis_semaphore(void) {
+
+  (void) osSemaphoreRelease(sid);
+  (void) osSemaphoreAcquire(sid, 0U);
+}
+
+static void native_queue(void) {
+  void *objp;
+
+  objp = chFifoTakeObjectTimeout(&fifo, TIME_IMMEDIATE);
+  memcpy(objp, bench_msg, BENCH_MSG_SIZE);
+  chFifoSendObject(&fifo, objp);
+  (void) chFifoReceiveObjectTimeout(&fifo, &objp, TIME_IMMEDIATE);
+  memcpy(bench_msg, objp, BENCH_MSG_SIZE);
+  chFifoReturnObject(&fifo, objp);
+}
+
+static void cmsis_queue(void) {
+
+  (void) osMessageQueuePut(qid, bench_msg, 0U, 0U);
+  (void) osMessageQueueGet(qid, bench_msg, NULL, 0U);
+}
+
+static void bench_setup(void) {
+
+  chMtxObjectInit(&mtx);
+  chSemObjectInit(&sem, (cnt_t)0);
+  chFifoObjectInit(&fifo, BENCH_MSG_SIZE, 1U, fifo_objs, fifo_msgs);
+  if (mid == NULL) {
+    mid = osMutexNew(NULL);
+    sid = osSemaphoreNew(1U, 0U, NULL);
+    qid = osMessageQueueNew(1U, BENCH_MSG_SIZE, NULL);
+  }
+}
+
+NOINLINE static uint32_t bench_run(void (*op)(void)) {
+  systime_t start, end;
+  uint32_t n = 0U;
+
+  bench_setup();
+  start = cmsis_os2_wait_tick();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    op();
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  return n;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page cmsis_os2_test_005_001 [5.1] Mutexes lock/unlock performance
+ *
+ * <h2>Description</h2>
+ * A mutex is locked and unlocked in a loop, no other threads are
+ * involved.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.1.1] The native lock and unlock operations are performed in a
+ *   one-second time window.
+ * - [5.1.2] The CMSIS lock and unlock operations are performed in a
+ *   one-second time window.
+ * - [5.1.3] The scores are printed.
+ * .
+ */
+
+static void cmsis_os2_test_005_001_execute(void) {
+  uint32_t n, c;
+
+  /* [5.1.1] The native lock and unlock operations are performed in a
+     one-second time window.*/
+  test_set_step(1);
+  {
+    n = bench_run(native_mutex);
+  }
+  test_end_step(1);
+
+  /* [5.1.2] The CMSIS lock and unlock operations are performed in a
+     one-second time window.*/
+  test_set_step(2);
+  {
+    c = bench_run(cmsis_mutex);
+  }
+  test_end_step(2);
+
+  /* [5.1.3] The scores are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Native: ");
+    test_printn(n);
+    test_println(" lock+unlock/S");
+    test_print("--- CMSIS : ");
+    test_printn(c);
+    test_println(" lock+unlock/S");
+    test_record_score(n, "lock+unlock/S (native)");
+    test_record_score(c, "lock+unlock/S (CMSIS)");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_005_001 = {
+  "Mutexes lock/unlock performance",
+  NULL,
+  NULL,
+  cmsis_os2_test_005_001_execute
+};
+
+/**
+ * @page cmsis_os2_test_005_002 [5.2] Semaphores signal/wait performance
+ *
+ * <h2>Description</h2>
+ * A semaphore is signaled and waited in a loop, no other threads are
+ * involved.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.2.1] The native signal and wait operations are performed in a
+ *   one-second time window.
+ * - [5.2.2] The CMSIS signal and wait operations are performed in a
+ *   one-second time window.
+ * - [5.2.3] The scores are printed.
+ * .
+ */
+
+static void cmsis_os2_test_005_002_execute(void) {
+  uint32_t n, c;
+
+  /* [5.2.1] The native signal and wait operations are performed in a
+     one-second time window.*/
+  test_set_step(1);
+  {
+    n = bench_run(native_semaphore);
+  }
+  test_end_step(1);
+
+  /* [5.2.2] The CMSIS signal and wait operations are performed in a
+     one-second time window.*/
+  test_set_step(2);
+  {
+    c = bench_run(cmsis_semaphore);
+  }
+  test_end_step(2);
+
+  /* [5.2.3] The scores are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Native: ");
+    test_printn(n);
+    test_println(" signal+wait/S");
+    test_print("--- CMSIS : ");
+    test_printn(c);
+    test_println(" signal+wait/S");
+    test_record_score(n, "signal+wait/S (native)");
+    test_record_score(c, "signal+wait/S (CMSIS)");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_005_002 = {
+  "Semaphores signal/wait performance",
+  NULL,
+  NULL,
+  cmsis_os2_test_005_002_execute
+};
+
+/**
+ * @page cmsis_os2_test_005_003 [5.3] Message queues put/get performance
+ *
+ * <h2>Description</h2>
+ * A 32 bytes message is put into a queue and retrieved in a loop, no
+ * other threads are involved. The native operations are performed on
+ * an objects FIFO.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.3.1] The native put and get operations are performed in a
+ *   one-second time window.
+ * - [5.3.2] The CMSIS put and get operations are performed in a
+ *   one-second time window.
+ * - [5.3.3] The scores are printed.
+ * .
+ */
+
+static void cmsis_os2_test_005_003_execute(void) {
+  uint32_t n, c;
+
+  /* [5.3.1] The native put and get operations are performed in a
+     one-second time window.*/
+  test_set_step(1);
+  {
+    n = bench_run(native_queue);
+  }
+  test_end_step(1);
+
+  /* [5.3.2] The CMSIS put and get operations are performed in a
+     one-second time window.*/
+  test_set_step(2);
+  {
+    c = bench_run(cmsis_queue);
+  }
+  test_end_step(2);
+
+  /* [5.3.3] The scores are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Native: ");
+    test_printn(n);
+    test_println(" put+get/S");
+    test_print("--- CMSIS : ");
+    test_printn(c);
+    test_println(" put+get/S");
+    test_record_score(n, "put+get/S (native)");
+    test_record_score(c, "put+get/S (CMSIS)");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t cmsis_os2_test_005_003 = {
+  "Message queues put/get performance",
+  NULL,
+  NULL,
+  cmsis_os2_test_005_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const cmsis_os2_test_sequence_005_array[] = {
+  &cmsis_os2_test_005_001,
+  &cmsis_os2_test_005_002,
+  &cmsis_os2_test_005_003,
+  NULL
+};
+
+/**
+ * @brief   Benchmarks.
+ */
+const testsequence_t cmsis_os2_test_sequence_005 = {
+  "Benchmarks",
+  cmsis_os2_test_sequence_005_array
+};
+
+#endif /* CH_CFG_USE_HEAP == TRUE */
@@ -239,6 +239,7 @@ static void corebmk_test_001_002_execute(void) {
     test_print("--- Time  : ");
     test_printn(msecs);
     test_println(" milliseconds");
+    test_record_score(msecs, "ms");
   }
   test_end_step(4);
 }
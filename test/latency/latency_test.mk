@@ -0,0 +1,10 @@
+# List of all the latency test files.
+TESTSRC += ${CHIBIOS}/test/latency/source/test/latency_test_root.c \
+           ${CHIBIOS}/test/latency/source/test/latency_test_sequence_001.c \
+           ${CHIBIOS}/test/latency/source/test/latency_test_sequence_002.c \
+           ${CHIBIOS}/test/latency/source/test/latency_test_sequence_003.c \
+           ${CHIBIOS}/test/latency/source/test/latency_test_sequence_004.c \
+           ${CHIBIOS}/test/latency/source/test/latency_test_sequence_005.c
+
+# Required include directories
+TESTINC += ${CHIBIOS}/test/latency/source/test
@@ -0,0 +1,315 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @mainpage Test Suite Specification
+ * Test suite for ChibiOS/RT latencies. The purpose of this suite is to
+ * measure end-to-end latency distributions of the kernel paths most
+ * relevant to real-time behavior: thread to thread wakeups, ISR to
+ * thread wakeups, timers and mutexes handoff. Samples are taken using
+ * the realtime counter and reported as histograms and percentiles, the
+ * unit is the realtime counter tick.
+ *
+ * <h2>Test Sequences</h2>
+ * - @subpage latency_test_sequence_001
+ * - @subpage latency_test_sequence_002
+ * - @subpage latency_test_sequence_003
+ * - @subpage latency_test_sequence_004
+ * - @subpage latency_test_sequence_005
+ * .
+ */
+
+/**
+ * @file    latency_test_root.c
+ * @brief   Test Suite root structures code.
+ */
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Array of test sequences.
+ */
+const testsequence_t * const latency_test_suite_array[] = {
+  &latency_test_sequence_001,
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+  &latency_test_sequence_002,
+#endif
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+  &latency_test_sequence_003,
+#endif
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+  &latency_test_sequence_004,
+#endif
+#if ((PORT_SUPPORTS_RT == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)) || defined(__DOXYGEN__)
+  &latency_test_sequence_005,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Test suite root structure.
+ */
+const testsuite_t latency_test_suite = {
+  "Latency Test Suite",
+  latency_test_suite_array
+};
+
+/*===========================================================================*/
+/* Shared code.                                                              */
+/*===========================================================================*/
+
+/*
+ * Global test buffer holding the threads working areas.
+ */
+static ALIGNED_VAR(PORT_WORKING_AREA_ALIGN)
+uint8_t latency_buffer[LATENCY_WA_SIZE * LATENCY_MAX_THREADS];
+
+/*
+ * Pointers to the spawned threads.
+ */
+thread_t *latency_threads[LATENCY_MAX_THREADS];
+
+/*
+ * Pointers to the working areas.
+ */
+void * ROMCONST latency_wa[LATENCY_MAX_THREADS] = {
+  latency_buffer + (LATENCY_WA_SIZE * 0),
+  latency_buffer + (LATENCY_WA_SIZE * 1),
+  latency_buffer + (LATENCY_WA_SIZE * 2),
+  latency_buffer + (LATENCY_WA_SIZE * 3)
+};
+
+/*
+ * Samples of the current test case.
+ */
+rtcnt_t latency_samples[LATENCY_SAMPLES];
+volatile unsigned latency_n;
+
+/*
+ * Start time of the measurement in progress.
+ */
+volatile rtcnt_t latency_t0;
+
+/*
+ * References used for ping-pong between the test thread and the thread
+ * being measured.
+ */
+thread_reference_t latency_ping_tr, latency_pong_tr;
+
+/*
+ * Discards the collected samples.
+ */
+void latency_reset(void) {
+
+  latency_n = 0U;
+}
+
+/*
+ * Stores a sample, samples exceeding the buffer size are ignored. It can
+ * be called from ISR context.
+ */
+void latency_record(rtcnt_t t) {
+
+  if (latency_n < LATENCY_SAMPLES) {
+    latency_samples[latency_n++] = t;
+  }
+}
+
+/*
+ * Converts the collected timestamps of a periodic event in the deviations
+ * of each period from the average period. The realtime counter frequency
+ * is not known here so the nominal period is measured over the whole run.
+ */
+void latency_jitter(void) {
+  unsigned i, n = latency_n;
+  rtcnt_t period;
+
+  if (n < 2U) {
+    latency_n = 0U;
+    return;
+  }
+
+  period = (rtcnt_t)((latency_samples[n - 1U] - latency_samples[0]) /
+                     (rtcnt_t)(n - 1U));
+  for (i = 0U; i < n - 1U; i++) {
+    rtcnt_t d = latency_samples[i + 1U] - latency_samples[i];
+
+    latency_samples[i] = d > period ? d - period : period - d;
+  }
+  latency_n = n - 1U;
+
+  test_print("--- Period  : ");
+  test_printn((uint32_t)period);
+  test_println(" ticks");
+}
+
+/*
+ * Prints the histogram and the percentiles of the collected samples, the
+ * histogram buckets are powers of two. The median, p99 and maximum are
+ * recorded as scores.
+ */
+void latency_report(void) {
+  unsigned i, j, n = latency_n;
+  uint32_t median, p99, max;
+
+  if (n == 0U) {
+    test_println("--- No samples");
+    return;
+  }
+
+  /* Insertion sort, the buffer is small.*/
+  for (i = 1U; i < n; i++) {
+    rtcnt_t t = latency_samples[i];
+
+    for (j = i; (j > 0U) && (latency_samples[j - 1U] > t); j--) {
+      latency_samples[j] = latency_samples[j - 1U];
+    }
+    latency_samples[j] = t;
+  }
+  median = (uint32_t)latency_samples[(n - 1U) / 2U];
+  p99    = (uint32_t)latency_samples[((n * 99U) + 99U) / 100U - 1U];
+  max    = (uint32_t)latency_samples[n - 1U];
+
+  test_print("--- Latency : min ");
+  test_printn((uint32_t)latency_samples[0]);
+  test_print(", median ");
+  test_printn(median);
+  test_print(", p99 ");
+  test_printn(p99);
+  test_print(", max ");
+  test_printn(max);
+  test_print(" ticks (");
+  test_printn(n);
+  test_println(" samples)");
+
+  i = 0U;
+  while (i < n) {
+    uint32_t lo, hi;
+
+    /* Bucket of the current sample, a zero upper bound means 2^32.*/
+    lo = 0U;
+    hi = 1U;
+    while ((hi <= (uint32_t)latency_samples[i]) && (hi != 0U)) {
+      lo = hi;
+      hi <<= 1;
+    }
+
+    j = i;
+    while ((j < n) && ((hi == 0U) || ((uint32_t)latency_samples[j] < hi))) {
+      j++;
+    }
+
+    test_print("---   [");
+    test_printn(lo);
+    test_print(", ");
+    if (hi == 0U) {
+      test_print("...");
+    }
+    else {
+      test_printn(hi);
+    }
+    test_print(") : ");
+    test_printn(j - i);
+    test_println("");
+    i = j;
+  }
+
+  test_record_score(median, "median ticks");
+  test_record_score(p99, "p99 ticks");
+  test_record_score(max, "max ticks");
+}
+
+/*
+ * Sets a termination request in all the test-spawned threads.
+ */
+void latency_terminate_threads(void) {
+  unsigned i;
+
+  for (i = 0; i < LATENCY_MAX_THREADS; i++)
+    if (latency_threads[i])
+      chThdTerminate(latency_threads[i]);
+}
+
+/*
+ * Waits for the completion of all the test-spawned threads.
+ */
+void latency_wait_threads(void) {
+  unsigned i;
+
+  for (i = 0; i < LATENCY_MAX_THREADS; i++)
+    if (latency_threads[i] != NULL) {
+      chThdWait(latency_threads[i]);
+      latency_threads[i] = NULL;
+    }
+}
+
+#if PORT_SUPPORTS_RT == TRUE
+/*
+ * Measured thread, records the time elapsed since latency_t0 each time it
+ * is resumed then resumes the test thread.
+ */
+static THD_FUNCTION(latency_pong_thread, arg) {
+  msg_t msg;
+
+  (void)arg;
+  chSysLock();
+  msg = chThdSuspendS(&latency_pong_tr);
+  while (msg == MSG_OK) {
+    latency_record(chSysGetRealtimeCounterX() - latency_t0);
+    chThdResumeI(&latency_ping_tr, MSG_OK);
+    msg = chThdSuspendS(&latency_pong_tr);
+  }
+  chSysUnlock();
+}
+
+/*
+ * Starts the measured thread and waits for it to be suspended, threads at
+ * lower or equal priority need the CPU in order to get there.
+ */
+void latency_pong_start(tprio_t prio) {
+  bool ready;
+
+  latency_threads[0] = chThdCreateStatic(latency_wa[0], LATENCY_WA_SIZE,
+                                         prio, latency_pong_thread, NULL);
+  do {
+    chSysLock();
+    ready = latency_pong_tr != NULL;
+    chSysUnlock();
+    if (!ready) {
+      chThdSleepMilliseconds(1);
+    }
+  } while (!ready);
+}
+
+/*
+ * Stops the measured thread and any other test-spawned thread.
+ */
+void latency_pong_stop(void) {
+
+  latency_terminate_threads();
+  chThdResume(&latency_pong_tr, MSG_RESET);
+  latency_wait_threads();
+}
+#endif
+
+#endif /* !defined(__DOXYGEN__) */
@@ -0,0 +1,110 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    latency_test_root.h
+ * @brief   Test Suite root structures header.
+ */
+
+#ifndef LATENCY_TEST_ROOT_H
+#define LATENCY_TEST_ROOT_H
+
+#include "ch_test.h"
+
+#include "latency_test_sequence_001.h"
+#include "latency_test_sequence_002.h"
+#include "latency_test_sequence_003.h"
+#include "latency_test_sequence_004.h"
+#include "latency_test_sequence_005.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testsuite_t latency_test_suite;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+/*
+ * Number of samples collected by each test case.
+ */
+#if !defined(LATENCY_SAMPLES)
+  #define LATENCY_SAMPLES           256
+#endif
+
+/*
+ * Maximum number of test threads.
+ */
+#define LATENCY_MAX_THREADS         4
+
+/*
+ * Stack size of test threads.
+ */
+#if !defined(LATENCY_STACK_SIZE)
+  #if defined(PORT_ARCHITECTURE_SIMIA32)
+    #define LATENCY_STACK_SIZE      512
+  #else
+    #define LATENCY_STACK_SIZE      192
+  #endif
+#endif
+
+/*
+ * Working Area size of test threads.
+ */
+#define LATENCY_WA_SIZE MEM_ALIGN_NEXT(THD_WORKING_AREA_SIZE(LATENCY_STACK_SIZE), \
+                                       PORT_WORKING_AREA_ALIGN)
+
+/*
+ * Number of scores recorded by latency_report().
+ */
+#define LATENCY_SCORES              3
+
+#if TEST_CFG_BENCHMARK_MAX_SCORES < LATENCY_SCORES
+#error "TEST_CFG_BENCHMARK_MAX_SCORES too small for the latency test suite"
+#endif
+
+extern thread_t *latency_threads[LATENCY_MAX_THREADS];
+extern void * ROMCONST latency_wa[LATENCY_MAX_THREADS];
+extern rtcnt_t latency_samples[LATENCY_SAMPLES];
+extern volatile unsigned latency_n;
+extern volatile rtcnt_t latency_t0;
+extern thread_reference_t latency_ping_tr, latency_pong_tr;
+
+void latency_reset(void);
+void latency_record(rtcnt_t t);
+void latency_jitter(void);
+void latency_report(void);
+void latency_terminate_threads(void);
+void latency_wait_threads(void);
+#if PORT_SUPPORTS_RT == TRUE
+void latency_pong_start(tprio_t prio);
+void latency_pong_stop(void);
+#endif
+
+#endif /* !defined(__DOXYGEN__) */
+
+#endif /* LATENCY_TEST_ROOT_H */
@@ -0,0 +1,180 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+/**
+ * @file    latency_test_sequence_001.c
+ * @brief   Test Sequence 001 code.
+ *
+ * @page latency_test_sequence_001 [1] Information
+ *
+ * File: @ref latency_test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence reports information about the execution environment
+ * and the resolution of the measurements.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage latency_test_001_001
+ * - @subpage latency_test_001_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page latency_test_001_001 [1.1] Port Info
+ *
+ * <h2>Description</h2>
+ * Port-related info are reported.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.1.1] Prints the port and measurement information.
+ * .
+ */
+
+static void latency_test_001_001_execute(void) {
+
+  /* [1.1.1] Prints the port and measurement information.*/
+  test_set_step(1);
+  {
+#if defined(PORT_ARCHITECTURE_NAME)
+    test_print("--- Architecture:                       ");
+    test_println(PORT_ARCHITECTURE_NAME);
+#endif
+#if defined(PORT_CORE_VARIANT_NAME)
+    test_print("--- Core Variant:                       ");
+    test_println(PORT_CORE_VARIANT_NAME);
+#endif
+#if defined(PORT_COMPILER_NAME)
+    test_print("--- Compiler:                           ");
+    test_println(PORT_COMPILER_NAME);
+#endif
+#if defined(PORT_INFO)
+    test_print("--- Port Info:                          ");
+    test_println(PORT_INFO);
+#endif
+    test_print("--- Realtime counter:                   ");
+#if PORT_SUPPORTS_RT == TRUE
+    test_println("available");
+#else
+    test_println("not available, latencies not measured");
+#endif
+    test_print("--- Samples per test:                   ");
+    test_printn(LATENCY_SAMPLES);
+    test_println("");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t latency_test_001_001 = {
+  "Port Info",
+  NULL,
+  NULL,
+  latency_test_001_001_execute
+};
+
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page latency_test_001_002 [1.2] Realtime counter overhead
+ *
+ * <h2>Description</h2>
+ * The realtime counter is read twice in a row, the difference is the
+ * floor of all the measurements.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - PORT_SUPPORTS_RT == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [1.2.1] The counter is read twice in a row, the operation is
+ *   repeated for each sample.
+ * - [1.2.2] The distribution is printed.
+ * .
+ */
+
+static void latency_test_001_002_setup(void) {
+  latency_reset();
+}
+
+static void latency_test_001_002_execute(void) {
+
+  /* [1.2.1] The counter is read twice in a row, the operation is
+     repeated for each sample.*/
+  test_set_step(1);
+  {
+    unsigned i;
+
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+      rtcnt_t t;
+
+      chSysLock();
+      t = chSysGetRealtimeCounterX();
+      latency_record(chSysGetRealtimeCounterX() - t);
+      chSysUnlock();
+    }
+  }
+  test_end_step(1);
+
+  /* [1.2.2] The distribution is printed.*/
+  test_set_step(2);
+  {
+    latency_report();
+  }
+  test_end_step(2);
+}
+
+static const testcase_t latency_test_001_002 = {
+  "Realtime counter overhead",
+  latency_test_001_002_setup,
+  NULL,
+  latency_test_001_002_execute
+};
+#endif /* PORT_SUPPORTS_RT == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const latency_test_sequence_001_array[] = {
+  &latency_test_001_001,
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+  &latency_test_001_002,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Information.
+ */
+const testsequence_t latency_test_sequence_001 = {
+  "Information",
+  latency_test_sequence_001_array
+};
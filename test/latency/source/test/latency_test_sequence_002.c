@@ -0,0 +1,265 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+/**
+ * @file    latency_test_sequence_002.c
+ * @brief   Test Sequence 002 code.
+ *
+ * @page latency_test_sequence_002 [2] Thread to thread latency
+ *
+ * File: @ref latency_test_sequence_002.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the time from a thread waking up another
+ * thread to the woken thread running, for various priority gaps
+ * between the two threads.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - PORT_SUPPORTS_RT == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage latency_test_002_001
+ * - @subpage latency_test_002_002
+ * - @subpage latency_test_002_003
+ * .
+ */
+
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/*
+ * Resumes the measured thread and suspends until it has run.
+ */
+static void handoff_loop(void) {
+  unsigned i;
+
+  for (i = 0; i < LATENCY_SAMPLES; i++) {
+    chSysLock();
+    latency_t0 = chSysGetRealtimeCounterX();
+    chThdResumeI(&latency_pong_tr, MSG_OK);
+    (void) chThdSuspendS(&latency_ping_tr);
+    chSysUnlock();
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page latency_test_002_001 [2.1] Wakeup of an higher priority thread
+ *
+ * <h2>Description</h2>
+ * A thread with priority one level higher than the test thread is
+ * resumed, the time until the woken thread runs is measured. This is
+ * the preemption path.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.1.1] The measured thread is started at an higher priority than
+ *   the current thread.
+ * - [2.1.2] The thread is resumed with immediate rescheduling, the
+ *   operation is repeated for each sample.
+ * - [2.1.3] The distribution is printed.
+ * .
+ */
+
+static void latency_test_002_001_setup(void) {
+  latency_reset();
+}
+
+static void latency_test_002_001_execute(void) {
+
+  /* [2.1.1] The measured thread is started at an higher priority than
+     the current thread.*/
+  test_set_step(1);
+  {
+    latency_pong_start(chThdGetPriorityX() + 1);
+  }
+  test_end_step(1);
+
+  /* [2.1.2] The thread is resumed with immediate rescheduling, the
+     operation is repeated for each sample.*/
+  test_set_step(2);
+  {
+    unsigned i;
+
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+      chSysLock();
+      latency_t0 = chSysGetRealtimeCounterX();
+      chThdResumeS(&latency_pong_tr, MSG_OK);
+      chSysUnlock();
+    }
+    latency_pong_stop();
+  }
+  test_end_step(2);
+
+  /* [2.1.3] The distribution is printed.*/
+  test_set_step(3);
+  {
+    latency_report();
+  }
+  test_end_step(3);
+}
+
+static const testcase_t latency_test_002_001 = {
+  "Wakeup of an higher priority thread",
+  latency_test_002_001_setup,
+  NULL,
+  latency_test_002_001_execute
+};
+
+/**
+ * @page latency_test_002_002 [2.2] Handoff to a thread with the same priority
+ *
+ * <h2>Description</h2>
+ * A thread with the same priority of the test thread is resumed and
+ * the test thread suspends, the time until the woken thread runs is
+ * measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.2.1] The measured thread is started at the same priority of the
+ *   current thread.
+ * - [2.2.2] The thread is resumed then the current thread suspends,
+ *   the operation is repeated for each sample.
+ * - [2.2.3] The distribution is printed.
+ * .
+ */
+
+static void latency_test_002_002_setup(void) {
+  latency_reset();
+}
+
+static void latency_test_002_002_execute(void) {
+
+  /* [2.2.1] The measured thread is started at the same priority of the
+     current thread.*/
+  test_set_step(1);
+  {
+    latency_pong_start(chThdGetPriorityX());
+  }
+  test_end_step(1);
+
+  /* [2.2.2] The thread is resumed then the current thread suspends,
+     the operation is repeated for each sample.*/
+  test_set_step(2);
+  {
+    handoff_loop();
+    latency_pong_stop();
+  }
+  test_end_step(2);
+
+  /* [2.2.3] The distribution is printed.*/
+  test_set_step(3);
+  {
+    latency_report();
+  }
+  test_end_step(3);
+}
+
+static const testcase_t latency_test_002_002 = {
+  "Handoff to a thread with the same priority",
+  latency_test_002_002_setup,
+  NULL,
+  latency_test_002_002_execute
+};
+
+/**
+ * @page latency_test_002_003 [2.3] Handoff to a lower priority thread
+ *
+ * <h2>Description</h2>
+ * A thread with priority one level lower than the test thread is
+ * resumed and the test thread suspends, the time until the woken
+ * thread runs is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.3.1] The measured thread is started at a lower priority than
+ *   the current thread.
+ * - [2.3.2] The thread is resumed then the current thread suspends,
+ *   the operation is repeated for each sample.
+ * - [2.3.3] The distribution is printed.
+ * .
+ */
+
+static void latency_test_002_003_setup(void) {
+  latency_reset();
+}
+
+static void latency_test_002_003_execute(void) {
+
+  /* [2.3.1] The measured thread is started at a lower priority than
+     the current thread.*/
+  test_set_step(1);
+  {
+    latency_pong_start(chThdGetPriorityX() - 1);
+  }
+  test_end_step(1);
+
+  /* [2.3.2] The thread is resumed then the current thread suspends,
+     the operation is repeated for each sample.*/
+  test_set_step(2);
+  {
+    handoff_loop();
+    latency_pong_stop();
+  }
+  test_end_step(2);
+
+  /* [2.3.3] The distribution is printed.*/
+  test_set_step(3);
+  {
+    latency_report();
+  }
+  test_end_step(3);
+}
+
+static const testcase_t latency_test_002_003 = {
+  "Handoff to a lower priority thread",
+  latency_test_002_003_setup,
+  NULL,
+  latency_test_002_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const latency_test_sequence_002_array[] = {
+  &latency_test_002_001,
+  &latency_test_002_002,
+  &latency_test_002_003,
+  NULL
+};
+
+/**
+ * @brief   Thread to thread latency.
+ */
+const testsequence_t latency_test_sequence_002 = {
+  "Thread to thread latency",
+  latency_test_sequence_002_array
+};
+
+#endif /* PORT_SUPPORTS_RT == TRUE */
@@ -0,0 +1,231 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+/**
+ * @file    latency_test_sequence_003.c
+ * @brief   Test Sequence 003 code.
+ *
+ * @page latency_test_sequence_003 [3] ISR to thread latency
+ *
+ * File: @ref latency_test_sequence_003.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the time from an ISR waking up a thread to
+ * the woken thread running. The ISR is a virtual timer callback so the
+ * measurement is available on all ports.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - PORT_SUPPORTS_RT == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage latency_test_003_001
+ * - @subpage latency_test_003_002
+ * .
+ */
+
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static virtual_timer_t vt;
+
+static void wakeup_cb(virtual_timer_t *vtp, void *p) {
+
+  (void)vtp;
+  (void)p;
+
+  chSysLockFromISR();
+  latency_t0 = chSysGetRealtimeCounterX();
+  chThdResumeI(&latency_pong_tr, MSG_OK);
+  chSysUnlockFromISR();
+}
+
+static THD_FUNCTION(busy_thread, p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+/*
+ * Arms the timer and suspends until the measured thread has run.
+ */
+static void isr_loop(void) {
+  unsigned i;
+
+  for (i = 0; i < LATENCY_SAMPLES; i++) {
+    chSysLock();
+    chVTSetI(&vt, TIME_MS2I(1), wakeup_cb, NULL);
+    (void) chThdSuspendS(&latency_ping_tr);
+    chSysUnlock();
+  }
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page latency_test_003_001 [3.1] Wakeup from idle
+ *
+ * <h2>Description</h2>
+ * A thread is resumed by a timer ISR while the system is idle, the
+ * time from the ISR to the woken thread running is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.1.1] The measured thread is started at an higher priority than
+ *   the current thread.
+ * - [3.1.2] The timer is armed and the current thread suspends, the
+ *   operation is repeated for each sample.
+ * - [3.1.3] The distribution is printed.
+ * .
+ */
+
+static void latency_test_003_001_setup(void) {
+  latency_reset();
+  chVTObjectInit(&vt);
+}
+
+static void latency_test_003_001_execute(void) {
+
+  /* [3.1.1] The measured thread is started at an higher priority than
+     the current thread.*/
+  test_set_step(1);
+  {
+    latency_pong_start(chThdGetPriorityX() + 1);
+  }
+  test_end_step(1);
+
+  /* [3.1.2] The timer is armed and the current thread suspends, the
+     operation is repeated for each sample.*/
+  test_set_step(2);
+  {
+    isr_loop();
+    latency_pong_stop();
+  }
+  test_end_step(2);
+
+  /* [3.1.3] The distribution is printed.*/
+  test_set_step(3);
+  {
+    latency_report();
+  }
+  test_end_step(3);
+}
+
+static const testcase_t latency_test_003_001 = {
+  "Wakeup from idle",
+  latency_test_003_001_setup,
+  NULL,
+  latency_test_003_001_execute
+};
+
+/**
+ * @page latency_test_003_002 [3.2] Preemption of busy threads
+ *
+ * <h2>Description</h2>
+ * A thread is resumed by a timer ISR while three lower priority
+ * threads are running, the time from the ISR to the woken thread
+ * running is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.2.1] The measured thread is started at an higher priority than
+ *   the current thread, three busy threads are started at a lower
+ *   priority.
+ * - [3.2.2] The timer is armed and the current thread suspends, the
+ *   operation is repeated for each sample.
+ * - [3.2.3] The distribution is printed.
+ * .
+ */
+
+static void latency_test_003_002_setup(void) {
+  latency_reset();
+  chVTObjectInit(&vt);
+}
+
+static void latency_test_003_002_execute(void) {
+
+  /* [3.2.1] The measured thread is started at an higher priority than
+     the current thread, three busy threads are started at a lower
+     priority.*/
+  test_set_step(1);
+  {
+    tprio_t prio = chThdGetPriorityX();
+
+    latency_pong_start(prio + 1);
+    latency_threads[1] = chThdCreateStatic(latency_wa[1], LATENCY_WA_SIZE, prio - 1, busy_thread, NULL);
+    latency_threads[2] = chThdCreateStatic(latency_wa[2], LATENCY_WA_SIZE, prio - 1, busy_thread, NULL);
+    latency_threads[3] = chThdCreateStatic(latency_wa[3], LATENCY_WA_SIZE, prio - 1, busy_thread, NULL);
+  }
+  test_end_step(1);
+
+  /* [3.2.2] The timer is armed and the current thread suspends, the
+     operation is repeated for each sample.*/
+  test_set_step(2);
+  {
+    isr_loop();
+    latency_pong_stop();
+  }
+  test_end_step(2);
+
+  /* [3.2.3] The distribution is printed.*/
+  test_set_step(3);
+  {
+    latency_report();
+  }
+  test_end_step(3);
+}
+
+static const testcase_t latency_test_003_002 = {
+  "Preemption of busy threads",
+  latency_test_003_002_setup,
+  NULL,
+  latency_test_003_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const latency_test_sequence_003_array[] = {
+  &latency_test_003_001,
+  &latency_test_003_002,
+  NULL
+};
+
+/**
+ * @brief   ISR to thread latency.
+ */
+const testsequence_t latency_test_sequence_003 = {
+  "ISR to thread latency",
+  latency_test_sequence_003_array
+};
+
+#endif /* PORT_SUPPORTS_RT == TRUE */
@@ -0,0 +1,190 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+/**
+ * @file    latency_test_sequence_004.c
+ * @brief   Test Sequence 004 code.
+ *
+ * @page latency_test_sequence_004 [4] Timers jitter
+ *
+ * File: @ref latency_test_sequence_004.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the deviation of periodic events from their
+ * average period. The first period is aligned to a system tick.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - PORT_SUPPORTS_RT == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage latency_test_004_001
+ * - @subpage latency_test_004_002
+ * .
+ */
+
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static virtual_timer_t vt;
+
+static void tick_cb(virtual_timer_t *vtp, void *p) {
+
+  (void)vtp;
+  (void)p;
+
+  chSysLockFromISR();
+  latency_record(chSysGetRealtimeCounterX());
+  if (latency_n >= LATENCY_SAMPLES) {
+    chThdResumeI(&latency_ping_tr, MSG_OK);
+  }
+  chSysUnlockFromISR();
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page latency_test_004_001 [4.1] Periodic thread
+ *
+ * <h2>Description</h2>
+ * The test thread wakes up every millisecond using
+ * chThdSleepUntilWindowed(), the deviation of each period is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [4.1.1] The wakeup time is sampled for each period.
+ * - [4.1.2] The distribution is printed.
+ * .
+ */
+
+static void latency_test_004_001_setup(void) {
+  latency_reset();
+}
+
+static void latency_test_004_001_execute(void) {
+
+  /* [4.1.1] The wakeup time is sampled for each period.*/
+  test_set_step(1);
+  {
+    unsigned i;
+    systime_t time;
+
+    chThdSleep((sysinterval_t)1);
+    time = chVTGetSystemTime();
+    for (i = 0; i < LATENCY_SAMPLES; i++) {
+      time = chThdSleepUntilWindowed(time, chTimeAddX(time, TIME_MS2I(1)));
+      latency_record(chSysGetRealtimeCounterX());
+    }
+    latency_jitter();
+  }
+  test_end_step(1);
+
+  /* [4.1.2] The distribution is printed.*/
+  test_set_step(2);
+  {
+    latency_report();
+  }
+  test_end_step(2);
+}
+
+static const testcase_t latency_test_004_001 = {
+  "Periodic thread",
+  latency_test_004_001_setup,
+  NULL,
+  latency_test_004_001_execute
+};
+
+/**
+ * @page latency_test_004_002 [4.2] Continuous virtual timer
+ *
+ * <h2>Description</h2>
+ * A continuous virtual timer is triggered every millisecond, the
+ * deviation of each period of the callback is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [4.2.1] The timer is started and the current thread suspends until
+ *   all samples have been taken.
+ * - [4.2.2] The distribution is printed.
+ * .
+ */
+
+static void latency_test_004_002_setup(void) {
+  latency_reset();
+  chVTObjectInit(&vt);
+}
+
+static void latency_test_004_002_execute(void) {
+
+  /* [4.2.1] The timer is started and the current thread suspends until
+     all samples have been taken.*/
+  test_set_step(1);
+  {
+    chThdSleep((sysinterval_t)1);
+    chSysLock();
+    chVTSetContinuousI(&vt, TIME_MS2I(1), tick_cb, NULL);
+    (void) chThdSuspendS(&latency_ping_tr);
+    chVTResetI(&vt);
+    chSysUnlock();
+    latency_jitter();
+  }
+  test_end_step(1);
+
+  /* [4.2.2] The distribution is printed.*/
+  test_set_step(2);
+  {
+    latency_report();
+  }
+  test_end_step(2);
+}
+
+static const testcase_t latency_test_004_002 = {
+  "Continuous virtual timer",
+  latency_test_004_002_setup,
+  NULL,
+  latency_test_004_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const latency_test_sequence_004_array[] = {
+  &latency_test_004_001,
+  &latency_test_004_002,
+  NULL
+};
+
+/**
+ * @brief   Timers jitter.
+ */
+const testsequence_t latency_test_sequence_004 = {
+  "Timers jitter",
+  latency_test_sequence_004_array
+};
+
+#endif /* PORT_SUPPORTS_RT == TRUE */
@@ -0,0 +1,212 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "latency_test_root.h"
+
+/**
+ * @file    latency_test_sequence_005.c
+ * @brief   Test Sequence 005 code.
+ *
+ * @page latency_test_sequence_005 [5] Mutex handoff latency
+ *
+ * File: @ref latency_test_sequence_005.c
+ *
+ * <h2>Description</h2>
+ * This sequence measures the time from a thread unlocking a mutex to
+ * the next owner running.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (PORT_SUPPORTS_RT == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage latency_test_005_001
+ * - @subpage latency_test_005_002
+ * .
+ */
+
+#if ((PORT_SUPPORTS_RT == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static mutex_t mtx;
+static thread_reference_t trs[LATENCY_MAX_THREADS];
+
+static THD_FUNCTION(waiter_thread, p) {
+  thread_reference_t *trp = (thread_reference_t *)p;
+  msg_t msg;
+
+  chSysLock();
+  msg = chThdSuspendS(trp);
+  chSysUnlock();
+  while (msg == MSG_OK) {
+    chMtxLock(&mtx);
+    latency_record(chSysGetRealtimeCounterX() - latency_t0);
+    latency_t0 = chSysGetRealtimeCounterX();
+    chMtxUnlock(&mtx);
+    chSysLock();
+    msg = chThdSuspendS(trp);
+    chSysUnlock();
+  }
+}
+
+/*
+ * Starts "n" waiters at increasing priorities above the current thread,
+ * each round the waiters queue on the locked mutex then it is unlocked.
+ */
+static void handoff_test(unsigned n) {
+  unsigned i;
+
+  for (i = 0; i < n; i++) {
+    latency_threads[i] = chThdCreateStatic(latency_wa[i], LATENCY_WA_SIZE,
+                                           chThdGetPriorityX() + 1 + i,
+                                           waiter_thread, &trs[i]);
+  }
+  while (latency_n < LATENCY_SAMPLES) {
+    chMtxLock(&mtx);
+    for (i = 0; i < n; i++) {
+      chThdResume(&trs[i], MSG_OK);
+    }
+    latency_t0 = chSysGetRealtimeCounterX();
+    chMtxUnlock(&mtx);
+  }
+  for (i = 0; i < n; i++) {
+    chThdResume(&trs[i], MSG_RESET);
+  }
+  latency_wait_threads();
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page latency_test_005_001 [5.1] Handoff to a single waiter
+ *
+ * <h2>Description</h2>
+ * An higher priority thread waits on a mutex owned by the test thread,
+ * the time from the unlock to the waiter running is measured.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.1.1] One waiter is started, the mutex is handed off for each
+ *   sample.
+ * - [5.1.2] The distribution is printed.
+ * .
+ */
+
+static void latency_test_005_001_setup(void) {
+  latency_reset();
+  chMtxObjectInit(&mtx);
+}
+
+static void latency_test_005_001_execute(void) {
+
+  /* [5.1.1] One waiter is started, the mutex is handed off for each
+     sample.*/
+  test_set_step(1);
+  {
+    handoff_test(1);
+  }
+  test_end_step(1);
+
+  /* [5.1.2] The distribution is printed.*/
+  test_set_step(2);
+  {
+    latency_report();
+  }
+  test_end_step(2);
+}
+
+static const testcase_t latency_test_005_001 = {
+  "Handoff to a single waiter",
+  latency_test_005_001_setup,
+  NULL,
+  latency_test_005_001_execute
+};
+
+/**
+ * @page latency_test_005_002 [5.2] Handoff under contention
+ *
+ * <h2>Description</h2>
+ * Three threads at different priorities wait on a mutex owned by the
+ * test thread, the mutex is passed along the chain of waiters and each
+ * handoff is measured. Priority inheritance is involved while the
+ * waiters queue.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.2.1] Three waiters are started, the mutex is handed off along
+ *   the chain until all samples have been taken.
+ * - [5.2.2] The distribution is printed.
+ * .
+ */
+
+static void latency_test_005_002_setup(void) {
+  latency_reset();
+  chMtxObjectInit(&mtx);
+}
+
+static void latency_test_005_002_execute(void) {
+
+  /* [5.2.1] Three waiters are started, the mutex is handed off along
+     the chain until all samples have been taken.*/
+  test_set_step(1);
+  {
+    handoff_test(3);
+  }
+  test_end_step(1);
+
+  /* [5.2.2] The distribution is printed.*/
+  test_set_step(2);
+  {
+    latency_report();
+  }
+  test_end_step(2);
+}
+
+static const testcase_t latency_test_005_002 = {
+  "Handoff under contention",
+  latency_test_005_002_setup,
+  NULL,
+  latency_test_005_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const latency_test_sequence_005_array[] = {
+  &latency_test_005_001,
+  &latency_test_005_002,
+  NULL
+};
+
+/**
+ * @brief   Mutex handoff latency.
+ */
+const testsequence_t latency_test_sequence_005 = {
+  "Mutex handoff latency",
+  latency_test_sequence_005_array
+};
+
+#endif /* (PORT_SUPPORTS_RT == TRUE) && (CH_CFG_USE_MUTEXES == TRUE) */
@@ -139,15 +139,13 @@ static void nasa_osal_test_004_001_execute(void) {
   test_set_step(6);
   {
     int32 err;
-    uint32 bsid1; /*, bsid2;*/
+    uint32 bsid1, bsid2;
 
     err = OS_BinSemCreate(&bsid1, "my semaphore", 0, 0);
     test_assert(err == OS_SUCCESS, "semaphore creation failed");
 
-#if 0 /* Semaphore name currently not implemented.*/
     err = OS_BinSemCreate(&bsid2, "my semaphore", 0, 0);
     test_assert(err == OS_ERR_NAME_TAKEN, "name conflict not detected");
-#endif
 
     err = OS_BinSemDelete(bsid1);
     test_assert(err == OS_SUCCESS, "semaphore deletion failed");
@@ -169,6 +169,7 @@ static void nil_test_008_001_execute(void) {
     test_print(" msgs/S, ");
     test_printn(n << 1);
     test_println(" ctxswc/S");
+    test_record_score(n, "msgs/S");
   }
   test_end_step(3);
 }
@@ -242,6 +243,7 @@ static void nil_test_008_002_execute(void) {
     test_print(" msgs/S, ");
     test_printn(n << 1);
     test_println(" ctxswc/S");
+    test_record_score(n, "msgs/S");
   }
   test_end_step(3);
 }
@@ -329,6 +331,7 @@ static void nil_test_008_003_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 2);
     test_println(" ctxswc/S");
+    test_record_score(n * 2, "ctxswc/S");
   }
   test_end_step(4);
 }
@@ -392,6 +395,7 @@ static void nil_test_008_004_execute(void) {
     test_print("--- Score : ");
     test_printn(n);
     test_println(" threads/S");
+    test_record_score(n, "threads/S");
   }
   test_end_step(2);
 }
@@ -456,6 +460,7 @@ static void nil_test_008_005_execute(void) {
     test_print("--- Score : ");
     test_printn(n);
     test_println(" threads/S");
+    test_record_score(n, "threads/S");
   }
   test_end_step(2);
 }
@@ -529,6 +534,7 @@ static void nil_test_008_006_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 4);
     test_println(" wait+signal/S");
+    test_record_score(n * 4, "wait+signal/S");
   }
   test_end_step(2);
 }
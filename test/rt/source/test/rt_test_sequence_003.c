@@ -32,6 +32,7 @@
  * <h2>Test Cases</h2>
  * - @subpage rt_test_003_001
  * - @subpage rt_test_003_002
+ * - @subpage rt_test_003_003
  * .
  */
 
@@ -41,6 +42,12 @@
 
 #include "ch.h"
 
+static void vt_store_time(virtual_timer_t *vtp, void *p) {
+
+  (void)vtp;
+  *(systime_t *)p = chVTGetSystemTimeX();
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -153,6 +160,60 @@ static const testcase_t rt_test_003_002 = {
   rt_test_003_002_execute
 };
 
+/**
+ * @page rt_test_003_003 [3.3] Virtual timers coalescing
+ *
+ * <h2>Description</h2>
+ * The functionality of the API @p chVTDoSetWithSlackI() is tested,
+ * timers with a deadline tolerance are expected to be aligned to armed
+ * timers expiring within their window.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.3.1] Arming a reference timer, a timer whose window contains
+ *   the reference deadline and a timer whose window does not.
+ * - [3.3.2] Waiting for the timers to expire then checking that only
+ *   the timer with a matching window has been coalesced.
+ * .
+ */
+
+static void rt_test_003_003_execute(void) {
+  static virtual_timer_t vt1, vt2, vt3;
+  systime_t t1, t2, t3;
+
+  /* [3.3.1] Arming a reference timer, a timer whose window contains
+     the reference deadline and a timer whose window does not.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    chVTDoSetI(&vt1, TIME_MS2I(100), vt_store_time, (void *)&t1);
+    chVTDoSetWithSlackI(&vt2, TIME_MS2I(80), TIME_MS2I(40),
+                        vt_store_time, (void *)&t2);
+    chVTDoSetWithSlackI(&vt3, TIME_MS2I(40), TIME_MS2I(10),
+                        vt_store_time, (void *)&t3);
+    chSysUnlock();
+  }
+  test_end_step(1);
+
+  /* [3.3.2] Waiting for the timers to expire then checking that only
+     the timer with a matching window has been coalesced.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(150);
+    test_assert(!chVTIsArmed(&vt1) && !chVTIsArmed(&vt2) && !chVTIsArmed(&vt3),
+                "timer still armed");
+    test_assert(t2 == t1, "not coalesced");
+    test_assert(chTimeDiffX(t3, t1) > (sysinterval_t)0, "wrongly coalesced");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_003_003 = {
+  "Virtual timers coalescing",
+  NULL,
+  NULL,
+  rt_test_003_003_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -163,6 +224,7 @@ static const testcase_t rt_test_003_002 = {
 const testcase_t * const rt_test_sequence_003_array[] = {
   &rt_test_003_001,
   &rt_test_003_002,
+  &rt_test_003_003,
   NULL
 };
 
@@ -34,6 +34,11 @@
  * - @subpage rt_test_005_002
  * - @subpage rt_test_005_003
  * - @subpage rt_test_005_004
+ * - @subpage rt_test_005_005
+ * - @subpage rt_test_005_006
+ * - @subpage rt_test_005_007
+ * - @subpage rt_test_005_008
+ * - @subpage rt_test_005_009
  * .
  */
 
@@ -46,6 +51,91 @@ static THD_FUNCTION(thread, p) {
   test_emit_token(*(char *)p);
 }
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+static edf_stats_t edf_stats;
+
+static thread_t *edf_create_i(unsigned i, systime_t deadline,
+                              const char *tokenp) {
+  thread_descriptor_t td = THD_DESCRIPTOR("edf",
+                                          THD_WORKING_AREA_BASE(wa[i]),
+                                          THD_WORKING_AREA_BASE(wa[i]) +
+                                            (WA_SIZE / sizeof (stkalign_t)),
+                                          CH_CFG_EDF_PRIORITY,
+                                          thread,
+                                          (void *)tokenp);
+
+  return chThdStartJobI(chThdCreateI(&td), deadline);
+}
+
+static THD_FUNCTION(edf_busy_thread, p) {
+  systime_t start = chVTGetSystemTimeX();
+
+  chThdSetDeadline(chTimeAddX(start, TIME_MS2I(1000)));
+  while (chVTIsSystemTimeWithinX(start, chTimeAddX(start, TIME_MS2I(20)))) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(edf_release_thread, p) {
+  systime_t time = chVTGetSystemTimeX();
+
+  (void) chThdSleepUntilRelease(time, chTimeAddX(time, TIME_MS2I(10)),
+                                TIME_MS2I(5));
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(edf_jobs_thread, p) {
+  systime_t time = chVTGetSystemTimeX();
+
+  (void)p;
+
+  /* First job, completed in time.*/
+  chThdSetDeadline(chTimeAddX(time, TIME_MS2I(100)));
+
+  /* Second job, released after 10mS with a deadline of one tick and
+     completed late.*/
+  (void) chThdSleepUntilRelease(time, chTimeAddX(time, TIME_MS2I(10)),
+                                (sysinterval_t)1);
+  chThdSleep(TIME_MS2I(10));
+  chThdSetDeadline(chTimeAddX(chVTGetSystemTimeX(), TIME_MS2I(100)));
+  chThdGetDeadlineStats(chThdGetSelfX(), &edf_stats);
+}
+
+static THD_FUNCTION(edf_end_thread, p) {
+
+  /* Job completed in time then waiting like an event-driven thread, its
+     expired deadline must not be used when it is woken up.*/
+  chThdSetDeadline(chTimeAddX(chVTGetSystemTimeX(), TIME_MS2I(5)));
+  chThdEndJob();
+  chThdSleep(TIME_MS2I(10));
+  chThdGetDeadlineStats(chThdGetSelfX(), &edf_stats);
+  test_emit_token(*(char *)p);
+}
+#endif
+
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+NOINLINE static void stack_consume(void) {
+  volatile uint8_t buf[32];
+  unsigned i;
+
+  for (i = 0U; i < sizeof buf; i++) {
+    buf[i] = (uint8_t)i;
+  }
+}
+
+static THD_FUNCTION(stack_thread, p) {
+
+  (void)p;
+  stack_consume();
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(1);
+  }
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -339,6 +429,336 @@ static const testcase_t rt_test_005_004 = {
 };
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_005 [5.5] EDF band, deadline order
+ *
+ * <h2>Description</h2>
+ * Five threads are created in the EDF band and made ready atomically.
+ * The test expects the threads to perform their operations in deadline
+ * order regardless of the creation order, threads with the same
+ * deadline are expected to be executed in creation order.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.5.1] Creating 5 threads with pseudo-random deadlines, execution
+ *   sequence is tested.
+ * - [5.5.2] Creating 5 threads with the same deadline, execution
+ *   sequence is tested.
+ * - [5.5.3] Creating 5 threads with deadlines across the system time
+ *   wrap-around, execution sequence is tested.
+ * .
+ */
+
+static void rt_test_005_005_execute(void) {
+  systime_t time;
+
+  /* [5.5.1] Creating 5 threads with pseudo-random deadlines, execution
+     sequence is tested.*/
+  test_set_step(1);
+  {
+    time = chVTGetSystemTimeX();
+    chSysLock();
+    threads[0] = edf_create_i(0, chTimeAddX(time, TIME_MS2I(40)), "D");
+    threads[1] = edf_create_i(1, chTimeAddX(time, TIME_MS2I(10)), "A");
+    threads[2] = edf_create_i(2, chTimeAddX(time, TIME_MS2I(50)), "E");
+    threads[3] = edf_create_i(3, chTimeAddX(time, TIME_MS2I(30)), "C");
+    threads[4] = edf_create_i(4, chTimeAddX(time, TIME_MS2I(20)), "B");
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABCDE", "invalid sequence");
+  }
+  test_end_step(1);
+
+  /* [5.5.2] Creating 5 threads with the same deadline, execution
+     sequence is tested.*/
+  test_set_step(2);
+  {
+    time = chTimeAddX(chVTGetSystemTimeX(), TIME_MS2I(10));
+    chSysLock();
+    threads[0] = edf_create_i(0, time, "A");
+    threads[1] = edf_create_i(1, time, "B");
+    threads[2] = edf_create_i(2, time, "C");
+    threads[3] = edf_create_i(3, time, "D");
+    threads[4] = edf_create_i(4, time, "E");
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABCDE", "invalid sequence");
+  }
+  test_end_step(2);
+
+  /* [5.5.3] Creating 5 threads with deadlines across the system time
+     wrap-around, execution sequence is tested.*/
+  test_set_step(3);
+  {
+    time = (systime_t)0 - (systime_t)TIME_MS2I(25);
+    chSysLock();
+    threads[0] = edf_create_i(0, chTimeAddX(time, TIME_MS2I(40)), "D");
+    threads[1] = edf_create_i(1, chTimeAddX(time, TIME_MS2I(10)), "A");
+    threads[2] = edf_create_i(2, chTimeAddX(time, TIME_MS2I(50)), "E");
+    threads[3] = edf_create_i(3, chTimeAddX(time, TIME_MS2I(30)), "C");
+    threads[4] = edf_create_i(4, chTimeAddX(time, TIME_MS2I(20)), "B");
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABCDE", "invalid sequence");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_005_005 = {
+  "EDF band, deadline order",
+  NULL,
+  NULL,
+  rt_test_005_005_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_006 [5.6] EDF band, preemption on release
+ *
+ * <h2>Description</h2>
+ * A thread in the EDF band with a late deadline is executing when a
+ * thread with an earlier deadline is released by its timer. The test
+ * expects the released thread to preempt the running one.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.6.1] Starting a thread waiting for a release after 10mS with a
+ *   relative deadline of 5mS then a thread busy for 20mS with a
+ *   deadline of one second, execution sequence is tested.
+ * .
+ */
+
+static void rt_test_005_006_execute(void) {
+
+  /* [5.6.1] Starting a thread waiting for a release after 10mS with a
+     relative deadline of 5mS then a thread busy for 20mS with a
+     deadline of one second, execution sequence is tested.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, CH_CFG_EDF_PRIORITY,
+                                   edf_release_thread, "A");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, CH_CFG_EDF_PRIORITY,
+                                   edf_busy_thread, "B");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t rt_test_005_006 = {
+  "EDF band, preemption on release",
+  NULL,
+  NULL,
+  rt_test_005_006_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_007 [5.7] Deadline statistics
+ *
+ * <h2>Description</h2>
+ * A thread completes a job within its deadline and a job after its
+ * deadline, the deadline statistics of the thread are verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.7.1] Starting the thread and waiting for its termination.
+ * - [5.7.2] Checking the collected statistics.
+ * .
+ */
+
+static void rt_test_005_007_execute(void) {
+
+  /* [5.7.1] Starting the thread and waiting for its termination.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                   edf_jobs_thread, NULL);
+    test_wait_threads();
+  }
+  test_end_step(1);
+
+  /* [5.7.2] Checking the collected statistics.*/
+  test_set_step(2);
+  {
+    test_assert(edf_stats.jobs == (ucnt_t)2, "invalid jobs count");
+    test_assert(edf_stats.misses == (ucnt_t)1, "invalid misses count");
+    test_assert(edf_stats.lateness >= TIME_MS2I(10) - (sysinterval_t)1,
+                "invalid lateness");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_005_007 = {
+  "Deadline statistics",
+  NULL,
+  NULL,
+  rt_test_005_007_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_008 [5.8] EDF band, end of job
+ *
+ * <h2>Description</h2>
+ * A thread in the EDF band completes its job then sleeps like an
+ * event-driven thread, when woken up after its deadline it must be
+ * scheduled behind a thread with a job in progress. The deadline
+ * statistics of the thread are verified.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.8.1] Starting a thread ending its job and sleeping 10mS then a
+ *   thread busy for 20mS with a deadline of one second, execution
+ *   sequence is tested.
+ * - [5.8.2] Checking the collected statistics.
+ * .
+ */
+
+static void rt_test_005_008_execute(void) {
+
+  /* [5.8.1] Starting a thread ending its job and sleeping 10mS then a
+     thread busy for 20mS with a deadline of one second, execution
+     sequence is tested.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, CH_CFG_EDF_PRIORITY,
+                                   edf_end_thread, "B");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, CH_CFG_EDF_PRIORITY,
+                                   edf_busy_thread, "A");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(1);
+
+  /* [5.8.2] Checking the collected statistics.*/
+  test_set_step(2);
+  {
+    test_assert(edf_stats.jobs == (ucnt_t)1, "invalid jobs count");
+    test_assert(edf_stats.misses == (ucnt_t)0, "invalid misses count");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_005_008 = {
+  "EDF band, end of job",
+  NULL,
+  NULL,
+  rt_test_005_008_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_009 [5.9] Stack high-water mark
+ *
+ * <h2>Description</h2>
+ * The stack usage of a thread is measured through the registry before
+ * and after the thread runs, the usage must grow and stay within the
+ * working area. The main thread usage is checked if its stack
+ * boundaries are known.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_STACK_USAGE == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.9.1] A thread is created at lower priority and the measurement
+ *   is repeated until the whole working area is painted, the usage of
+ *   the thread initial context is recorded.
+ * - [5.9.2] The thread is allowed to run and use its stack, the usage
+ *   is measured again while the thread is sleeping.
+ * - [5.9.3] If the main thread stack boundaries are known and the main
+ *   thread is not the current one then its usage is measured twice,
+ *   the first measurement paints the stack.
+ * .
+ */
+
+static void rt_test_005_009_execute(void) {
+  size_t n1, n2;
+
+  /* [5.9.1] A thread is created at lower priority and the measurement
+     is repeated until the whole working area is painted, the usage of
+     the thread initial context is recorded.*/
+  test_set_step(1);
+  {
+    unsigned i;
+
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1,
+                                   stack_thread, NULL);
+    for (i = 0U; i <= (unsigned)(WA_SIZE / CH_DBG_STACK_USAGE_CHUNK); i++) {
+      (void) chRegGetThreadStackUsage(threads[0]);
+    }
+    n1 = chRegGetThreadStackUsage(threads[0]);
+    test_assert(n1 > (size_t)0, "not tracked");
+  }
+  test_end_step(1);
+
+  /* [5.9.2] The thread is allowed to run and use its stack, the usage
+     is measured again while the thread is sleeping.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(10);
+    n2 = chRegGetThreadStackUsage(threads[0]);
+    test_assert(n2 > n1, "usage not increased");
+    test_assert(n2 <= (size_t)WA_SIZE, "usage out of the working area");
+    chThdTerminate(threads[0]);
+    test_wait_threads();
+  }
+  test_end_step(2);
+
+  /* [5.9.3] If the main thread stack boundaries are known and the main
+     thread is not the current one then its usage is measured twice,
+     the first measurement paints the stack.*/
+  test_set_step(3);
+  {
+    if ((currcore->config->mainthread_end != NULL) &&
+        (chThdGetSelfX() != &currcore->mainthread)) {
+      (void) chRegGetThreadStackUsage(&currcore->mainthread);
+      test_assert(chRegGetThreadStackUsage(&currcore->mainthread) > (size_t)0,
+                  "main thread not tracked");
+    }
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_005_009 = {
+  "Stack high-water mark",
+  NULL,
+  NULL,
+  rt_test_005_009_execute
+};
+#endif /* CH_DBG_STACK_USAGE == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -352,6 +772,21 @@ const testcase_t * const rt_test_sequence_005_array[] = {
   &rt_test_005_003,
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   &rt_test_005_004,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_005,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_006,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_007,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_008,
+#endif
+#if (CH_DBG_STACK_USAGE == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_009,
 #endif
   NULL
 };
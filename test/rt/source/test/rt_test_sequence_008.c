@@ -45,6 +45,7 @@
  * - @subpage rt_test_008_007
  * - @subpage rt_test_008_008
  * - @subpage rt_test_008_009
+ * - @subpage rt_test_008_010
  * .
  */
 
@@ -197,6 +198,17 @@ static THD_FUNCTION(thread4B, p) {
   chSysUnlock();
 }
 
+static THD_FUNCTION(thread10, p) {
+
+  if (chMtxLockTimeout(&m1, TIME_MS2I(50)) == MSG_OK) {
+    chMtxUnlock(&m1);
+    test_emit_token(*(char *)p);
+  }
+  else {
+    test_emit_token('T');
+  }
+}
+
 #if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
 static THD_FUNCTION(thread6, p) {
 
@@ -1078,6 +1090,91 @@ static const testcase_t rt_test_008_009 = {
 };
 #endif /* CH_CFG_USE_CONDVARS == TRUE */
 
+/**
+ * @page rt_test_008_010 [8.10] Mutex lock with timeout
+ *
+ * <h2>Description</h2>
+ * The priority inheritance protocol is tested on mutexes locked with
+ * timeout. The priority of the owner must be boosted while a thread is
+ * waiting and restored when the wait times out.
+ *
+ * <h2>Test Steps</h2>
+ * - [8.10.1] Reading current base priority and locking M1.
+ * - [8.10.2] Thread A is created at priority P(+1), it waits on M1
+ *   with timeout and boosts the owner priority to P(+1).
+ * - [8.10.3] Waiting for thread A to time out, the owner priority must
+ *   go back to P.
+ * - [8.10.4] Thread B is created at priority P(+1), it waits on M1
+ *   with timeout. Unlocking M1 before the timeout, thread B gets the
+ *   mutex.
+ * - [8.10.5] Checking the order of operations.
+ * .
+ */
+
+static void rt_test_008_010_setup(void) {
+  chMtxObjectInit(&m1);
+}
+
+static void rt_test_008_010_execute(void) {
+  tprio_t prio;
+
+  /* [8.10.1] Reading current base priority and locking M1.*/
+  test_set_step(1);
+  {
+    prio = chThdGetPriorityX();
+    chMtxLock(&m1);
+  }
+  test_end_step(1);
+
+  /* [8.10.2] Thread A is created at priority P(+1), it waits on M1
+     with timeout and boosts the owner priority to P(+1).*/
+  test_set_step(2);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread10, "A");
+    test_assert(chThdGetPriorityX() == prio + 1, "not boosted");
+  }
+  test_end_step(2);
+
+  /* [8.10.3] Waiting for thread A to time out, the owner priority must
+     go back to P.*/
+  test_set_step(3);
+  {
+    test_wait_threads();
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_assert(m1.owner == chThdGetSelfX(), "not owned");
+    test_assert(ch_queue_isempty(&m1.queue), "queue not empty");
+  }
+  test_end_step(3);
+
+  /* [8.10.4] Thread B is created at priority P(+1), it waits on M1
+     with timeout. Unlocking M1 before the timeout, thread B gets the
+     mutex.*/
+  test_set_step(4);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread10, "B");
+    test_assert(chThdGetPriorityX() == prio + 1, "not boosted");
+    chMtxUnlock(&m1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+  }
+  test_end_step(4);
+
+  /* [8.10.5] Checking the order of operations.*/
+  test_set_step(5);
+  {
+    test_wait_threads();
+    test_assert(m1.owner == NULL, "still owned");
+    test_assert_sequence("TB", "invalid sequence");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_008_010 = {
+  "Mutex lock with timeout",
+  rt_test_008_010_setup,
+  NULL,
+  rt_test_008_010_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -1109,6 +1206,7 @@ const testcase_t * const rt_test_sequence_008_array[] = {
 #if (CH_CFG_USE_CONDVARS == TRUE) || defined(__DOXYGEN__)
   &rt_test_008_009,
 #endif
+  &rt_test_008_010,
   NULL
 };
 
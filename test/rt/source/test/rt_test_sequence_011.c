@@ -38,6 +38,7 @@
  * <h2>Test Cases</h2>
  * - @subpage rt_test_011_001
  * - @subpage rt_test_011_002
+ * - @subpage rt_test_011_003
  * .
  */
 
@@ -52,6 +53,7 @@ static memory_heap_t heap1;
 #endif
 #if CH_CFG_USE_MEMPOOLS
 static memory_pool_t mp1;
+static thread_cache_t tc1;
 #endif
 
 static THD_FUNCTION(dyn_thread1, p) {
@@ -276,6 +278,109 @@ static const testcase_t rt_test_011_002 = {
 };
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_011_003 [11.3] Threads creation from working areas cache
+ *
+ * <h2>Description</h2>
+ * Three thread creations are attempted from a cache whose single size
+ * class contains only two working areas.<br> The test expects the
+ * first two threads to start from cached working areas and the third
+ * one to fail without being counted as a miss, then the working areas
+ * are expected to be reused after the threads termination.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MEMPOOLS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.3.1] Adding two working areas to the cache.
+ * - [11.3.2] Getting base priority for threads.
+ * - [11.3.3] Creating three threads, the third is expected to fail.
+ * - [11.3.4] Letting them run, free the memory then checking the
+ *   execution sequence.
+ * - [11.3.5] Creating two more threads, the working areas are expected
+ *   to be reused.
+ * .
+ */
+
+static void rt_test_011_003_setup(void) {
+  chPoolObjectInitAligned(&mp1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                          PORT_WORKING_AREA_ALIGN, NULL);
+  chThdCacheObjectInit(&tc1, &mp1, 1U);
+}
+
+static void rt_test_011_003_execute(void) {
+  unsigned i;
+  tprio_t prio;
+
+  /* [11.3.1] Adding two working areas to the cache.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < 2; i++)
+      chPoolFree(&mp1, wa[i]);
+  }
+  test_end_step(1);
+
+  /* [11.3.2] Getting base priority for threads.*/
+  test_set_step(2);
+  {
+    prio = chThdGetPriorityX();
+  }
+  test_end_step(2);
+
+  /* [11.3.3] Creating three threads, the third is expected to fail.*/
+  test_set_step(3);
+  {
+    threads[0] = chThdCreateFromCache(&tc1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                                      "dyn1", prio-1, dyn_thread1, "A");
+    threads[1] = chThdCreateFromCache(&tc1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                                      "dyn2", prio-2, dyn_thread1, "B");
+    threads[2] = chThdCreateFromCache(&tc1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                                      "dyn3", prio-3, dyn_thread1, "C");
+    test_assert((threads[0] != NULL) && (threads[1] != NULL),
+                "thread creation failed");
+    test_assert(threads[2] == NULL, "thread creation not failed");
+    test_assert((tc1.hits == 2U) && (tc1.misses == 0U), "wrong statistics");
+  }
+  test_end_step(3);
+
+  /* [11.3.4] Letting them run, free the memory then checking the
+     execution sequence.*/
+  test_set_step(4);
+  {
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(4);
+
+  /* [11.3.5] Creating two more threads, the working areas are expected
+     to be reused.*/
+  test_set_step(5);
+  {
+    threads[0] = chThdCreateFromCache(&tc1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                                      "dyn4", prio-1, dyn_thread1, "D");
+    threads[1] = chThdCreateFromCache(&tc1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE),
+                                      "dyn5", prio-2, dyn_thread1, "E");
+    test_assert((threads[0] != NULL) && (threads[1] != NULL),
+                "thread creation failed");
+    test_wait_threads();
+    test_assert_sequence("DE", "invalid sequence");
+    test_assert((tc1.hits == 4U) && (tc1.misses == 0U), "wrong statistics");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_011_003 = {
+  "Threads creation from working areas cache",
+  rt_test_011_003_setup,
+  NULL,
+  rt_test_011_003_execute
+};
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -289,6 +394,9 @@ const testcase_t * const rt_test_sequence_011_array[] = {
 #endif
 #if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
   &rt_test_011_002,
+#endif
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_011_003,
 #endif
   NULL
 };
@@ -46,6 +46,8 @@
  * - @subpage rt_test_012_010
  * - @subpage rt_test_012_011
  * - @subpage rt_test_012_012
+ * - @subpage rt_test_012_013
+ * - @subpage rt_test_012_014
  * .
  */
 
@@ -95,6 +97,134 @@ NOINLINE static unsigned int msg_loop_test(thread_t *tp) {
   (void)chMsgSend(tp, 0);
   return n;
 }
+
+/* Buffer messages server, a non-NULL parameter selects the combined
+   release and wait call instead of a release followed by a wait.*/
+static THD_FUNCTION(bmk_thread2, p) {
+  thread_t *tp;
+  msg_buffer_t *mbp;
+
+  tp = chMsgWait();
+  while (true) {
+    mbp = chMsgGetBuffer(tp);
+    if (mbp->n == 0U) {
+      chMsgRelease(tp, MSG_OK);
+      break;
+    }
+    (*(uint32_t *)mbp->buffer)++;
+    if (p != NULL) {
+      tp = chMsgReleaseAndWait(tp, MSG_OK);
+    }
+    else {
+      chMsgRelease(tp, MSG_OK);
+      tp = chMsgWait();
+    }
+  }
+}
+
+NOINLINE static unsigned int msg_buffer_loop_test(thread_t *tp) {
+  systime_t start, end;
+  uint32_t data = 0;
+  msg_buffer_t mb = {&data, sizeof data, sizeof data};
+
+  uint32_t n = 0;
+  start = test_wait_tick();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    (void)chMsgSendBuffer(tp, &mb);
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+  mb.n = 0U;
+  (void)chMsgSendBuffer(tp, &mb);
+  return n;
+}
+#endif
+
+#if CH_CFG_USE_EDF || defined(__DOXYGEN__)
+#define EDF_UNIT                TIME_MS2I(5)
+
+/* Test case 12.14 records four scores.*/
+#if TEST_CFG_BENCHMARK_MAX_SCORES < 4
+#error "TEST_CFG_BENCHMARK_MAX_SCORES too small for the EDF benchmark"
+#endif
+
+typedef struct {
+  sysinterval_t         period;
+  uint32_t              wcet;
+  unsigned              jobs;
+  edf_stats_t           stats;
+} edf_task_t;
+
+static uint32_t edf_loops;
+static systime_t edf_start;
+
+NOINLINE static void edf_spin(uint32_t n) {
+  volatile uint32_t i = n;
+
+  while (i > 0U) {
+    i--;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static void edf_calibrate(void) {
+  uint32_t n = 256U;
+  sysinterval_t elapsed;
+
+  do {
+    systime_t start;
+
+    n *= 2U;
+    start = test_wait_tick();
+    edf_spin(n);
+    elapsed = chTimeDiffX(start, chVTGetSystemTimeX());
+  } while (elapsed < EDF_UNIT * 4);
+  edf_loops = (uint32_t)(((uint64_t)n * (uint64_t)EDF_UNIT) /
+                         (uint64_t)elapsed);
+}
+
+static THD_FUNCTION(edf_task_thread, p) {
+  edf_task_t *etp = (edf_task_t *)p;
+  systime_t release;
+  unsigned i;
+
+  /* Waiting for the first release, no job is in progress yet.*/
+  release = chThdSleepUntilRelease(chVTGetSystemTimeX(), edf_start,
+                                   etp->period);
+  for (i = 0U; i < etp->jobs; i++) {
+    edf_spin(edf_loops * etp->wcet);
+    release = chThdSleepUntilRelease(release,
+                                     chTimeAddX(release, etp->period),
+                                     etp->period);
+  }
+  chThdGetDeadlineStats(chThdGetSelfX(), &etp->stats);
+}
+
+static uint32_t edf_run(edf_task_t *tasks, bool edf) {
+  unsigned i;
+  uint32_t misses = 0U;
+
+  /* Task zero has the shortest period, with fixed priorities it gets the
+     highest priority.*/
+  edf_start = chTimeAddX(chVTGetSystemTimeX(), EDF_UNIT * 2);
+  for (i = 0U; i < 2U; i++) {
+    threads[i] = chThdCreateStatic(wa[i], WA_SIZE,
+                                   edf ? CH_CFG_EDF_PRIORITY :
+                                         CH_CFG_EDF_PRIORITY - 1 - i,
+                                   edf_task_thread, (void *)&tasks[i]);
+  }
+  test_wait_threads();
+  for (i = 0U; i < 2U; i++) {
+    misses += (uint32_t)tasks[i].stats.misses;
+  }
+
+  return misses;
+}
 #endif
 
 static THD_FUNCTION(bmk_thread3, p) {
@@ -194,6 +324,7 @@ static void rt_test_012_001_execute(void) {
     test_print(" msgs/S, ");
     test_printn(n << 1);
     test_println(" ctxswc/S");
+    test_record_score(n, "msgs/S");
   }
   test_end_step(3);
 }
@@ -258,6 +389,7 @@ static void rt_test_012_002_execute(void) {
     test_print(" msgs/S, ");
     test_printn(n << 1);
     test_println(" ctxswc/S");
+    test_record_score(n, "msgs/S");
   }
   test_end_step(3);
 }
@@ -336,6 +468,7 @@ static void rt_test_012_003_execute(void) {
     test_print(" msgs/S, ");
     test_printn(n << 1);
     test_println(" ctxswc/S");
+    test_record_score(n, "msgs/S");
   }
   test_end_step(4);
 }
@@ -419,6 +552,7 @@ static void rt_test_012_004_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 2);
     test_println(" ctxswc/S");
+    test_record_score(n * 2, "ctxswc/S");
   }
   test_end_step(4);
 }
@@ -477,6 +611,7 @@ static void rt_test_012_005_execute(void) {
     test_print("--- Score : ");
     test_printn(n);
     test_println(" threads/S");
+    test_record_score(n, "threads/S");
   }
   test_end_step(2);
 }
@@ -540,6 +675,7 @@ static void rt_test_012_006_execute(void) {
     test_print("--- Score : ");
     test_printn(n);
     test_println(" threads/S");
+    test_record_score(n, "threads/S");
   }
   test_end_step(2);
 }
@@ -632,6 +768,7 @@ static void rt_test_012_007_execute(void) {
     test_print(" reschedules/S, ");
     test_printn(n * 6);
     test_println(" ctxswc/S");
+    test_record_score(n, "reschedules/S");
   }
   test_end_step(4);
 }
@@ -695,6 +832,7 @@ static void rt_test_012_008_execute(void) {
     test_print("--- Score : ");
     test_printn(n);
     test_println(" ctxswc/S");
+    test_record_score(n, "ctxswc/S");
   }
   test_end_step(3);
 }
@@ -757,6 +895,7 @@ static void rt_test_012_009_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 2);
     test_println(" timers/S");
+    test_record_score(n * 2, "timers/S");
   }
   test_end_step(2);
 }
@@ -830,6 +969,7 @@ static void rt_test_012_010_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 4);
     test_println(" wait+signal/S");
+    test_record_score(n * 4, "wait+signal/S");
   }
   test_end_step(2);
 }
@@ -904,6 +1044,7 @@ static void rt_test_012_011_execute(void) {
     test_print("--- Score : ");
     test_printn(n * 4);
     test_println(" lock+unlock/S");
+    test_record_score(n * 4, "lock+unlock/S");
   }
   test_end_step(2);
 }
@@ -1038,6 +1179,202 @@ static const testcase_t rt_test_012_012 = {
   rt_test_012_012_execute
 };
 
+#if (CH_CFG_USE_MESSAGES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_012_013 [12.13] Messages performance #4
+ *
+ * <h2>Description</h2>
+ * Buffer messages are served by a release followed by a wait and by
+ * the combined release and wait call, with the server at lower and at
+ * higher priority than the client. The combined call saves a context
+ * switch only when the released client has a higher priority than the
+ * server, with a higher priority server the two scores are expected to
+ * match.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MESSAGES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [12.13.1] The server thread is started at a lower priority than
+ *   the current thread, the number of buffers exchanged is counted in
+ *   a one second time window, first with separate release and wait
+ *   then with the combined call.
+ * - [12.13.2] The server thread is started at a higher priority than
+ *   the current thread, the number of buffers exchanged is counted in
+ *   a one second time window, first with separate release and wait
+ *   then with the combined call.
+ * - [12.13.3] Scores are printed.
+ * .
+ */
+
+static void rt_test_012_013_execute(void) {
+  uint32_t n1, n2, n3, n4;
+
+  /* [12.13.1] The server thread is started at a lower priority than
+     the current thread, the number of buffers exchanged is counted in
+     a one second time window, first with separate release and wait
+     then with the combined call.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, bmk_thread2, NULL);
+    n1 = msg_buffer_loop_test(threads[0]);
+    test_wait_threads();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, bmk_thread2, (void *)1);
+    n2 = msg_buffer_loop_test(threads[0]);
+    test_wait_threads();
+  }
+  test_end_step(1);
+
+  /* [12.13.2] The server thread is started at a higher priority than
+     the current thread, the number of buffers exchanged is counted in
+     a one second time window, first with separate release and wait
+     then with the combined call.*/
+  test_set_step(2);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, bmk_thread2, NULL);
+    n3 = msg_buffer_loop_test(threads[0]);
+    test_wait_threads();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, bmk_thread2, (void *)1);
+    n4 = msg_buffer_loop_test(threads[0]);
+    test_wait_threads();
+  }
+  test_end_step(2);
+
+  /* [12.13.3] Scores are printed.*/
+  test_set_step(3);
+  {
+    test_print("--- Score : ");
+    test_printn(n1);
+    test_println(" msgs/S (lower server, release then wait)");
+    test_record_score(n1, "msgs/S (lower server, release then wait)");
+    test_print("--- Score : ");
+    test_printn(n2);
+    test_println(" msgs/S (lower server, combined)");
+    test_record_score(n2, "msgs/S (lower server, combined)");
+    test_print("--- Score : ");
+    test_printn(n3);
+    test_println(" msgs/S (higher server, release then wait)");
+    test_record_score(n3, "msgs/S (higher server, release then wait)");
+    test_print("--- Score : ");
+    test_printn(n4);
+    test_println(" msgs/S (higher server, combined)");
+    test_record_score(n4, "msgs/S (higher server, combined)");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_012_013 = {
+  "Messages performance #4",
+  NULL,
+  NULL,
+  rt_test_012_013_execute
+};
+#endif /* CH_CFG_USE_MESSAGES == TRUE */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_012_014 [12.14] EDF versus fixed priorities under overload
+ *
+ * <h2>Description</h2>
+ * Two periodic tasks are executed first with rate-monotonic fixed
+ * priorities then in the EDF band, the jobs are busy loops calibrated
+ * in units of 5mS. A set with 90% utilization is not schedulable with
+ * fixed priorities but it is with EDF, a set with 111% utilization
+ * overloads both policies. The deadline misses are counted over two
+ * hyperperiods.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [12.14.1] The busy loop is calibrated and the task sets are
+ *   initialized, periods and execution times are 10/4 and 14/7 units
+ *   for the first set, 10/4 and 14/10 units for the second set.
+ * - [12.14.2] The first set is executed with fixed priorities then
+ *   with EDF.
+ * - [12.14.3] The second set is executed with fixed priorities then
+ *   with EDF.
+ * - [12.14.4] Scores are printed.
+ * .
+ */
+
+static void rt_test_012_014_execute(void) {
+  static edf_task_t set1[2], set2[2];
+  uint32_t rm1, edf1, rm2, edf2;
+
+  /* [12.14.1] The busy loop is calibrated and the task sets are
+     initialized, periods and execution times are 10/4 and 14/7 units
+     for the first set, 10/4 and 14/10 units for the second set.*/
+  test_set_step(1);
+  {
+    edf_calibrate();
+    set1[0].period = EDF_UNIT * 10;
+    set1[0].wcet   = 4U;
+    set1[0].jobs   = 14U;
+    set1[1].period = EDF_UNIT * 14;
+    set1[1].wcet   = 7U;
+    set1[1].jobs   = 10U;
+    set2[0]        = set1[0];
+    set2[1]        = set1[1];
+    set2[1].wcet   = 10U;
+  }
+  test_end_step(1);
+
+  /* [12.14.2] The first set is executed with fixed priorities then
+     with EDF.*/
+  test_set_step(2);
+  {
+    rm1  = edf_run(set1, false);
+    edf1 = edf_run(set1, true);
+  }
+  test_end_step(2);
+
+  /* [12.14.3] The second set is executed with fixed priorities then
+     with EDF.*/
+  test_set_step(3);
+  {
+    rm2  = edf_run(set2, false);
+    edf2 = edf_run(set2, true);
+  }
+  test_end_step(3);
+
+  /* [12.14.4] Scores are printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(rm1);
+    test_println(" misses (fixed priorities, U=90%)");
+    test_record_score(rm1, "misses (fixed priorities, U=90%)");
+    test_print("--- Score : ");
+    test_printn(edf1);
+    test_println(" misses (EDF, U=90%)");
+    test_record_score(edf1, "misses (EDF, U=90%)");
+    test_print("--- Score : ");
+    test_printn(rm2);
+    test_println(" misses (fixed priorities, U=111%)");
+    test_record_score(rm2, "misses (fixed priorities, U=111%)");
+    test_print("--- Score : ");
+    test_printn(edf2);
+    test_println(" misses (EDF, U=111%)");
+    test_record_score(edf2, "misses (EDF, U=111%)");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_012_014 = {
+  "EDF versus fixed priorities under overload",
+  NULL,
+  NULL,
+  rt_test_012_014_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -1070,6 +1407,12 @@ const testcase_t * const rt_test_sequence_012_array[] = {
   &rt_test_012_011,
 #endif
   &rt_test_012_012,
+#if (CH_CFG_USE_MESSAGES == TRUE) || defined(__DOXYGEN__)
+  &rt_test_012_013,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_012_014,
+#endif
   NULL
 };
 
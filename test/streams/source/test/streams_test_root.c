@@ -0,0 +1,150 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @mainpage Test Suite Specification
+ * Test suite for the ChibiOS/HAL streams utilities. The purpose of
+ * this suite is to check the numeric conversions and the formatted
+ * input functions against known results, including floating point
+ * inputs whose rounding depends on digits beyond those kept by an
+ * accumulator.
+ *
+ * <h2>Test Sequences</h2>
+ * - @subpage streams_test_sequence_001
+ * - @subpage streams_test_sequence_002
+ * .
+ */
+
+/**
+ * @file    streams_test_root.c
+ * @brief   Test Suite root structures code.
+ */
+
+#include "hal.h"
+#include "streams_test_root.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Array of test sequences.
+ */
+const testsequence_t * const streams_test_suite_array[] = {
+  &streams_test_sequence_001,
+  &streams_test_sequence_002,
+  NULL
+};
+
+/**
+ * @brief   Test suite root structure.
+ */
+const testsuite_t streams_test_suite = {
+  "ChibiOS/HAL Streams Test Suite",
+  streams_test_suite_array
+};
+
+/*===========================================================================*/
+/* Shared code.                                                              */
+/*===========================================================================*/
+
+/*
+ * Numbers and their correctly rounded double and float representations.
+ */
+const streams_float_case_t streams_float_cases[31] = {
+  {"0",
+   0x0000000000000000U, 0x00000000U},
+  {"-0.0",
+   0x8000000000000000U, 0x80000000U},
+  {"1",
+   0x3FF0000000000000U, 0x3F800000U},
+  {"3.14159",
+   0x400921F9F01B866EU, 0x40490FD0U},
+  {"4807.038",
+   0x40B2C709BA5E353FU, 0x4596384EU},
+  {"1e23",
+   0x44B52D02C7E14AF6U, 0x65A96816U},
+  {"8.98846567431158e307",
+   0x7FE0000000000000U, 0x7F800000U},
+  {"1.7976931348623157e308",
+   0x7FEFFFFFFFFFFFFFU, 0x7F800000U},
+  {"1.7976931348623159e308",
+   0x7FF0000000000000U, 0x7F800000U},
+  {"2.4703282292062327e-324",
+   0x0000000000000000U, 0x00000000U},
+  {"2.4703282292062328e-324",
+   0x0000000000000001U, 0x00000000U},
+  {"2.2250738585072011e-308",
+   0x000FFFFFFFFFFFFFU, 0x00000000U},
+  {"9007199254740993",
+   0x4340000000000000U, 0x5A000000U},
+  {"0.1",
+   0x3FB999999999999AU, 0x3DCCCCCDU},
+  {"1e-400",
+   0x0000000000000000U, 0x00000000U},
+  {"1e400",
+   0x7FF0000000000000U, 0x7F800000U},
+  {"0x1.fffffffffffff8p1023",
+   0x7FF0000000000000U, 0x7F800000U},
+  {"0x123.abcp-5",
+   0x40223ABC00000000U, 0x4111D5E0U},
+  {"1.00000005960464477539062499",
+   0x3FF0000010000000U, 0x3F800000U},
+  {"1.000000059604644775390625",
+   0x3FF0000010000000U, 0x3F800000U},
+  {"1.00000005960464477539062501",
+   0x3FF0000010000000U, 0x3F800001U},
+  {"123456789012345678901234567890",
+   0x45F8EE90FF6C373EU, 0x6FC77488U},
+  {"14934968458854688440360.86725e2",
+   0x44F3C42A0519F69DU, 0x679E2150U},
+  {"1797693134862315807937289714053034150799341327100378269361737789"
+   "8044496829276475094664901797758720709633028641669288791094655554"
+   "7851940402630657488671505820681908902000708383676273854845817711"
+   "5317644757302700698555713669596228429148198608349364752927190741"
+   "68444365510704342711559699508093042880177904174497791.9999999999"
+   "999999999999999999999999999999999999999999999999999999999999",
+   0x7FEFFFFFFFFFFFFFU, 0x7F800000U},
+  {"2.47032822920623272088284396434110686182529901307162382212792841"
+   "2503377536351043759326499181808179961898982823477228588654633283"
+   "5517796989819938739800539093906315035659515570226392290858392449"
+   "1051844359318028499365361525003193704576782492193656236698636584"
+   "8075700158576926990370631192827955855133292783433840935197801553"
+   "1246597263579574622766465272827220056374006485499977096599470454"
+   "0208281662262378573934507363390079677619305775067401763246736009"
+   "6895134053553745851666113422376667860416215968046191446729184030"
+   "0530057530849048765391711386591646239524912623653881879636239373"
+   "2804238910186723484976682350898633885879256283027559956575244555"
+   "0725518931369083625477918694866799496832404970582102851318545139"
+   "62138377228261454376934125320985913276672363281255e-324",
+   0x0000000000000001U, 0x00000000U},
+  {"7.038531e-26",
+   0x3AB5C87FB0000000U, 0x15AE43FDU},
+  {"3.4028235e38",
+   0x47EFFFFFE54DAFF8U, 0x7F7FFFFFU},
+  {"3.4028236e38",
+   0x47EFFFFFF514A7BCU, 0x7F800000U},
+  {"1.4e-45",
+   0x369FF868BF4D956AU, 0x00000001U},
+  {"7e-46",
+   0x368FF868BF4D956AU, 0x00000000U},
+  {"7.1e-46",
+   0x369036AA2680F22CU, 0x00000001U}
+};
+
+#endif /* !defined(__DOXYGEN__) */
@@ -0,0 +1,74 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    streams_test_root.h
+ * @brief   Test Suite root structures header.
+ */
+
+#ifndef STREAMS_TEST_ROOT_H
+#define STREAMS_TEST_ROOT_H
+
+#include "ch_test.h"
+
+#include "streams_test_sequence_001.h"
+#include "streams_test_sequence_002.h"
+
+#if !defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testsuite_t streams_test_suite;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+#include <string.h>
+#include <float.h>
+
+#include "chconv.h"
+#include "chscanf.h"
+
+/*
+ * Floating point parsing test case.
+ */
+typedef struct {
+  const char        *s;
+  uint64_t          d;
+  uint32_t          f;
+} streams_float_case_t;
+
+/*
+ * Number of floating point parsing test cases.
+ */
+#define STREAMS_FLOAT_CASES                                                 \
+  (sizeof streams_float_cases / sizeof streams_float_cases[0])
+
+extern const streams_float_case_t streams_float_cases[31];
+
+#endif /* !defined(__DOXYGEN__) */
+
+#endif /* STREAMS_TEST_ROOT_H */
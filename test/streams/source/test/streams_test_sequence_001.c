@@ -0,0 +1,226 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "streams_test_root.h"
+
+/**
+ * @file    streams_test_sequence_001.c
+ * @brief   Test Sequence 001 code.
+ *
+ * @page streams_test_sequence_001 [1] Numeric conversions
+ *
+ * File: @ref streams_test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the numeric conversions shared by the formatter
+ * utilities.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage streams_test_001_001
+ * - @subpage streams_test_001_002
+ * - @subpage streams_test_001_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page streams_test_001_001 [1.1] Integer conversions
+ *
+ * <h2>Description</h2>
+ * Spans of characters are converted to unsigned long integers and
+ * back.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.1.1] Converting spans in the various bases, the end pointer
+ *   must point after the last digit.
+ * - [1.1.2] Converting numbers to strings with a minimum number of
+ *   digits.
+ * .
+ */
+
+static void streams_test_001_001_execute(void) {
+  const char *endp;
+  char buf[16];
+
+  /* [1.1.1] Converting spans in the various bases, the end pointer
+     must point after the last digit.*/
+  test_set_step(1);
+  {
+    static const char s1[] = "4294967295", s2[] = "0x1Fg", s3[] = "017", s4[] = "zz";
+
+    test_assert(ch_strntoul(s1, s1 + sizeof s1 - 1U, &endp, 10U) == 4294967295UL,
+                "wrong decimal value");
+    test_assert(endp == s1 + 10, "wrong end pointer");
+    test_assert(ch_strntoul(s2, s2 + sizeof s2 - 1U, &endp, 0U) == 0x1FUL,
+                "wrong hexadecimal value");
+    test_assert(endp == s2 + 4, "wrong end pointer");
+    test_assert(ch_strntoul(s3, s3 + sizeof s3 - 1U, &endp, 0U) == 017UL,
+                "wrong octal value");
+    test_assert(ch_strntoul(s4, s4 + sizeof s4 - 1U, &endp, 10U) == 0UL,
+                "not a number");
+    test_assert(endp == s4, "wrong end pointer");
+  }
+  test_end_step(1);
+
+  /* [1.1.2] Converting numbers to strings with a minimum number of
+     digits.*/
+  test_set_step(2);
+  {
+    *ch_ultoa(buf, 0xFFFFFFFFUL, 16U, 1U) = '\0';
+    test_assert(strcmp(buf, "FFFFFFFF") == 0, "wrong hexadecimal string");
+    *ch_ultoa(buf, 5UL, 10U, 4U) = '\0';
+    test_assert(strcmp(buf, "0005") == 0, "wrong padding");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t streams_test_001_001 = {
+  "Integer conversions",
+  NULL,
+  NULL,
+  streams_test_001_001_execute
+};
+
+/**
+ * @page streams_test_001_002 [1.2] Floating point parsing
+ *
+ * <h2>Description</h2>
+ * Spans of characters are converted to float and double numbers, the
+ * results are compared bit by bit with the correctly rounded values.
+ * The table includes halfway cases, denormals, overflows and numbers
+ * with more significant digits than an accumulator can hold.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.2.1] Converting all the numbers in the table.
+ * - [1.2.2] Checking special values and partial numbers.
+ * .
+ */
+
+static void streams_test_001_002_execute(void) {
+  unsigned i;
+  const char *endp;
+
+  /* [1.2.1] Converting all the numbers in the table.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < STREAMS_FLOAT_CASES; i++) {
+      const char *s = streams_float_cases[i].s;
+      const char *end = s + strlen(s);
+      union {
+        double    d;
+        uint64_t  u;
+      } d;
+      union {
+        float     f;
+        uint32_t  u;
+      } f;
+
+      d.d = ch_strntod(s, end, &endp);
+      test_assert(endp == end, "wrong end pointer");
+      test_assert(d.u == streams_float_cases[i].d, "wrong double value");
+      f.f = ch_strntof(s, end, &endp);
+      test_assert(f.u == streams_float_cases[i].f, "wrong float value");
+    }
+  }
+  test_end_step(1);
+
+  /* [1.2.2] Checking special values and partial numbers.*/
+  test_set_step(2);
+  {
+    static const char s1[] = "-Infinity", s2[] = "1e+", s3[] = "nanx";
+
+    test_assert(ch_strntod(s1, s1 + sizeof s1 - 1U, &endp) < -DBL_MAX,
+                "not infinity");
+    test_assert(endp == s1 + 9, "wrong end pointer");
+    test_assert(ch_strntod(s2, s2 + sizeof s2 - 1U, &endp) == 1.0,
+                "wrong value");
+    test_assert(endp == s2 + 1, "exponent consumed");
+    (void) ch_strntod(s3, s3 + sizeof s3 - 1U, &endp);
+    test_assert(endp == s3 + 3, "wrong end pointer");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t streams_test_001_002 = {
+  "Floating point parsing",
+  NULL,
+  NULL,
+  streams_test_001_002_execute
+};
+
+/**
+ * @page streams_test_001_003 [1.3] Floating point formatting
+ *
+ * <h2>Description</h2>
+ * Numbers are converted to strings with a fixed precision, the digits
+ * beyond the precision are truncated.
+ *
+ * <h2>Test Steps</h2>
+ * - [1.3.1] Converting numbers with and without fractional digits.
+ * .
+ */
+
+static void streams_test_001_003_execute(void) {
+  char buf[32];
+
+  /* [1.3.1] Converting numbers with and without fractional digits.*/
+  test_set_step(1);
+  {
+    *ch_ftoa(buf, 3.14159, 2U) = '\0';
+    test_assert(strcmp(buf, "3.14") == 0, "wrong string");
+    *ch_ftoa(buf, 2.5, 1U) = '\0';
+    test_assert(strcmp(buf, "2.5") == 0, "wrong string");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t streams_test_001_003 = {
+  "Floating point formatting",
+  NULL,
+  NULL,
+  streams_test_001_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const streams_test_sequence_001_array[] = {
+  &streams_test_001_001,
+  &streams_test_001_002,
+  &streams_test_001_003,
+  NULL
+};
+
+/**
+ * @brief   Numeric conversions.
+ */
+const testsequence_t streams_test_sequence_001 = {
+  "Numeric conversions",
+  streams_test_sequence_001_array
+};
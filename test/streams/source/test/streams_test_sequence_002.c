@@ -0,0 +1,172 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "streams_test_root.h"
+
+/**
+ * @file    streams_test_sequence_002.c
+ * @brief   Test Sequence 002 code.
+ *
+ * @page streams_test_sequence_002 [2] Formatted input
+ *
+ * File: @ref streams_test_sequence_002.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the formatted input from strings.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage streams_test_002_001
+ * - @subpage streams_test_002_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page streams_test_002_001 [2.1] Integers and strings
+ *
+ * <h2>Description</h2>
+ * Integers and strings are parsed from a buffer, conversions stop at
+ * the first mismatch.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.1.1] Parsing a line with several conversions.
+ * - [2.1.2] Parsing with field widths and a limited buffer size.
+ * .
+ */
+
+static void streams_test_002_001_execute(void) {
+  char buf[40], s1[8], s2[8];
+  int r, a, b;
+  unsigned x;
+  unsigned long l;
+
+  /* [2.1.1] Parsing a line with several conversions.*/
+  test_set_step(1);
+  {
+    strcpy(buf, "12 ff abc de -7% 4294967295");
+    r = chsnscanf(buf, sizeof buf, "%d %x %s %2s %i%% %lu",
+                  &a, &x, s1, s2, &b, &l);
+    test_assert(r == 6, "wrong number of conversions");
+    test_assert((a == 12) && (x == 0xFFU) && (b == -7) && (l == 4294967295UL),
+                "wrong integers");
+    test_assert((strcmp(s1, "abc") == 0) && (strcmp(s2, "de") == 0),
+                "wrong strings");
+  }
+  test_end_step(1);
+
+  /* [2.1.2] Parsing with field widths and a limited buffer size.*/
+  test_set_step(2);
+  {
+    strcpy(buf, "123456");
+    r = chsnscanf(buf, sizeof buf, "%3d%d", &a, &b);
+    test_assert((r == 2) && (a == 123) && (b == 456), "wrong widths");
+    strcpy(buf, "12345");
+    r = chsnscanf(buf, 3U, "%d", &a);
+    test_assert((r == 1) && (a == 123), "buffer size not respected");
+    strcpy(buf, "x");
+    r = chsnscanf(buf, sizeof buf, "%d", &a);
+    test_assert(r == 0, "mismatch not detected");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t streams_test_002_001 = {
+  "Integers and strings",
+  NULL,
+  NULL,
+  streams_test_002_001_execute
+};
+
+#if (CHSCANF_USE_FLOAT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page streams_test_002_002 [2.2] Floating point numbers
+ *
+ * <h2>Description</h2>
+ * An NMEA sentence is parsed, the floating point fields must be
+ * correctly rounded.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CHSCANF_USE_FLOAT == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.2.1] Parsing a GGA sentence.
+ * .
+ */
+
+static void streams_test_002_002_execute(void) {
+  char buf[64], ns, ew;
+  unsigned t;
+  int r, q, sats;
+  float hdop;
+  double lat, lon, alt, hd;
+
+  /* [2.2.1] Parsing a GGA sentence.*/
+  test_set_step(1);
+  {
+    strcpy(buf, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9");
+    r = chsnscanf(buf, sizeof buf, "$GPGGA,%u,%lf,%c,%lf,%c,%d,%d,%f,%lf,M,%lf",
+                  &t, &lat, &ns, &lon, &ew, &q, &sats, &hdop, &alt, &hd);
+    test_assert(r == 10, "wrong number of conversions");
+    test_assert((t == 123519U) && (ns == 'N') && (ew == 'E') &&
+                (q == 1) && (sats == 8), "wrong fields");
+    test_assert((lat == 4807.038) && (lon == 1131.0) && (hdop == 0.9f) &&
+                (alt == 545.4) && (hd == 46.9), "wrong numbers");
+  }
+  test_end_step(1);
+}
+
+static const testcase_t streams_test_002_002 = {
+  "Floating point numbers",
+  NULL,
+  NULL,
+  streams_test_002_002_execute
+};
+#endif /* CHSCANF_USE_FLOAT == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const streams_test_sequence_002_array[] = {
+  &streams_test_002_001,
+#if (CHSCANF_USE_FLOAT == TRUE) || defined(__DOXYGEN__)
+  &streams_test_002_002,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Formatted input.
+ */
+const testsequence_t streams_test_sequence_002 = {
+  "Formatted input",
+  streams_test_sequence_002_array
+};
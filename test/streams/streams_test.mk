@@ -0,0 +1,7 @@
+# List of all the streams test files.
+TESTSRC += ${CHIBIOS}/test/streams/source/test/streams_test_root.c \
+           ${CHIBIOS}/test/streams/source/test/streams_test_sequence_001.c \
+           ${CHIBIOS}/test/streams/source/test/streams_test_sequence_002.c
+
+# Required include directories
+TESTINC += ${CHIBIOS}/test/streams/source/test